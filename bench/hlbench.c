@@ -0,0 +1,543 @@
+/* --------------------------------------------------------------------
+Copyright (C) 2026 Swedish Meteorological and Hydrological Institute, SMHI,
+
+This file is part of HLHDF.
+
+HLHDF is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+HLHDF is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with HLHDF.  If not, see <http://www.gnu.org/licenses/>.
+------------------------------------------------------------------------*/
+
+/**
+ * @file
+ * @date 2026-10-19
+
+Benchmarks reading, fetching, writing and updating of a generated file
+and reports the result as JSON.
+
+<b>hlbench [</b>-hk<b>] [</b>-g groups<b>] [</b>-n datasets<b>] [</b>-a attributes<b>]
+[</b>-x xsize<b>] [</b>-y ysize<b>] [</b>-t type<b>] [</b>-z compression<b>]
+[</b>-r repeats<b>] [</b>-f file<b>] [</b>-o output<b>]</b>
+
+<b>[-h]</b> Prints a help text.
+
+<b>[-k]</b> Keeps the generated file.
+
+<b>[-g groups]</b> Number of groups, default 10.
+
+<b>[-n datasets]</b> Number of datasets in each group, default 2.
+
+<b>[-a attributes]</b> Number of attributes in each group and dataset, default 10.
+
+<b>[-x xsize] [-y ysize]</b> Dataset dimensions, default 500x500.
+
+<b>[-t type]</b> Dataset format, one of uchar, short, ushort, int, float and double, default uchar.
+
+<b>[-z compression]</b> ZLIB compression level, 0 to 9, default 6. 0 means no compression.
+
+<b>[-r repeats]</b> Number of times each operation is timed, default 10.
+
+<b>[-f file]</b> The file to generate, default hlbench.h5.
+
+<b>[-o output]</b> The JSON report, default is stdout.
+ */
+#include <stdio.h>
+#include <unistd.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include <sys/resource.h>
+#include "hlhdf.h"
+
+/**
+ * The benchmark configuration.
+ */
+typedef struct {
+  int groups;          /**< number of groups */
+  int datasets;        /**< number of datasets in each group */
+  int attributes;      /**< number of attributes in each group and dataset */
+  int xsize;           /**< dataset x size */
+  int ysize;           /**< dataset y size */
+  const char* format;  /**< dataset format */
+  int compression;     /**< ZLIB level, 0 for none */
+  int repeats;         /**< number of timed runs for each operation */
+  const char* file;    /**< the generated file */
+} HLBenchConfig;
+
+/**
+ * Timings for one operation.
+ */
+typedef struct {
+  const char* name;    /**< the name of the operation */
+  double* seconds;     /**< the time of each run */
+  int n;               /**< number of runs */
+  size_t bytes;        /**< number of data bytes handled by each run */
+  size_t nodes;        /**< number of nodes handled by each run */
+} HLBenchResult;
+
+static char* ProcessName;
+
+static void PrintHelp(int all);
+
+/**
+ * Returns the current time in seconds from a monotonic clock.
+ */
+static double HLBench_now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/**
+ * Returns the peak resident set size of the process in kilobytes.
+ */
+static long HLBench_peakRss(void)
+{
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return -1;
+  }
+  return usage.ru_maxrss;
+}
+
+/**
+ * Returns the size of one value of the format or 0 if the format is not supported.
+ */
+static size_t HLBench_formatSize(const char* format)
+{
+  if (strcmp(format, "uchar") == 0) {
+    return sizeof(unsigned char);
+  } else if (strcmp(format, "short") == 0) {
+    return sizeof(short);
+  } else if (strcmp(format, "ushort") == 0) {
+    return sizeof(unsigned short);
+  } else if (strcmp(format, "int") == 0) {
+    return sizeof(int);
+  } else if (strcmp(format, "float") == 0) {
+    return sizeof(float);
+  } else if (strcmp(format, "double") == 0) {
+    return sizeof(double);
+  }
+  return 0;
+}
+
+/**
+ * Fills the dataset buffer with a pattern that compresses moderately.
+ */
+static void HLBench_fillData(const HLBenchConfig* config, unsigned char* data, int seed)
+{
+  size_t i, n = (size_t)config->xsize * (size_t)config->ysize;
+  for (i = 0; i < n; i++) {
+    int v = (int)((i * 7 + (i / config->xsize) * 3 + seed) % 251);
+    if (strcmp(config->format, "uchar") == 0) {
+      ((unsigned char*)data)[i] = (unsigned char)v;
+    } else if (strcmp(config->format, "short") == 0) {
+      ((short*)data)[i] = (short)v;
+    } else if (strcmp(config->format, "ushort") == 0) {
+      ((unsigned short*)data)[i] = (unsigned short)v;
+    } else if (strcmp(config->format, "int") == 0) {
+      ((int*)data)[i] = v;
+    } else if (strcmp(config->format, "float") == 0) {
+      ((float*)data)[i] = (float)v * 0.5f;
+    } else {
+      ((double*)data)[i] = (double)v * 0.5;
+    }
+  }
+}
+
+/**
+ * Adds config->attributes attributes below the parent node.
+ */
+static int HLBench_addAttributes(HL_NodeList* nodelist, const HLBenchConfig* config, const char* parent)
+{
+  char name[256];
+  int i;
+  for (i = 0; i < config->attributes; i++) {
+    HL_Node* node = NULL;
+    double value = (double)i * 1.5;
+    snprintf(name, sizeof(name), "%s/attr%d", parent, i);
+    if ((node = HLNode_newAttribute(name)) == NULL ||
+        !HLNode_setScalarValue(node, sizeof(double), (unsigned char*)&value, "double", -1) ||
+        !HLNodeList_addNode(nodelist, node)) {
+      HLNode_free(node);
+      return 0;
+    }
+  }
+  return 1;
+}
+
+/**
+ * Builds the node list that is written by the benchmark.
+ */
+static HL_NodeList* HLBench_createNodeList(const HLBenchConfig* config, size_t* nnodes)
+{
+  HL_NodeList* nodelist = NULL;
+  unsigned char* data = NULL;
+  hsize_t dims[2];
+  char name[256];
+  size_t dsize = HLBench_formatSize(config->format);
+  int g, d;
+
+  dims[0] = config->ysize;
+  dims[1] = config->xsize;
+  if ((nodelist = HLNodeList_new()) == NULL ||
+      (data = malloc(dims[0] * dims[1] * dsize)) == NULL) {
+    goto fail;
+  }
+  for (g = 0; g < config->groups; g++) {
+    HL_Node* node = NULL;
+    snprintf(name, sizeof(name), "/group%d", g);
+    if ((node = HLNode_newGroup(name)) == NULL || !HLNodeList_addNode(nodelist, node)) {
+      HLNode_free(node);
+      goto fail;
+    }
+    if (!HLBench_addAttributes(nodelist, config, name)) {
+      goto fail;
+    }
+    for (d = 0; d < config->datasets; d++) {
+      snprintf(name, sizeof(name), "/group%d/data%d", g, d);
+      HLBench_fillData(config, data, g * config->datasets + d);
+      if ((node = HLNode_newDataset(name)) == NULL ||
+          !HLNode_setArrayValue(node, dsize, 2, dims, data, config->format, -1) ||
+          !HLNodeList_addNode(nodelist, node)) {
+        HLNode_free(node);
+        goto fail;
+      }
+      if (!HLBench_addAttributes(nodelist, config, name)) {
+        goto fail;
+      }
+    }
+  }
+  *nnodes = (size_t)HLNodeList_getNumberOfNodes(nodelist);
+  free(data);
+  return nodelist;
+fail:
+  fprintf(stderr, "Failed to create node list\n");
+  HLNodeList_free(nodelist);
+  free(data);
+  return NULL;
+}
+
+/**
+ * Writes the node list to config->file.
+ */
+static int HLBench_write(const HLBenchConfig* config, HL_NodeList* nodelist)
+{
+  HL_Compression* compression = NULL;
+  int result = 0;
+  if (config->compression > 0) {
+    if ((compression = HLCompression_new(CT_ZLIB)) == NULL) {
+      return 0;
+    }
+    compression->level = config->compression;
+  }
+  result = HLNodeList_setFileName(nodelist, config->file) &&
+           HLNodeList_write(nodelist, NULL, compression);
+  HLCompression_free(compression);
+  return result;
+}
+
+/**
+ * The read and fetch variants that are timed.
+ */
+typedef enum {
+  HLBENCH_READ = 0,        /**< HLNodeList_read only */
+  HLBENCH_READ_METADATA,   /**< read, select all metadata and fetch */
+  HLBENCH_FETCH_ALL,       /**< read, select all and fetch */
+  HLBENCH_FETCH_DATASETS,  /**< read, select only datasets and fetch */
+  HLBENCH_FETCH_NODE,      /**< read and fetch one dataset */
+  HLBENCH_UPDATE           /**< read, add an attribute and update */
+} HLBenchOperation;
+
+/**
+ * Runs one read operation.
+ */
+static int HLBench_runRead(const HLBenchConfig* config, HLBenchOperation op, int run)
+{
+  HL_NodeList* nodelist = NULL;
+  int result = 0;
+
+  if ((nodelist = HLNodeList_read(config->file)) == NULL) {
+    return 0;
+  }
+  switch (op) {
+  case HLBENCH_READ:
+    result = 1;
+    break;
+  case HLBENCH_READ_METADATA:
+    result = HLNodeList_selectAllMetadataNodes(nodelist) && HLNodeList_fetchMarkedNodes(nodelist);
+    break;
+  case HLBENCH_FETCH_ALL:
+    result = HLNodeList_selectAllNodes(nodelist) && HLNodeList_fetchMarkedNodes(nodelist);
+    break;
+  case HLBENCH_FETCH_DATASETS:
+    result = HLNodeList_selectOnlyDatasetNodes(nodelist) && HLNodeList_fetchMarkedNodes(nodelist);
+    break;
+  case HLBENCH_FETCH_NODE:
+    result = (HLNodeList_fetchNode(nodelist, "/group0/data0") != NULL);
+    break;
+  case HLBENCH_UPDATE: {
+    char name[64];
+    HL_Node* node = NULL;
+    int value = run;
+    snprintf(name, sizeof(name), "/group0/update%d", run);
+    if ((node = HLNode_newAttribute(name)) == NULL ||
+        !HLNode_setScalarValue(node, sizeof(int), (unsigned char*)&value, "int", -1) ||
+        !HLNodeList_addNode(nodelist, node)) {
+      HLNode_free(node);
+      break;
+    }
+    result = HLNodeList_update(nodelist, NULL);
+    break;
+  }
+  default:
+    break;
+  }
+  HLNodeList_free(nodelist);
+  return result;
+}
+
+/**
+ * Compares two doubles for qsort.
+ */
+static int HLBench_compare(const void* a, const void* b)
+{
+  double da = *(const double*)a, db = *(const double*)b;
+  return (da < db) ? -1 : (da > db) ? 1 : 0;
+}
+
+/**
+ * Returns the p:th percentile of sorted values using linear interpolation.
+ */
+static double HLBench_percentile(const double* sorted, int n, double p)
+{
+  double pos = p / 100.0 * (double)(n - 1);
+  int i = (int)pos;
+  if (i >= n - 1) {
+    return sorted[n - 1];
+  }
+  return sorted[i] + (pos - (double)i) * (sorted[i + 1] - sorted[i]);
+}
+
+/**
+ * Prints one result as a JSON object.
+ */
+static void HLBench_printResult(FILE* fp, HLBenchResult* result, int last)
+{
+  double sum = 0.0, mean = 0.0;
+  int i;
+
+  qsort(result->seconds, result->n, sizeof(double), HLBench_compare);
+  for (i = 0; i < result->n; i++) {
+    sum += result->seconds[i];
+  }
+  mean = sum / (double)result->n;
+  fprintf(fp, "    {\"name\": \"%s\", \"runs\": %d, \"bytes\": %lu, \"nodes\": %lu,\n",
+          result->name, result->n, (unsigned long)result->bytes, (unsigned long)result->nodes);
+  fprintf(fp, "     \"latency_ms\": {\"min\": %.4f, \"mean\": %.4f, \"p50\": %.4f, \"p90\": %.4f, \"p99\": %.4f, \"max\": %.4f},\n",
+          result->seconds[0] * 1e3, mean * 1e3,
+          HLBench_percentile(result->seconds, result->n, 50.0) * 1e3,
+          HLBench_percentile(result->seconds, result->n, 90.0) * 1e3,
+          HLBench_percentile(result->seconds, result->n, 99.0) * 1e3,
+          result->seconds[result->n - 1] * 1e3);
+  fprintf(fp, "     \"throughput_mb_s\": %.3f, \"nodes_per_s\": %.1f}%s\n",
+          (mean > 0.0) ? (double)result->bytes / mean / (1024.0 * 1024.0) : 0.0,
+          (mean > 0.0) ? (double)result->nodes / mean : 0.0,
+          last ? "" : ",");
+}
+
+/**
+ * Main function
+ */
+int main(int argc, char** argv)
+{
+  extern char* optarg;
+  extern int opterr;
+  HLBenchConfig config;
+  HLBenchResult results[7];
+  static const char* names[] = {"read", "read_metadata", "fetch_all", "fetch_datasets", "fetch_node", "update"};
+  HL_NodeList* nodelist = NULL;
+  FILE* fp = stdout;
+  const char* output = NULL;
+  size_t nnodes = 0, dsbytes = 0;
+  int keep = 0, c, i, op, nresults = 0, exitcode = 1;
+  double start;
+
+  config.groups = 10;
+  config.datasets = 2;
+  config.attributes = 10;
+  config.xsize = 500;
+  config.ysize = 500;
+  config.format = "uchar";
+  config.compression = 6;
+  config.repeats = 10;
+  config.file = "hlbench.h5";
+  memset(results, 0, sizeof(results));
+
+  HL_init();
+  HL_setDebugMode(0);
+
+  ProcessName = argv[0];
+  opterr = 0;
+
+  while ((c = getopt(argc, argv, "hkg:n:a:x:y:t:z:r:f:o:")) != EOF) {
+    switch (c) {
+    case 'h':
+      PrintHelp(1);
+      exit(0);
+      break;
+    case 'k':
+      keep = 1;
+      break;
+    case 'g':
+      config.groups = atoi(optarg);
+      break;
+    case 'n':
+      config.datasets = atoi(optarg);
+      break;
+    case 'a':
+      config.attributes = atoi(optarg);
+      break;
+    case 'x':
+      config.xsize = atoi(optarg);
+      break;
+    case 'y':
+      config.ysize = atoi(optarg);
+      break;
+    case 't':
+      config.format = optarg;
+      break;
+    case 'z':
+      config.compression = atoi(optarg);
+      break;
+    case 'r':
+      config.repeats = atoi(optarg);
+      break;
+    case 'f':
+      config.file = optarg;
+      break;
+    case 'o':
+      output = optarg;
+      break;
+    default:
+      PrintHelp(0);
+      exit(1);
+      break;
+    }
+  }
+
+  if (config.groups < 1 || config.datasets < 1 || config.attributes < 0 || config.xsize < 1 ||
+      config.ysize < 1 || config.repeats < 1 || config.compression < 0 || config.compression > 9 ||
+      HLBench_formatSize(config.format) == 0) {
+    PrintHelp(0);
+    exit(1);
+  }
+  dsbytes = (size_t)config.xsize * (size_t)config.ysize * HLBench_formatSize(config.format);
+
+  /* Write, a node list can only be written once so a new one is built for each run */
+  results[nresults].name = "write";
+  results[nresults].n = config.repeats;
+  results[nresults].bytes = dsbytes * config.groups * config.datasets;
+  if ((results[nresults].seconds = malloc(sizeof(double) * config.repeats)) == NULL) {
+    goto fail;
+  }
+  for (i = 0; i < config.repeats; i++) {
+    if ((nodelist = HLBench_createNodeList(&config, &nnodes)) == NULL) {
+      goto fail;
+    }
+    start = HLBench_now();
+    if (!HLBench_write(&config, nodelist)) {
+      fprintf(stderr, "Failed to write %s\n", config.file);
+      goto fail;
+    }
+    results[nresults].seconds[i] = HLBench_now() - start;
+    HLNodeList_free(nodelist);
+    nodelist = NULL;
+  }
+  results[nresults].nodes = nnodes;
+  nresults++;
+
+  /* Read and fetch variants, update last since it modifies the file */
+  for (op = HLBENCH_READ; op <= HLBENCH_UPDATE; op++) {
+    HLBenchResult* result = &results[nresults];
+    result->name = names[op];
+    result->n = config.repeats;
+    result->nodes = nnodes;
+    if (op == HLBENCH_FETCH_ALL || op == HLBENCH_FETCH_DATASETS) {
+      result->bytes = dsbytes * config.groups * config.datasets;
+    } else if (op == HLBENCH_FETCH_NODE) {
+      result->bytes = dsbytes;
+      result->nodes = 1;
+    }
+    if ((result->seconds = malloc(sizeof(double) * config.repeats)) == NULL) {
+      goto fail;
+    }
+    for (i = 0; i < config.repeats; i++) {
+      start = HLBench_now();
+      if (!HLBench_runRead(&config, (HLBenchOperation)op, i)) {
+        fprintf(stderr, "Failed to run %s\n", result->name);
+        goto fail;
+      }
+      result->seconds[i] = HLBench_now() - start;
+    }
+    nresults++;
+  }
+
+  if (output != NULL && (fp = fopen(output, "w")) == NULL) {
+    fprintf(stderr, "Could not open %s\n", output);
+    goto fail;
+  }
+  fprintf(fp, "{\n  \"benchmark\": \"hlhdf\",\n  \"hdf5_version\": \"%s\",\n", HL_getHDF5Version());
+  fprintf(fp, "  \"config\": {\"groups\": %d, \"datasets\": %d, \"attributes\": %d, \"xsize\": %d, \"ysize\": %d, "
+          "\"format\": \"%s\", \"compression\": %d, \"repeats\": %d},\n",
+          config.groups, config.datasets, config.attributes, config.xsize, config.ysize,
+          config.format, config.compression, config.repeats);
+  fprintf(fp, "  \"results\": [\n");
+  for (i = 0; i < nresults; i++) {
+    HLBench_printResult(fp, &results[i], i == nresults - 1);
+  }
+  fprintf(fp, "  ],\n  \"peak_rss_kb\": %ld\n}\n", HLBench_peakRss());
+  exitcode = 0;
+fail:
+  if (fp != stdout && fp != NULL) {
+    fclose(fp);
+  }
+  for (i = 0; i < (int)(sizeof(results) / sizeof(results[0])); i++) {
+    free(results[i].seconds);
+  }
+  HLNodeList_free(nodelist);
+  if (!keep) {
+    unlink(config.file);
+  }
+  return exitcode;
+}
+
+static void PrintHelp(int all)
+{
+  fprintf(stderr, "Usage: %s [-hk] [-g groups] [-n datasets] [-a attributes] [-x xsize] [-y ysize]\n"
+          "       [-t type] [-z compression] [-r repeats] [-f file] [-o output]\n", ProcessName);
+  if (!all)
+    return;
+  fprintf(stderr, "\t[-h]    Prints this help.\n");
+  fprintf(stderr, "\t[-k]    Keeps the generated file.\n");
+  fprintf(stderr, "\t[-g groups]      Number of groups, default 10.\n");
+  fprintf(stderr, "\t[-n datasets]    Number of datasets in each group, default 2.\n");
+  fprintf(stderr, "\t[-a attributes]  Number of attributes in each group and dataset, default 10.\n");
+  fprintf(stderr, "\t[-x xsize]       Dataset x size, default 500.\n");
+  fprintf(stderr, "\t[-y ysize]       Dataset y size, default 500.\n");
+  fprintf(stderr, "\t[-t type]        uchar, short, ushort, int, float or double, default uchar.\n");
+  fprintf(stderr, "\t[-z compression] ZLIB level 0-9, 0 is no compression, default 6.\n");
+  fprintf(stderr, "\t[-r repeats]     Number of timed runs of each operation, default 10.\n");
+  fprintf(stderr, "\t[-f file]        The file to generate, default hlbench.h5.\n");
+  fprintf(stderr, "\t[-o output]      The JSON report, default stdout.\n");
+}
@@ -0,0 +1,195 @@
+###########################################################################
+# Copyright (C) 2026 Swedish Meteorological and Hydrological Institute, SMHI,
+#
+# This file is part of HLHDF.
+#
+# HLHDF is free software: you can redistribute it and/or modify
+# it under the terms of the GNU Lesser General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# HLHDF is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public License
+# along with HLHDF.  If not, see <http://www.gnu.org/licenses/>.
+###########################################################################
+
+## @package bench
+# @file hlbench.py
+#
+# The pyhl equivalent of hlbench. Takes the same options and writes
+# a JSON report with the same layout.
+import _pyhl
+import getopt
+import json
+import os
+import resource
+import sys
+import time
+import numpy
+
+FORMATS = {"uchar": numpy.uint8, "short": numpy.int16, "ushort": numpy.uint16,
+           "int": numpy.int32, "float": numpy.float32, "double": numpy.float64}
+
+class Config(object):
+  def __init__(self):
+    self.groups = 10
+    self.datasets = 2
+    self.attributes = 10
+    self.xsize = 500
+    self.ysize = 500
+    self.format = "uchar"
+    self.compression = 6
+    self.repeats = 10
+    self.file = "pyhlbench.h5"
+
+def fillData(config, seed):
+  i = numpy.arange(config.xsize * config.ysize, dtype=numpy.int64)
+  v = (i * 7 + (i // config.xsize) * 3 + seed) % 251
+  if config.format in ("float", "double"):
+    v = v * 0.5
+  return v.astype(FORMATS[config.format]).reshape(config.ysize, config.xsize)
+
+def addAttributes(nodelist, config, parent):
+  for i in range(config.attributes):
+    node = _pyhl.node(_pyhl.ATTRIBUTE_ID, "%s/attr%d" % (parent, i))
+    node.setScalarValue(-1, i * 1.5, "double", -1)
+    nodelist.addNode(node)
+
+def createNodeList(config):
+  nodelist = _pyhl.nodelist()
+  for g in range(config.groups):
+    name = "/group%d" % g
+    nodelist.addNode(_pyhl.node(_pyhl.GROUP_ID, name))
+    addAttributes(nodelist, config, name)
+    for d in range(config.datasets):
+      name = "/group%d/data%d" % (g, d)
+      node = _pyhl.node(_pyhl.DATASET_ID, name)
+      node.setArrayValue(-1, [config.ysize, config.xsize], fillData(config, g * config.datasets + d), config.format, -1)
+      nodelist.addNode(node)
+      addAttributes(nodelist, config, name)
+  return nodelist
+
+def write(config):
+  nodelist = createNodeList(config)
+  nodelist.write(config.file, config.compression)
+
+def read(config, run):
+  _pyhl.read_nodelist(config.file)
+
+def readMetadata(config, run):
+  nodelist = _pyhl.read_nodelist(config.file)
+  nodelist.selectAllMetadata()
+  nodelist.fetch()
+
+def fetchAll(config, run):
+  nodelist = _pyhl.read_nodelist(config.file)
+  nodelist.selectAll()
+  nodelist.fetch()
+
+def fetchDatasets(config, run):
+  nodelist = _pyhl.read_nodelist(config.file)
+  nodelist.selectOnlyDatasets()
+  nodelist.fetch()
+
+def fetchNode(config, run):
+  nodelist = _pyhl.read_nodelist(config.file)
+  nodelist.fetchNode("/group0/data0").data()
+
+def update(config, run):
+  nodelist = _pyhl.read_nodelist(config.file)
+  node = _pyhl.node(_pyhl.ATTRIBUTE_ID, "/group0/update%d" % run)
+  node.setScalarValue(-1, run, "int", -1)
+  nodelist.addNode(node)
+  nodelist.update()
+
+def percentile(values, p):
+  pos = p / 100.0 * (len(values) - 1)
+  i = int(pos)
+  if i >= len(values) - 1:
+    return values[-1]
+  return values[i] + (pos - i) * (values[i + 1] - values[i])
+
+def timeOperation(config, name, function, nbytes, nodes):
+  seconds = []
+  if name == "write":
+    # Building the nodelist in python is part of writing a file with pyhl
+    for run in range(config.repeats):
+      start = time.perf_counter()
+      function(config)
+      seconds.append(time.perf_counter() - start)
+  else:
+    for run in range(config.repeats):
+      start = time.perf_counter()
+      function(config, run)
+      seconds.append(time.perf_counter() - start)
+  seconds.sort()
+  mean = sum(seconds) / len(seconds)
+  return {"name": name, "runs": len(seconds), "bytes": nbytes, "nodes": nodes,
+          "latency_ms": {"min": seconds[0] * 1e3, "mean": mean * 1e3,
+                         "p50": percentile(seconds, 50.0) * 1e3, "p90": percentile(seconds, 90.0) * 1e3,
+                         "p99": percentile(seconds, 99.0) * 1e3, "max": seconds[-1] * 1e3},
+          "throughput_mb_s": (nbytes / mean / (1024.0 * 1024.0)) if mean > 0 else 0.0,
+          "nodes_per_s": (nodes / mean) if mean > 0 else 0.0}
+
+def main(argv):
+  config = Config()
+  output = None
+  keep = False
+  opts, args = getopt.getopt(argv, "hkg:n:a:x:y:t:z:r:f:o:")
+  for o, a in opts:
+    if o == "-h":
+      print("Usage: hlbench.py [-hk] [-g groups] [-n datasets] [-a attributes] [-x xsize] [-y ysize]")
+      print("       [-t type] [-z compression] [-r repeats] [-f file] [-o output]")
+      return 0
+    elif o == "-k": keep = True
+    elif o == "-g": config.groups = int(a)
+    elif o == "-n": config.datasets = int(a)
+    elif o == "-a": config.attributes = int(a)
+    elif o == "-x": config.xsize = int(a)
+    elif o == "-y": config.ysize = int(a)
+    elif o == "-t": config.format = a
+    elif o == "-z": config.compression = int(a)
+    elif o == "-r": config.repeats = int(a)
+    elif o == "-f": config.file = a
+    elif o == "-o": output = a
+  if config.format not in FORMATS:
+    sys.stderr.write("Unsupported format %s\n" % config.format)
+    return 1
+
+  dsbytes = config.xsize * config.ysize * numpy.dtype(FORMATS[config.format]).itemsize
+  nodes = config.groups * (1 + config.attributes + config.datasets * (1 + config.attributes))
+  allbytes = dsbytes * config.groups * config.datasets
+
+  results = []
+  try:
+    results.append(timeOperation(config, "write", write, allbytes, nodes))
+    results.append(timeOperation(config, "read", read, 0, nodes))
+    results.append(timeOperation(config, "read_metadata", readMetadata, 0, nodes))
+    results.append(timeOperation(config, "fetch_all", fetchAll, allbytes, nodes))
+    results.append(timeOperation(config, "fetch_datasets", fetchDatasets, allbytes, nodes))
+    results.append(timeOperation(config, "fetch_node", fetchNode, dsbytes, 1))
+    results.append(timeOperation(config, "update", update, 0, nodes))
+  finally:
+    if not keep and os.path.exists(config.file):
+      os.unlink(config.file)
+
+  report = {"benchmark": "pyhl", "hdf5_version": _pyhl.get_hdf5version(),
+            "config": {"groups": config.groups, "datasets": config.datasets, "attributes": config.attributes,
+                       "xsize": config.xsize, "ysize": config.ysize, "format": config.format,
+                       "compression": config.compression, "repeats": config.repeats},
+            "results": results,
+            "peak_rss_kb": resource.getrusage(resource.RUSAGE_SELF).ru_maxrss}
+  text = json.dumps(report, indent=2)
+  if output is not None:
+    with open(output, "w") as fp:
+      fp.write(text + "\n")
+  else:
+    print(text)
+  return 0
+
+if __name__ == "__main__":
+  sys.exit(main(sys.argv[1:]))
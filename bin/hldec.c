@@ -168,7 +168,7 @@ int main(int argc, char** argv)
 
    npts=(size_t)HLNode_getNumberOfPoints(node);
 
-   if(fwrite(HLNode_getData(node), HLNode_getDataSize(node), npts, data_fp) != npts) {
+   if(fwrite(HLNode_getConstData(node), HLNode_getDataSize(node), npts, data_fp) != npts) {
       fprintf(stderr,"Failed to write datafield\n");
       goto fail;
    }
@@ -28,8 +28,11 @@ along with HLHDF.  If not, see <http://www.gnu.org/licenses/>.
 #include "hlhdf_debug.h"
 #include "hlhdf_alloc.h"
 #include "hlhdf_defines_private.h"
+#include "hlhdf_counters_private.h"
+#include "hlhdf_trace_private.h"
 #include <string.h>
 #include <stdlib.h>
+#include <pthread.h>
 
 /*For internal use*/
 static int errorReportingOn=1;
@@ -41,6 +44,11 @@ static int initialized = 0;
 /** Flag toggling the debugging */
 static int _debug_hdf;
 
+/**
+ * Size of the page buffer used when opening files for reading, see \ref HL_setPageBufferSize.
+ */
+static size_t hlhdfPageBufferSize = 0;
+
 static const char HLHDF_UNDEFINED_STR[]= "UNDEFINED"; /**< 'UNDEFINED' */
 static const char HLHDF_CHAR_STR[]     = "char";      /**< 'char' */
 static const char HLHDF_SCHAR_STR[]    = "schar";     /**< 'schar' */
@@ -66,6 +74,30 @@ static const char HLHDF_ARRAY_STR[]    = "array";     /**< 'array' */
 
 static char HLHDF_HDF5_VERSION_STRING[64];      /**< keeps the version string */
 
+/**
+ * Max number of distinct native types kept in the shared type cache.
+ */
+#define HLHDF_TYPECACHE_SIZE 128
+
+/**
+ * One native type in the shared type cache. Identified by what \ref getFixedType
+ * uses when translating a type.
+ */
+typedef struct HLTypeCacheEntry_t {
+  H5T_class_t tclass;         /**< the type class */
+  size_t size;                /**< the size of the file type */
+  H5T_sign_t sign;            /**< sign for integers */
+  H5T_str_t strpad;           /**< string padding */
+  H5T_cset_t cset;            /**< string character set */
+  htri_t isvariable;          /**< if variable length string */
+  hid_t typeId;               /**< the native type */
+  HL_FormatSpecifier format;  /**< the format of the native type */
+} HLTypeCacheEntry_t;
+
+static HLTypeCacheEntry_t hlhdf_typecache[HLHDF_TYPECACHE_SIZE]; /**< the shared native types */
+static int hlhdf_typecache_n = 0; /**< number of types in the cache */
+static pthread_mutex_t hlhdf_typecache_lock = PTHREAD_MUTEX_INITIALIZER; /**< protects the type cache */
+
 static const char* VALID_FORMAT_SPECIFIERS[] = {
   HLHDF_UNDEFINED_STR,
   HLHDF_CHAR_STR,
@@ -130,6 +162,16 @@ static void hlhdf_dump_memory_information(void)
 }
 #endif
 
+void HL_setPageBufferSize(size_t size)
+{
+  hlhdfPageBufferSize = size;
+}
+
+size_t HL_getPageBufferSize(void)
+{
+  return hlhdfPageBufferSize;
+}
+
 /************************************************
  * initHlHdf
  ***********************************************/
@@ -142,6 +184,7 @@ void HL_init(void)
     HL_InitializeDebugger();
     HL_enableHdf5ErrorReporting();
     HL_disableErrorReporting();
+    HLTracePrivate_initialize();
 #ifdef HLHDF_MEMORY_DEBUG
     if (atexit(hlhdf_dump_memory_information) != 0) {
       HL_printf("Could not set atexit function");
@@ -155,6 +198,13 @@ void HL_init(void)
  ***********************************************/
 void HL_setDebugMode(int flag)
 {
+  if ((flag & HLHDF_DEBUG_TRACE) != 0) {
+    if (HL_getTraceFile() == NULL) {
+      const char* filename = getenv("HLHDF_TRACE_FILE");
+      HL_startTrace((filename != NULL && *filename != '\0') ? filename : "hlhdf_trace.json");
+    }
+    flag &= ~HLHDF_DEBUG_TRACE;
+  }
   if (flag == 0) {
     /*Don't debug anything*/
     _debug_hdf = 0;
@@ -244,6 +294,10 @@ HL_FileCreationProperty* HLFileCreationProperty_new(void)
     goto fail;
   }
   HL_H5P_CLOSE(theHid);
+  retv->fs_strategy = HL_FSPACE_DEFAULT;
+  retv->fs_persist = 0;
+  retv->fs_page_size = 0;
+  retv->page_buffer_size = 0;
 
   return retv;
 fail:
@@ -405,6 +459,10 @@ void HLCompression_free(HL_Compression* inv)
 hid_t openHlHdfFile(const char* filename, const char* how)
 {
   unsigned flags = H5F_ACC_RDWR;
+  hid_t fileId = -1;
+  hid_t fapl = -1;
+  HL_TraceEvent event;
+  int traced = HL_TRACE_ENABLED();
   HL_DEBUG2("ENTER: openHlHdfFile(%s,%s)", filename, how);
 
   if (strcmp(how, "r") == 0) {
@@ -415,8 +473,62 @@ hid_t openHlHdfFile(const char* filename, const char* how)
     HL_ERROR0("Illegal mode given when opening file, should be (r|w|rw)");
     return (hid_t) -1;
   }
+  if (traced) {
+    HLTracePrivate_begin(&event, HL_TRACE_OPEN, filename, NULL);
+  }
+#if H5_VERSION_GE(1,10,1)
+  if (flags == H5F_ACC_RDONLY && hlhdfPageBufferSize > 0 &&
+      (fapl = H5Pcreate(H5P_FILE_ACCESS)) >= 0 &&
+      H5Pset_page_buffer_size(fapl, hlhdfPageBufferSize, 0, 0) >= 0) {
+    /* Fails unless the file was written with paged aggregation */
+    H5E_BEGIN_TRY {
+      fileId = H5Fopen(filename, flags, fapl);
+    } H5E_END_TRY;
+  }
+#endif
+  if (fileId < 0) {
+    fileId = H5Fopen(filename, flags, H5P_DEFAULT);
+  }
+  if (fileId >= 0) {
+    HL_STATS_INC(filesOpened);
+  }
+  if (traced) {
+    HLTracePrivate_end(&event, fileId >= 0);
+  }
+  HL_H5P_CLOSE(fapl);
   HL_DEBUG0("EXIT: openHlHdfFile");
-  return H5Fopen(filename, flags, H5P_DEFAULT);
+  return fileId;
+}
+
+/************************************************
+ * openHlHdfFileInMemory
+ ***********************************************/
+hid_t openHlHdfFileInMemory(const char* filename)
+{
+  hid_t fapl = -1;
+  hid_t fileId = -1;
+  HL_TraceEvent event;
+  int traced = HL_TRACE_ENABLED();
+  HL_DEBUG1("ENTER: openHlHdfFileInMemory(%s)", filename);
+
+  if ((fapl = H5Pcreate(H5P_FILE_ACCESS)) < 0 ||
+      H5Pset_fapl_core(fapl, HLHDF_SLAB_BYTES, 0) < 0) {
+    HL_ERROR0("Failed to create in-memory file access property");
+    HL_H5P_CLOSE(fapl);
+    return (hid_t) -1;
+  }
+  if (traced) {
+    HLTracePrivate_begin(&event, HL_TRACE_OPEN, filename, NULL);
+  }
+  if ((fileId = H5Fopen(filename, H5F_ACC_RDONLY, fapl)) >= 0) {
+    HL_STATS_INC(filesOpened);
+  }
+  if (traced) {
+    HLTracePrivate_end(&event, fileId >= 0);
+  }
+  HL_H5P_CLOSE(fapl);
+  HL_DEBUG0("EXIT: openHlHdfFileInMemory");
+  return fileId;
 }
 
 /************************************************
@@ -428,8 +540,13 @@ hid_t createHlHdfFile(const char* filename,
   hid_t propId = -1;
   hid_t fileId = -1;
   hid_t fileaccesspropertyId = -1;
+  HL_TraceEvent event;
+  int traced = HL_TRACE_ENABLED();
 
   HL_DEBUG0("ENTER: createHlHdfFile");
+  if (traced) {
+    HLTracePrivate_begin(&event, HL_TRACE_OPEN, filename, NULL);
+  }
   if (property == NULL) {
     HL_DEBUG0("Using default properties");
     fileId = H5Fcreate(filename, H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
@@ -465,24 +582,75 @@ hid_t createHlHdfFile(const char* filename,
       goto done;
     }
 
-    if (property->meta_block_size != 2048) {
+#if H5_VERSION_GE(1,10,1)
+    if (property->fs_strategy != HL_FSPACE_DEFAULT) {
+      H5F_fspace_strategy_t strategy = H5F_FSPACE_STRATEGY_FSM_AGGR;
+      switch (property->fs_strategy) {
+      case HL_FSPACE_PAGE:
+        strategy = H5F_FSPACE_STRATEGY_PAGE;
+        break;
+      case HL_FSPACE_AGGR:
+        strategy = H5F_FSPACE_STRATEGY_AGGR;
+        break;
+      case HL_FSPACE_NONE:
+        strategy = H5F_FSPACE_STRATEGY_NONE;
+        break;
+      default:
+        break;
+      }
+      HL_DEBUG2("Setting file space strategy to %d, persist %d",(int)strategy,property->fs_persist);
+      if (H5Pset_file_space_strategy(propId, strategy, property->fs_persist ? 1 : 0, 1) < 0) {
+        HL_ERROR0("Failed to set the file space strategy");
+        goto done;
+      }
+    }
+
+    if (property->fs_page_size > 0) {
+      HL_DEBUG1("Setting file space page size to %ld",(long)property->fs_page_size);
+      if (H5Pset_file_space_page_size(propId, property->fs_page_size) < 0) {
+        HL_ERROR0("Failed to set the file space page size");
+        goto done;
+      }
+    }
+#else
+    if (property->fs_strategy != HL_FSPACE_DEFAULT || property->fs_page_size > 0 ||
+        property->page_buffer_size > 0) {
+      HL_ERROR0("File space strategy, page size and page buffer require HDF5 1.10.1 or later");
+      goto done;
+    }
+#endif
+
+    if (property->meta_block_size != 2048 || property->page_buffer_size > 0) {
       if ((fileaccesspropertyId = H5Pcreate(H5P_FILE_ACCESS)) < 0) {
         HL_ERROR0("Failed to create the H5P_FILE_ACCESS property");
         goto done;
       }
-      if (H5Pset_meta_block_size(fileaccesspropertyId,
+      if (property->meta_block_size != 2048 &&
+          H5Pset_meta_block_size(fileaccesspropertyId,
                                  property->meta_block_size) < 0) {
         HL_ERROR0("Failed to set the meta block size");
         goto done;
       }
+#if H5_VERSION_GE(1,10,1)
+      if (property->page_buffer_size > 0 &&
+          H5Pset_page_buffer_size(fileaccesspropertyId, property->page_buffer_size, 0, 0) < 0) {
+        HL_ERROR0("Failed to set the page buffer size");
+        goto done;
+      }
+#endif
       fileId = H5Fcreate(filename, H5F_ACC_TRUNC, propId, fileaccesspropertyId);
     } else {
       fileId = H5Fcreate(filename, H5F_ACC_TRUNC, propId, H5P_DEFAULT);
-      return fileId;
     }
   }
 
 done:
+  if (fileId >= 0) {
+    HL_STATS_INC(filesOpened);
+  }
+  if (traced) {
+    HLTracePrivate_end(&event, fileId >= 0);
+  }
   HL_H5P_CLOSE(propId);
   HL_H5P_CLOSE(fileaccesspropertyId);
   HL_DEBUG0("EXIT: createHlHdfFile");
@@ -771,6 +939,92 @@ hid_t HL_translateFormatSpecifierToType(HL_FormatSpecifier specifier)
   return retv;
 }
 
+/**
+ * Returns the index of the cache entry that matches the key. Must be called with
+ * hlhdf_typecache_lock held.
+ * @param[in] key the key
+ * @return the index or -1 if the type is not cached
+ */
+static int HLTypeCacheInternal_find(const HLTypeCacheEntry_t* key)
+{
+  int i = 0;
+  for (i = 0; i < hlhdf_typecache_n; i++) {
+    HLTypeCacheEntry_t* entry = &hlhdf_typecache[i];
+    if (entry->tclass == key->tclass && entry->size == key->size && entry->sign == key->sign &&
+        entry->strpad == key->strpad && entry->cset == key->cset && entry->isvariable == key->isvariable) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+/************************************************
+ * getSharedFixedType
+ ***********************************************/
+hid_t getSharedFixedType(hid_t type, HL_FormatSpecifier* format)
+{
+  HLTypeCacheEntry_t key;
+  hid_t cached = -1;
+  int inserted = 0;
+  int i = 0;
+
+  memset(&key, 0, sizeof(key));
+  key.tclass = H5Tget_class(type);
+  key.size = H5Tget_size(type);
+  if (key.tclass == H5T_INTEGER) {
+    key.sign = H5Tget_sign(type);
+  } else if (key.tclass == H5T_STRING) {
+    key.strpad = H5Tget_strpad(type);
+    key.cset = H5Tget_cset(type);
+    key.isvariable = H5Tis_variable_str(type);
+  } else if (key.tclass != H5T_FLOAT) {
+    return -1;
+  }
+
+  /* No HDF5 calls are made while the lock is held. This function is called from within
+   * HDF5 iteration callbacks where the HDF5 library lock is held, so holding our lock while
+   * waiting for the library lock could deadlock against another thread. */
+  pthread_mutex_lock(&hlhdf_typecache_lock);
+  if ((i = HLTypeCacheInternal_find(&key)) >= 0) {
+    cached = hlhdf_typecache[i].typeId;
+    *format = hlhdf_typecache[i].format;
+  }
+  pthread_mutex_unlock(&hlhdf_typecache_lock);
+
+  if (cached >= 0) {
+    if (H5Iis_valid(cached) > 0 && H5Iinc_ref(cached) >= 0) {
+      return cached;
+    }
+    /* HDF5 has been closed and reopened, the cache is no longer valid */
+    pthread_mutex_lock(&hlhdf_typecache_lock);
+    hlhdf_typecache_n = 0;
+    pthread_mutex_unlock(&hlhdf_typecache_lock);
+  }
+
+  if ((key.typeId = getFixedType(type)) < 0) {
+    return -1;
+  }
+  key.format = HL_getFormatSpecifierFromType(key.typeId);
+  if (key.format == HLHDF_UNDEFINED || H5Iinc_ref(key.typeId) < 0) {
+    HL_H5T_CLOSE(key.typeId);
+    return -1;
+  }
+
+  pthread_mutex_lock(&hlhdf_typecache_lock);
+  if (hlhdf_typecache_n < HLHDF_TYPECACHE_SIZE && HLTypeCacheInternal_find(&key) < 0) {
+    hlhdf_typecache[hlhdf_typecache_n++] = key;
+    inserted = 1;
+  }
+  pthread_mutex_unlock(&hlhdf_typecache_lock);
+
+  if (!inserted) {
+    /* The cache is full or another thread added the same type, the caller gets the only reference */
+    H5Idec_ref(key.typeId);
+  }
+  *format = key.format;
+  return key.typeId;
+}
+
 /************************************************
  * HL_translateFormatStringToDatatype
  ***********************************************/
@@ -1123,6 +1377,7 @@ int openGroupOrDataset(hid_t file_id, const char* name, hid_t* lid, HL_Type* typ
     }
     *type = GROUP_ID;
   }
+  HL_STATS_INC(objectsOpened);
   status = 1;
 fail:
   if (status == 0) {
@@ -1132,5 +1387,88 @@ fail:
   return status;
 }
 
+int readDatasetInSlabs(hid_t obj, hid_t mtype, unsigned char* dest, HL_SlabConsumer consume, void* ctx)
+{
+  hid_t f_space = -1, m_space = -1, dcpl = -1;
+  hsize_t dims[H5S_MAX_RANK], start[H5S_MAX_RANK], count[H5S_MAX_RANK], cdims[H5S_MAX_RANK];
+  hsize_t npoints = 0, rowpoints = 1, rows = 0, row = 0;
+  unsigned char* buffer = NULL;
+  unsigned char* slab = NULL;
+  size_t size = H5Tget_size(mtype);
+  int ndims = 0, i = 0, status = 0;
+
+  if ((f_space = H5Dget_space(obj)) < 0 || (ndims = H5Sget_simple_extent_ndims(f_space)) < 0 ||
+      H5Sget_simple_extent_dims(f_space, dims, NULL) < 0) {
+    HL_ERROR0("Could not get dimensions of dataset");
+    goto fail;
+  }
+  npoints = (hsize_t)H5Sget_simple_extent_npoints(f_space);
+  if (npoints == 0) {
+    status = 1;
+    goto fail;
+  }
+
+  if (ndims == 0) {
+    unsigned char value[64];
+    slab = (dest != NULL) ? dest : value;
+    if (size > sizeof(value) && dest == NULL) {
+      HL_ERROR0("Scalar value too large");
+      goto fail;
+    }
+    if (H5Dread(obj, mtype, H5S_ALL, H5S_ALL, H5P_DEFAULT, slab) < 0) {
+      HL_ERROR0("Failed to read dataset");
+      goto fail;
+    }
+    status = (consume == NULL || consume(ctx, slab, 0, 1));
+    goto fail;
+  }
+
+  /* Read whole rows, as many as fits in the slab but at least one chunk of rows */
+  for (i = 1; i < ndims; i++) {
+    rowpoints *= dims[i];
+  }
+  rows = HLHDF_SLAB_BYTES / (rowpoints * size);
+  if ((dcpl = H5Dget_create_plist(obj)) >= 0 && H5Pget_layout(dcpl) == H5D_CHUNKED &&
+      H5Pget_chunk(dcpl, ndims, cdims) == ndims && cdims[0] > 0) {
+    rows = (rows < cdims[0]) ? cdims[0] : rows - (rows % cdims[0]);
+  }
+  if (rows == 0) {
+    rows = 1;
+  }
+  if (rows > dims[0]) {
+    rows = dims[0];
+  }
+  if (dest == NULL && (buffer = HLHDF_MALLOC(rows * rowpoints * size)) == NULL) {
+    HL_ERROR0("Failed to allocate memory for slab");
+    goto fail;
+  }
+  for (i = 0; i < ndims; i++) {
+    start[i] = 0;
+    count[i] = dims[i];
+  }
+  for (row = 0; row < dims[0]; row += rows) {
+    start[0] = row;
+    count[0] = (dims[0] - row < rows) ? (dims[0] - row) : rows;
+    slab = (dest != NULL) ? (dest + row * rowpoints * size) : buffer;
+    if (H5Sselect_hyperslab(f_space, H5S_SELECT_SET, start, NULL, count, NULL) < 0 ||
+        (m_space = H5Screate_simple(ndims, count, NULL)) < 0 ||
+        H5Dread(obj, mtype, m_space, f_space, H5P_DEFAULT, slab) < 0) {
+      HL_ERROR1("Failed to read rows from %lu", (unsigned long)row);
+      goto fail;
+    }
+    HL_H5S_CLOSE(m_space);
+    if (consume != NULL && !consume(ctx, slab, row * rowpoints, count[0] * rowpoints)) {
+      goto fail;
+    }
+  }
+  status = 1;
+fail:
+  HLHDF_FREE(buffer);
+  HL_H5P_CLOSE(dcpl);
+  HL_H5S_CLOSE(m_space);
+  HL_H5S_CLOSE(f_space);
+  return status;
+}
+
 /*@} End of Private functions */
 
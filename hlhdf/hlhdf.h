@@ -32,6 +32,14 @@ along with HLHDF.  If not, see <http://www.gnu.org/licenses/>.
 #include "hlhdf_read.h"
 #include "hlhdf_write.h"
 #include "hlhdf_compound.h"
+#include "hlhdf_cache.h"
+#include "hlhdf_index.h"
+#include "hlhdf_scale.h"
+#include "hlhdf_stats.h"
+#include "hlhdf_counters.h"
+#include "hlhdf_trace.h"
+#include "hlhdf_copy.h"
+#include "hlhdf_iterator.h"
 
 /**
  * Define for FALSE unless it already has been defined.
@@ -88,11 +96,30 @@ void HL_init(void);
  *   <li>1 = Debug only the HLHDF library</li>
  *   <li>2 = Debug both HLHDF and HDF5 library</li>
  * </ul>
+ * If \ref HLHDF_DEBUG_TRACE is or:ed into flag, a Chrome trace is also started,
+ * see \ref HL_startTrace. It is stopped with \ref HL_stopTrace.
  * @ingroup hlhdf_c_apis
  * @param[in] flag the level of debugging
  */
 void HL_setDebugMode(int flag);
 
+/**
+ * Sets the size of the page buffer used when opening files for reading, see hdf5
+ * documentation for H5Pset_page_buffer_size. Only files written with the paged file
+ * space strategy (\ref HL_FSPACE_PAGE) can be page buffered, other files are opened
+ * without page buffer. Has no effect with HDF5 versions before 1.10.1.
+ * @ingroup hlhdf_c_apis
+ * @param[in] size the size of the page buffer in bytes, 0 disables (default)
+ */
+void HL_setPageBufferSize(size_t size);
+
+/**
+ * Returns the size of the page buffer used when opening files for reading, see \ref HL_setPageBufferSize.
+ * @ingroup hlhdf_c_apis
+ * @return the size in bytes, 0 if disabled
+ */
+size_t HL_getPageBufferSize(void);
+
 /**
  * Verifies if the provided filename is a valid HDF5 file or not.
  * @ingroup hlhdf_c_apis
@@ -27,27 +27,52 @@ along with HLHDF.  If not, see <http://www.gnu.org/licenses/>.
 #include "hlhdf_debug.h"
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+
+/**
+ * Keeps track on the allocations done from one call site (file + line).
+ */
+typedef struct HlhdfHeapSite_t {
+  char* filename; /**< the filename the allocations are done in */
+  int lineno; /**< the line the allocations are done at */
+  size_t count; /**< number of allocations done from this site */
+  size_t bytes; /**< number of bytes currently allocated from this site */
+  size_t peak; /**< max number of bytes that has been allocated at the same time from this site */
+  size_t total; /**< total number of bytes allocated from this site */
+  struct HlhdfHeapSite_t* next; /**< next site in same bucket */
+} HlhdfHeapSite_t;
 
 /**
  * Keeps track on one allocation.
  */
 typedef struct HlhdfHeapEntry_t {
-  char* filename; /**< the filename the data was allocated in */
-  int lineno; /**< the line the data was allocated at */
+  HlhdfHeapSite_t* site; /**< the call site the data was allocated at */
   size_t sz; /**< the allocated size */
   void* b;   /**< the returned ptr */
   void* ptr; /**< the internal ptr */
+  struct HlhdfHeapEntry_t* next; /**< next entry in same bucket */
 } HlhdfHeapEntry_t;
 
 /**
- * A linked list where each entry corresponds to one allocation.
+ * A hash table with chained buckets. Used both for the allocations, keyed
+ * by the returned pointer, and for the call sites, keyed by file and line.
  */
-typedef struct HlhdfHeap_t {
-  HlhdfHeapEntry_t* entry; /**< the allocation information */
-  struct HlhdfHeap_t* next; /**< the next entry in the linked list */
-} HlhdfHeap_t;
+typedef struct HlhdfHashTable_t {
+  void** buckets; /**< the buckets */
+  size_t nbuckets; /**< number of buckets, always a power of 2 */
+  size_t nentries; /**< number of entries in the table */
+} HlhdfHashTable_t;
 
-static HlhdfHeap_t* hlhdf_heap = NULL;
+/**
+ * Initial number of buckets in the hash tables.
+ */
+#define HLHDF_HEAP_INITIAL_BUCKETS 1024
+
+unsigned long long hlhdf_alloc_count = 0;
+
+static HlhdfHashTable_t hlhdf_heap = {NULL, 0, 0};
+static HlhdfHashTable_t hlhdf_sites = {NULL, 0, 0};
 
 static size_t number_of_allocations = 0;
 static size_t number_of_failed_allocations = 0;
@@ -59,6 +84,148 @@ static size_t number_of_strdup = 0;
 static size_t number_of_failed_strdup = 0;
 static size_t total_heap_usage = 0;
 static size_t total_freed_heap_usage = 0;
+static size_t max_number_of_allocations = 0;
+
+/**
+ * Serializes the bookkeeping since allocations are made from the background threads as well.
+ */
+static pthread_mutex_t hlhdf_alloc_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static size_t hlhdf_alloc_hashPointer(void* ptr)
+{
+  uint64_t h = (uint64_t)(uintptr_t)ptr;
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  return (size_t)h;
+}
+
+static size_t hlhdf_alloc_hashSite(const char* filename, int lineno)
+{
+  size_t h = 5381;
+  while (*filename != '\0') {
+    h = h * 33 + (unsigned char)*filename++;
+  }
+  return h * 33 + (size_t)lineno;
+}
+
+static int hlhdf_alloc_initTable(HlhdfHashTable_t* table)
+{
+  if (table->buckets == NULL) {
+    table->buckets = calloc(HLHDF_HEAP_INITIAL_BUCKETS, sizeof(void*));
+    if (table->buckets == NULL) {
+      HL_printf("HLHDF_MEMORY_CHECK: Failed to allocate hash table\n");
+      return 0;
+    }
+    table->nbuckets = HLHDF_HEAP_INITIAL_BUCKETS;
+    table->nentries = 0;
+  }
+  return 1;
+}
+
+/**
+ * Doubles the number of buckets in the heap table when it becomes too crowded.
+ * If the resize fails the old buckets are kept.
+ */
+static void hlhdf_alloc_growHeap(void)
+{
+  size_t i = 0;
+  size_t nbuckets = hlhdf_heap.nbuckets * 2;
+  HlhdfHeapEntry_t** buckets = NULL;
+
+  if (hlhdf_heap.nentries < hlhdf_heap.nbuckets) {
+    return;
+  }
+  buckets = calloc(nbuckets, sizeof(HlhdfHeapEntry_t*));
+  if (buckets == NULL) {
+    return;
+  }
+  for (i = 0; i < hlhdf_heap.nbuckets; i++) {
+    HlhdfHeapEntry_t* entry = (HlhdfHeapEntry_t*)hlhdf_heap.buckets[i];
+    while (entry != NULL) {
+      HlhdfHeapEntry_t* next = entry->next;
+      size_t idx = hlhdf_alloc_hashPointer(entry->b) & (nbuckets - 1);
+      entry->next = buckets[idx];
+      buckets[idx] = entry;
+      entry = next;
+    }
+  }
+  free(hlhdf_heap.buckets);
+  hlhdf_heap.buckets = (void**)buckets;
+  hlhdf_heap.nbuckets = nbuckets;
+}
+
+static HlhdfHeapSite_t* hlhdf_alloc_getSite(const char* filename, int lineno)
+{
+  size_t idx = 0;
+  HlhdfHeapSite_t* site = NULL;
+  if (!hlhdf_alloc_initTable(&hlhdf_sites)) {
+    return NULL;
+  }
+  idx = hlhdf_alloc_hashSite(filename, lineno) & (hlhdf_sites.nbuckets - 1);
+  site = (HlhdfHeapSite_t*)hlhdf_sites.buckets[idx];
+  while (site != NULL) {
+    if (site->lineno == lineno && strcmp(site->filename, filename) == 0) {
+      return site;
+    }
+    site = site->next;
+  }
+  site = calloc(1, sizeof(HlhdfHeapSite_t));
+  if (site == NULL || (site->filename = strdup(filename)) == NULL) {
+    HL_printf("HLHDF_MEMORY_CHECK: Failed to allocate memory for call site\n");
+    free(site);
+    return NULL;
+  }
+  site->lineno = lineno;
+  site->next = (HlhdfHeapSite_t*)hlhdf_sites.buckets[idx];
+  hlhdf_sites.buckets[idx] = site;
+  hlhdf_sites.nentries++;
+  return site;
+}
+
+static void hlhdf_alloc_siteAdd(HlhdfHeapSite_t* site, size_t sz)
+{
+  site->bytes += sz;
+  site->total += sz;
+  if (site->bytes > site->peak) {
+    site->peak = site->bytes;
+  }
+}
+
+static void hlhdf_alloc_insertEntry(HlhdfHeapEntry_t* entry)
+{
+  size_t idx = hlhdf_alloc_hashPointer(entry->b) & (hlhdf_heap.nbuckets - 1);
+  entry->next = (HlhdfHeapEntry_t*)hlhdf_heap.buckets[idx];
+  hlhdf_heap.buckets[idx] = entry;
+  hlhdf_heap.nentries++;
+  if (hlhdf_heap.nentries > max_number_of_allocations) {
+    max_number_of_allocations = hlhdf_heap.nentries;
+  }
+}
+
+/**
+ * Locates the entry for ptr and unlinks it from the heap table.
+ * @return the entry or NULL if ptr not has been allocated by hlhdf
+ */
+static HlhdfHeapEntry_t* hlhdf_alloc_removeEntry(void* ptr)
+{
+  HlhdfHeapEntry_t** pentry = NULL;
+  if (hlhdf_heap.buckets == NULL) {
+    return NULL;
+  }
+  pentry = (HlhdfHeapEntry_t**)&hlhdf_heap.buckets[hlhdf_alloc_hashPointer(ptr) & (hlhdf_heap.nbuckets - 1)];
+  while (*pentry != NULL) {
+    if ((*pentry)->b == ptr) {
+      HlhdfHeapEntry_t* entry = *pentry;
+      *pentry = entry->next;
+      entry->next = NULL;
+      hlhdf_heap.nentries--;
+      return entry;
+    }
+    pentry = &(*pentry)->next;
+  }
+  return NULL;
+}
 
 static HlhdfHeapEntry_t* hlhdf_alloc_createHeapEntry(const char* filename, int lineno, size_t sz)
 {
@@ -68,13 +235,12 @@ static HlhdfHeapEntry_t* hlhdf_alloc_createHeapEntry(const char* filename, int l
     HL_printf("HLHDF_MEMORY_CHECK: Failed to allocate memory for heap entry\n");
     return NULL;
   }
-  result->filename = strdup(filename);
-  result->lineno = lineno;
+  result->site = hlhdf_alloc_getSite(filename, lineno);
   result->sz = sz;
+  result->next = NULL;
   ptr = malloc(sz + 4);
-  if (result->filename == NULL || ptr == NULL) {
-    HL_printf("HLHDF_MEMORY_CHECK: Failed to allocate memory for filename and/or databuffer\n");
-    if (result->filename != NULL) free(result->filename);
+  if (result->site == NULL || ptr == NULL) {
+    HL_printf("HLHDF_MEMORY_CHECK: Failed to allocate memory for call site and/or databuffer\n");
     if (ptr != NULL) free(ptr);
     free(result);
     return NULL;
@@ -90,15 +256,17 @@ static HlhdfHeapEntry_t* hlhdf_alloc_createHeapEntry(const char* filename, int l
 
 static int hlhdf_alloc_reallocateDataInEntry(HlhdfHeapEntry_t* entry, size_t sz)
 {
+  void* ptr = NULL;
   if (entry == NULL) {
     HL_printf("BAD CALL TO REALLOCATION FUNCTION, PROGRAMMING ERROR!!\n");
     HL_ABORT();
   }
-  entry->ptr = realloc(entry->ptr, sz + 4);
-  if (entry->ptr == NULL) {
+  ptr = realloc(entry->ptr, sz + 4);
+  if (ptr == NULL) {
     HL_printf("Failed to reallocate memory...\n");
     return 0;
   }
+  entry->ptr = ptr;
   entry->sz = sz;
   ((unsigned char*)entry->ptr)[sz+2] = 0xCA;
   ((unsigned char*)entry->ptr)[sz+3] = 0xFE;
@@ -108,61 +276,28 @@ static int hlhdf_alloc_reallocateDataInEntry(HlhdfHeapEntry_t* entry, size_t sz)
 
 static HlhdfHeapEntry_t* hlhdf_alloc_addHeapEntry(const char* filename, int lineno, size_t sz)
 {
-  HlhdfHeap_t* heap = NULL;
-  if (hlhdf_heap == NULL) {
-    hlhdf_heap = malloc(sizeof(HlhdfHeap_t));
-    if (hlhdf_heap == NULL) {
-      HL_printf("HLHDF_MEMORY_CHECK: Failed to allocate root heap entry\n");
-      return NULL;
-    }
-    hlhdf_heap->entry = NULL;
-    hlhdf_heap->next = NULL;
-  }
-  heap = hlhdf_heap;
-  while (heap->entry != NULL && heap->next != NULL) {
-    heap = heap->next;
-  }
-  if (heap->entry == NULL) {
-    heap->entry = hlhdf_alloc_createHeapEntry(filename, lineno, sz);
-  } else {
-    heap->next = malloc(sizeof(HlhdfHeap_t));
-    if (heap->next == NULL) {
-      HL_printf("HLHDF_MEMORY_CHECK: Failed to allocate heap node\n");
-      return NULL;
-    }
-    heap->next->next = NULL;
-    heap->next->entry = NULL;
-    heap = heap->next;
-
-    heap->entry = hlhdf_alloc_createHeapEntry(filename, lineno, sz);
+  HlhdfHeapEntry_t* entry = NULL;
+  if (!hlhdf_alloc_initTable(&hlhdf_heap)) {
+    HL_printf("HLHDF_MEMORY_CHECK: Failed to allocate root heap entry\n");
+    return NULL;
   }
+  hlhdf_alloc_growHeap();
 
-  if (heap->entry == NULL) {
+  entry = hlhdf_alloc_createHeapEntry(filename, lineno, sz);
+  if (entry == NULL) {
     HL_printf("HLHDF_MEMORY_CHECK: Failed to allocate heap entry\n");
-  }
-  return heap->entry;
-}
-
-static HlhdfHeapEntry_t* hlhdf_alloc_findPointer(void* ptr)
-{
-  HlhdfHeap_t* heap = hlhdf_heap;
-  if (heap == NULL) {
     return NULL;
   }
-  while (heap != NULL) {
-    if (heap->entry != NULL && heap->entry->b == ptr) {
-      return heap->entry;
-    }
-    heap = heap->next;
-  }
-  return NULL;
+  hlhdf_alloc_insertEntry(entry);
+  entry->site->count++;
+  hlhdf_alloc_siteAdd(entry->site, sz);
+  return entry;
 }
 
-static void hlhdf_alloc_releaseMemory(const char* filename, int lineno, HlhdfHeap_t* heapptr)
+static void hlhdf_alloc_releaseMemory(const char* filename, int lineno, HlhdfHeapEntry_t* entry)
 {
   int status = 0;
-  if (heapptr != NULL && heapptr->entry != NULL) {
-    HlhdfHeapEntry_t* entry = heapptr->entry;
+  if (entry != NULL) {
     unsigned char* ptr = (unsigned char*)entry->ptr;
     if (ptr[0] == 0xCA && ptr[1] == 0xFE &&
         ptr[entry->sz+2] == 0xCA && ptr[entry->sz+3] == 0xFE) {
@@ -171,21 +306,21 @@ static void hlhdf_alloc_releaseMemory(const char* filename, int lineno, HlhdfHea
     }
     if (status == 0) {
       HL_printf("HLHDF_MEMORY_CHECK: ---------MEMORY CORRUPTION HAS OCCURED-----------------\n");
-      HL_printf("HLHDF_MEMORY_CHECK: Memory allocated from: %s:%d\n", entry->filename, entry->lineno);
+      HL_printf("HLHDF_MEMORY_CHECK: Memory allocated from: %s:%d\n", entry->site->filename, entry->site->lineno);
       HL_printf("HLHDF_MEMORY_CHECK: Was corrupted when releasing at: %s:%d\n", filename, lineno);
       HL_printf("HLHDF_MEMORY_CHECK: Memory markers are: %x%x ... %x%x\n",
         (int)ptr[0], (int)ptr[1], (int)ptr[entry->sz+2], (int)ptr[entry->sz+3]);
     }
+    entry->site->bytes -= entry->sz;
     free(entry->ptr);
-    free(entry->filename);
     free(entry);
-    heapptr->entry = NULL;
   }
 }
 
-void* hlhdf_alloc_malloc(const char* filename, int lineno, size_t sz)
+static void* hlhdf_alloc_doMalloc(const char* filename, int lineno, size_t sz)
 {
   HlhdfHeapEntry_t* entry = hlhdf_alloc_addHeapEntry(filename, lineno, sz);
+  hlhdf_alloc_count++;
   if (entry != NULL) {
     number_of_allocations++;
     total_heap_usage += sz;
@@ -197,9 +332,10 @@ void* hlhdf_alloc_malloc(const char* filename, int lineno, size_t sz)
   }
 }
 
-void* hlhdf_alloc_calloc(const char* filename, int lineno, size_t npts, size_t sz)
+static void* hlhdf_alloc_doCalloc(const char* filename, int lineno, size_t npts, size_t sz)
 {
   HlhdfHeapEntry_t* entry = hlhdf_alloc_addHeapEntry(filename, lineno, npts*sz);
+  hlhdf_alloc_count++;
   if (entry != NULL) {
     if (entry->b != NULL) {
       total_heap_usage += npts*sz;
@@ -217,14 +353,15 @@ void* hlhdf_alloc_calloc(const char* filename, int lineno, size_t npts, size_t s
   }
 }
 
-void* hlhdf_alloc_realloc(const char* filename, int lineno, void* ptr, size_t sz)
+static void* hlhdf_alloc_doRealloc(const char* filename, int lineno, void* ptr, size_t sz)
 {
   HlhdfHeapEntry_t* entry = NULL;
   size_t oldsz = 0;
   if (ptr == NULL) {
-    return hlhdf_alloc_malloc(filename, lineno, sz);
+    return hlhdf_alloc_doMalloc(filename, lineno, sz);
   }
-  entry = hlhdf_alloc_findPointer(ptr);
+  hlhdf_alloc_count++;
+  entry = hlhdf_alloc_removeEntry(ptr);
   if (entry == NULL) {
     number_of_failed_reallocations++;
     HL_printf("HLHDF_MEMORY_CHECK: Calling realloc without a valid pointer at %s:%d\n",filename,lineno);
@@ -234,21 +371,28 @@ void* hlhdf_alloc_realloc(const char* filename, int lineno, void* ptr, size_t sz
   if(!hlhdf_alloc_reallocateDataInEntry(entry, sz)) {
     number_of_failed_reallocations++;
     HL_printf("HLHDF_MEMORY_CHECK: Failed to reallocate memory at %s:%d\n",filename,lineno);
+    hlhdf_alloc_insertEntry(entry);
+    return NULL;
   } else {
     number_of_reallocations++;
+    entry->site->bytes -= oldsz;
+    hlhdf_alloc_siteAdd(entry->site, sz);
     if (sz > oldsz) {
       total_heap_usage += (sz - oldsz);
     } else {
       total_heap_usage -= (oldsz - sz);
     }
   }
+  /* The returned pointer might have changed so entry has to be rehashed */
+  hlhdf_alloc_insertEntry(entry);
   return entry->b;
 }
 
-char* hlhdf_alloc_strdup(const char* filename, int lineno, const char* str)
+static char* hlhdf_alloc_doStrdup(const char* filename, int lineno, const char* str)
 {
   size_t len = 0;
   HlhdfHeapEntry_t* entry = NULL;
+  hlhdf_alloc_count++;
   if (str == NULL) {
     number_of_failed_strdup++;
     HL_printf("HLHDF_MEMORY_CHECK:Atempting to strdup NULL string %s:%d\n",filename,lineno);
@@ -272,10 +416,10 @@ char* hlhdf_alloc_strdup(const char* filename, int lineno, const char* str)
   }
 }
 
-void hlhdf_alloc_free(const char* filename, int lineno, void* ptr)
+static void hlhdf_alloc_doFree(const char* filename, int lineno, void* ptr)
 {
-  HlhdfHeap_t* heapptr = hlhdf_heap;
-  if (heapptr == NULL) {
+  HlhdfHeapEntry_t* entry = NULL;
+  if (hlhdf_heap.buckets == NULL) {
     number_of_failed_frees++;
     HL_printf("HLHDF_MEMORY_CHECK: FREE CALLED ON DATA NOT ALLOCATED BY HLHDF: %s:%d.\n",filename,lineno);
     return;
@@ -285,48 +429,95 @@ void hlhdf_alloc_free(const char* filename, int lineno, void* ptr)
     HL_printf("HLHDF_MEMORY_CHECK: ATEMPTING TO FREE NULL-value at %s:%d", filename, lineno);
     return;
   }
-  while (heapptr != NULL) {
-    if (heapptr->entry != NULL && heapptr->entry->b == ptr) {
-      number_of_frees++;
-      total_freed_heap_usage += heapptr->entry->sz;
-      hlhdf_alloc_releaseMemory(filename, lineno, heapptr);
-      return;
-    }
-    heapptr = heapptr->next;
+  entry = hlhdf_alloc_removeEntry(ptr);
+  if (entry != NULL) {
+    number_of_frees++;
+    total_freed_heap_usage += entry->sz;
+    hlhdf_alloc_releaseMemory(filename, lineno, entry);
+    return;
   }
   number_of_failed_frees++;
   HL_printf("HLHDF_MEMORY_CHECK: Atempting to free something that not has been allocated: %s:%d\n", filename, lineno);
 }
 
+void* hlhdf_alloc_malloc(const char* filename, int lineno, size_t sz)
+{
+  void* result = NULL;
+  pthread_mutex_lock(&hlhdf_alloc_lock);
+  result = hlhdf_alloc_doMalloc(filename, lineno, sz);
+  pthread_mutex_unlock(&hlhdf_alloc_lock);
+  return result;
+}
+
+void* hlhdf_alloc_calloc(const char* filename, int lineno, size_t npts, size_t sz)
+{
+  void* result = NULL;
+  pthread_mutex_lock(&hlhdf_alloc_lock);
+  result = hlhdf_alloc_doCalloc(filename, lineno, npts, sz);
+  pthread_mutex_unlock(&hlhdf_alloc_lock);
+  return result;
+}
+
+void* hlhdf_alloc_realloc(const char* filename, int lineno, void* ptr, size_t sz)
+{
+  void* result = NULL;
+  pthread_mutex_lock(&hlhdf_alloc_lock);
+  result = hlhdf_alloc_doRealloc(filename, lineno, ptr, sz);
+  pthread_mutex_unlock(&hlhdf_alloc_lock);
+  return result;
+}
+
+char* hlhdf_alloc_strdup(const char* filename, int lineno, const char* str)
+{
+  char* result = NULL;
+  pthread_mutex_lock(&hlhdf_alloc_lock);
+  result = hlhdf_alloc_doStrdup(filename, lineno, str);
+  pthread_mutex_unlock(&hlhdf_alloc_lock);
+  return result;
+}
+
+void hlhdf_alloc_free(const char* filename, int lineno, void* ptr)
+{
+  pthread_mutex_lock(&hlhdf_alloc_lock);
+  hlhdf_alloc_doFree(filename, lineno, ptr);
+  pthread_mutex_unlock(&hlhdf_alloc_lock);
+}
+
 void hlhdf_alloc_dump_heap(void)
 {
-  HlhdfHeap_t* heapptr = hlhdf_heap;
+  size_t i = 0;
   int msgPrinted = 0;
-  if (heapptr == NULL) {
-    return;
-  }
-  while (heapptr != NULL) {
-    if (heapptr->entry != NULL) {
+  for (i = 0; i < hlhdf_heap.nbuckets; i++) {
+    HlhdfHeapEntry_t* entry = (HlhdfHeapEntry_t*)hlhdf_heap.buckets[i];
+    while (entry != NULL) {
       if (!msgPrinted) {
         HL_printf("HLHDF_MEMORY_CHECK: Application terminating...\n");
         msgPrinted = 1;
       }
-      HL_printf("HLHDF_MEMORY_CHECK: %d bytes allocated %s:%d\n", (int)heapptr->entry->sz, heapptr->entry->filename, heapptr->entry->lineno);
+      HL_printf("HLHDF_MEMORY_CHECK: %d bytes allocated %s:%d\n", (int)entry->sz, entry->site->filename, entry->site->lineno);
+      entry = entry->next;
     }
-    heapptr = heapptr->next;
   }
 }
 
+/**
+ * Sorts call sites with largest peak first.
+ */
+static int hlhdf_alloc_compareSites(const void* a, const void* b)
+{
+  const HlhdfHeapSite_t* sa = *(const HlhdfHeapSite_t**)a;
+  const HlhdfHeapSite_t* sb = *(const HlhdfHeapSite_t**)b;
+  if (sa->peak != sb->peak) {
+    return (sa->peak < sb->peak) ? 1 : -1;
+  }
+  return (sa->count < sb->count) ? 1 : ((sa->count > sb->count) ? -1 : 0);
+}
+
 void hlhdf_alloc_print_statistics(void)
 {
   size_t totalNumberOfAllocations = number_of_allocations + number_of_strdup;
-  int maxNbrOfAllocs = 0;
-  HlhdfHeap_t* heapptr = hlhdf_heap;
-
-  while (heapptr != NULL) {
-    maxNbrOfAllocs++;
-    heapptr = heapptr->next;
-  }
+  HlhdfHeapSite_t** sites = NULL;
+  size_t i = 0, nsites = 0;
 
   HL_printf("HLHDF HEAP STATISTICS:\n");
   HL_printf("Number of allocations  : %ld\n",number_of_allocations);
@@ -337,7 +528,7 @@ void hlhdf_alloc_print_statistics(void)
   HL_printf("Total heap allocation  : %ld bytes\n", total_heap_usage);
   HL_printf("Total heap deallocation: %ld bytes\n", total_freed_heap_usage);
   HL_printf("Lost heap              : %ld bytes\n", (total_heap_usage - total_freed_heap_usage));
-  HL_printf("Max number of allocs   : %d\n", maxNbrOfAllocs);
+  HL_printf("Max number of allocs   : %ld\n", max_number_of_allocations);
 
   if (number_of_failed_allocations > 0)
     HL_printf("Number of failed allocations     : %ld\n", number_of_failed_allocations);
@@ -347,4 +538,29 @@ void hlhdf_alloc_print_statistics(void)
     HL_printf("Number of failed frees           : %ld\n", number_of_failed_frees);
   if (number_of_failed_strdup > 0)
     HL_printf("Number of failed strdup          : %ld\n", number_of_failed_strdup);
+
+  if (hlhdf_sites.nentries == 0) {
+    return;
+  }
+  sites = malloc(sizeof(HlhdfHeapSite_t*) * hlhdf_sites.nentries);
+  if (sites == NULL) {
+    HL_printf("HLHDF_MEMORY_CHECK: Failed to allocate memory for call site statistics\n");
+    return;
+  }
+  for (i = 0; i < hlhdf_sites.nbuckets; i++) {
+    HlhdfHeapSite_t* site = (HlhdfHeapSite_t*)hlhdf_sites.buckets[i];
+    while (site != NULL) {
+      sites[nsites++] = site;
+      site = site->next;
+    }
+  }
+  qsort(sites, nsites, sizeof(HlhdfHeapSite_t*), hlhdf_alloc_compareSites);
+
+  HL_printf("HLHDF HEAP USAGE PER CALL SITE (sorted on peak):\n");
+  HL_printf("%12s %12s %12s %12s  %s\n", "allocs", "total", "peak", "in use", "location");
+  for (i = 0; i < nsites; i++) {
+    HL_printf("%12ld %12ld %12ld %12ld  %s:%d\n", sites[i]->count, sites[i]->total,
+      sites[i]->peak, sites[i]->bytes, sites[i]->filename, sites[i]->lineno);
+  }
+  free(sites);
 }
@@ -80,6 +80,20 @@ void hlhdf_alloc_dump_heap(void);
  */
 void hlhdf_alloc_print_statistics(void);
 
+/**
+ * Number of allocations made through the HLHDF allocation macros, reported by HL_getStats.
+ */
+extern unsigned long long hlhdf_alloc_count;
+
+/**
+ * @brief Counts one allocation in hlhdf_alloc_count, atomically when the compiler supports it
+ */
+#if defined(__GNUC__)
+#define HLHDF_COUNT_ALLOC() __atomic_fetch_add(&hlhdf_alloc_count, 1, __ATOMIC_RELAXED)
+#else
+#define HLHDF_COUNT_ALLOC() (hlhdf_alloc_count++)
+#endif
+
 #ifdef HLHDF_MEMORY_DEBUG
 /**
  * @brief debugged malloc
@@ -110,22 +124,22 @@ void hlhdf_alloc_print_statistics(void);
 /**
  * @brief malloc
  */
-#define HLHDF_MALLOC(sz) malloc(sz)
+#define HLHDF_MALLOC(sz) (HLHDF_COUNT_ALLOC(), malloc(sz))
 
 /**
  * @brief calloc
  */
-#define HLHDF_CALLOC(npts,sz) calloc(npts, sz)
+#define HLHDF_CALLOC(npts,sz) (HLHDF_COUNT_ALLOC(), calloc(npts, sz))
 
 /**
  * @brief realloc
  */
-#define HLHDF_REALLOC(ptr, sz) realloc(ptr, sz)
+#define HLHDF_REALLOC(ptr, sz) (HLHDF_COUNT_ALLOC(), realloc(ptr, sz))
 
 /**
  * @brief strdup
  */
-#define HLHDF_STRDUP(x) strdup(x)
+#define HLHDF_STRDUP(x) (HLHDF_COUNT_ALLOC(), strdup(x))
 
 /**
  * @brief Frees the pointer if != NULL
@@ -0,0 +1,571 @@
+/* --------------------------------------------------------------------
+Copyright (C) 2026 Swedish Meteorological and Hydrological Institute, SMHI,
+
+This file is part of HLHDF.
+
+HLHDF is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+HLHDF is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with HLHDF.  If not, see <http://www.gnu.org/licenses/>.
+------------------------------------------------------------------------*/
+
+/**
+ * Process wide cache of fetched dataset and attribute data.
+ * @file
+ * @date 2026-10-19
+ */
+#include "hlhdf.h"
+#include "hlhdf_alloc.h"
+#include "hlhdf_cache.h"
+#include "hlhdf_cache_private.h"
+#include "hlhdf_compound_private.h"
+#include "hlhdf_compound_utils.h"
+#include "hlhdf_debug.h"
+#include "hlhdf_defines_private.h"
+#include "hlhdf_node_private.h"
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+
+/*@{ Structs */
+/**
+ * A reference counted data buffer.
+ */
+struct _HL_SharedBuffer {
+  int refcount;        /**< number of references, updated atomically */
+  size_t size;         /**< size of data in bytes */
+  unsigned char* data; /**< the data */
+  void* map;           /**< the memory map data points into, NULL if data is allocated */
+  size_t mapsize;      /**< size of the memory map */
+};
+
+/**
+ * Identifies a file by name and by what stat reports about it.
+ */
+struct _HL_DataCacheFileKey {
+  char* prefix; /**< filename, device, inode, mtime and size as a string */
+};
+
+/**
+ * One cached node.
+ */
+typedef struct HLDataCacheEntry_t {
+  char* key;                     /**< file key prefix + node name */
+  size_t hash;                   /**< hash of key */
+  HL_Type type;                  /**< node type */
+  int ndims;                     /**< rank */
+  hsize_t* dims;                 /**< dimensions */
+  size_t dSize;                  /**< size of data type */
+  size_t rdSize;                 /**< size of raw data type */
+  HL_SharedBuffer* data;         /**< the data */
+  HL_SharedBuffer* rawdata;      /**< the rawdata, may be NULL */
+  hid_t typeId;                  /**< the fixed type */
+  HL_CompoundTypeDescription* compoundDescription; /**< compound description, may be NULL */
+  size_t nbytes;                 /**< number of bytes accounted for this entry */
+  struct HLDataCacheEntry_t* prev; /**< more recently used */
+  struct HLDataCacheEntry_t* next; /**< less recently used */
+  struct HLDataCacheEntry_t* hnext; /**< next in same bucket */
+} HLDataCacheEntry_t;
+
+/**
+ * The cache, a hash table with all entries also linked in LRU order.
+ */
+typedef struct {
+  size_t limit;                 /**< max number of bytes */
+  size_t usage;                 /**< current number of bytes */
+  size_t hits;                  /**< number of hits */
+  size_t misses;                /**< number of misses */
+  HLDataCacheEntry_t** buckets; /**< the hash buckets */
+  size_t nbuckets;              /**< number of buckets, power of 2 */
+  size_t nentries;              /**< number of entries */
+  HLDataCacheEntry_t* head;     /**< most recently used */
+  HLDataCacheEntry_t* tail;     /**< least recently used */
+} HLDataCache_t;
+
+/*@} End of Structs */
+
+/**
+ * Initial number of buckets in the cache.
+ */
+#define HLDATACACHE_INITIAL_BUCKETS 256
+
+static HLDataCache_t hlhdf_datacache = {0, 0, 0, 0, NULL, 0, 0, NULL, NULL};
+
+/**
+ * Protects the cache since nodes may be fetched from background threads.
+ */
+static pthread_mutex_t hlhdf_datacache_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/*@{ Static functions */
+static size_t HLDataCacheInternal_hash(const char* str)
+{
+  size_t h = 5381;
+  while (*str != '\0') {
+    h = h * 33 + (unsigned char)*str++;
+  }
+  return h;
+}
+
+static void HLDataCacheInternal_unlink(HLDataCacheEntry_t* entry)
+{
+  if (entry->prev != NULL) {
+    entry->prev->next = entry->next;
+  } else {
+    hlhdf_datacache.head = entry->next;
+  }
+  if (entry->next != NULL) {
+    entry->next->prev = entry->prev;
+  } else {
+    hlhdf_datacache.tail = entry->prev;
+  }
+  entry->prev = entry->next = NULL;
+}
+
+static void HLDataCacheInternal_pushFront(HLDataCacheEntry_t* entry)
+{
+  entry->prev = NULL;
+  entry->next = hlhdf_datacache.head;
+  if (hlhdf_datacache.head != NULL) {
+    hlhdf_datacache.head->prev = entry;
+  }
+  hlhdf_datacache.head = entry;
+  if (hlhdf_datacache.tail == NULL) {
+    hlhdf_datacache.tail = entry;
+  }
+}
+
+static void HLDataCacheInternal_freeEntry(HLDataCacheEntry_t* entry)
+{
+  if (entry != NULL) {
+    HLHDF_FREE(entry->key);
+    HLHDF_FREE(entry->dims);
+    HLSharedBuffer_release(entry->data);
+    HLSharedBuffer_release(entry->rawdata);
+    HL_H5T_CLOSE(entry->typeId);
+    freeHL_CompoundTypeDescription(entry->compoundDescription);
+    HLHDF_FREE(entry);
+  }
+}
+
+/**
+ * Removes the entry from both the hash table and the LRU list and releases it.
+ */
+static void HLDataCacheInternal_removeEntry(HLDataCacheEntry_t* entry)
+{
+  HLDataCacheEntry_t** pentry = &hlhdf_datacache.buckets[entry->hash & (hlhdf_datacache.nbuckets - 1)];
+  while (*pentry != NULL) {
+    if (*pentry == entry) {
+      *pentry = entry->hnext;
+      break;
+    }
+    pentry = &(*pentry)->hnext;
+  }
+  HLDataCacheInternal_unlink(entry);
+  hlhdf_datacache.usage -= entry->nbytes;
+  hlhdf_datacache.nentries--;
+  HLDataCacheInternal_freeEntry(entry);
+}
+
+/**
+ * Removes least recently used entries until usage is within limit.
+ */
+static void HLDataCacheInternal_trim(size_t limit)
+{
+  while (hlhdf_datacache.tail != NULL && hlhdf_datacache.usage > limit) {
+    HLDataCacheInternal_removeEntry(hlhdf_datacache.tail);
+  }
+}
+
+static HLDataCacheEntry_t* HLDataCacheInternal_find(const char* key, size_t hash)
+{
+  HLDataCacheEntry_t* entry = NULL;
+  if (hlhdf_datacache.buckets == NULL) {
+    return NULL;
+  }
+  entry = hlhdf_datacache.buckets[hash & (hlhdf_datacache.nbuckets - 1)];
+  while (entry != NULL) {
+    if (entry->hash == hash && strcmp(entry->key, key) == 0) {
+      return entry;
+    }
+    entry = entry->hnext;
+  }
+  return NULL;
+}
+
+/**
+ * Doubles the number of buckets when the table becomes crowded.
+ */
+static int HLDataCacheInternal_ensureCapacity(void)
+{
+  size_t i = 0;
+  size_t nbuckets = 0;
+  HLDataCacheEntry_t** buckets = NULL;
+
+  if (hlhdf_datacache.buckets == NULL) {
+    hlhdf_datacache.buckets = HLHDF_CALLOC(HLDATACACHE_INITIAL_BUCKETS, sizeof(HLDataCacheEntry_t*));
+    if (hlhdf_datacache.buckets == NULL) {
+      HL_ERROR0("Failed to allocate data cache");
+      return 0;
+    }
+    hlhdf_datacache.nbuckets = HLDATACACHE_INITIAL_BUCKETS;
+    return 1;
+  }
+  if (hlhdf_datacache.nentries < hlhdf_datacache.nbuckets) {
+    return 1;
+  }
+  nbuckets = hlhdf_datacache.nbuckets * 2;
+  if ((buckets = HLHDF_CALLOC(nbuckets, sizeof(HLDataCacheEntry_t*))) == NULL) {
+    return 1; /* Keep using the old buckets */
+  }
+  for (i = 0; i < hlhdf_datacache.nbuckets; i++) {
+    HLDataCacheEntry_t* entry = hlhdf_datacache.buckets[i];
+    while (entry != NULL) {
+      HLDataCacheEntry_t* next = entry->hnext;
+      entry->hnext = buckets[entry->hash & (nbuckets - 1)];
+      buckets[entry->hash & (nbuckets - 1)] = entry;
+      entry = next;
+    }
+  }
+  HLHDF_FREE(hlhdf_datacache.buckets);
+  hlhdf_datacache.buckets = buckets;
+  hlhdf_datacache.nbuckets = nbuckets;
+  return 1;
+}
+
+static char* HLDataCacheInternal_createKey(HL_DataCacheFileKey* fkey, HL_Node* node)
+{
+  const char* name = HLNode_getName(node);
+  size_t len = strlen(fkey->prefix) + strlen(name) + 1;
+  char* key = HLHDF_MALLOC(len);
+  if (key == NULL) {
+    HL_ERROR0("Failed to allocate memory for cache key");
+    return NULL;
+  }
+  strcpy(key, fkey->prefix);
+  strcat(key, name);
+  return key;
+}
+
+/*@} End of Static functions */
+
+/*@{ Private functions */
+HL_SharedBuffer* HLSharedBuffer_adopt(unsigned char* data, size_t size)
+{
+  HL_SharedBuffer* result = HLHDF_MALLOC(sizeof(HL_SharedBuffer));
+  if (result == NULL) {
+    HL_ERROR0("Failed to allocate shared buffer");
+    return NULL;
+  }
+  result->refcount = 1;
+  result->size = size;
+  result->data = data;
+  result->map = NULL;
+  result->mapsize = 0;
+  return result;
+}
+
+HL_SharedBuffer* HLSharedBuffer_map(const char* filename, size_t offset, size_t size)
+{
+  HL_SharedBuffer* result = NULL;
+  struct stat st;
+  size_t start = offset - offset % (size_t)sysconf(_SC_PAGESIZE);
+  void* map = MAP_FAILED;
+  int fd = -1;
+
+  if ((fd = open(filename, O_RDONLY)) < 0) {
+    HL_DEBUG1("Could not open %s for mapping", filename);
+    return NULL;
+  }
+  /* Mapping beyond the end of the file would give SIGBUS when the data is accessed */
+  if (fstat(fd, &st) != 0 || (size_t)st.st_size < offset + size) {
+    HL_DEBUG1("Region to map is outside %s", filename);
+    close(fd);
+    return NULL;
+  }
+  map = mmap(NULL, size + (offset - start), PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, (off_t)start);
+  close(fd);
+  if (map == MAP_FAILED) {
+    HL_DEBUG1("Failed to map %s", filename);
+    return NULL;
+  }
+  madvise(map, size + (offset - start), MADV_SEQUENTIAL);
+
+  if ((result = HLHDF_MALLOC(sizeof(HL_SharedBuffer))) == NULL) {
+    HL_ERROR0("Failed to allocate shared buffer");
+    munmap(map, size + (offset - start));
+    return NULL;
+  }
+  result->refcount = 1;
+  result->size = size;
+  result->data = (unsigned char*)map + (offset - start);
+  result->map = map;
+  result->mapsize = size + (offset - start);
+  return result;
+}
+
+HL_SharedBuffer* HLSharedBuffer_ref(HL_SharedBuffer* buffer)
+{
+  HL_ASSERT((buffer != NULL), "HLSharedBuffer_ref called with buffer == NULL");
+  HL_ATOMIC_ADD(buffer->refcount, 1);
+  return buffer;
+}
+
+int HLSharedBuffer_release(HL_SharedBuffer* buffer)
+{
+  if (buffer != NULL) {
+    if (HL_ATOMIC_SUB(buffer->refcount, 1) <= 0) {
+      if (buffer->map != NULL) {
+        munmap(buffer->map, buffer->mapsize);
+      } else {
+        HLHDF_FREE(buffer->data);
+      }
+      HLHDF_FREE(buffer);
+      return 1;
+    }
+  }
+  return 0;
+}
+
+int HLSharedBuffer_isExclusive(HL_SharedBuffer* buffer)
+{
+  HL_ASSERT((buffer != NULL), "HLSharedBuffer_isExclusive called with buffer == NULL");
+  return HL_ATOMIC_LOAD(buffer->refcount) == 1;
+}
+
+int HLSharedBuffer_isMapped(HL_SharedBuffer* buffer)
+{
+  HL_ASSERT((buffer != NULL), "HLSharedBuffer_isMapped called with buffer == NULL");
+  return buffer->map != NULL;
+}
+
+unsigned char* HLSharedBuffer_getData(HL_SharedBuffer* buffer)
+{
+  HL_ASSERT((buffer != NULL), "HLSharedBuffer_getData called with buffer == NULL");
+  return buffer->data;
+}
+
+size_t HLSharedBuffer_getSize(HL_SharedBuffer* buffer)
+{
+  HL_ASSERT((buffer != NULL), "HLSharedBuffer_getSize called with buffer == NULL");
+  return buffer->size;
+}
+
+HL_DataCacheFileKey* HLDataCachePrivate_createFileKey(const char* filename)
+{
+  struct stat st;
+  char buff[128];
+  HL_DataCacheFileKey* result = NULL;
+
+  if (hlhdf_datacache.limit == 0 || filename == NULL) {
+    return NULL;
+  }
+  if (stat(filename, &st) != 0) {
+    return NULL;
+  }
+  snprintf(buff, sizeof(buff), "\n%lu:%lu:%ld.%09ld:%lld\n",
+           (unsigned long)st.st_dev, (unsigned long)st.st_ino,
+           (long)st.st_mtime, HLHDF_MTIME_NSEC(st), (long long)st.st_size);
+
+  if ((result = HLHDF_MALLOC(sizeof(HL_DataCacheFileKey))) == NULL ||
+      (result->prefix = HLHDF_MALLOC(strlen(filename) + strlen(buff) + 1)) == NULL) {
+    HL_ERROR0("Failed to allocate cache file key");
+    HLHDF_FREE(result);
+    return NULL;
+  }
+  strcpy(result->prefix, filename);
+  strcat(result->prefix, buff);
+  return result;
+}
+
+void HLDataCachePrivate_freeFileKey(HL_DataCacheFileKey* key)
+{
+  if (key != NULL) {
+    HLHDF_FREE(key->prefix);
+    HLHDF_FREE(key);
+  }
+}
+
+int HLDataCachePrivate_containsNode(HL_DataCacheFileKey* fkey, HL_Node* node)
+{
+  char* key = NULL;
+  HLDataCacheEntry_t* entry = NULL;
+  int result = 0;
+
+  if (fkey == NULL || node == NULL || hlhdf_datacache.limit == 0) {
+    return 0;
+  }
+  if ((key = HLDataCacheInternal_createKey(fkey, node)) == NULL) {
+    return 0;
+  }
+  pthread_mutex_lock(&hlhdf_datacache_lock);
+  entry = HLDataCacheInternal_find(key, HLDataCacheInternal_hash(key));
+  result = (entry != NULL && entry->type == HLNode_getType(node));
+  pthread_mutex_unlock(&hlhdf_datacache_lock);
+  HLHDF_FREE(key);
+  return result;
+}
+
+int HLDataCachePrivate_fillNode(HL_DataCacheFileKey* fkey, HL_Node* node)
+{
+  char* key = NULL;
+  HLDataCacheEntry_t* entry = NULL;
+  int result = 0;
+
+  if (fkey == NULL || node == NULL || hlhdf_datacache.limit == 0) {
+    return 0;
+  }
+  if ((key = HLDataCacheInternal_createKey(fkey, node)) == NULL) {
+    return 0;
+  }
+  pthread_mutex_lock(&hlhdf_datacache_lock);
+  entry = HLDataCacheInternal_find(key, HLDataCacheInternal_hash(key));
+  if (entry == NULL || entry->type != HLNode_getType(node)) {
+    hlhdf_datacache.misses++;
+    goto done;
+  }
+
+  if (!HLNode_setDimensions(node, entry->ndims, entry->dims) ||
+      !HLNodePrivate_setTypeIdAndDeriveFormat(node, entry->typeId) ||
+      !HLNodePrivate_setSharedData(node, entry->dSize, entry->data) ||
+      (entry->rawdata != NULL && !HLNodePrivate_setSharedRawdata(node, entry->rdSize, entry->rawdata))) {
+    HL_ERROR1("Failed to fill node %s from cache", HLNode_getName(node));
+    goto done;
+  }
+  if (entry->compoundDescription != NULL) {
+    HLNode_setCompoundDescription(node, HLCompoundPrivate_ref(entry->compoundDescription));
+  }
+  HLNode_setMark(node, NMARK_ORIGINAL);
+  HLNode_setFetched(node, 1);
+
+  HLDataCacheInternal_unlink(entry);
+  HLDataCacheInternal_pushFront(entry);
+  hlhdf_datacache.hits++;
+  result = 1;
+done:
+  pthread_mutex_unlock(&hlhdf_datacache_lock);
+  HLHDF_FREE(key);
+  return result;
+}
+
+void HLDataCachePrivate_addNode(HL_DataCacheFileKey* fkey, HL_Node* node)
+{
+  HLDataCacheEntry_t* entry = NULL;
+  HLDataCacheEntry_t* old = NULL;
+  int ndims = 0;
+
+  if (fkey == NULL || node == NULL || hlhdf_datacache.limit == 0 || HLNode_getConstData(node) == NULL) {
+    return;
+  }
+  if ((entry = HLHDF_CALLOC(1, sizeof(HLDataCacheEntry_t))) == NULL) {
+    HL_ERROR0("Failed to allocate cache entry");
+    return;
+  }
+  entry->typeId = -1;
+  entry->type = HLNode_getType(node);
+  entry->dSize = HLNode_getDataSize(node);
+  entry->rdSize = HLNode_getRawdataSize(node);
+  if ((entry->key = HLDataCacheInternal_createKey(fkey, node)) == NULL) {
+    goto fail;
+  }
+  entry->hash = HLDataCacheInternal_hash(entry->key);
+  HLNode_getDimensions(node, &ndims, &entry->dims);
+  entry->ndims = ndims;
+  if (HLNodePrivate_getTypeId(node) >= 0 && (entry->typeId = H5Tcopy(HLNodePrivate_getTypeId(node))) < 0) {
+    goto fail;
+  }
+  entry->compoundDescription = HLCompoundPrivate_ref((HL_CompoundTypeDescription*)HLNode_getConstCompoundDescription(node));
+  if ((entry->data = HLNodePrivate_shareData(node)) == NULL || HLSharedBuffer_isMapped(entry->data)) {
+    goto fail;
+  }
+  entry->nbytes = HLSharedBuffer_getSize(entry->data);
+  if (HLNode_getConstRawdata(node) != NULL) {
+    if ((entry->rawdata = HLNodePrivate_shareRawdata(node)) == NULL) {
+      goto fail;
+    }
+    entry->nbytes += HLSharedBuffer_getSize(entry->rawdata);
+  }
+
+  pthread_mutex_lock(&hlhdf_datacache_lock);
+  if (entry->nbytes > hlhdf_datacache.limit || !HLDataCacheInternal_ensureCapacity()) {
+    pthread_mutex_unlock(&hlhdf_datacache_lock);
+    goto fail; /* Would never fit */
+  }
+
+  if ((old = HLDataCacheInternal_find(entry->key, entry->hash)) != NULL) {
+    HLDataCacheInternal_removeEntry(old);
+  }
+  HLDataCacheInternal_trim(hlhdf_datacache.limit - entry->nbytes);
+
+  entry->hnext = hlhdf_datacache.buckets[entry->hash & (hlhdf_datacache.nbuckets - 1)];
+  hlhdf_datacache.buckets[entry->hash & (hlhdf_datacache.nbuckets - 1)] = entry;
+  HLDataCacheInternal_pushFront(entry);
+  hlhdf_datacache.usage += entry->nbytes;
+  hlhdf_datacache.nentries++;
+  pthread_mutex_unlock(&hlhdf_datacache_lock);
+  return;
+fail:
+  HLDataCacheInternal_freeEntry(entry);
+}
+/*@} End of Private functions */
+
+/*@{ Interface functions */
+void HL_setDataCacheLimit(size_t limit)
+{
+  pthread_mutex_lock(&hlhdf_datacache_lock);
+  hlhdf_datacache.limit = limit;
+  HLDataCacheInternal_trim(limit);
+  pthread_mutex_unlock(&hlhdf_datacache_lock);
+}
+
+size_t HL_getDataCacheLimit(void)
+{
+  return hlhdf_datacache.limit;
+}
+
+size_t HL_getDataCacheUsage(void)
+{
+  size_t usage = 0;
+  pthread_mutex_lock(&hlhdf_datacache_lock);
+  usage = hlhdf_datacache.usage;
+  pthread_mutex_unlock(&hlhdf_datacache_lock);
+  return usage;
+}
+
+void HL_getDataCacheStatistics(size_t* hits, size_t* misses)
+{
+  pthread_mutex_lock(&hlhdf_datacache_lock);
+  if (hits != NULL) {
+    *hits = hlhdf_datacache.hits;
+  }
+  if (misses != NULL) {
+    *misses = hlhdf_datacache.misses;
+  }
+  pthread_mutex_unlock(&hlhdf_datacache_lock);
+}
+
+void HL_clearDataCache(void)
+{
+  pthread_mutex_lock(&hlhdf_datacache_lock);
+  HLDataCacheInternal_trim(0);
+  HLHDF_FREE(hlhdf_datacache.buckets);
+  hlhdf_datacache.nbuckets = 0;
+  hlhdf_datacache.nentries = 0;
+  hlhdf_datacache.hits = 0;
+  hlhdf_datacache.misses = 0;
+  pthread_mutex_unlock(&hlhdf_datacache_lock);
+}
+/*@} End of Interface functions */
@@ -0,0 +1,75 @@
+/* --------------------------------------------------------------------
+Copyright (C) 2026 Swedish Meteorological and Hydrological Institute, SMHI,
+
+This file is part of HLHDF.
+
+HLHDF is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+HLHDF is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with HLHDF.  If not, see <http://www.gnu.org/licenses/>.
+------------------------------------------------------------------------*/
+
+/**
+ * Process wide cache of fetched dataset and attribute data. When enabled,
+ * data that has been fetched once is kept in memory and shared by all nodelists
+ * that fetch the same node from the same, unmodified file.
+ * @file
+ * @date 2026-10-19
+ */
+#ifndef HLHDF_CACHE_H
+#define HLHDF_CACHE_H
+#include "hlhdf_types.h"
+
+/**
+ * Sets the max number of bytes that the data cache may hold. When the limit is exceeded
+ * the least recently used entries are removed. Entries are identified by file name,
+ * device, inode, modification time and size of the file together with the node name
+ * so a file that is rewritten will not be served from the cache.
+ * Fetched nodes share their data with the cache. \ref HLNode_getConstData and
+ * \ref HLNode_getConstRawdata return the shared data as is, while \ref HLNode_getData and
+ * \ref HLNode_getRawdata give the node a private copy before returning, so modifying the
+ * returned data never affects the cache or other nodes.
+ * @ingroup hlhdf_c_apis
+ * @param[in] limit the limit in bytes, 0 disables the cache (default)
+ */
+void HL_setDataCacheLimit(size_t limit);
+
+/**
+ * Returns the max number of bytes that the data cache may hold.
+ * @ingroup hlhdf_c_apis
+ * @return the limit in bytes, 0 if the cache is disabled
+ */
+size_t HL_getDataCacheLimit(void);
+
+/**
+ * Returns the number of bytes currently held by the data cache.
+ * @ingroup hlhdf_c_apis
+ * @return the number of bytes
+ */
+size_t HL_getDataCacheUsage(void);
+
+/**
+ * Returns the number of lookups that have been served from and missed in the cache
+ * since the cache was last cleared.
+ * @ingroup hlhdf_c_apis
+ * @param[out] hits number of lookups served from cache (may be NULL)
+ * @param[out] misses number of lookups not found in cache (may be NULL)
+ */
+void HL_getDataCacheStatistics(size_t* hits, size_t* misses);
+
+/**
+ * Removes all entries from the data cache and resets the statistics. Nodes that are
+ * sharing data with the cache will keep their data.
+ * @ingroup hlhdf_c_apis
+ */
+void HL_clearDataCache(void);
+
+#endif /* HLHDF_CACHE_H */
@@ -0,0 +1,141 @@
+/* --------------------------------------------------------------------
+Copyright (C) 2026 Swedish Meteorological and Hydrological Institute, SMHI,
+
+This file is part of HLHDF.
+
+HLHDF is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+HLHDF is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with HLHDF.  If not, see <http://www.gnu.org/licenses/>.
+------------------------------------------------------------------------*/
+
+/**
+ * Private functions for the data cache and the reference counted buffers
+ * that are shared between nodes and the cache.
+ * @file
+ * @date 2026-10-19
+ */
+#ifndef HLHDF_CACHE_PRIVATE_H
+#define HLHDF_CACHE_PRIVATE_H
+#include "hlhdf.h"
+
+/**
+ * A reference counted data buffer.
+ */
+typedef struct _HL_SharedBuffer HL_SharedBuffer;
+
+/**
+ * Creates a shared buffer that takes over responsibility for data.
+ * @param[in] data the data (<b>responsibility taken over on success</b>)
+ * @param[in] size the size of data in bytes
+ * @return the shared buffer with a reference count of 1 or NULL on failure
+ */
+HL_SharedBuffer* HLSharedBuffer_adopt(unsigned char* data, size_t size);
+
+/**
+ * Creates a shared buffer with a private copy-on-write memory map of size bytes at
+ * offset in a file. The pages are shared with the page cache and with other
+ * processes mapping the same file until they are written to.
+ * @param[in] filename the file
+ * @param[in] offset the offset in the file
+ * @param[in] size the number of bytes
+ * @return the shared buffer with a reference count of 1 or NULL if the region could not be mapped
+ */
+HL_SharedBuffer* HLSharedBuffer_map(const char* filename, size_t offset, size_t size);
+
+/**
+ * Increases the reference count.
+ * @param[in] buffer the buffer
+ * @return the buffer
+ */
+HL_SharedBuffer* HLSharedBuffer_ref(HL_SharedBuffer* buffer);
+
+/**
+ * Decreases the reference count and releases the buffer when it reaches 0.
+ * @param[in] buffer the buffer, may be NULL
+ * @return 1 if this was the last reference and the buffer was released, otherwise 0
+ */
+int HLSharedBuffer_release(HL_SharedBuffer* buffer);
+
+/**
+ * Returns if the caller holds the only reference to the buffer.
+ * @param[in] buffer the buffer
+ * @return 1 if there are no other references, otherwise 0
+ */
+int HLSharedBuffer_isExclusive(HL_SharedBuffer* buffer);
+
+/**
+ * Returns if the buffer is a memory map of a file, see \ref HLSharedBuffer_map.
+ * @param[in] buffer the buffer
+ * @return 1 if the buffer is mapped, otherwise 0
+ */
+int HLSharedBuffer_isMapped(HL_SharedBuffer* buffer);
+
+/**
+ * Returns the data of the buffer.
+ * @param[in] buffer the buffer
+ * @return the data (<b>internal memory, do not release</b>)
+ */
+unsigned char* HLSharedBuffer_getData(HL_SharedBuffer* buffer);
+
+/**
+ * Returns the size of the buffer.
+ * @param[in] buffer the buffer
+ * @return the size in bytes
+ */
+size_t HLSharedBuffer_getSize(HL_SharedBuffer* buffer);
+
+/**
+ * Identifies a file in the cache.
+ */
+typedef struct _HL_DataCacheFileKey HL_DataCacheFileKey;
+
+/**
+ * Creates a key for the file if the cache is enabled.
+ * @param[in] filename the file
+ * @return the key or NULL if the cache is disabled or the file could not be examined
+ */
+HL_DataCacheFileKey* HLDataCachePrivate_createFileKey(const char* filename);
+
+/**
+ * Releases the file key.
+ * @param[in] key the key, may be NULL
+ */
+void HLDataCachePrivate_freeFileKey(HL_DataCacheFileKey* key);
+
+/**
+ * Returns if the cache has data for the node. Neither the statistics nor the
+ * order of the entries are affected and the entry may be evicted before the
+ * node is filled.
+ * @param[in] key the file key
+ * @param[in] node the node
+ * @return 1 if the node is cached, otherwise 0
+ */
+int HLDataCachePrivate_containsNode(HL_DataCacheFileKey* key, HL_Node* node);
+
+/**
+ * Fills the node with the data from the cache if it exists.
+ * @param[in] key the file key
+ * @param[in] node the node
+ * @return 1 if the node was filled from the cache, otherwise 0
+ */
+int HLDataCachePrivate_fillNode(HL_DataCacheFileKey* key, HL_Node* node);
+
+/**
+ * Adds the data of a fetched node to the cache. The data is shared between node and cache.
+ * Memory mapped data is not added, it is already shared with the page cache and sharing
+ * it with the data cache would make the first write access copy the whole map.
+ * @param[in] key the file key
+ * @param[in] node the node
+ */
+void HLDataCachePrivate_addNode(HL_DataCacheFileKey* key, HL_Node* node);
+
+#endif /* HLHDF_CACHE_PRIVATE_H */
@@ -27,8 +27,108 @@ along with HLHDF.  If not, see <http://www.gnu.org/licenses/>.
 #include "hlhdf_alloc.h"
 #include "hlhdf_defines_private.h"
 #include "hlhdf_debug.h"
+#include "hlhdf_compound_private.h"
 #include <string.h>
 #include <stdlib.h>
+#include <pthread.h>
+
+/**
+ * Number of buckets in the table of shared compound descriptions.
+ */
+#define HLHDF_COMPOUNDTABLE_SIZE 64
+
+/**
+ * Max number of table entries that are compared with a type in one lookup.
+ */
+#define HLHDF_COMPOUNDTABLE_CANDIDATES 8
+
+/**
+ * The allocation behind every description created by \ref newHL_CompoundTypeDescription.
+ * The public part comes first so that a description can be converted to this struct.
+ */
+typedef struct HLCompoundDescription_t {
+  HL_CompoundTypeDescription descr; /**< the public description */
+  int refCount;                     /**< number of holders of the description */
+  int registered;                   /**< if the description is in the table of shared descriptions */
+} HLCompoundDescription_t;
+
+/**
+ * Returns the allocation behind a description.
+ */
+#define HLCOMPOUND_PRIVATE(d) ((HLCompoundDescription_t*)(d))
+
+/**
+ * One shared compound description together with the native type it was built from.
+ */
+typedef struct HLSharedCompound_t {
+  hid_t typeId;                       /**< copy of the native compound type */
+  HL_CompoundTypeDescription* descr;  /**< the shared description */
+  struct HLSharedCompound_t* next;    /**< next entry in the same bucket */
+} HLSharedCompound_t;
+
+static HLSharedCompound_t* hlhdf_compoundtable[HLHDF_COMPOUNDTABLE_SIZE]; /**< the shared descriptions */
+
+/**
+ * Protects the table and the release of shared descriptions. The background fetch and
+ * write threads look up and release descriptions at the same time as the caller. No HDF5
+ * calls are made while the lock is held, since the lookups are made from within HDF5
+ * iteration callbacks where the HDF5 library lock is held.
+ */
+static pthread_mutex_t hlhdf_compoundtable_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Returns the bucket for a description.
+ * @param[in] size the size of the compound type
+ * @param[in] nmembers the number of members
+ * @param[in] objno0 first part of the object number
+ * @param[in] objno1 second part of the object number
+ * @return the bucket index
+ */
+static unsigned int HLCompoundInternal_bucket(size_t size, int nmembers,
+  unsigned long objno0, unsigned long objno1)
+{
+  unsigned long h = (unsigned long)size;
+  h = h * 31 + (unsigned long)nmembers;
+  h = h * 31 + objno0;
+  h = h * 31 + objno1;
+  return (unsigned int)(h % HLHDF_COMPOUNDTABLE_SIZE);
+}
+
+/**
+ * Removes a description from the table of shared descriptions if it is registered.
+ * Must be called with hlhdf_compoundtable_lock held.
+ * @param[in] descr the description
+ * @return the removed entry that should be released with \ref HLCompoundInternal_freeEntry or NULL
+ */
+static HLSharedCompound_t* HLCompoundInternal_unregister(HL_CompoundTypeDescription* descr)
+{
+  HLSharedCompound_t** pentry = &hlhdf_compoundtable[
+    HLCompoundInternal_bucket(descr->size, descr->nAttrs, descr->objno[0], descr->objno[1])];
+  while (*pentry != NULL) {
+    HLSharedCompound_t* entry = *pentry;
+    if (entry->descr == descr) {
+      *pentry = entry->next;
+      HLCOMPOUND_PRIVATE(descr)->registered = 0;
+      return entry;
+    }
+    pentry = &entry->next;
+  }
+  return NULL;
+}
+
+/**
+ * Releases an entry that has been removed from the table.
+ * @param[in] entry the entry, may be NULL
+ */
+static void HLCompoundInternal_freeEntry(HLSharedCompound_t* entry)
+{
+  if (entry != NULL) {
+    if (H5Iis_valid(entry->typeId) > 0) {
+      HL_H5T_CLOSE(entry->typeId);
+    }
+    HLHDF_FREE(entry);
+  }
+}
 
 HL_CompoundTypeAttribute* newHL_CompoundTypeAttribute(char* attrname,
   size_t offset, const char* format, size_t size, int ndims, size_t* dims)
@@ -64,18 +164,22 @@ fail:
 
 HL_CompoundTypeDescription* newHL_CompoundTypeDescription(void)
 {
+   HLCompoundDescription_t* wrapper=NULL;
    HL_CompoundTypeDescription* retv=NULL;
    int i;
    HL_DEBUG0("ENTER: newHL_CompoundTypeDescription");
-   if(!(retv=(HL_CompoundTypeDescription*)HLHDF_MALLOC(sizeof(HL_CompoundTypeDescription)))) {
+   if(!(wrapper=(HLCompoundDescription_t*)HLHDF_MALLOC(sizeof(HLCompoundDescription_t)))) {
       HL_ERROR0("Failed to allocate memory for CompoundTypeDescription");
       return NULL;
    }
+   wrapper->refCount=1;
+   wrapper->registered=0;
+   retv=&wrapper->descr;
    strcpy(retv->hltypename,"");
    retv->size=0;
    if(!(retv->attrs = (HL_CompoundTypeAttribute **)HLHDF_MALLOC(sizeof(HL_CompoundTypeAttribute*)*DEFAULT_SIZE_NODELIST))) {
       HL_ERROR0("Failed to allocate memory for CompoundTypeDescription list");
-      HLHDF_FREE(retv);
+      HLHDF_FREE(wrapper);
       return NULL;
    }
    for(i=0;i<DEFAULT_SIZE_NODELIST;i++) {
@@ -99,12 +203,26 @@ void freeHL_CompoundTypeAttribute(HL_CompoundTypeAttribute* attr)
 
 void freeHL_CompoundTypeDescription(HL_CompoundTypeDescription* typelist)
 {
+  HLSharedCompound_t* entry = NULL;
+  HLCompoundDescription_t* wrapper = NULL;
   int i;
   if (!typelist)
     return;
 
   HL_SPEWDEBUG0("ENTER: freeHL_CompoundTypeDescription");
 
+  /* The last reference is dropped and the description unregistered in one step so that
+   * HLCompoundPrivate_findShared never returns a description that is being released */
+  pthread_mutex_lock(&hlhdf_compoundtable_lock);
+  if (HL_ATOMIC_SUB(HLCOMPOUND_PRIVATE(typelist)->refCount, 1) > 0) {
+    pthread_mutex_unlock(&hlhdf_compoundtable_lock);
+    HL_SPEWDEBUG0("EXIT: freeHL_CompoundTypeDescription");
+    return;
+  }
+  entry = HLCompoundInternal_unregister(typelist);
+  pthread_mutex_unlock(&hlhdf_compoundtable_lock);
+  HLCompoundInternal_freeEntry(entry);
+
   if (typelist->attrs) {
     for (i = 0; i < typelist->nAttrs; i++) {
       if (typelist->attrs[i])
@@ -112,7 +230,8 @@ void freeHL_CompoundTypeDescription(HL_CompoundTypeDescription* typelist)
     }
     HLHDF_FREE(typelist->attrs);
   }
-  HLHDF_FREE(typelist);
+  wrapper = HLCOMPOUND_PRIVATE(typelist);
+  HLHDF_FREE(wrapper);
 
   HL_SPEWDEBUG0("EXIT: freeHL_CompoundTypeDescription");
 }
@@ -193,3 +312,108 @@ fail:
   freeHL_CompoundTypeDescription(retv);
   return NULL;
 }
+
+const HL_CompoundTypeAttribute* findHL_CompoundTypeAttribute(const HL_CompoundTypeDescription* descr,
+  const char* attrname)
+{
+  int i;
+  if (descr == NULL || attrname == NULL) {
+    return NULL;
+  }
+  for (i = 0; i < descr->nAttrs; i++) {
+    if (strcmp(descr->attrs[i]->attrname, attrname) == 0) {
+      return descr->attrs[i];
+    }
+  }
+  return NULL;
+}
+
+HL_CompoundTypeDescription* HLCompoundPrivate_ref(HL_CompoundTypeDescription* descr)
+{
+  if (descr != NULL) {
+    HL_ATOMIC_ADD(HLCOMPOUND_PRIVATE(descr)->refCount, 1);
+  }
+  return descr;
+}
+
+int HLCompoundPrivate_isShared(HL_CompoundTypeDescription* descr)
+{
+  int shared = 0;
+  HL_ASSERT((descr != NULL), "HLCompoundPrivate_isShared called with descr == NULL");
+  pthread_mutex_lock(&hlhdf_compoundtable_lock);
+  shared = (HLCOMPOUND_PRIVATE(descr)->refCount > 1 || HLCOMPOUND_PRIVATE(descr)->registered);
+  pthread_mutex_unlock(&hlhdf_compoundtable_lock);
+  return shared;
+}
+
+HL_CompoundTypeDescription* HLCompoundPrivate_findShared(hid_t mtype,
+  unsigned long objno0, unsigned long objno1)
+{
+  HLSharedCompound_t* entry = NULL;
+  HLSharedCompound_t candidates[HLHDF_COMPOUNDTABLE_CANDIDATES];
+  HL_CompoundTypeDescription* retv = NULL;
+  size_t size = H5Tget_size(mtype);
+  int nmembers = H5Tget_nmembers(mtype);
+  int ncandidates = 0, i = 0;
+  if (nmembers < 0) {
+    return NULL;
+  }
+
+  /* Collect and reference the possible matches under the lock, the types are compared
+   * afterwards. A referenced description stays registered so its type remains open. */
+  pthread_mutex_lock(&hlhdf_compoundtable_lock);
+  entry = hlhdf_compoundtable[HLCompoundInternal_bucket(size, nmembers, objno0, objno1)];
+  for (; entry != NULL && ncandidates < HLHDF_COMPOUNDTABLE_CANDIDATES; entry = entry->next) {
+    HL_CompoundTypeDescription* descr = entry->descr;
+    if (descr->objno[0] == objno0 && descr->objno[1] == objno1 &&
+        descr->nAttrs == nmembers && descr->size == size) {
+      candidates[ncandidates].typeId = entry->typeId;
+      candidates[ncandidates].descr = HLCompoundPrivate_ref(descr);
+      ncandidates++;
+    }
+  }
+  pthread_mutex_unlock(&hlhdf_compoundtable_lock);
+
+  for (i = 0; i < ncandidates; i++) {
+    if (retv == NULL && H5Tequal(candidates[i].typeId, mtype) > 0) {
+      retv = candidates[i].descr;
+    } else {
+      freeHL_CompoundTypeDescription(candidates[i].descr);
+    }
+  }
+  return retv;
+}
+
+int HLCompoundPrivate_registerShared(hid_t mtype, HL_CompoundTypeDescription* descr)
+{
+  HLSharedCompound_t* entry = NULL;
+  unsigned int bucket = 0;
+  HL_ASSERT((descr != NULL), "HLCompoundPrivate_registerShared called with descr == NULL");
+
+  if ((entry = (HLSharedCompound_t*)HLHDF_MALLOC(sizeof(HLSharedCompound_t))) == NULL) {
+    HL_ERROR0("Failed to allocate shared compound entry");
+    return 0;
+  }
+  if ((entry->typeId = H5Tcopy(mtype)) < 0) {
+    HL_ERROR0("Failed to copy compound type");
+    HLHDF_FREE(entry);
+    return 0;
+  }
+  entry->descr = descr;
+  bucket = HLCompoundInternal_bucket(descr->size, descr->nAttrs, descr->objno[0], descr->objno[1]);
+  pthread_mutex_lock(&hlhdf_compoundtable_lock);
+  entry->next = hlhdf_compoundtable[bucket];
+  hlhdf_compoundtable[bucket] = entry;
+  HLCOMPOUND_PRIVATE(descr)->registered = 1;
+  pthread_mutex_unlock(&hlhdf_compoundtable_lock);
+  return 1;
+}
+
+size_t HLCompoundPrivate_getMemoryUsage(const HL_CompoundTypeDescription* descr)
+{
+  if (descr == NULL) {
+    return 0;
+  }
+  return sizeof(HLCompoundDescription_t) + descr->nAllocAttrs * sizeof(HL_CompoundTypeAttribute*) +
+         descr->nAttrs * sizeof(HL_CompoundTypeAttribute);
+}
@@ -28,14 +28,16 @@ along with HLHDF.  If not, see <http://www.gnu.org/licenses/>.
 #include "hlhdf_types.h"
 
 /**
- * Creates a compound type description list.
+ * Creates a compound type description list. Descriptions must always be created with
+ * this function since the library keeps a reference count next to the description.
  * @ingroup hlhdf_c_apis
  * @return the compound type descriptor on success, otherwise NULL.
  */
 HL_CompoundTypeDescription* newHL_CompoundTypeDescription(void);
 
 /**
- * Frees the compound type, including all members.
+ * Frees the compound type, including all members. A description that is shared between
+ * nodes is released when the last holder frees it.
  * @ingroup hlhdf_c_apis
  * @param[in] typelist the descriptor that should be deleted.
  */
@@ -84,4 +86,13 @@ int addHL_CompoundTypeAttribute(HL_CompoundTypeDescription* typelist,
  */
 HL_CompoundTypeDescription* copyHL_CompoundTypeDescription(HL_CompoundTypeDescription* descr);
 
+/**
+ * Locates a member in the compound type descriptor.
+ * @ingroup hlhdf_c_apis
+ * @param[in] descr the descriptor
+ * @param[in] attrname the name of the member
+ * @return the member (<b>internal memory, do not release</b>) or NULL if there is no such member
+ */
+const HL_CompoundTypeAttribute* findHL_CompoundTypeAttribute(const HL_CompoundTypeDescription* descr, const char* attrname);
+
 #endif
@@ -0,0 +1,71 @@
+/* --------------------------------------------------------------------
+Copyright (C) 2026 Swedish Meteorological and Hydrological Institute, SMHI,
+
+This file is part of HLHDF.
+
+HLHDF is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+HLHDF is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with HLHDF.  If not, see <http://www.gnu.org/licenses/>.
+------------------------------------------------------------------------*/
+
+/**
+ * Private functions for sharing compound type descriptions between nodes.
+ * @file
+ * @date 2026-10-19
+ */
+#ifndef HLHDF_COMPOUND_PRIVATE_H
+#define HLHDF_COMPOUND_PRIVATE_H
+#include "hlhdf.h"
+
+/**
+ * Increases the reference count of a description. The description is released
+ * when \ref freeHL_CompoundTypeDescription has been called once for every reference.
+ * @param[in] descr the description, may be NULL
+ * @return the description
+ */
+HL_CompoundTypeDescription* HLCompoundPrivate_ref(HL_CompoundTypeDescription* descr);
+
+/**
+ * Returns if a description is held by more than one holder or can be found by
+ * \ref HLCompoundPrivate_findShared, i.e. if it must be copied before it is modified.
+ * @param[in] descr the description
+ * @return 1 if the description is shared, otherwise 0
+ */
+int HLCompoundPrivate_isShared(HL_CompoundTypeDescription* descr);
+
+/**
+ * Looks up a shared description for a native compound type.
+ * @param[in] mtype the native compound type
+ * @param[in] objno0 first part of the committed type object number, 0 if not committed
+ * @param[in] objno1 second part of the committed type object number, 0 if not committed
+ * @return a new reference to the shared description or NULL if there is none
+ */
+HL_CompoundTypeDescription* HLCompoundPrivate_findShared(hid_t mtype, unsigned long objno0, unsigned long objno1);
+
+/**
+ * Registers a description so that later lookups with an equal native type and the same
+ * object number gets the same description. The description is unregistered when it
+ * is released.
+ * @param[in] mtype the native compound type the description was built from
+ * @param[in] descr the description
+ * @return 1 on success, otherwise 0
+ */
+int HLCompoundPrivate_registerShared(hid_t mtype, HL_CompoundTypeDescription* descr);
+
+/**
+ * Returns the number of bytes held by a description.
+ * @param[in] descr the description
+ * @return the number of bytes
+ */
+size_t HLCompoundPrivate_getMemoryUsage(const HL_CompoundTypeDescription* descr);
+
+#endif /* HLHDF_COMPOUND_PRIVATE_H */
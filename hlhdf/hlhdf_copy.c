@@ -0,0 +1,586 @@
+/* --------------------------------------------------------------------
+Copyright (C) 2026 Swedish Meteorological and Hydrological Institute, SMHI,
+
+This file is part of HLHDF.
+
+HLHDF is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+HLHDF is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with HLHDF.  If not, see <http://www.gnu.org/licenses/>.
+------------------------------------------------------------------------*/
+
+
+/**
+ * Copying of nodes between files without decompressing the data.
+ * @file
+ * @date 2026-10-19
+ */
+#include "hlhdf.h"
+#include "hlhdf_alloc.h"
+#include "hlhdf_debug.h"
+#include "hlhdf_private.h"
+#include "hlhdf_defines_private.h"
+#include "hlhdf_counters_private.h"
+#include "hlhdf_trace_private.h"
+#include <stdlib.h>
+#include <string.h>
+
+/*@{ Private functions */
+/**
+ * Returns the location to use for a parent name as given by extractParentChildName.
+ * @param[in] parent the parent name, "" for the root group
+ * @return the location
+ */
+static const char* HLCopyInternal_location(const char* parent)
+{
+  return (parent[0] == '\0') ? "/" : parent;
+}
+
+/**
+ * Creates the groups in a path that does not exist yet.
+ * @param[in] file_id the file
+ * @param[in] path the path, "" for the root group
+ * @return 1 on success, otherwise 0
+ */
+static int HLCopyInternal_createGroups(hid_t file_id, const char* path)
+{
+  char* tmp = NULL;
+  char* p = NULL;
+  hid_t gid = -1;
+  htri_t exists;
+  int status = 0;
+
+  if (path[0] == '\0') {
+    return 1;
+  }
+  if ((tmp = HLHDF_STRDUP(path)) == NULL) {
+    HL_ERROR0("Failed to allocate memory for path");
+    return 0;
+  }
+  p = tmp;
+  do {
+    if ((p = strchr(p + 1, '/')) != NULL) {
+      *p = '\0';
+    }
+    if ((exists = H5Lexists(file_id, tmp, H5P_DEFAULT)) < 0) {
+      HL_ERROR1("Failed to check if '%s' exists", tmp);
+      goto fail;
+    }
+    if (!exists) {
+      if ((gid = H5Gcreate(file_id, tmp, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT)) < 0) {
+        HL_ERROR1("Failed to create group '%s'", tmp);
+        goto fail;
+      }
+      HL_H5G_CLOSE(gid);
+    }
+    if (p != NULL) {
+      *p = '/';
+    }
+  } while (p != NULL);
+
+  status = 1;
+fail:
+  HL_H5G_CLOSE(gid);
+  HLHDF_FREE(tmp);
+  return status;
+}
+
+/**
+ * Returns if values of a type holds pointers to memory allocated by HDF5 when read.
+ * @param[in] type the type
+ * @return 1 if the values must be reclaimed with H5Dvlen_reclaim, otherwise 0
+ */
+static int HLCopyInternal_isVariable(hid_t type)
+{
+  return (H5Tdetect_class(type, H5T_VLEN) > 0 || H5Tis_variable_str(type) > 0);
+}
+
+/**
+ * Copies a group. The group may already exist if it has been created as parent
+ * to an earlier node.
+ * @param[in] src the source file
+ * @param[in] dst the destination file
+ * @param[in] name the name of the group
+ * @return 1 on success, otherwise 0
+ */
+static int HLCopyInternal_group(hid_t src, hid_t dst, const char* name)
+{
+  hid_t sid = -1, did = -1, gcpl = -1;
+  htri_t exists;
+  int status = 0;
+
+  if ((exists = H5Lexists(dst, name, H5P_DEFAULT)) < 0) {
+    HL_ERROR1("Failed to check if '%s' exists", name);
+    goto fail;
+  }
+  if (exists) {
+    return 1;
+  }
+  if ((sid = H5Gopen(src, name, H5P_DEFAULT)) < 0) {
+    HL_ERROR1("Failed to open group '%s'", name);
+    goto fail;
+  }
+  HL_STATS_INC(objectsOpened);
+  if ((gcpl = H5Gget_create_plist(sid)) < 0) {
+    HL_ERROR1("Failed to get creation properties of group '%s'", name);
+    goto fail;
+  }
+  if ((did = H5Gcreate(dst, name, H5P_DEFAULT, gcpl, H5P_DEFAULT)) < 0) {
+    HL_ERROR1("Failed to create group '%s'", name);
+    goto fail;
+  }
+  status = 1;
+fail:
+  HL_H5P_CLOSE(gcpl);
+  HL_H5G_CLOSE(sid);
+  HL_H5G_CLOSE(did);
+  return status;
+}
+
+/**
+ * Copies an attribute as it is stored.
+ * @param[in] src the source file
+ * @param[in] dst the destination file
+ * @param[in] parent the name of the object the attribute belongs to
+ * @param[in] name the name of the attribute
+ * @return 1 on success, otherwise 0
+ */
+static int HLCopyInternal_attribute(hid_t src, hid_t dst, const char* parent, const char* name)
+{
+  hid_t sid = -1, did = -1, ftype = -1, type = -1, space = -1;
+  hssize_t npoints = 0;
+  size_t nbytes = 0;
+  unsigned char* buf = NULL;
+  int reclaim = 0, status = 0;
+
+  if ((sid = H5Aopen_by_name(src, HLCopyInternal_location(parent), name, H5P_DEFAULT, H5P_DEFAULT)) < 0) {
+    HL_ERROR2("Failed to open attribute '%s' of '%s'", name, parent);
+    goto fail;
+  }
+  HL_STATS_INC(objectsOpened);
+  if ((ftype = H5Aget_type(sid)) < 0 || (type = H5Tcopy(ftype)) < 0 ||
+      (space = H5Aget_space(sid)) < 0) {
+    HL_ERROR2("Failed to get type and space of attribute '%s' of '%s'", name, parent);
+    goto fail;
+  }
+  if ((npoints = H5Sget_simple_extent_npoints(space)) < 0) {
+    HL_ERROR2("Failed to get size of attribute '%s' of '%s'", name, parent);
+    goto fail;
+  }
+  nbytes = (size_t)npoints * H5Tget_size(type);
+  if (nbytes > 0) {
+    if ((buf = HLHDF_MALLOC(nbytes)) == NULL) {
+      HL_ERROR0("Failed to allocate memory for attribute");
+      goto fail;
+    }
+    if (H5Aread(sid, type, buf) < 0) {
+      HL_ERROR2("Failed to read attribute '%s' of '%s'", name, parent);
+      goto fail;
+    }
+    reclaim = HLCopyInternal_isVariable(type);
+  }
+  if ((did = H5Acreate_by_name(dst, HLCopyInternal_location(parent), name, type, space,
+                               H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT)) < 0) {
+    HL_ERROR2("Failed to create attribute '%s' of '%s'", name, parent);
+    goto fail;
+  }
+  if (buf != NULL && H5Awrite(did, type, buf) < 0) {
+    HL_ERROR2("Failed to write attribute '%s' of '%s'", name, parent);
+    goto fail;
+  }
+  HL_STATS_INC(attributesRead);
+  HL_STATS_INC(attributesWritten);
+  HL_STATS_ADD(bytesRead, nbytes);
+  HL_STATS_ADD(rawBytesRead, H5Aget_storage_size(sid));
+  HL_STATS_ADD(bytesWritten, nbytes);
+  HL_STATS_ADD(rawBytesWritten, H5Aget_storage_size(did));
+  status = 1;
+fail:
+  if (reclaim) {
+    H5Dvlen_reclaim(type, space, H5P_DEFAULT, buf);
+  }
+  HLHDF_FREE(buf);
+  HL_H5A_CLOSE(sid);
+  HL_H5A_CLOSE(did);
+  HL_H5S_CLOSE(space);
+  HL_H5T_CLOSE(type);
+  HL_H5T_CLOSE(ftype);
+  return status;
+}
+
+/**
+ * Copies a reference attribute. The referenced object must already have been copied.
+ * @param[in] src the source file
+ * @param[in] dst the destination file
+ * @param[in] parent the name of the object the attribute belongs to
+ * @param[in] name the name of the attribute
+ * @return 1 on success, otherwise 0
+ */
+static int HLCopyInternal_reference(hid_t src, hid_t dst, const char* parent, const char* name)
+{
+  hid_t sid = -1, did = -1, space = -1;
+  hobj_ref_t ref;
+  ssize_t len = 0;
+  char* target = NULL;
+  int status = 0;
+
+  if ((sid = H5Aopen_by_name(src, HLCopyInternal_location(parent), name, H5P_DEFAULT, H5P_DEFAULT)) < 0) {
+    HL_ERROR2("Failed to open reference '%s' of '%s'", name, parent);
+    goto fail;
+  }
+  HL_STATS_INC(objectsOpened);
+  if (H5Aread(sid, H5T_STD_REF_OBJ, &ref) < 0) {
+    HL_ERROR2("Failed to read reference '%s' of '%s'", name, parent);
+    goto fail;
+  }
+  if ((len = H5Rget_name(src, H5R_OBJECT, &ref, NULL, 0)) <= 0) {
+    HL_ERROR2("Failed to locate the object referenced by '%s' of '%s'", name, parent);
+    goto fail;
+  }
+  if ((target = HLHDF_MALLOC(len + 1)) == NULL) {
+    HL_ERROR0("Failed to allocate memory for reference name");
+    goto fail;
+  }
+  H5Rget_name(src, H5R_OBJECT, &ref, target, len + 1);
+  if (H5Rcreate(&ref, dst, target, H5R_OBJECT, -1) < 0) {
+    HL_ERROR3("Failed to create reference '%s' of '%s', '%s' has not been copied", name, parent, target);
+    goto fail;
+  }
+  if ((space = H5Screate(H5S_SCALAR)) < 0 ||
+      (did = H5Acreate_by_name(dst, HLCopyInternal_location(parent), name, H5T_STD_REF_OBJ, space,
+                               H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT)) < 0) {
+    HL_ERROR2("Failed to create reference '%s' of '%s'", name, parent);
+    goto fail;
+  }
+  if (H5Awrite(did, H5T_STD_REF_OBJ, &ref) < 0) {
+    HL_ERROR2("Failed to write reference '%s' of '%s'", name, parent);
+    goto fail;
+  }
+  HL_STATS_INC(attributesRead);
+  HL_STATS_INC(attributesWritten);
+  status = 1;
+fail:
+  HLHDF_FREE(target);
+  HL_H5A_CLOSE(sid);
+  HL_H5A_CLOSE(did);
+  HL_H5S_CLOSE(space);
+  return status;
+}
+
+#if H5_VERSION_GE(1,10,2)
+/**
+ * Copies the allocated chunks of a chunked dataset as they are stored.
+ * H5Dread_chunk and H5Dwrite_chunk are available from HDF5 1.10.2, older
+ * versions copy chunked datasets with \ref HLCopyInternal_values instead.
+ * @param[in] sid the source dataset
+ * @param[in] did the destination dataset, with the same creation properties as the source
+ * @param[in] space the dataspace
+ * @param[in] dcpl the creation properties
+ * @return 1 on success, otherwise 0
+ */
+static int HLCopyInternal_chunks(hid_t sid, hid_t did, hid_t space, hid_t dcpl)
+{
+  hsize_t dims[H5S_MAX_RANK], chunk[H5S_MAX_RANK], offset[H5S_MAX_RANK];
+  hsize_t nbytes = 0, capacity = 0;
+  unsigned char* buf = NULL;
+  uint32_t filters = 0;
+  int rank, i, status = 0;
+
+  if ((rank = H5Sget_simple_extent_dims(space, dims, NULL)) < 0 ||
+      H5Pget_chunk(dcpl, rank, chunk) != rank) {
+    HL_ERROR0("Failed to get dimensions and chunk dimensions");
+    return 0;
+  }
+  for (i = 0; i < rank; i++) {
+    if (dims[i] == 0) {
+      return 1;
+    }
+    offset[i] = 0;
+  }
+
+  do {
+    if (H5Dget_chunk_storage_size(sid, offset, &nbytes) < 0) {
+      HL_ERROR0("Failed to get chunk size");
+      goto fail;
+    }
+    if (nbytes > 0) {
+      if (nbytes > capacity) {
+        HLHDF_FREE(buf);
+        if ((buf = HLHDF_MALLOC(nbytes)) == NULL) {
+          HL_ERROR0("Failed to allocate memory for chunk");
+          goto fail;
+        }
+        capacity = nbytes;
+      }
+      if (H5Dread_chunk(sid, H5P_DEFAULT, offset, &filters, buf) < 0) {
+        HL_ERROR0("Failed to read chunk");
+        goto fail;
+      }
+      if (H5Dwrite_chunk(did, H5P_DEFAULT, filters, offset, (size_t)nbytes, buf) < 0) {
+        HL_ERROR0("Failed to write chunk");
+        goto fail;
+      }
+    }
+    for (i = rank - 1; i >= 0; i--) {
+      offset[i] += chunk[i];
+      if (offset[i] < dims[i]) {
+        break;
+      }
+      offset[i] = 0;
+    }
+  } while (i >= 0);
+
+  status = 1;
+fail:
+  HLHDF_FREE(buf);
+  return status;
+}
+#endif
+
+/**
+ * Copies the data of a dataset without any type conversion. A chunked dataset is
+ * decompressed and compressed again by the filters of the destination.
+ * @param[in] sid the source dataset
+ * @param[in] did the destination dataset
+ * @param[in] type the type of both datasets
+ * @param[in] space the dataspace
+ * @return 1 on success, otherwise 0
+ */
+static int HLCopyInternal_values(hid_t sid, hid_t did, hid_t type, hid_t space)
+{
+  hssize_t npoints = H5Sget_simple_extent_npoints(space);
+  unsigned char* buf = NULL;
+  int reclaim = 0, status = 0;
+
+  if (npoints <= 0) {
+    return (npoints == 0);
+  }
+  if ((buf = HLHDF_MALLOC((size_t)npoints * H5Tget_size(type))) == NULL) {
+    HL_ERROR0("Failed to allocate memory for dataset");
+    goto fail;
+  }
+  if (H5Dread(sid, type, H5S_ALL, H5S_ALL, H5P_DEFAULT, buf) < 0) {
+    HL_ERROR0("Failed to read dataset");
+    goto fail;
+  }
+  reclaim = HLCopyInternal_isVariable(type);
+  if (H5Dwrite(did, type, H5S_ALL, H5S_ALL, H5P_DEFAULT, buf) < 0) {
+    HL_ERROR0("Failed to write dataset");
+    goto fail;
+  }
+  status = 1;
+fail:
+  if (reclaim) {
+    H5Dvlen_reclaim(type, space, H5P_DEFAULT, buf);
+  }
+  HLHDF_FREE(buf);
+  return status;
+}
+
+/**
+ * Copies a dataset with the same type, dimensions, layout and filters.
+ * @param[in] filename the destination filename, used when tracing
+ * @param[in] src the source file
+ * @param[in] dst the destination file
+ * @param[in] name the name of the dataset
+ * @param[in] values 0 if only the dataset should be created, otherwise the values are copied as well
+ * @return 1 on success, otherwise 0
+ */
+static int HLCopyInternal_dataset(const char* filename, hid_t src, hid_t dst, const char* name, int values)
+{
+  hid_t sid = -1, did = -1, ftype = -1, type = -1, space = -1, dcpl = -1;
+  hsize_t rawBytes = 0;
+  int traced = HL_TRACE_ENABLED(), status = 0;
+  HL_TraceEvent event;
+
+  if (traced) {
+    HLTracePrivate_begin(&event, HL_TRACE_WRITE, filename, name);
+  }
+  if ((sid = H5Dopen(src, name, H5P_DEFAULT)) < 0) {
+    HL_ERROR1("Failed to open dataset '%s'", name);
+    goto fail;
+  }
+  HL_STATS_INC(objectsOpened);
+  if ((ftype = H5Dget_type(sid)) < 0 || (type = H5Tcopy(ftype)) < 0 ||
+      (space = H5Dget_space(sid)) < 0 || (dcpl = H5Dget_create_plist(sid)) < 0) {
+    HL_ERROR1("Failed to get type, space and creation properties of dataset '%s'", name);
+    goto fail;
+  }
+  if (H5Tdetect_class(type, H5T_REFERENCE) > 0) {
+    HL_ERROR1("Dataset '%s' contains references and can not be copied", name);
+    goto fail;
+  }
+  if ((did = H5Dcreate(dst, name, type, space, H5P_DEFAULT, dcpl, H5P_DEFAULT)) < 0) {
+    HL_ERROR1("Failed to create dataset '%s'", name);
+    goto fail;
+  }
+  if (values) {
+#if H5_VERSION_GE(1,10,2)
+    if (H5Pget_layout(dcpl) == H5D_CHUNKED) {
+      if (!HLCopyInternal_chunks(sid, did, space, dcpl)) {
+        HL_ERROR1("Failed to copy the chunks of dataset '%s'", name);
+        goto fail;
+      }
+    } else
+#endif
+    if (!HLCopyInternal_values(sid, did, type, space)) {
+      HL_ERROR1("Failed to copy the values of dataset '%s'", name);
+      goto fail;
+    }
+    rawBytes = H5Dget_storage_size(did);
+    HL_STATS_INC(datasetsRead);
+    HL_STATS_INC(datasetsWritten);
+    HL_STATS_ADD(rawBytesRead, rawBytes);
+    HL_STATS_ADD(rawBytesWritten, rawBytes);
+  }
+  status = 1;
+fail:
+  if (traced) {
+    if (did >= 0) {
+      HLTracePrivate_setFilters(&event, did);
+    }
+    if (values && space >= 0 && type >= 0) {
+      event.bytes = (unsigned long long)H5Sget_simple_extent_npoints(space) * H5Tget_size(type);
+    }
+    event.rawBytes = rawBytes;
+    HLTracePrivate_end(&event, status);
+  }
+  HL_H5P_CLOSE(dcpl);
+  HL_H5S_CLOSE(space);
+  HL_H5T_CLOSE(type);
+  HL_H5T_CLOSE(ftype);
+  HL_H5D_CLOSE(sid);
+  HL_H5D_CLOSE(did);
+  return status;
+}
+
+/**
+ * Copies one selected node.
+ * @param[in] nodelist the nodelist
+ * @param[in] node the node
+ * @param[in] filename the destination filename
+ * @param[in] src the source file
+ * @param[in] dst the destination file
+ * @return 1 on success, otherwise 0
+ */
+static int HLCopyInternal_node(HL_NodeList* nodelist, HL_Node* node, const char* filename, hid_t src, hid_t dst)
+{
+  char* parentName = NULL;
+  char* childName = NULL;
+  HL_Node* parentNode = NULL;
+  const char* name = HLNode_getName(node);
+  int status = 0;
+
+  if (!extractParentChildName(node, &parentName, &childName)) {
+    HL_ERROR0("Failed to extract parent, child name");
+    goto fail;
+  }
+  if (parentName[0] != '\0') {
+    parentNode = HLNodeList_getNodeByName(nodelist, parentName);
+  }
+  if (parentNode == NULL || HLNode_getType(parentNode) == GROUP_ID) {
+    if (!HLCopyInternal_createGroups(dst, parentName)) {
+      goto fail;
+    }
+  }
+
+  switch (HLNode_getType(node)) {
+  case ATTRIBUTE_ID:
+    status = HLCopyInternal_attribute(src, dst, parentName, childName);
+    break;
+  case REFERENCE_ID:
+    status = HLCopyInternal_reference(src, dst, parentName, childName);
+    break;
+  case GROUP_ID:
+    status = HLCopyInternal_group(src, dst, name);
+    break;
+  case DATASET_ID:
+    status = HLCopyInternal_dataset(filename, src, dst, name, HLNode_getMark(node) != NMARK_SELECTMETA);
+    break;
+  case TYPE_ID:
+    if (H5Ocopy(src, name, dst, name, H5P_DEFAULT, H5P_DEFAULT) < 0) {
+      HL_ERROR1("Failed to copy type '%s'", name);
+    } else {
+      status = 1;
+    }
+    break;
+  default:
+    HL_ERROR1("Unsupported node type for copy '%d'", HLNode_getType(node));
+    break;
+  }
+fail:
+  HLHDF_FREE(parentName);
+  HLHDF_FREE(childName);
+  return status;
+}
+
+/*@} End of Private functions */
+
+/*@{ Interface functions */
+int HLNodeList_copyMarkedNodes(HL_NodeList* nodelist, const char* filename, HL_FileCreationProperty* property)
+{
+  char* srcname = NULL;
+  hid_t src = -1, dst = -1;
+  int nNodes = 0, i, pass, status = 0;
+  double start = HLCountersPrivate_now();
+
+  HL_DEBUG0("ENTER: HLNodeList_copyMarkedNodes");
+  if (nodelist == NULL || filename == NULL) {
+    HL_ERROR0("Inparameters NULL");
+    goto fail;
+  }
+  if ((srcname = HLNodeList_getFileName(nodelist)) == NULL) {
+    HL_ERROR0("Could not get filename from nodelist");
+    goto fail;
+  }
+  if (strcmp(srcname, filename) == 0) {
+    HL_ERROR1("Can not copy nodes from '%s' into the same file", filename);
+    goto fail;
+  }
+  if ((nNodes = HLNodeList_getNumberOfNodes(nodelist)) < 0) {
+    HL_ERROR0("Failed to get number of nodes");
+    goto fail;
+  }
+  if ((src = openHlHdfFile(srcname, "r")) < 0) {
+    HL_ERROR1("Failed to open file %s", srcname);
+    goto fail;
+  }
+  if ((dst = createHlHdfFile(filename, property)) < 0) {
+    HL_ERROR1("Failed to create file %s", filename);
+    goto fail;
+  }
+
+  /* References are copied last so that the referenced objects exist */
+  for (pass = 0; pass < 2; pass++) {
+    for (i = 0; i < nNodes; i++) {
+      HL_Node* node = HLNodeList_getNodeByIndex(nodelist, i);
+      HL_NodeMark mark = HLNode_getMark(node);
+      if ((mark == NMARK_SELECT || mark == NMARK_SELECTMETA) &&
+          (HLNode_getType(node) == REFERENCE_ID) == (pass == 1)) {
+        if (!HLCopyInternal_node(nodelist, node, filename, src, dst)) {
+          HL_ERROR1("Failed to copy node '%s'", HLNode_getName(node));
+          goto fail;
+        }
+      }
+    }
+  }
+  H5Fflush(dst, H5F_SCOPE_LOCAL);
+  status = 1;
+fail:
+  HL_H5F_CLOSE(src);
+  HL_H5F_CLOSE(dst);
+  HLHDF_FREE(srcname);
+  HL_STATS_ADD_TIME(writeTime, start);
+  HL_DEBUG1("EXIT: HLNodeList_copyMarkedNodes with status = %d", status);
+  return status;
+}
+
+/*@} End of Interface functions */
@@ -0,0 +1,48 @@
+/* --------------------------------------------------------------------
+Copyright (C) 2026 Swedish Meteorological and Hydrological Institute, SMHI,
+
+This file is part of HLHDF.
+
+HLHDF is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+HLHDF is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with HLHDF.  If not, see <http://www.gnu.org/licenses/>.
+------------------------------------------------------------------------*/
+
+
+/**
+ * Copying of nodes between files without decompressing the data.
+ * @file
+ * @date 2026-10-19
+ */
+#ifndef HLHDF_COPY_H
+#define HLHDF_COPY_H
+#include "hlhdf_types.h"
+
+/**
+ * Copies the selected nodes of a nodelist that has been read from a file into a new file.
+ * Chunked datasets are copied chunk by chunk as they are stored, i.e. the data is never
+ * decompressed and compressed again, and they keep their chunking and filters. With HDF5
+ * versions before 1.10.2 the chunked datasets are read and written through their filters
+ * instead, which gives the same result but is slower. Other
+ * datasets and the attributes are copied as they are stored without any type conversion.
+ * Groups that are needed by the selected nodes but that have not been selected are created
+ * without attributes. Datasets that only has been selected for their metadata are not copied.
+ * The data of the nodes in the nodelist is neither used nor modified.
+ * @ingroup hlhdf_c_apis
+ * @param[in] nodelist the nodelist, must have been read from a file
+ * @param[in] filename the file to create, must not be the file the nodelist was read from
+ * @param[in] property the file creation properties, may be NULL
+ * @return 1 on success, otherwise 0
+ */
+int HLNodeList_copyMarkedNodes(HL_NodeList* nodelist, const char* filename, HL_FileCreationProperty* property);
+
+#endif /* HLHDF_COPY_H */
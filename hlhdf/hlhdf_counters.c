@@ -0,0 +1,73 @@
+/* --------------------------------------------------------------------
+Copyright (C) 2026 Swedish Meteorological and Hydrological Institute, SMHI,
+
+This file is part of HLHDF.
+
+HLHDF is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+HLHDF is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with HLHDF.  If not, see <http://www.gnu.org/licenses/>.
+------------------------------------------------------------------------*/
+
+/**
+ * Process wide operation counters and phase timings.
+ * @file
+ * @date 2026-10-19
+ */
+#include "hlhdf.h"
+#include "hlhdf_alloc.h"
+#include "hlhdf_debug.h"
+#include "hlhdf_counters_private.h"
+#include <string.h>
+#include <time.h>
+
+/**
+ * The counters.
+ */
+HL_Stats hlhdfStats;
+
+/*@{ Private functions */
+double HLCountersPrivate_now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+void HLCountersPrivate_addTime(double* timing, double start)
+{
+  double elapsed = HLCountersPrivate_now() - start;
+#if defined(__GNUC__)
+  double old = 0.0, value = 0.0;
+  __atomic_load(timing, &old, __ATOMIC_RELAXED);
+  do {
+    value = old + elapsed;
+  } while (!__atomic_compare_exchange(timing, &old, &value, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+#else
+  *timing += elapsed;
+#endif
+}
+/*@} End of Private functions */
+
+/*@{ Interface functions */
+void HL_getStats(HL_Stats* stats)
+{
+  HL_ASSERT((stats != NULL), "HL_getStats called with stats == NULL");
+  *stats = hlhdfStats;
+  stats->allocations = hlhdf_alloc_count;
+}
+
+void HL_resetStats(void)
+{
+  memset(&hlhdfStats, 0, sizeof(HL_Stats));
+  hlhdf_alloc_count = 0;
+}
+/*@} End of Interface functions */
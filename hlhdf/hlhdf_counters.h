@@ -0,0 +1,43 @@
+/* --------------------------------------------------------------------
+Copyright (C) 2026 Swedish Meteorological and Hydrological Institute, SMHI,
+
+This file is part of HLHDF.
+
+HLHDF is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+HLHDF is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with HLHDF.  If not, see <http://www.gnu.org/licenses/>.
+------------------------------------------------------------------------*/
+
+/**
+ * Process wide operation counters and phase timings. The counters are always
+ * collected, updating them is a few additions per node.
+ * @file
+ * @date 2026-10-19
+ */
+#ifndef HLHDF_COUNTERS_H
+#define HLHDF_COUNTERS_H
+#include "hlhdf_types.h"
+
+/**
+ * Returns the current counters.
+ * @ingroup hlhdf_c_apis
+ * @param[out] stats the counters, will be overwritten
+ */
+void HL_getStats(HL_Stats* stats);
+
+/**
+ * Sets all counters and timings to 0.
+ * @ingroup hlhdf_c_apis
+ */
+void HL_resetStats(void);
+
+#endif /* HLHDF_COUNTERS_H */
@@ -0,0 +1,80 @@
+/* --------------------------------------------------------------------
+Copyright (C) 2026 Swedish Meteorological and Hydrological Institute, SMHI,
+
+This file is part of HLHDF.
+
+HLHDF is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+HLHDF is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with HLHDF.  If not, see <http://www.gnu.org/licenses/>.
+------------------------------------------------------------------------*/
+
+/**
+ * Private macros for updating the operation counters.
+ * @file
+ * @date 2026-10-19
+ */
+#ifndef HLHDF_COUNTERS_PRIVATE_H
+#define HLHDF_COUNTERS_PRIVATE_H
+#include "hlhdf_types.h"
+
+/**
+ * The process wide counters, allocations are kept in hlhdf_alloc_count.
+ */
+extern HL_Stats hlhdfStats;
+
+/**
+ * Increases a counter by one. The counters may be updated from background threads
+ * so the update is atomic, but without ordering since nothing depends on them.
+ */
+#if defined(__GNUC__)
+#define HL_STATS_INC(field) __atomic_fetch_add(&hlhdfStats.field, 1, __ATOMIC_RELAXED)
+#else
+#define HL_STATS_INC(field) (hlhdfStats.field++)
+#endif
+
+/**
+ * Adds n to a counter.
+ */
+#if defined(__GNUC__)
+#define HL_STATS_ADD(field, n) __atomic_fetch_add(&hlhdfStats.field, (n), __ATOMIC_RELAXED)
+#else
+#define HL_STATS_ADD(field, n) (hlhdfStats.field += (n))
+#endif
+
+/**
+ * Reads a counter that may be updated by a background thread at the same time.
+ */
+#if defined(__GNUC__)
+#define HL_STATS_GET(field) __atomic_load_n(&hlhdfStats.field, __ATOMIC_RELAXED)
+#else
+#define HL_STATS_GET(field) (hlhdfStats.field)
+#endif
+
+/**
+ * Adds the time since start, as returned by \ref HLCountersPrivate_now, to a timing.
+ */
+#define HL_STATS_ADD_TIME(field, start) HLCountersPrivate_addTime(&hlhdfStats.field, start)
+
+/**
+ * Returns the time in seconds from a monotonic clock.
+ * @return the time
+ */
+double HLCountersPrivate_now(void);
+
+/**
+ * Atomically adds the time since start to a timing.
+ * @param[in] timing the timing
+ * @param[in] start the start time as returned by \ref HLCountersPrivate_now
+ */
+void HLCountersPrivate_addTime(double* timing, double start);
+
+#endif /* HLHDF_COUNTERS_PRIVATE_H */
@@ -24,6 +24,8 @@ along with HLHDF.  If not, see <http://www.gnu.org/licenses/>.
 #include <string.h>
 #include <stdarg.h>
 #include <stdlib.h>
+#include <pthread.h>
+#include <sched.h>
 
 hlhdf_debug_struct hlhdfDbg;
 static int initialized = 0;
@@ -32,67 +34,258 @@ static int initialized = 0;
 static void setLogTime(char* strtime, int len)
 {
   time_t cur_time;
-  struct tm* tu_time;
+  struct tm tu_time;
 
   time(&cur_time);
-  tu_time = gmtime(&cur_time);
-  strftime(strtime, len, "%Y/%m/%d %H:%M:%S", tu_time);
+  gmtime_r(&cur_time, &tu_time);
+  strftime(strtime, len, "%Y/%m/%d %H:%M:%S", &tu_time);
 }
 
-static void HL_DefaultDebugFunction(char* filename, int lineno, HL_Debug lvl,
-  const char* fmt, ...)
+/**
+ * Formats a debug message the same way for the default function and the asynchronous sink.
+ * @return 0 if the message should not be printed, otherwise 1
+ */
+static int HLDebugInternal_format(char* buf, size_t len, char* filename, int lineno, HL_Debug lvl,
+  const char* fmt, va_list alist)
 {
   char msgbuff[512];
   char dbgtype[20];
   char strtime[24];
-  char infobuff[120];
 
+  if (hlhdfDbg.dbgLevel == HLHDF_SILENT || lvl < hlhdfDbg.dbgLevel) {
+    return 0;
+  }
+
+  setLogTime(strtime, 24);
+
+  switch (lvl) {
+  case HLHDF_SPEWDEBUG:
+    snprintf(dbgtype, 20, "SDEBUG");
+    break;
+  case HLHDF_DEBUG:
+    snprintf(dbgtype, 20, "DEBUG");
+    break;
+  case HLHDF_DEPRECATED:
+    snprintf(dbgtype, 20, "DEPRECATED");
+    break;
+  case HLHDF_INFO:
+    snprintf(dbgtype, 20, "INFO");
+    break;
+  case HLHDF_WARNING:
+    snprintf(dbgtype, 20, "WARNING");
+    break;
+  case HLHDF_ERROR:
+    snprintf(dbgtype, 20, "ERROR");
+    break;
+  case HLHDF_CRITICAL:
+    snprintf(dbgtype, 20, "CRITICAL");
+    break;
+  default:
+    snprintf(dbgtype, 20, "UNKNOWN");
+    break;
+  }
+  vsnprintf(msgbuff, 512, fmt, alist);
+  snprintf(buf, len, "%20s : %11s : %s (%s:%d)\n", strtime, dbgtype, msgbuff, filename, lineno);
+  return 1;
+}
+
+static void HL_DefaultDebugFunction(char* filename, int lineno, HL_Debug lvl,
+  const char* fmt, ...)
+{
+  char buff[768];
+  int print = 0;
   va_list alist;
+
   va_start(alist,fmt);
+  print = HLDebugInternal_format(buff, sizeof(buff), filename, lineno, lvl, fmt, alist);
+  va_end(alist);
+#ifndef NO_HLHDF_PRINTF
+  if (print) {
+    fputs(buff, stderr);
+  }
+#endif
+}
 
-  if (hlhdfDbg.dbgLevel == HLHDF_SILENT) {
-    return;
+/**
+ * Size of one message in the asynchronous log buffer.
+ */
+#define HLHDF_LOG_MESSAGE_SIZE 768
+
+/**
+ * One slot in the asynchronous log buffer. The sequence tells if the slot is free
+ * for the producer at position sequence or holds the message at position sequence - 1.
+ */
+typedef struct {
+  size_t sequence; /**< accessed with __atomic builtins */
+  char message[HLHDF_LOG_MESSAGE_SIZE];
+} HLLogSlot_t;
+
+/**
+ * The asynchronous log buffer, a bounded multi producer queue drained by one thread.
+ * The fields marked atomic are only accessed with __atomic builtins.
+ */
+static struct {
+  HLLogSlot_t* slots;
+  size_t mask;
+  size_t enqueuePos;   /**< atomic, next position for the producers */
+  size_t dequeuePos;   /**< only used by the drain thread */
+  size_t dropped;      /**< atomic, messages dropped since last drain */
+  int running;         /**< atomic, if producers may use the buffer */
+  int producers;       /**< atomic, number of producers currently using the buffer */
+  int sleeping;        /**< atomic, if the drain thread waits for messages */
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+  pthread_t thread;
+  int atexitRegistered;
+} asyncLog = {NULL, 0, 0, 0, 0, 0, 0, 0, PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER};
+
+/**
+ * Wakes up the drain thread if it is waiting for messages.
+ */
+static void HLDebugInternal_wakeDrain(void)
+{
+  if (__atomic_load_n(&asyncLog.sleeping, __ATOMIC_SEQ_CST)) {
+    pthread_mutex_lock(&asyncLog.lock);
+    pthread_cond_signal(&asyncLog.cond);
+    pthread_mutex_unlock(&asyncLog.lock);
   }
+}
 
-  setLogTime(strtime, 24);
+static void HLDebugInternal_asyncDebugFunction(char* filename, int lineno, HL_Debug lvl,
+  const char* fmt, ...)
+{
+  char buff[HLHDF_LOG_MESSAGE_SIZE];
+  HLLogSlot_t* slot = NULL;
+  size_t pos = 0;
+  int print = 0;
+  va_list alist;
 
-  strcpy(dbgtype, "");
+  va_start(alist,fmt);
+  print = HLDebugInternal_format(buff, sizeof(buff), filename, lineno, lvl, fmt, alist);
+  va_end(alist);
+  if (!print) {
+    return;
+  }
 
-  if (lvl >= hlhdfDbg.dbgLevel) {
-    switch (lvl) {
-    case HLHDF_SPEWDEBUG:
-      snprintf(dbgtype, 20, "SDEBUG");
-      break;
-    case HLHDF_DEBUG:
-      snprintf(dbgtype, 20, "DEBUG");
-      break;
-    case HLHDF_DEPRECATED:
-      snprintf(dbgtype, 20, "DEPRECATED");
-      break;
-    case HLHDF_INFO:
-      snprintf(dbgtype, 20, "INFO");
-      break;
-    case HLHDF_WARNING:
-      snprintf(dbgtype, 20, "WARNING");
-      break;
-    case HLHDF_ERROR:
-      snprintf(dbgtype, 20, "ERROR");
-      break;
-    case HLHDF_CRITICAL:
-      snprintf(dbgtype, 20, "CRITICAL");
-      break;
-    default:
-      snprintf(dbgtype, 20, "UNKNOWN");
+  /* A caller may have picked up this function just before the logging was stopped. The
+   * buffer is only released when no producer is using it, otherwise print directly. */
+  __atomic_add_fetch(&asyncLog.producers, 1, __ATOMIC_SEQ_CST);
+  if (!__atomic_load_n(&asyncLog.running, __ATOMIC_SEQ_CST)) {
+    __atomic_sub_fetch(&asyncLog.producers, 1, __ATOMIC_SEQ_CST);
+#ifndef NO_HLHDF_PRINTF
+    fputs(buff, stderr);
+#endif
+    return;
+  }
+
+  pos = __atomic_load_n(&asyncLog.enqueuePos, __ATOMIC_RELAXED);
+  for (;;) {
+    size_t seq = 0;
+    slot = &asyncLog.slots[pos & asyncLog.mask];
+    seq = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+    if (seq == pos) {
+      if (__atomic_compare_exchange_n(&asyncLog.enqueuePos, &pos, pos + 1, 1,
+                                      __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        break;
+      }
+    } else if ((long)(seq - pos) < 0) {
+      __atomic_fetch_add(&asyncLog.dropped, 1, __ATOMIC_RELAXED);
+      slot = NULL;
       break;
+    } else {
+      pos = __atomic_load_n(&asyncLog.enqueuePos, __ATOMIC_RELAXED);
     }
-  } else {
-    return;
   }
-  snprintf(infobuff, 120, "%20s : %11s", strtime, dbgtype);
-  vsnprintf(msgbuff, 512, fmt, alist);
+  if (slot != NULL) {
+    memcpy(slot->message, buff, HLHDF_LOG_MESSAGE_SIZE);
+    __atomic_store_n(&slot->sequence, pos + 1, __ATOMIC_SEQ_CST);
+    HLDebugInternal_wakeDrain();
+  }
+  __atomic_sub_fetch(&asyncLog.producers, 1, __ATOMIC_SEQ_CST);
+}
+
+/**
+ * Returns if the next message is ready to be written.
+ */
+static int HLDebugInternal_ready(void)
+{
+  HLLogSlot_t* slot = &asyncLog.slots[asyncLog.dequeuePos & asyncLog.mask];
+  return __atomic_load_n(&slot->sequence, __ATOMIC_SEQ_CST) == asyncLog.dequeuePos + 1;
+}
+
+/**
+ * Writes all messages that are ready.
+ * @return the number of written messages
+ */
+static int HLDebugInternal_drain(void)
+{
+  int n = 0;
+  size_t dropped = 0;
+  while (HLDebugInternal_ready()) {
+    HLLogSlot_t* slot = &asyncLog.slots[asyncLog.dequeuePos & asyncLog.mask];
+#ifndef NO_HLHDF_PRINTF
+    fputs(slot->message, stderr);
+#endif
+    __atomic_store_n(&slot->sequence, asyncLog.dequeuePos + asyncLog.mask + 1, __ATOMIC_RELEASE);
+    asyncLog.dequeuePos++;
+    n++;
+  }
+  if ((dropped = __atomic_exchange_n(&asyncLog.dropped, 0, __ATOMIC_RELAXED)) > 0) {
 #ifndef NO_HLHDF_PRINTF
-  fprintf(stderr, "%s : %s (%s:%d)\n", infobuff, msgbuff, filename, lineno);
+    fprintf(stderr, "HLHDF: %lu log messages dropped\n", (unsigned long)dropped);
 #endif
+  }
+  return n;
+}
+
+/**
+ * Writes messages as they arrive. When the buffer is empty the thread waits on the
+ * condition variable, producers only take the lock to signal it when it is waiting.
+ */
+static void* HLDebugInternal_asyncThread(void* arg)
+{
+  while (__atomic_load_n(&asyncLog.running, __ATOMIC_SEQ_CST)) {
+    if (HLDebugInternal_drain() > 0) {
+      continue;
+    }
+    pthread_mutex_lock(&asyncLog.lock);
+    __atomic_store_n(&asyncLog.sleeping, 1, __ATOMIC_SEQ_CST);
+    if (!HLDebugInternal_ready() && __atomic_load_n(&asyncLog.running, __ATOMIC_SEQ_CST)) {
+      pthread_cond_wait(&asyncLog.cond, &asyncLog.lock);
+    }
+    __atomic_store_n(&asyncLog.sleeping, 0, __ATOMIC_SEQ_CST);
+    pthread_mutex_unlock(&asyncLog.lock);
+  }
+  /* Messages from producers that entered before the stop are still written */
+  while (__atomic_load_n(&asyncLog.producers, __ATOMIC_SEQ_CST) > 0) {
+    sched_yield();
+  }
+  HLDebugInternal_drain();
+  return NULL;
+}
+
+/**
+ * Messages below the debug level are filtered before the call when HLHDF knows
+ * that the function does the same check. Custom functions get all messages.
+ * The gate and the function are read by the logging macros without a lock.
+ */
+static void HLDebugInternal_updateGate(void)
+{
+  void (*dbgfun)(char*, int, HL_Debug, const char*, ...) = __atomic_load_n(&hlhdfDbg.dbgfun, __ATOMIC_RELAXED);
+  HL_Debug gate = HLHDF_SPEWDEBUG;
+  if (dbgfun == HL_DefaultDebugFunction || dbgfun == HLDebugInternal_asyncDebugFunction) {
+    gate = hlhdfDbg.dbgLevel;
+  }
+  __atomic_store_n(&hlhdfDbg.gateLevel, gate, __ATOMIC_RELAXED);
+}
+
+/**
+ * Replaces the debug function and updates the gate accordingly.
+ */
+static void HLDebugInternal_setFunction(void (*dbgfun)(char*, int, HL_Debug, const char*, ...))
+{
+  __atomic_store_n(&hlhdfDbg.dbgfun, dbgfun, __ATOMIC_RELEASE);
+  HLDebugInternal_updateGate();
 }
 
 static void HL_DefaultHdf5ErrorFunction(unsigned n, const H5E_error_t* rowmsg)
@@ -134,21 +327,81 @@ void HL_InitializeDebugger(void)
   if (initialized == 0) {
     initialized = 1;
     hlhdfDbg.dbgLevel = HLHDF_SILENT;
-    hlhdfDbg.dbgfun = HL_DefaultDebugFunction;
     hlhdfDbg.hdf5showerror = 1;
     hlhdfDbg.hdf5fun = HL_DefaultHdf5ErrorFunction;
+    HLDebugInternal_setFunction(HL_DefaultDebugFunction);
   }
 }
 
 void HL_setDebugLevel(HL_Debug lvl)
 {
   hlhdfDbg.dbgLevel = lvl;
+  HLDebugInternal_updateGate();
 }
 
 void HL_setDebugFunction(void(*dbgfun)(char* filename, int lineno,
   HL_Debug lvl, const char* fmt, ...))
 {
-  hlhdfDbg.dbgfun = dbgfun;
+  HLDebugInternal_setFunction(dbgfun);
+}
+
+int HL_startAsyncLogging(size_t nslots)
+{
+  size_t n = 1, i = 0;
+
+  if (asyncLog.slots != NULL) {
+    return 1;
+  }
+  while (n < nslots) {
+    n <<= 1;
+  }
+  if ((asyncLog.slots = malloc(n * sizeof(HLLogSlot_t))) == NULL) {
+    HL_ERROR0("Failed to allocate memory for log buffer");
+    return 0;
+  }
+  for (i = 0; i < n; i++) {
+    asyncLog.slots[i].sequence = i;
+  }
+  asyncLog.mask = n - 1;
+  asyncLog.enqueuePos = 0;
+  asyncLog.dequeuePos = 0;
+  asyncLog.dropped = 0;
+  asyncLog.sleeping = 0;
+  __atomic_store_n(&asyncLog.running, 1, __ATOMIC_SEQ_CST);
+  if (pthread_create(&asyncLog.thread, NULL, HLDebugInternal_asyncThread, NULL) != 0) {
+    HL_ERROR0("Failed to start log thread");
+    __atomic_store_n(&asyncLog.running, 0, __ATOMIC_SEQ_CST);
+    free(asyncLog.slots);
+    asyncLog.slots = NULL;
+    return 0;
+  }
+  if (!asyncLog.atexitRegistered) {
+    asyncLog.atexitRegistered = 1;
+    atexit(HL_stopAsyncLogging);
+  }
+  HLDebugInternal_setFunction(HLDebugInternal_asyncDebugFunction);
+  return 1;
+}
+
+void HL_stopAsyncLogging(void)
+{
+  if (asyncLog.slots == NULL) {
+    return;
+  }
+  HLDebugInternal_setFunction(HL_DefaultDebugFunction);
+
+  /* Producers that already called the async function either see that the logging
+   * is stopped or are waited for before the buffer is released */
+  __atomic_store_n(&asyncLog.running, 0, __ATOMIC_SEQ_CST);
+  while (__atomic_load_n(&asyncLog.producers, __ATOMIC_SEQ_CST) > 0) {
+    sched_yield();
+  }
+  pthread_mutex_lock(&asyncLog.lock);
+  pthread_cond_signal(&asyncLog.cond);
+  pthread_mutex_unlock(&asyncLog.lock);
+  pthread_join(asyncLog.thread, NULL);
+  free(asyncLog.slots);
+  asyncLog.slots = NULL;
 }
 
 void HL_disableHdf5ErrorReporting(void)
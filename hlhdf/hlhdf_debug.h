@@ -28,6 +28,7 @@ along with HLHDF.  If not, see <http://www.gnu.org/licenses/>.
 #define HLHDF_DEBUG_H
 
 #include <H5Epublic.h>
+#include <stddef.h>
 
 /**
  * Debug levels. The levels are defined so that if HLHDF_INFO debug level is turned on,
@@ -50,6 +51,7 @@ typedef enum HL_Debug {
  */
 typedef struct {
    HL_Debug dbgLevel; /**< Debug level */
+   HL_Debug gateLevel; /**< Messages below this level are not passed to dbgfun, see \ref HL_DEBUG_ENABLED */
    void (*dbgfun)(char* filename, int lineno, HL_Debug lvl, const char* fmt,...); /**< Debug function */
    int hdf5showerror; /**< If hdf5 errors should be printed or not */
    void (*hdf5fun)(unsigned n, const H5E_error_t* rowmsg); /**< the HDF5 error reporting function */
@@ -87,6 +89,26 @@ void HL_setDebugLevel(HL_Debug lvl);
  */
 void HL_setDebugFunction(void (*dbgfun)(char* filename, int lineno, HL_Debug lvl, const char* fmt, ...));
 
+/**
+ * Routes the debug printouts through a lock-free ring buffer that is written to
+ * stderr by a background thread, so that threads logging at the same time do not
+ * wait for each other or for the terminal. Messages are dropped, and the number of
+ * dropped messages reported, if the buffer is full. Replaces the debug function,
+ * the default function is restored by \ref HL_stopAsyncLogging.
+ * @ingroup hlhdf_c_apis
+ * @param[in] nslots the number of messages the buffer can hold, rounded up to a power of 2
+ * @return 1 on success, otherwise 0
+ */
+int HL_startAsyncLogging(size_t nslots);
+
+/**
+ * Writes all buffered messages, stops the background thread and restores the
+ * default debug function. Threads that are logging at the same time are waited
+ * for before the buffer is released. Done automatically when the process exits.
+ * @ingroup hlhdf_c_apis
+ */
+void HL_stopAsyncLogging(void);
+
 /**
  * Sets the HDF5 error reporting function.
  * @ingroup hlhdf_c_apis
@@ -118,250 +140,171 @@ herr_t HL_hdf5_debug_function(hid_t estack, void *inv);
  * @defgroup DebugMacros Macros for debugging and error reporting that is used in HLHDF.
  */
 /*@{*/
-#ifdef DEBUG_HLHDF
 /**
- * Spewdebug macro taking one text string.
+ * The lowest level that is compiled into HLHDF, messages with a lower level are
+ * removed by the compiler. Defaults to HLHDF_SPEWDEBUG when DEBUG_HLHDF is defined
+ * and to HLHDF_INFO otherwise. Can be set with -DHLHDF_MIN_DEBUG_LEVEL=&lt;level&gt;.
  */
-#define HL_SPEWDEBUG0(msg) \
-hlhdfDbg.dbgfun(__FILE__,__LINE__,HLHDF_SPEWDEBUG,msg)
+#ifndef HLHDF_MIN_DEBUG_LEVEL
+#ifdef DEBUG_HLHDF
+#define HLHDF_MIN_DEBUG_LEVEL 0
+#else
+#define HLHDF_MIN_DEBUG_LEVEL 3
+#endif
+#endif
 
 /**
- * Spewdebug macro taking one text string and one formatter argument.
+ * If a message of level lvl should be passed on to the debug function. Checked
+ * inline so that a message that is not wanted costs a comparison instead of a call.
  */
-#define HL_SPEWDEBUG1(msg,arg1) \
-hlhdfDbg.dbgfun(__FILE__,__LINE__,HLHDF_SPEWDEBUG,msg,arg1)
-
-#define HL_SPEWDEBUG2(msg,arg1,arg2) \
-hlhdfDbg.dbgfun(__FILE__,__LINE__,HLHDF_SPEWDEBUG,msg,arg1,arg2)
-
-#define HL_SPEWDEBUG3(msg,arg1,arg2,arg3) \
-hlhdfDbg.dbgfun(__FILE__,__LINE__,HLHDF_SPEWDEBUG,msg,arg1,arg2,arg3)
-
-#define HL_SPEWDEBUG4(msg,arg1,arg2,arg3,arg4) \
-hlhdfDbg.dbgfun(__FILE__,__LINE__,HLHDF_SPEWDEBUG,msg,arg1,arg2,arg3,arg4)
-
-#define HL_DEBUG0(msg) \
-hlhdfDbg.dbgfun(__FILE__,__LINE__,HLHDF_DEBUG,msg)
-
-#define HL_DEBUG1(msg,arg1) \
-hlhdfDbg.dbgfun(__FILE__,__LINE__,HLHDF_DEBUG,msg,arg1)
-
-#define HL_DEBUG2(msg,arg1,arg2) \
-hlhdfDbg.dbgfun(__FILE__,__LINE__,HLHDF_DEBUG,msg,arg1,arg2)
-
-#define HL_DEBUG3(msg,arg1,arg2,arg3) \
-hlhdfDbg.dbgfun(__FILE__,__LINE__,HLHDF_DEBUG,msg,arg1,arg2,arg3)
-
-#define HL_DEBUG4(msg,arg1,arg2,arg3,arg4) \
-hlhdfDbg.dbgfun(__FILE__,__LINE__,HLHDF_DEBUG,msg,arg1,arg2,arg3,arg4)
-
-#define HL_DEPRECATED0(msg) \
-hlhdfDbg.dbgfun(__FILE__,__LINE__,HLHDF_DEPRECATED,msg)
-
-#define HL_DEPRECATED1(msg,arg1) \
-hlhdfDbg.dbgfun(__FILE__,__LINE__,HLHDF_DEPRECATED,msg,arg1)
-
-#define HL_DEPRECATED2(msg,arg1,arg2) \
-hlhdfDbg.dbgfun(__FILE__,__LINE__,HLHDF_DEPRECATED,msg,arg1,arg2)
-
-#define HL_DEPRECATED3(msg,arg1,arg2,arg3) \
-hlhdfDbg.dbgfun(__FILE__,__LINE__,HLHDF_DEPRECATED,msg,arg1,arg2,arg3)
-
-#define HL_DEPRECATED4(msg,arg1,arg2,arg3,arg4) \
-hlhdfDbg.dbgfun(__FILE__,__LINE__,HLHDF_DEPRECATED,msg,arg1,arg2,arg3,arg4)
-
-#define HL_INFO0(msg) \
-hlhdfDbg.dbgfun(__FILE__,__LINE__,HLHDF_INFO,msg)
-
-#define HL_INFO1(msg,arg1) \
-hlhdfDbg.dbgfun(__FILE__,__LINE__,HLHDF_INFO,msg,arg1)
-
-#define HL_INFO2(msg,arg1,arg2) \
-hlhdfDbg.dbgfun(__FILE__,__LINE__,HLHDF_INFO,msg,arg1,arg2)
-
-#define HL_INFO3(msg,arg1,arg2,arg3) \
-hlhdfDbg.dbgfun(__FILE__,__LINE__,HLHDF_INFO,msg,arg1,arg2,arg3)
-
-#define HL_INFO4(msg,arg1,arg2,arg3,arg4) \
-hlhdfDbg.dbgfun(__FILE__,__LINE__,HLHDF_INFO,msg,arg1,arg2,arg3,arg4)
-
-#define HL_WARNING0(msg) \
-hlhdfDbg.dbgfun(__FILE__,__LINE__,HLHDF_WARNING,msg)
-
-#define HL_WARNING1(msg,arg1) \
-hlhdfDbg.dbgfun(__FILE__,__LINE__,HLHDF_WARNING,msg,arg1)
-
-#define HL_WARNING2(msg,arg1,arg2) \
-hlhdfDbg.dbgfun(__FILE__,__LINE__,HLHDF_WARNING,msg,arg1,arg2)
-
-#define HL_WARNING3(msg,arg1,arg2,arg3) \
-hlhdfDbg.dbgfun(__FILE__,__LINE__,HLHDF_WARNING,msg,arg1,arg2,arg3)
-
-#define HL_WARNING4(msg,arg1,arg2,arg3,arg4) \
-hlhdfDbg.dbgfun(__FILE__,__LINE__,HLHDF_WARNING,msg,arg1,arg2,arg3,arg4)
-
-#define HL_ERROR0(msg) \
-hlhdfDbg.dbgfun(__FILE__,__LINE__,HLHDF_ERROR,msg)
-
-#define HL_ERROR1(msg,arg1) \
-hlhdfDbg.dbgfun(__FILE__,__LINE__,HLHDF_ERROR,msg,arg1)
-
-#define HL_ERROR2(msg,arg1,arg2) \
-hlhdfDbg.dbgfun(__FILE__,__LINE__,HLHDF_ERROR,msg,arg1,arg2)
-
-#define HL_ERROR3(msg,arg1,arg2,arg3) \
-hlhdfDbg.dbgfun(__FILE__,__LINE__,HLHDF_ERROR,msg,arg1,arg2,arg3)
-
-#define HL_ERROR4(msg,arg1,arg2,arg3,arg4) \
-hlhdfDbg.dbgfun(__FILE__,__LINE__,HLHDF_ERROR,msg,arg1,arg2,arg3,arg4)
-
-#define HL_CRITICAL0(msg) \
-hlhdfDbg.dbgfun(__FILE__,__LINE__,HLHDF_CRITICAL,msg)
-
-#define HL_CRITICAL1(msg,arg1) \
-hlhdfDbg.dbgfun(__FILE__,__LINE__,HLHDF_CRITICAL,msg,arg1)
-
-#define HL_CRITICAL2(msg,arg1,arg2) \
-hlhdfDbg.dbgfun(__FILE__,__LINE__,HLHDF_CRITICAL,msg,arg1,arg2)
-
-#define HL_CRITICAL3(msg,arg1,arg2,arg3) \
-hlhdfDbg.dbgfun(__FILE__,__LINE__,HLHDF_CRITICAL,msg,arg1,arg2,arg3)
-
-#define HL_CRITICAL4(msg,arg1,arg2,arg3,arg4) \
-hlhdfDbg.dbgfun(__FILE__,__LINE__,HLHDF_CRITICAL,msg,arg1,arg2,arg3,arg4)
-
-#define HL_ASSERT(expr, msg) \
-if(!expr) { \
-hlhdfDbg.dbgfun(__FILE__, __LINE__, HLHDF_CRITICAL, msg); \
-abort(); \
-}
+#define HL_DEBUG_ENABLED(lvl) \
+((lvl) >= HLHDF_MIN_DEBUG_LEVEL && (lvl) >= __atomic_load_n(&hlhdfDbg.gateLevel, __ATOMIC_RELAXED))
 
+/**
+ * Passes the parenthesized argument list args to the debug function if lvl is enabled.
+ */
+#define HL_DEBUG_MESSAGE(lvl, args) \
+do { if (HL_DEBUG_ENABLED(lvl)) { __atomic_load_n(&hlhdfDbg.dbgfun, __ATOMIC_ACQUIRE) args; } } while (0)
 
-#else
 /** Spewdebug macro taking one text string.*/
-#define HL_SPEWDEBUG0(msg)
+#define HL_SPEWDEBUG0(msg) \
+HL_DEBUG_MESSAGE(HLHDF_SPEWDEBUG, (__FILE__,__LINE__,HLHDF_SPEWDEBUG,msg))
 
 /** Spewdebug macro taking one text string and one argument.*/
-#define HL_SPEWDEBUG1(msg,arg1)
+#define HL_SPEWDEBUG1(msg,arg1) \
+HL_DEBUG_MESSAGE(HLHDF_SPEWDEBUG, (__FILE__,__LINE__,HLHDF_SPEWDEBUG,msg,arg1))
 
 /** Spewdebug macro taking one text string and two arguments.*/
-#define HL_SPEWDEBUG2(msg,arg1,arg2)
+#define HL_SPEWDEBUG2(msg,arg1,arg2) \
+HL_DEBUG_MESSAGE(HLHDF_SPEWDEBUG, (__FILE__,__LINE__,HLHDF_SPEWDEBUG,msg,arg1,arg2))
 
 /** Spewdebug macro taking one text string and three arguments.*/
-#define HL_SPEWDEBUG3(msg,arg1,arg2,arg3)
+#define HL_SPEWDEBUG3(msg,arg1,arg2,arg3) \
+HL_DEBUG_MESSAGE(HLHDF_SPEWDEBUG, (__FILE__,__LINE__,HLHDF_SPEWDEBUG,msg,arg1,arg2,arg3))
 
 /** Spewdebug macro taking one text string and four arguments.*/
-#define HL_SPEWDEBUG4(msg,arg1,arg2,arg3,arg4)
+#define HL_SPEWDEBUG4(msg,arg1,arg2,arg3,arg4) \
+HL_DEBUG_MESSAGE(HLHDF_SPEWDEBUG, (__FILE__,__LINE__,HLHDF_SPEWDEBUG,msg,arg1,arg2,arg3,arg4))
 
 /** Debug macro taking one text string.*/
-#define HL_DEBUG0(msg)
+#define HL_DEBUG0(msg) \
+HL_DEBUG_MESSAGE(HLHDF_DEBUG, (__FILE__,__LINE__,HLHDF_DEBUG,msg))
 
 /** Debug macro taking one text string and one argument.*/
-#define HL_DEBUG1(msg,arg1)
+#define HL_DEBUG1(msg,arg1) \
+HL_DEBUG_MESSAGE(HLHDF_DEBUG, (__FILE__,__LINE__,HLHDF_DEBUG,msg,arg1))
 
 /** Debug macro taking one text string and two arguments.*/
-#define HL_DEBUG2(msg,arg1,arg2)
+#define HL_DEBUG2(msg,arg1,arg2) \
+HL_DEBUG_MESSAGE(HLHDF_DEBUG, (__FILE__,__LINE__,HLHDF_DEBUG,msg,arg1,arg2))
 
 /** Debug macro taking one text string and three arguments.*/
-#define HL_DEBUG3(msg,arg1,arg2,arg3)
+#define HL_DEBUG3(msg,arg1,arg2,arg3) \
+HL_DEBUG_MESSAGE(HLHDF_DEBUG, (__FILE__,__LINE__,HLHDF_DEBUG,msg,arg1,arg2,arg3))
 
 /** Debug macro taking one text string and four arguments.*/
-#define HL_DEBUG4(msg,arg1,arg2,arg3,arg4)
+#define HL_DEBUG4(msg,arg1,arg2,arg3,arg4) \
+HL_DEBUG_MESSAGE(HLHDF_DEBUG, (__FILE__,__LINE__,HLHDF_DEBUG,msg,arg1,arg2,arg3,arg4))
 
 /** Deprecated macro taking one text string.*/
-#define HL_DEPRECATED0(msg)
+#define HL_DEPRECATED0(msg) \
+HL_DEBUG_MESSAGE(HLHDF_DEPRECATED, (__FILE__,__LINE__,HLHDF_DEPRECATED,msg))
 
 /** Deprecated macro taking one text string and one argument.*/
-#define HL_DEPRECATED1(msg,arg1)
+#define HL_DEPRECATED1(msg,arg1) \
+HL_DEBUG_MESSAGE(HLHDF_DEPRECATED, (__FILE__,__LINE__,HLHDF_DEPRECATED,msg,arg1))
 
 /** Deprecated macro taking one text string and two arguments.*/
-#define HL_DEPRECATED2(msg,arg1,arg2)
+#define HL_DEPRECATED2(msg,arg1,arg2) \
+HL_DEBUG_MESSAGE(HLHDF_DEPRECATED, (__FILE__,__LINE__,HLHDF_DEPRECATED,msg,arg1,arg2))
 
 /** Deprecated macro taking one text string and three arguments.*/
-#define HL_DEPRECATED3(msg,arg1,arg2,arg3)
+#define HL_DEPRECATED3(msg,arg1,arg2,arg3) \
+HL_DEBUG_MESSAGE(HLHDF_DEPRECATED, (__FILE__,__LINE__,HLHDF_DEPRECATED,msg,arg1,arg2,arg3))
 
 /** Deprecated macro taking one text string and four arguments.*/
-#define HL_DEPRECATED4(msg,arg1,arg2,arg3,arg4)
+#define HL_DEPRECATED4(msg,arg1,arg2,arg3,arg4) \
+HL_DEBUG_MESSAGE(HLHDF_DEPRECATED, (__FILE__,__LINE__,HLHDF_DEPRECATED,msg,arg1,arg2,arg3,arg4))
 
 /** Info macro taking one text string.*/
 #define HL_INFO0(msg) \
-hlhdfDbg.dbgfun(__FILE__,__LINE__,HLHDF_INFO,msg)
+HL_DEBUG_MESSAGE(HLHDF_INFO, (__FILE__,__LINE__,HLHDF_INFO,msg))
 
 /** Info macro taking one text string and one argument.*/
 #define HL_INFO1(msg,arg1) \
-hlhdfDbg.dbgfun(__FILE__,__LINE__,HLHDF_INFO,msg,arg1)
+HL_DEBUG_MESSAGE(HLHDF_INFO, (__FILE__,__LINE__,HLHDF_INFO,msg,arg1))
 
 /** Info macro taking one text string and two arguments.*/
 #define HL_INFO2(msg,arg1,arg2) \
-hlhdfDbg.dbgfun(__FILE__,__LINE__,HLHDF_INFO,msg,arg1,arg2)
+HL_DEBUG_MESSAGE(HLHDF_INFO, (__FILE__,__LINE__,HLHDF_INFO,msg,arg1,arg2))
 
 /** Info macro taking one text string and three arguments.*/
 #define HL_INFO3(msg,arg1,arg2,arg3) \
-hlhdfDbg.dbgfun(__FILE__,__LINE__,HLHDF_INFO,msg,arg1,arg2,arg3)
+HL_DEBUG_MESSAGE(HLHDF_INFO, (__FILE__,__LINE__,HLHDF_INFO,msg,arg1,arg2,arg3))
 
 /** Info macro taking one text string and four arguments.*/
 #define HL_INFO4(msg,arg1,arg2,arg3,arg4) \
-hlhdfDbg.dbgfun(__FILE__,__LINE__,HLHDF_INFO,msg,arg1,arg2,arg3,arg4)
+HL_DEBUG_MESSAGE(HLHDF_INFO, (__FILE__,__LINE__,HLHDF_INFO,msg,arg1,arg2,arg3,arg4))
 
 /** Warning macro taking one text string.*/
 #define HL_WARNING0(msg) \
-hlhdfDbg.dbgfun(__FILE__,__LINE__,HLHDF_WARNING,msg)
+HL_DEBUG_MESSAGE(HLHDF_WARNING, (__FILE__,__LINE__,HLHDF_WARNING,msg))
 
 /** Warning macro taking one text string and one argument.*/
 #define HL_WARNING1(msg,arg1) \
-hlhdfDbg.dbgfun(__FILE__,__LINE__,HLHDF_WARNING,msg,arg1)
+HL_DEBUG_MESSAGE(HLHDF_WARNING, (__FILE__,__LINE__,HLHDF_WARNING,msg,arg1))
 
 /** Warning macro taking one text string and two arguments.*/
 #define HL_WARNING2(msg,arg1,arg2) \
-hlhdfDbg.dbgfun(__FILE__,__LINE__,HLHDF_WARNING,msg,arg1,arg2)
+HL_DEBUG_MESSAGE(HLHDF_WARNING, (__FILE__,__LINE__,HLHDF_WARNING,msg,arg1,arg2))
 
 /** Warning macro taking one text string and three arguments.*/
 #define HL_WARNING3(msg,arg1,arg2,arg3) \
-hlhdfDbg.dbgfun(__FILE__,__LINE__,HLHDF_WARNING,msg,arg1,arg2,arg3)
+HL_DEBUG_MESSAGE(HLHDF_WARNING, (__FILE__,__LINE__,HLHDF_WARNING,msg,arg1,arg2,arg3))
 
 /** Warning macro taking one text string and four arguments.*/
 #define HL_WARNING4(msg,arg1,arg2,arg3,arg4) \
-hlhdfDbg.dbgfun(__FILE__,__LINE__,HLHDF_WARNING,msg,arg1,arg2,arg3,arg4)
+HL_DEBUG_MESSAGE(HLHDF_WARNING, (__FILE__,__LINE__,HLHDF_WARNING,msg,arg1,arg2,arg3,arg4))
 
 /** Error macro taking one text string.*/
 #define HL_ERROR0(msg) \
-hlhdfDbg.dbgfun(__FILE__,__LINE__,HLHDF_ERROR,msg)
+HL_DEBUG_MESSAGE(HLHDF_ERROR, (__FILE__,__LINE__,HLHDF_ERROR,msg))
 
 /** Error macro taking one text string and one argument.*/
 #define HL_ERROR1(msg,arg1) \
-hlhdfDbg.dbgfun(__FILE__,__LINE__,HLHDF_ERROR,msg,arg1)
+HL_DEBUG_MESSAGE(HLHDF_ERROR, (__FILE__,__LINE__,HLHDF_ERROR,msg,arg1))
 
 /** Error macro taking one text string and two arguments.*/
 #define HL_ERROR2(msg,arg1,arg2) \
-hlhdfDbg.dbgfun(__FILE__,__LINE__,HLHDF_ERROR,msg,arg1,arg2)
+HL_DEBUG_MESSAGE(HLHDF_ERROR, (__FILE__,__LINE__,HLHDF_ERROR,msg,arg1,arg2))
 
 /** Error macro taking one text string and three arguments.*/
 #define HL_ERROR3(msg,arg1,arg2,arg3) \
-hlhdfDbg.dbgfun(__FILE__,__LINE__,HLHDF_ERROR,msg,arg1,arg2,arg3)
+HL_DEBUG_MESSAGE(HLHDF_ERROR, (__FILE__,__LINE__,HLHDF_ERROR,msg,arg1,arg2,arg3))
 
 /** Error macro taking one text string and four arguments.*/
 #define HL_ERROR4(msg,arg1,arg2,arg3,arg4) \
-hlhdfDbg.dbgfun(__FILE__,__LINE__,HLHDF_ERROR,msg,arg1,arg2,arg3,arg4)
+HL_DEBUG_MESSAGE(HLHDF_ERROR, (__FILE__,__LINE__,HLHDF_ERROR,msg,arg1,arg2,arg3,arg4))
 
 /** Critical macro taking one text string.*/
 #define HL_CRITICAL0(msg) \
-hlhdfDbg.dbgfun(__FILE__,__LINE__,HLHDF_CRITICAL,msg)
+HL_DEBUG_MESSAGE(HLHDF_CRITICAL, (__FILE__,__LINE__,HLHDF_CRITICAL,msg))
 
 /** Critical macro taking one text string and one argument.*/
 #define HL_CRITICAL1(msg,arg1) \
-hlhdfDbg.dbgfun(__FILE__,__LINE__,HLHDF_CRITICAL,msg,arg1)
+HL_DEBUG_MESSAGE(HLHDF_CRITICAL, (__FILE__,__LINE__,HLHDF_CRITICAL,msg,arg1))
 
 /** Critical macro taking one text string and two arguments.*/
 #define HL_CRITICAL2(msg,arg1,arg2) \
-hlhdfDbg.dbgfun(__FILE__,__LINE__,HLHDF_CRITICAL,msg,arg1,arg2)
+HL_DEBUG_MESSAGE(HLHDF_CRITICAL, (__FILE__,__LINE__,HLHDF_CRITICAL,msg,arg1,arg2))
 
 /** Critical macro taking one text string and three arguments.*/
 #define HL_CRITICAL3(msg,arg1,arg2,arg3) \
-hlhdfDbg.dbgfun(__FILE__,__LINE__,HLHDF_CRITICAL,msg,arg1,arg2,arg3)
+HL_DEBUG_MESSAGE(HLHDF_CRITICAL, (__FILE__,__LINE__,HLHDF_CRITICAL,msg,arg1,arg2,arg3))
 
 /** Critical macro taking one text string and four arguments.*/
 #define HL_CRITICAL4(msg,arg1,arg2,arg3,arg4) \
-hlhdfDbg.dbgfun(__FILE__,__LINE__,HLHDF_CRITICAL,msg,arg1,arg2,arg3,arg4)
+HL_DEBUG_MESSAGE(HLHDF_CRITICAL, (__FILE__,__LINE__,HLHDF_CRITICAL,msg,arg1,arg2,arg3,arg4))
 
 #ifdef NO_HLHDF_ABORT
 
@@ -375,14 +318,12 @@ hlhdfDbg.dbgfun(__FILE__,__LINE__,HLHDF_CRITICAL,msg,arg1,arg2,arg3,arg4)
  */
 #define HL_ASSERT(expr, msg) \
 if(!expr) { \
-hlhdfDbg.dbgfun(__FILE__, __LINE__, HLHDF_CRITICAL, msg); \
+__atomic_load_n(&hlhdfDbg.dbgfun, __ATOMIC_ACQUIRE)(__FILE__, __LINE__, HLHDF_CRITICAL, msg); \
 abort(); \
 }
 
 #define HL_ABORT() abort()
 
-#endif
-
 #endif
 /*@}*/
 
@@ -26,6 +26,8 @@ along with HLHDF.  If not, see <http://www.gnu.org/licenses/>.
 #ifndef HLHDF_DEFINES_PRIVATE_H
 #define HLHDF_DEFINES_PRIVATE_H
 #include "hdf5.h"
+#include <sys/types.h>
+#include <sys/stat.h>
 
 /**
  * @brief Closes a H5 group identifier.
@@ -77,5 +79,60 @@ along with HLHDF.  If not, see <http://www.gnu.org/licenses/>.
  */
 #define DEFAULT_SIZE_NODELIST 20
 
+/**
+ * Number of bytes of data (and rawdata) that will be stored directly
+ * in the HL_Node instead of in a separately allocated buffer.
+ */
+#define HLNODE_INLINE_DATA_SIZE 32
+
+/**
+ * Max rank for dimensions that will be stored directly in the HL_Node.
+ */
+#define HLNODE_INLINE_RANK 4
+
+/**
+ * Approximate number of bytes that are read at a time when a dataset is read in slabs.
+ */
+#define HLHDF_SLAB_BYTES (1024*1024)
+
+/**
+ * Nanoseconds part of the modification time in a struct stat when the platform provides it.
+ */
+#if defined(__APPLE__)
+#define HLHDF_MTIME_NSEC(st) ((long)(st).st_mtimespec.tv_nsec)
+#elif defined(st_mtime)
+#define HLHDF_MTIME_NSEC(st) ((long)(st).st_mtim.tv_nsec)
+#else
+#define HLHDF_MTIME_NSEC(st) (0L)
+#endif
+
+/**
+ * Atomically adds n to x and returns the new value. Used for values that are updated
+ * from the background threads. Compilers without the GCC atomic builtins get a plain update.
+ */
+#if defined(__GNUC__)
+#define HL_ATOMIC_ADD(x, n) __atomic_add_fetch(&(x), (n), __ATOMIC_ACQ_REL)
+#else
+#define HL_ATOMIC_ADD(x, n) ((x) += (n))
+#endif
+
+/**
+ * Atomically subtracts n from x and returns the new value, see \ref HL_ATOMIC_ADD.
+ */
+#if defined(__GNUC__)
+#define HL_ATOMIC_SUB(x, n) __atomic_sub_fetch(&(x), (n), __ATOMIC_ACQ_REL)
+#else
+#define HL_ATOMIC_SUB(x, n) ((x) -= (n))
+#endif
+
+/**
+ * Atomically reads x, see \ref HL_ATOMIC_ADD.
+ */
+#if defined(__GNUC__)
+#define HL_ATOMIC_LOAD(x) __atomic_load_n(&(x), __ATOMIC_ACQUIRE)
+#else
+#define HL_ATOMIC_LOAD(x) (x)
+#endif
+
 
 #endif
@@ -0,0 +1,843 @@
+/* --------------------------------------------------------------------
+Copyright (C) 2026 Swedish Meteorological and Hydrological Institute, SMHI,
+
+This file is part of HLHDF.
+
+HLHDF is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+HLHDF is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with HLHDF.  If not, see <http://www.gnu.org/licenses/>.
+------------------------------------------------------------------------*/
+
+
+/**
+ * Index of the structure of read files.
+ * @file
+ * @date 2026-10-19
+ */
+#include "hlhdf.h"
+#include "hlhdf_alloc.h"
+#include "hlhdf_index.h"
+#include "hlhdf_index_private.h"
+#include "hlhdf_debug.h"
+#include "hlhdf_defines_private.h"
+#include "hlhdf_node_private.h"
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <pthread.h>
+
+/*@{ Structs */
+/**
+ * A growable byte buffer used when serializing an index.
+ */
+typedef struct HLIndexBuffer_t {
+  unsigned char* data; /**< the data */
+  size_t size;         /**< number of used bytes */
+  size_t capacity;     /**< number of allocated bytes */
+} HLIndexBuffer_t;
+
+/**
+ * Read position in a serialized index.
+ */
+typedef struct HLIndexCursor_t {
+  const unsigned char* data; /**< the data */
+  size_t size;               /**< total number of bytes */
+  size_t pos;                /**< current position */
+} HLIndexCursor_t;
+
+/**
+ * What is known about the indexed file.
+ */
+typedef struct HLIndexStamp_t {
+  uint64_t dev;       /**< device of the file */
+  uint64_t ino;       /**< inode of the file */
+  uint64_t size;      /**< file size */
+  int64_t mtime;      /**< modification time, seconds */
+  int64_t mtimensec;  /**< modification time, nanoseconds */
+} HLIndexStamp_t;
+
+/**
+ * One index kept in memory.
+ */
+typedef struct HLIndexEntry_t {
+  char* key;                   /**< filename and from path */
+  unsigned char* data;         /**< the serialized index */
+  size_t size;                 /**< size of data */
+  struct HLIndexEntry_t* next; /**< next entry, most recently used first */
+} HLIndexEntry_t;
+
+/**
+ * The process wide index state.
+ */
+typedef struct HLIndex_t {
+  HL_IndexMode mode;     /**< the index mode */
+  size_t hits;           /**< number of reads served from an index */
+  size_t misses;         /**< number of reads that traversed the file */
+  int nentries;          /**< number of entries in memory */
+  HLIndexEntry_t* head;  /**< the entries */
+} HLIndex_t;
+
+/*@} End of Structs */
+
+/**
+ * Identifies a serialized index.
+ */
+#define HLINDEX_MAGIC "HLHDFIDX"
+
+/**
+ * Version of the serialized index.
+ */
+#define HLINDEX_VERSION 2
+
+/**
+ * Written in native byte order so that an index from another architecture is ignored.
+ */
+#define HLINDEX_BYTEORDER 0x01020304
+
+/**
+ * Suffix added to the file name for the sidecar file.
+ */
+#define HLINDEX_SIDECAR_SUFFIX ".hlidx"
+
+/**
+ * Max number of indexes that are kept in memory.
+ */
+#define HLINDEX_MAX_ENTRIES 64
+
+static HLIndex_t hlhdf_index = {HL_INDEX_NONE, 0, 0, 0, NULL};
+
+/**
+ * Protects the memory index and the statistics since nodelists may be read
+ * from several threads.
+ */
+static pthread_mutex_t hlhdf_index_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/*@{ Private functions */
+/**
+ * Appends bytes to the buffer.
+ * @param[in] buf the buffer
+ * @param[in] ptr the bytes
+ * @param[in] n number of bytes
+ * @return 1 on success, otherwise 0
+ */
+static int HLIndexInternal_put(HLIndexBuffer_t* buf, const void* ptr, size_t n)
+{
+  if (buf->size + n > buf->capacity) {
+    size_t ncapacity = buf->capacity == 0 ? 1024 : buf->capacity * 2;
+    unsigned char* ndata = NULL;
+    while (ncapacity < buf->size + n) {
+      ncapacity *= 2;
+    }
+    if ((ndata = HLHDF_REALLOC(buf->data, ncapacity)) == NULL) {
+      HL_ERROR0("Failed to allocate memory for index");
+      return 0;
+    }
+    buf->data = ndata;
+    buf->capacity = ncapacity;
+  }
+  memcpy(buf->data + buf->size, ptr, n);
+  buf->size += n;
+  return 1;
+}
+
+static int HLIndexInternal_putUint32(HLIndexBuffer_t* buf, uint32_t v)
+{
+  return HLIndexInternal_put(buf, &v, sizeof(v));
+}
+
+static int HLIndexInternal_putUint64(HLIndexBuffer_t* buf, uint64_t v)
+{
+  return HLIndexInternal_put(buf, &v, sizeof(v));
+}
+
+static int HLIndexInternal_putString(HLIndexBuffer_t* buf, const char* str)
+{
+  uint32_t len = (uint32_t)strlen(str);
+  return HLIndexInternal_putUint32(buf, len) && HLIndexInternal_put(buf, str, len);
+}
+
+/**
+ * Reads bytes from the cursor.
+ * @param[in] cursor the cursor
+ * @param[in] ptr where to store the bytes
+ * @param[in] n number of bytes
+ * @return 1 on success, 0 if there are not enough bytes left
+ */
+static int HLIndexInternal_get(HLIndexCursor_t* cursor, void* ptr, size_t n)
+{
+  if (n > cursor->size - cursor->pos) {
+    return 0;
+  }
+  memcpy(ptr, cursor->data + cursor->pos, n);
+  cursor->pos += n;
+  return 1;
+}
+
+/**
+ * Reads a string from the cursor.
+ * @param[in] cursor the cursor
+ * @return the string or NULL on failure, must be released by caller
+ */
+static char* HLIndexInternal_getString(HLIndexCursor_t* cursor)
+{
+  uint32_t len = 0;
+  char* result = NULL;
+  if (!HLIndexInternal_get(cursor, &len, sizeof(len)) || len > cursor->size - cursor->pos) {
+    return NULL;
+  }
+  if ((result = HLHDF_MALLOC(len + 1)) == NULL) {
+    HL_ERROR0("Failed to allocate memory for index string");
+    return NULL;
+  }
+  HLIndexInternal_get(cursor, result, len);
+  result[len] = '\0';
+  return result;
+}
+
+/**
+ * Returns the path that is used in the index for fromPath, "." and "/" are the same.
+ * @param[in] fromPath the path
+ * @return the path
+ */
+static const char* HLIndexInternal_normalizePath(const char* fromPath)
+{
+  if (fromPath == NULL || strcmp(fromPath, ".") == 0) {
+    return "/";
+  }
+  return fromPath;
+}
+
+/**
+ * Gets the stamp that an index for filename is validated against.
+ * @param[in] filename the file name
+ * @param[out] stamp the stamp
+ * @return 1 on success, otherwise 0
+ */
+static int HLIndexInternal_getStamp(const char* filename, HLIndexStamp_t* stamp)
+{
+  struct stat st;
+  if (filename == NULL || stat(filename, &st) != 0) {
+    return 0;
+  }
+  stamp->dev = (uint64_t)st.st_dev;
+  stamp->ino = (uint64_t)st.st_ino;
+  stamp->size = (uint64_t)st.st_size;
+  stamp->mtime = (int64_t)st.st_mtime;
+  stamp->mtimensec = (int64_t)HLHDF_MTIME_NSEC(st);
+  return 1;
+}
+
+/**
+ * Creates name of the sidecar file.
+ * @param[in] filename the file name
+ * @return the sidecar file name, must be released by caller
+ */
+static char* HLIndexInternal_sidecarName(const char* filename)
+{
+  char* result = HLHDF_MALLOC(strlen(filename) + strlen(HLINDEX_SIDECAR_SUFFIX) + 1);
+  if (result == NULL) {
+    HL_ERROR0("Failed to allocate memory for sidecar name");
+    return NULL;
+  }
+  strcpy(result, filename);
+  strcat(result, HLINDEX_SIDECAR_SUFFIX);
+  return result;
+}
+
+/**
+ * Serializes the structure of the nodelist.
+ * @param[in] nodelist the nodelist
+ * @param[in] stamp the stamp of the file
+ * @param[in] path the (normalized) path the nodelist was read from
+ * @param[out] buf the buffer to fill, released on failure
+ * @return 1 on success, otherwise 0
+ */
+static int HLIndexInternal_serialize(HL_NodeList* nodelist, HLIndexStamp_t* stamp, const char* path, HLIndexBuffer_t* buf)
+{
+  int i = 0, j = 0;
+  int nnodes = HLNodeList_getNumberOfNodes(nodelist);
+
+  buf->data = NULL;
+  buf->size = buf->capacity = 0;
+
+  if (!HLIndexInternal_put(buf, HLINDEX_MAGIC, strlen(HLINDEX_MAGIC)) ||
+      !HLIndexInternal_putUint32(buf, HLINDEX_VERSION) ||
+      !HLIndexInternal_putUint32(buf, HLINDEX_BYTEORDER) ||
+      !HLIndexInternal_putUint64(buf, stamp->dev) ||
+      !HLIndexInternal_putUint64(buf, stamp->ino) ||
+      !HLIndexInternal_putUint64(buf, stamp->size) ||
+      !HLIndexInternal_putUint64(buf, (uint64_t)stamp->mtime) ||
+      !HLIndexInternal_putUint64(buf, (uint64_t)stamp->mtimensec) ||
+      !HLIndexInternal_putString(buf, path) ||
+      !HLIndexInternal_putUint32(buf, (uint32_t)nnodes)) {
+    goto fail;
+  }
+
+  for (i = 0; i < nnodes; i++) {
+    HL_Node* node = HLNodeList_getNodeByIndex(nodelist, i);
+    int ndims = HLNode_getRank(node);
+    const hsize_t* dims = HLNodePrivate_getDims(node);
+    int32_t values[4];
+    values[0] = (int32_t)HLNode_getType(node);
+    values[1] = (int32_t)HLNode_getDataType(node);
+    values[2] = (int32_t)HLNode_getFormat(node);
+    values[3] = (int32_t)ndims;
+    if (!HLIndexInternal_put(buf, values, sizeof(values))) {
+      goto fail;
+    }
+    for (j = 0; j < ndims; j++) {
+      if (!HLIndexInternal_putUint64(buf, (uint64_t)dims[j])) {
+        goto fail;
+      }
+    }
+    if (!HLIndexInternal_putString(buf, HLNode_getName(node))) {
+      goto fail;
+    }
+  }
+  return 1;
+fail:
+  HLHDF_FREE(buf->data);
+  buf->size = buf->capacity = 0;
+  return 0;
+}
+
+/**
+ * Creates a node from its serialized form.
+ * @param[in] cursor the cursor
+ * @return the node or NULL on failure
+ */
+static HL_Node* HLIndexInternal_readNode(HLIndexCursor_t* cursor)
+{
+  int32_t values[4];
+  hsize_t dims[H5S_MAX_RANK];
+  char* name = NULL;
+  HL_Node* node = NULL;
+  int j = 0;
+
+  if (!HLIndexInternal_get(cursor, values, sizeof(values)) ||
+      values[3] < 0 || values[3] > H5S_MAX_RANK ||
+      values[2] < HLHDF_UNDEFINED || values[2] >= HLHDF_END_OF_SPECIFIERS) {
+    goto fail;
+  }
+  for (j = 0; j < values[3]; j++) {
+    uint64_t v = 0;
+    if (!HLIndexInternal_get(cursor, &v, sizeof(v))) {
+      goto fail;
+    }
+    dims[j] = (hsize_t)v;
+  }
+  if ((name = HLIndexInternal_getString(cursor)) == NULL) {
+    goto fail;
+  }
+
+  switch (values[0]) {
+  case ATTRIBUTE_ID:
+    node = HLNode_newAttribute(name);
+    break;
+  case GROUP_ID:
+    node = HLNode_newGroup(name);
+    break;
+  case DATASET_ID:
+    node = HLNode_newDataset(name);
+    break;
+  case TYPE_ID:
+    node = HLNode_newDatatype(name);
+    break;
+  case REFERENCE_ID:
+    node = HLNode_newReference(name);
+    break;
+  default:
+    break;
+  }
+  if (node == NULL) {
+    goto fail;
+  }
+  if (values[3] > 0 && !HLNode_setDimensions(node, values[3], dims)) {
+    goto fail;
+  }
+  if (values[1] == HL_SIMPLE || values[1] == HL_ARRAY) {
+    HLNode_setDataType(node, (HL_DataType)values[1]);
+  }
+  HLNodePrivate_setFormat(node, (HL_FormatSpecifier)values[2]);
+  HLHDF_FREE(name);
+  return node;
+fail:
+  HLHDF_FREE(name);
+  HLNode_free(node);
+  return NULL;
+}
+
+/**
+ * Creates a nodelist from a serialized index if it is valid for the file and path.
+ * @param[in] data the serialized index
+ * @param[in] size the size of data
+ * @param[in] filename the file name
+ * @param[in] stamp the current stamp of the file
+ * @param[in] path the (normalized) path
+ * @return the nodelist or NULL if the index could not be used
+ */
+static HL_NodeList* HLIndexInternal_deserialize(const unsigned char* data, size_t size,
+  const char* filename, HLIndexStamp_t* stamp, const char* path)
+{
+  HLIndexCursor_t cursor;
+  char magic[8];
+  uint32_t version = 0, byteorder = 0, nnodes = 0, i = 0;
+  uint64_t dev = 0, ino = 0, fsize = 0, mtime = 0, mtimensec = 0;
+  char* ipath = NULL;
+  HL_NodeList* result = NULL;
+
+  cursor.data = data;
+  cursor.size = size;
+  cursor.pos = 0;
+
+  if (!HLIndexInternal_get(&cursor, magic, sizeof(magic)) ||
+      memcmp(magic, HLINDEX_MAGIC, sizeof(magic)) != 0 ||
+      !HLIndexInternal_get(&cursor, &version, sizeof(version)) || version != HLINDEX_VERSION ||
+      !HLIndexInternal_get(&cursor, &byteorder, sizeof(byteorder)) || byteorder != HLINDEX_BYTEORDER ||
+      !HLIndexInternal_get(&cursor, &dev, sizeof(dev)) ||
+      !HLIndexInternal_get(&cursor, &ino, sizeof(ino)) ||
+      !HLIndexInternal_get(&cursor, &fsize, sizeof(fsize)) ||
+      !HLIndexInternal_get(&cursor, &mtime, sizeof(mtime)) ||
+      !HLIndexInternal_get(&cursor, &mtimensec, sizeof(mtimensec))) {
+    HL_DEBUG1("Index for %s is not valid", filename);
+    goto fail;
+  }
+  if (dev != stamp->dev || ino != stamp->ino ||
+      fsize != stamp->size || (int64_t)mtime != stamp->mtime || (int64_t)mtimensec != stamp->mtimensec) {
+    HL_DEBUG1("Index for %s is out of date", filename);
+    goto fail;
+  }
+  if ((ipath = HLIndexInternal_getString(&cursor)) == NULL || strcmp(ipath, path) != 0 ||
+      !HLIndexInternal_get(&cursor, &nnodes, sizeof(nnodes))) {
+    goto fail;
+  }
+
+  if ((result = HLNodeList_new()) == NULL || !HLNodeList_setFileName(result, filename)) {
+    goto fail;
+  }
+  for (i = 0; i < nnodes; i++) {
+    HL_Node* node = HLIndexInternal_readNode(&cursor);
+    if (node == NULL) {
+      HL_DEBUG1("Index for %s is corrupt", filename);
+      goto fail;
+    }
+    if (!HLNodeList_addNode(result, node)) {
+      HLNode_free(node);
+      goto fail;
+    }
+  }
+  HLNodeList_markNodes(result, NMARK_ORIGINAL);
+  HLHDF_FREE(ipath);
+  return result;
+fail:
+  HLHDF_FREE(ipath);
+  HLNodeList_free(result);
+  return NULL;
+}
+
+/**
+ * Reads a whole file into memory.
+ * @param[in] filename the file
+ * @param[out] size the number of bytes read
+ * @return the data or NULL on failure, must be released by caller
+ */
+static unsigned char* HLIndexInternal_readFile(const char* filename, size_t* size)
+{
+  FILE* fp = NULL;
+  long len = 0;
+  unsigned char* data = NULL;
+
+  if ((fp = fopen(filename, "rb")) == NULL) {
+    return NULL;
+  }
+  if (fseek(fp, 0, SEEK_END) != 0 || (len = ftell(fp)) <= 0 || fseek(fp, 0, SEEK_SET) != 0) {
+    goto fail;
+  }
+  if ((data = HLHDF_MALLOC((size_t)len)) == NULL) {
+    HL_ERROR1("Failed to allocate memory for index %s", filename);
+    goto fail;
+  }
+  if (fread(data, 1, (size_t)len, fp) != (size_t)len) {
+    goto fail;
+  }
+  fclose(fp);
+  *size = (size_t)len;
+  return data;
+fail:
+  HLHDF_FREE(data);
+  fclose(fp);
+  return NULL;
+}
+
+/**
+ * Writes data to a file by first writing it to a temporary file in the same
+ * directory and then renaming it so that readers never see a partial index.
+ * @param[in] filename the file
+ * @param[in] data the data
+ * @param[in] size number of bytes
+ * @return 1 on success, otherwise 0
+ */
+static int HLIndexInternal_writeFile(const char* filename, const unsigned char* data, size_t size)
+{
+  char* tmpname = NULL;
+  int fd = -1;
+  FILE* fp = NULL;
+  int status = 0;
+
+  if ((tmpname = HLHDF_MALLOC(strlen(filename) + 8)) == NULL) {
+    HL_ERROR0("Failed to allocate memory for index file name");
+    goto done;
+  }
+  strcpy(tmpname, filename);
+  strcat(tmpname, ".XXXXXX");
+  if ((fd = mkstemp(tmpname)) < 0) {
+    HL_DEBUG1("Could not create temporary index file for %s", filename);
+    goto done;
+  }
+  if ((fp = fdopen(fd, "wb")) == NULL) {
+    close(fd);
+    unlink(tmpname);
+    goto done;
+  }
+  if (fwrite(data, 1, size, fp) != size) {
+    fclose(fp);
+    unlink(tmpname);
+    goto done;
+  }
+  if (fclose(fp) != 0 || rename(tmpname, filename) != 0) {
+    unlink(tmpname);
+    goto done;
+  }
+  status = 1;
+done:
+  HLHDF_FREE(tmpname);
+  return status;
+}
+
+/**
+ * Creates the key used for the memory index.
+ * @param[in] filename the file name
+ * @param[in] path the (normalized) path
+ * @return the key, must be released by caller
+ */
+static char* HLIndexInternal_createKey(const char* filename, const char* path)
+{
+  char* key = HLHDF_MALLOC(strlen(filename) + strlen(path) + 2);
+  if (key == NULL) {
+    HL_ERROR0("Failed to allocate memory for index key");
+    return NULL;
+  }
+  strcpy(key, filename);
+  strcat(key, "\n");
+  strcat(key, path);
+  return key;
+}
+
+static void HLIndexInternal_freeEntry(HLIndexEntry_t* entry)
+{
+  if (entry != NULL) {
+    HLHDF_FREE(entry->key);
+    HLHDF_FREE(entry->data);
+    HLHDF_FREE(entry);
+  }
+}
+
+/**
+ * Unlinks the entry with the specified key from the memory index.
+ * Must be called with hlhdf_index_lock held.
+ * @param[in] key the key
+ * @return the entry or NULL if not found
+ */
+static HLIndexEntry_t* HLIndexInternal_unlink(const char* key)
+{
+  HLIndexEntry_t** pp = &hlhdf_index.head;
+  while (*pp != NULL) {
+    if (strcmp((*pp)->key, key) == 0) {
+      HLIndexEntry_t* entry = *pp;
+      *pp = entry->next;
+      entry->next = NULL;
+      hlhdf_index.nentries--;
+      return entry;
+    }
+    pp = &(*pp)->next;
+  }
+  return NULL;
+}
+
+/**
+ * Adds an entry first in the memory index and removes the least recently
+ * used entries if there are too many. Must be called with hlhdf_index_lock held.
+ * @param[in] entry the entry
+ */
+static void HLIndexInternal_link(HLIndexEntry_t* entry)
+{
+  entry->next = hlhdf_index.head;
+  hlhdf_index.head = entry;
+  hlhdf_index.nentries++;
+  if (hlhdf_index.nentries > HLINDEX_MAX_ENTRIES) {
+    HLIndexEntry_t* e = hlhdf_index.head;
+    int n = 1;
+    while (n < HLINDEX_MAX_ENTRIES) {
+      e = e->next;
+      n++;
+    }
+    while (e->next != NULL) {
+      HLIndexEntry_t* victim = e->next;
+      e->next = victim->next;
+      HLIndexInternal_freeEntry(victim);
+      hlhdf_index.nentries--;
+    }
+  }
+}
+
+/**
+ * Adds an entry first in the memory index, replacing any entry with the same key.
+ * @param[in] entry the entry (taken over)
+ */
+static void HLIndexInternal_insert(HLIndexEntry_t* entry)
+{
+  HLIndexEntry_t* old = NULL;
+  pthread_mutex_lock(&hlhdf_index_lock);
+  old = HLIndexInternal_unlink(entry->key);
+  HLIndexInternal_link(entry);
+  pthread_mutex_unlock(&hlhdf_index_lock);
+  HLIndexInternal_freeEntry(old);
+}
+
+/**
+ * Stores serialized data in the memory index, the data is taken over.
+ * @param[in] key the key (taken over)
+ * @param[in] data the data (taken over)
+ * @param[in] size the size of data
+ */
+static void HLIndexInternal_remember(char* key, unsigned char* data, size_t size)
+{
+  HLIndexEntry_t* entry = NULL;
+  if ((entry = HLHDF_MALLOC(sizeof(HLIndexEntry_t))) == NULL) {
+    HL_ERROR0("Failed to allocate memory for index entry");
+    HLHDF_FREE(key);
+    HLHDF_FREE(data);
+    return;
+  }
+  entry->key = key;
+  entry->data = data;
+  entry->size = size;
+  HLIndexInternal_insert(entry);
+}
+
+/*@} End of Private functions */
+
+/*@{ Interface functions */
+void HL_setIndexMode(HL_IndexMode mode)
+{
+  hlhdf_index.mode = mode;
+  if (mode == HL_INDEX_NONE) {
+    HL_clearIndexCache();
+  }
+}
+
+HL_IndexMode HL_getIndexMode(void)
+{
+  return hlhdf_index.mode;
+}
+
+void HL_getIndexStatistics(size_t* hits, size_t* misses)
+{
+  pthread_mutex_lock(&hlhdf_index_lock);
+  if (hits != NULL) {
+    *hits = hlhdf_index.hits;
+  }
+  if (misses != NULL) {
+    *misses = hlhdf_index.misses;
+  }
+  pthread_mutex_unlock(&hlhdf_index_lock);
+}
+
+void HL_clearIndexCache(void)
+{
+  HLIndexEntry_t* head = NULL;
+  pthread_mutex_lock(&hlhdf_index_lock);
+  head = hlhdf_index.head;
+  hlhdf_index.head = NULL;
+  hlhdf_index.nentries = 0;
+  hlhdf_index.hits = 0;
+  hlhdf_index.misses = 0;
+  pthread_mutex_unlock(&hlhdf_index_lock);
+  while (head != NULL) {
+    HLIndexEntry_t* entry = head;
+    head = entry->next;
+    HLIndexInternal_freeEntry(entry);
+  }
+}
+
+int HLNodeList_writeIndex(HL_NodeList* nodelist, const char* indexfile)
+{
+  HLIndexStamp_t stamp;
+  HLIndexBuffer_t buf = {NULL, 0, 0};
+  char* filename = NULL;
+  char* sidecar = NULL;
+  int status = 0;
+
+  if (nodelist == NULL) {
+    HL_ERROR0("Inparameters NULL");
+    return 0;
+  }
+  if ((filename = HLNodeList_getFileName(nodelist)) == NULL) {
+    HL_ERROR0("Nodelist does not have a filename");
+    goto done;
+  }
+  if (!HLIndexInternal_getStamp(filename, &stamp)) {
+    HL_ERROR1("Could not stat %s", filename);
+    goto done;
+  }
+  if (indexfile == NULL) {
+    if ((sidecar = HLIndexInternal_sidecarName(filename)) == NULL) {
+      goto done;
+    }
+    indexfile = sidecar;
+  }
+  if (!HLIndexInternal_serialize(nodelist, &stamp, "/", &buf)) {
+    goto done;
+  }
+  if (!HLIndexInternal_writeFile(indexfile, buf.data, buf.size)) {
+    HL_ERROR1("Failed to write index %s", indexfile);
+    goto done;
+  }
+  status = 1;
+done:
+  HLHDF_FREE(buf.data);
+  HLHDF_FREE(sidecar);
+  HLHDF_FREE(filename);
+  return status;
+}
+
+HL_NodeList* HLNodeList_readIndex(const char* filename, const char* indexfile)
+{
+  HLIndexStamp_t stamp;
+  unsigned char* data = NULL;
+  size_t size = 0;
+  char* sidecar = NULL;
+  HL_NodeList* result = NULL;
+
+  if (filename == NULL) {
+    HL_ERROR0("Inparameters NULL");
+    return NULL;
+  }
+  if (!HLIndexInternal_getStamp(filename, &stamp)) {
+    goto done;
+  }
+  if (indexfile == NULL) {
+    if ((sidecar = HLIndexInternal_sidecarName(filename)) == NULL) {
+      goto done;
+    }
+    indexfile = sidecar;
+  }
+  if ((data = HLIndexInternal_readFile(indexfile, &size)) == NULL) {
+    goto done;
+  }
+  result = HLIndexInternal_deserialize(data, size, filename, &stamp, "/");
+done:
+  HLHDF_FREE(data);
+  HLHDF_FREE(sidecar);
+  return result;
+}
+
+HL_NodeList* HLIndexPrivate_load(const char* filename, const char* fromPath)
+{
+  HLIndexStamp_t stamp;
+  const char* path = HLIndexInternal_normalizePath(fromPath);
+  char* key = NULL;
+  HLIndexEntry_t* entry = NULL;
+  HL_NodeList* result = NULL;
+
+  if (hlhdf_index.mode == HL_INDEX_NONE || !HLIndexInternal_getStamp(filename, &stamp)) {
+    return NULL;
+  }
+  if ((key = HLIndexInternal_createKey(filename, path)) == NULL) {
+    return NULL;
+  }
+
+  /* The entry is unlinked while it is deserialized so that no other thread can release it */
+  pthread_mutex_lock(&hlhdf_index_lock);
+  entry = HLIndexInternal_unlink(key);
+  pthread_mutex_unlock(&hlhdf_index_lock);
+  if (entry != NULL) {
+    result = HLIndexInternal_deserialize(entry->data, entry->size, filename, &stamp, path);
+    if (result != NULL) {
+      HLIndexInternal_insert(entry);
+    } else {
+      HLIndexInternal_freeEntry(entry);
+    }
+  }
+
+  if (result == NULL && hlhdf_index.mode == HL_INDEX_SIDECAR && strcmp(path, "/") == 0) {
+    char* sidecar = HLIndexInternal_sidecarName(filename);
+    unsigned char* data = NULL;
+    size_t size = 0;
+    if (sidecar != NULL && (data = HLIndexInternal_readFile(sidecar, &size)) != NULL) {
+      result = HLIndexInternal_deserialize(data, size, filename, &stamp, path);
+    }
+    HLHDF_FREE(sidecar);
+    if (result != NULL) {
+      HLIndexInternal_remember(key, data, size);
+      key = NULL;
+    } else {
+      HLHDF_FREE(data);
+    }
+  }
+
+  pthread_mutex_lock(&hlhdf_index_lock);
+  if (result != NULL) {
+    hlhdf_index.hits++;
+  } else {
+    hlhdf_index.misses++;
+  }
+  pthread_mutex_unlock(&hlhdf_index_lock);
+  HLHDF_FREE(key);
+  return result;
+}
+
+void HLIndexPrivate_store(HL_NodeList* nodelist, const char* fromPath)
+{
+  HLIndexStamp_t stamp;
+  HLIndexBuffer_t buf = {NULL, 0, 0};
+  const char* path = HLIndexInternal_normalizePath(fromPath);
+  char* filename = NULL;
+  char* key = NULL;
+
+  if (hlhdf_index.mode == HL_INDEX_NONE || nodelist == NULL) {
+    return;
+  }
+  if ((filename = HLNodeList_getFileName(nodelist)) == NULL ||
+      !HLIndexInternal_getStamp(filename, &stamp) ||
+      !HLIndexInternal_serialize(nodelist, &stamp, path, &buf)) {
+    goto done;
+  }
+  if (hlhdf_index.mode == HL_INDEX_SIDECAR && strcmp(path, "/") == 0) {
+    char* sidecar = HLIndexInternal_sidecarName(filename);
+    if (sidecar != NULL && !HLIndexInternal_writeFile(sidecar, buf.data, buf.size)) {
+      HL_DEBUG1("Could not write index %s", sidecar);
+    }
+    HLHDF_FREE(sidecar);
+  }
+  if ((key = HLIndexInternal_createKey(filename, path)) != NULL) {
+    HLIndexInternal_remember(key, buf.data, buf.size);
+    buf.data = NULL;
+  }
+done:
+  HLHDF_FREE(buf.data);
+  HLHDF_FREE(filename);
+}
+
+/*@} End of Interface functions */
@@ -0,0 +1,85 @@
+/* --------------------------------------------------------------------
+Copyright (C) 2026 Swedish Meteorological and Hydrological Institute, SMHI,
+
+This file is part of HLHDF.
+
+HLHDF is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+HLHDF is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with HLHDF.  If not, see <http://www.gnu.org/licenses/>.
+------------------------------------------------------------------------*/
+
+
+/**
+ * Index of the structure of read files. When enabled, the names, types and, when known,
+ * dimensions and formats of all nodes in a file are remembered the first time the file
+ * is read so that the file does not need to be traversed again as long as it is unmodified.
+ * @file
+ * @date 2026-10-19
+ */
+#ifndef HLHDF_INDEX_H
+#define HLHDF_INDEX_H
+#include "hlhdf_types.h"
+
+/**
+ * Sets how read files should be indexed. An index is only used when the device, inode,
+ * size and modification time of the file are the same as when the index was created,
+ * so a file that is replaced by another one with the same size and time is not
+ * served from a stale index.
+ * In @ref HL_INDEX_SIDECAR mode the index is stored next to the file as filename + ".hlidx".
+ * @ingroup hlhdf_c_apis
+ * @param[in] mode the index mode, default is HL_INDEX_NONE
+ */
+void HL_setIndexMode(HL_IndexMode mode);
+
+/**
+ * Returns the index mode.
+ * @ingroup hlhdf_c_apis
+ * @return the index mode
+ */
+HL_IndexMode HL_getIndexMode(void);
+
+/**
+ * Returns the number of reads that have been served from and missed in the index
+ * since the index was last cleared.
+ * @ingroup hlhdf_c_apis
+ * @param[out] hits number of reads served from an index (may be NULL)
+ * @param[out] misses number of reads that had to traverse the file (may be NULL)
+ */
+void HL_getIndexStatistics(size_t* hits, size_t* misses);
+
+/**
+ * Removes all indexes kept in memory and resets the statistics. Sidecar files are not removed.
+ * @ingroup hlhdf_c_apis
+ */
+void HL_clearIndexCache(void);
+
+/**
+ * Writes an index for the nodelist to a file. If the nodelist has been fetched, the
+ * dimensions and formats are stored as well so that they are available after the
+ * next read without fetching. The nodelist must contain the whole file.
+ * @ingroup hlhdf_c_apis
+ * @param[in] nodelist the nodelist, must have a filename
+ * @param[in] indexfile the name of the index file, if NULL filename + ".hlidx" is used
+ * @return 1 on success, otherwise 0
+ */
+int HLNodeList_writeIndex(HL_NodeList* nodelist, const char* indexfile);
+
+/**
+ * Creates a nodelist from an index file without traversing the HDF5 file.
+ * @ingroup hlhdf_c_apis
+ * @param[in] filename the name of the HDF5 file
+ * @param[in] indexfile the name of the index file, if NULL filename + ".hlidx" is used
+ * @return the nodelist or NULL if the index does not exist, is invalid or is out of date.
+ */
+HL_NodeList* HLNodeList_readIndex(const char* filename, const char* indexfile);
+
+#endif /* HLHDF_INDEX_H */
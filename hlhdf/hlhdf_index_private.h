@@ -0,0 +1,46 @@
+/* --------------------------------------------------------------------
+Copyright (C) 2026 Swedish Meteorological and Hydrological Institute, SMHI,
+
+This file is part of HLHDF.
+
+HLHDF is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+HLHDF is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with HLHDF.  If not, see <http://www.gnu.org/licenses/>.
+------------------------------------------------------------------------*/
+
+
+/**
+ * Private functions used by the read functions to look up and store indexes.
+ * @file
+ * @date 2026-10-19
+ */
+#ifndef HLHDF_INDEX_PRIVATE_H
+#define HLHDF_INDEX_PRIVATE_H
+#include "hlhdf.h"
+
+/**
+ * Creates a nodelist from the index of a file according to the current index mode.
+ * @param[in] filename the name of the HDF5 file
+ * @param[in] fromPath the path the file is read from
+ * @return the nodelist with all nodes marked as original, or NULL if there is no valid index
+ */
+HL_NodeList* HLIndexPrivate_load(const char* filename, const char* fromPath);
+
+/**
+ * Stores the index of a nodelist that just has been read according to the current index mode.
+ * Failures are silently ignored.
+ * @param[in] nodelist the nodelist
+ * @param[in] fromPath the path the file was read from
+ */
+void HLIndexPrivate_store(HL_NodeList* nodelist, const char* fromPath);
+
+#endif /* HLHDF_INDEX_PRIVATE_H */
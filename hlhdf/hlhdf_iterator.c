@@ -0,0 +1,509 @@
+/* --------------------------------------------------------------------
+Copyright (C) 2026 Swedish Meteorological and Hydrological Institute, SMHI,
+
+This file is part of HLHDF.
+
+HLHDF is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+HLHDF is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with HLHDF.  If not, see <http://www.gnu.org/licenses/>.
+------------------------------------------------------------------------*/
+
+
+/**
+ * Iteration over datasets a block at a time.
+ * @file
+ * @date 2026-10-19
+ */
+#include "hlhdf.h"
+#include "hlhdf_alloc.h"
+#include "hlhdf_debug.h"
+#include "hlhdf_private.h"
+#include "hlhdf_defines_private.h"
+#include "hlhdf_counters_private.h"
+#include "hlhdf_nodelist_private.h"
+#include <stdlib.h>
+#include <string.h>
+#ifdef H5_HAVE_THREADSAFE
+#include <pthread.h>
+#endif
+
+/*@{ Structs */
+/**
+ * One block of a dataset.
+ */
+typedef struct HLChunkBlock_t {
+  hsize_t offset[H5S_MAX_RANK]; /**< offset of the block */
+  hsize_t count[H5S_MAX_RANK];  /**< dimensions of the block */
+  hid_t space;                  /**< file space used when selecting the block */
+  unsigned char* data;          /**< the decoded values */
+  int status;                   /**< 1 if the block has been read, 0 on failure */
+} HLChunkBlock_t;
+
+/**
+ * The chunk iterator.
+ */
+struct _HL_ChunkIterator {
+  hid_t obj;                     /**< the dataset */
+  hid_t mtype;                   /**< the memory type */
+  HL_FormatSpecifier format;     /**< the format of the memory type */
+  size_t typesize;               /**< the size of one value */
+  int rank;                      /**< the rank */
+  hsize_t dims[H5S_MAX_RANK];    /**< the dataset dimensions */
+  hsize_t block[H5S_MAX_RANK];   /**< the dimensions of a full block */
+  hsize_t next[H5S_MAX_RANK];    /**< offset of the next block to read */
+  int remaining;                 /**< 1 if there are blocks that have not been read */
+  HLChunkBlock_t blocks[2];      /**< the current block and the block read ahead */
+  int current;                   /**< index of the current block, -1 if not positioned at a block */
+  int ahead;                     /**< 1 if the other block has been or is being read */
+  int readahead;                 /**< 1 if blocks should be read ahead */
+  int threaded;                  /**< 1 if the read-ahead thread has been started */
+  H5E_auto2_t efunc;             /**< HDF5 error reporting of the creating thread */
+  void* edata;                   /**< HDF5 error reporting data of the creating thread */
+#ifdef H5_HAVE_THREADSAFE
+  pthread_t thread;              /**< the read-ahead thread, reads one block per request */
+  pthread_mutex_t lock;          /**< protects requested and stopped */
+  pthread_cond_t cond;           /**< signalled when requested or stopped changes */
+  int requested;                 /**< 1 while the thread should read the block that is not current */
+  int stopped;                   /**< 1 when the thread should exit */
+#endif
+};
+/*@} End of Structs */
+
+/*@{ Private functions */
+/**
+ * Sets the offset and dimensions of a block to the next block of the dataset and
+ * moves on to the block after that.
+ * @param[in] iterator the iterator
+ * @param[in] block the block
+ */
+static void HLIteratorInternal_prepare(HL_ChunkIterator* iterator, HLChunkBlock_t* block)
+{
+  int i;
+  for (i = 0; i < iterator->rank; i++) {
+    block->offset[i] = iterator->next[i];
+    block->count[i] = iterator->dims[i] - block->offset[i];
+    if (block->count[i] > iterator->block[i]) {
+      block->count[i] = iterator->block[i];
+    }
+  }
+  block->status = 0;
+  for (i = iterator->rank - 1; i >= 0; i--) {
+    iterator->next[i] += iterator->block[i];
+    if (iterator->next[i] < iterator->dims[i]) {
+      break;
+    }
+    iterator->next[i] = 0;
+  }
+  if (i < 0) {
+    iterator->remaining = 0;
+  }
+}
+
+/**
+ * Reads the values of a prepared block.
+ * @param[in] iterator the iterator
+ * @param[in] block the block
+ */
+static void HLIteratorInternal_read(HL_ChunkIterator* iterator, HLChunkBlock_t* block)
+{
+  hid_t m_space = -1;
+  if (iterator->rank == 0) {
+    block->status = (H5Dread(iterator->obj, iterator->mtype, H5S_ALL, H5S_ALL, H5P_DEFAULT, block->data) >= 0);
+  } else {
+    block->status = (H5Sselect_hyperslab(block->space, H5S_SELECT_SET, block->offset, NULL, block->count, NULL) >= 0 &&
+                     (m_space = H5Screate_simple(iterator->rank, block->count, NULL)) >= 0 &&
+                     H5Dread(iterator->obj, iterator->mtype, m_space, block->space, H5P_DEFAULT, block->data) >= 0);
+  }
+  if (!block->status) {
+    HL_ERROR0("Failed to read block");
+  }
+  HL_H5S_CLOSE(m_space);
+}
+
+#ifdef H5_HAVE_THREADSAFE
+/**
+ * The read-ahead thread. Reads the block that is not current each time it is
+ * requested until the iterator is released.
+ * @param[in] arg the iterator
+ * @return NULL
+ */
+static void* HLIteratorInternal_run(void* arg)
+{
+  HL_ChunkIterator* iterator = (HL_ChunkIterator*)arg;
+  H5Eset_auto2(H5E_DEFAULT, iterator->efunc, iterator->edata);
+  pthread_mutex_lock(&iterator->lock);
+  for (;;) {
+    while (!iterator->requested && !iterator->stopped) {
+      pthread_cond_wait(&iterator->cond, &iterator->lock);
+    }
+    if (!iterator->requested) {
+      break;
+    }
+    pthread_mutex_unlock(&iterator->lock);
+    HLIteratorInternal_read(iterator, &iterator->blocks[1 - iterator->current]);
+    pthread_mutex_lock(&iterator->lock);
+    iterator->requested = 0;
+    pthread_cond_broadcast(&iterator->cond);
+  }
+  pthread_mutex_unlock(&iterator->lock);
+  return NULL;
+}
+#endif
+
+/**
+ * Prepares the block that is not current and reads it, on the read-ahead thread if
+ * possible. The thread is started the first time.
+ * @param[in] iterator the iterator
+ */
+static void HLIteratorInternal_readAhead(HL_ChunkIterator* iterator)
+{
+  HLChunkBlock_t* block = &iterator->blocks[1 - iterator->current];
+  HLIteratorInternal_prepare(iterator, block);
+  iterator->ahead = 1;
+#ifdef H5_HAVE_THREADSAFE
+  if (!iterator->threaded &&
+      pthread_create(&iterator->thread, NULL, HLIteratorInternal_run, iterator) == 0) {
+    iterator->threaded = 1;
+  }
+  if (iterator->threaded) {
+    pthread_mutex_lock(&iterator->lock);
+    iterator->requested = 1;
+    pthread_cond_broadcast(&iterator->cond);
+    pthread_mutex_unlock(&iterator->lock);
+    return;
+  }
+#endif
+  HLIteratorInternal_read(iterator, block);
+}
+
+/**
+ * Waits for the block read ahead.
+ * @param[in] iterator the iterator
+ */
+static void HLIteratorInternal_wait(HL_ChunkIterator* iterator)
+{
+#ifdef H5_HAVE_THREADSAFE
+  if (iterator->threaded) {
+    pthread_mutex_lock(&iterator->lock);
+    while (iterator->requested) {
+      pthread_cond_wait(&iterator->cond, &iterator->lock);
+    }
+    pthread_mutex_unlock(&iterator->lock);
+  }
+#endif
+}
+
+/**
+ * Waits for the block read ahead and stops the read-ahead thread.
+ * @param[in] iterator the iterator
+ */
+static void HLIteratorInternal_stop(HL_ChunkIterator* iterator)
+{
+#ifdef H5_HAVE_THREADSAFE
+  if (iterator->threaded) {
+    pthread_mutex_lock(&iterator->lock);
+    iterator->stopped = 1;
+    pthread_cond_broadcast(&iterator->cond);
+    pthread_mutex_unlock(&iterator->lock);
+    pthread_join(iterator->thread, NULL);
+    iterator->threaded = 0;
+  }
+#endif
+}
+
+/**
+ * Splits a chunk dimension so that a block of the chunk is at most HLHDF_SLAB_BYTES.
+ * The block dimension is a divisor of the chunk dimension so that a block never
+ * straddles two chunks.
+ * @param[in] chunk the chunk dimension
+ * @param[in] inner the number of bytes of one step along the dimension
+ * @return the block dimension
+ */
+static hsize_t HLIteratorInternal_splitChunk(hsize_t chunk, size_t inner)
+{
+  hsize_t n = HLHDF_SLAB_BYTES / inner;
+  if (n >= chunk) {
+    return chunk;
+  }
+  while (n > 1 && chunk % n != 0) {
+    n--;
+  }
+  return (n == 0) ? 1 : n;
+}
+
+/**
+ * Sets up the block dimensions. Chunked datasets are iterated chunk by chunk, other
+ * datasets a number of whole rows at a time.
+ * @param[in] iterator the iterator
+ * @return 1 on success, otherwise 0
+ */
+static int HLIteratorInternal_setupBlocks(HL_ChunkIterator* iterator)
+{
+  hid_t dcpl = -1, dapl = -1, obj = -1;
+  hsize_t rowpoints = 1, rows = 0;
+  size_t nbytes = iterator->typesize, inner = 0, chunkbytes = 0;
+  int i, status = 0;
+
+  if (iterator->rank > 0) {
+    if ((dcpl = H5Dget_create_plist(iterator->obj)) < 0) {
+      HL_ERROR0("Failed to get dataset creation properties");
+      goto fail;
+    }
+    if (H5Pget_layout(dcpl) == H5D_CHUNKED) {
+      if (H5Pget_chunk(dcpl, iterator->rank, iterator->block) != iterator->rank) {
+        HL_ERROR0("Failed to get chunk dimensions");
+        goto fail;
+      }
+      /* Large chunks are split, along the outermost dimensions first */
+      chunkbytes = iterator->typesize;
+      for (i = 0; i < iterator->rank; i++) {
+        chunkbytes *= iterator->block[i];
+      }
+      if (chunkbytes > HLHDF_SLAB_BYTES) {
+        inner = iterator->typesize;
+        for (i = iterator->rank - 1; i > 0; i--) {
+          inner *= iterator->block[i];
+        }
+        for (i = 0; i < iterator->rank && inner * iterator->block[i] > HLHDF_SLAB_BYTES; i++) {
+          iterator->block[i] = HLIteratorInternal_splitChunk(iterator->block[i], inner);
+          if (i + 1 < iterator->rank) {
+            inner /= iterator->block[i + 1];
+          }
+        }
+        /* Reopened with a chunk cache that holds a whole chunk, otherwise each block
+         * would decompress the chunk again */
+        if ((dapl = H5Pcreate(H5P_DATASET_ACCESS)) < 0 ||
+            H5Pset_chunk_cache(dapl, H5D_CHUNK_CACHE_NSLOTS_DEFAULT, chunkbytes, H5D_CHUNK_CACHE_W0_DEFAULT) < 0 ||
+            (obj = H5Dopen(iterator->obj, ".", dapl)) < 0) {
+          HL_ERROR0("Failed to set chunk cache");
+          goto fail;
+        }
+        HL_H5D_CLOSE(iterator->obj);
+        iterator->obj = obj;
+      }
+    } else {
+      for (i = 1; i < iterator->rank; i++) {
+        rowpoints *= iterator->dims[i];
+        iterator->block[i] = iterator->dims[i];
+      }
+      rows = HLHDF_SLAB_BYTES / (rowpoints * iterator->typesize);
+      iterator->block[0] = (rows == 0) ? 1 : rows;
+    }
+    for (i = 0; i < iterator->rank; i++) {
+      if (iterator->block[i] > iterator->dims[i]) {
+        iterator->block[i] = iterator->dims[i];
+      }
+      nbytes *= iterator->block[i];
+      iterator->next[i] = 0;
+    }
+  }
+  for (i = 0; i < 2; i++) {
+    if ((iterator->blocks[i].space = H5Dget_space(iterator->obj)) < 0 ||
+        (iterator->blocks[i].data = HLHDF_MALLOC(nbytes)) == NULL) {
+      HL_ERROR0("Failed to allocate block");
+      goto fail;
+    }
+  }
+  status = 1;
+fail:
+  HL_H5P_CLOSE(dapl);
+  HL_H5P_CLOSE(dcpl);
+  return status;
+}
+
+/*@} End of Private functions */
+
+/*@{ Interface functions */
+HL_ChunkIterator* HLNodeList_iterateChunks(HL_NodeList* nodelist, const char* name, int readahead)
+{
+  HL_ChunkIterator* result = NULL;
+  HL_ChunkIterator* iterator = NULL;
+  hid_t file_id = -1, type = -1, f_space = -1;
+  char* filename = NULL;
+
+  HL_DEBUG0("ENTER: HLNodeList_iterateChunks");
+  if (nodelist == NULL || name == NULL) {
+    HL_ERROR0("Inparameters NULL");
+    goto fail;
+  }
+  if ((filename = HLNodeList_getFileName(nodelist)) == NULL) {
+    HL_ERROR0("Could not get filename from nodelist");
+    goto fail;
+  }
+  if ((iterator = HLHDF_MALLOC(sizeof(HL_ChunkIterator))) == NULL) {
+    HL_ERROR0("Failed to allocate memory for iterator");
+    goto fail;
+  }
+  memset(iterator, 0, sizeof(HL_ChunkIterator));
+  iterator->obj = iterator->mtype = -1;
+  iterator->blocks[0].space = iterator->blocks[1].space = -1;
+  iterator->current = -1;
+#ifdef H5_HAVE_THREADSAFE
+  iterator->readahead = readahead;
+  pthread_mutex_init(&iterator->lock, NULL);
+  pthread_cond_init(&iterator->cond, NULL);
+#endif
+  H5Eget_auto2(H5E_DEFAULT, &iterator->efunc, &iterator->edata);
+
+  /* The dataset keeps the file open after the file identifier has been released */
+  if ((file_id = HLNodeListPrivate_getFile(nodelist)) < 0 && (file_id = openHlHdfFile(filename, "r")) < 0) {
+    HL_ERROR1("Could not open file %s", filename);
+    goto fail;
+  }
+  if ((iterator->obj = H5Dopen(file_id, name, H5P_DEFAULT)) < 0) {
+    HL_ERROR1("Could not open dataset %s", name);
+    goto fail;
+  }
+  HL_STATS_INC(objectsOpened);
+  if ((type = H5Dget_type(iterator->obj)) < 0 || H5Tis_variable_str(type) > 0 ||
+      H5Tdetect_class(type, H5T_VLEN) > 0 || H5Tdetect_class(type, H5T_REFERENCE) > 0) {
+    HL_ERROR1("Dataset %s is not of a fixed size type", name);
+    goto fail;
+  }
+  if ((iterator->mtype = getFixedType(type)) < 0) {
+    HL_ERROR0("Failed to convert to fixed type");
+    goto fail;
+  }
+  iterator->format = HL_getFormatSpecifierFromType(iterator->mtype);
+  iterator->typesize = H5Tget_size(iterator->mtype);
+
+  if ((f_space = H5Dget_space(iterator->obj)) < 0 ||
+      (iterator->rank = H5Sget_simple_extent_ndims(f_space)) < 0 ||
+      H5Sget_simple_extent_dims(f_space, iterator->dims, NULL) < 0) {
+    HL_ERROR1("Could not get dimensions of dataset %s", name);
+    goto fail;
+  }
+  iterator->remaining = (H5Sget_simple_extent_npoints(f_space) > 0);
+  if (!HLIteratorInternal_setupBlocks(iterator)) {
+    goto fail;
+  }
+
+  result = iterator;
+  iterator = NULL;
+fail:
+  HLChunkIterator_free(iterator);
+  HLNodeListPrivate_releaseFile(nodelist, &file_id);
+  HL_H5S_CLOSE(f_space);
+  HL_H5T_CLOSE(type);
+  HLHDF_FREE(filename);
+  HL_DEBUG0("EXIT: HLNodeList_iterateChunks");
+  return result;
+}
+
+void HLChunkIterator_free(HL_ChunkIterator* iterator)
+{
+  int i;
+  if (iterator == NULL) {
+    return;
+  }
+  HLIteratorInternal_stop(iterator);
+  for (i = 0; i < 2; i++) {
+    HL_H5S_CLOSE(iterator->blocks[i].space);
+    HLHDF_FREE(iterator->blocks[i].data);
+  }
+  HL_H5T_CLOSE(iterator->mtype);
+  HL_H5D_CLOSE(iterator->obj);
+#ifdef H5_HAVE_THREADSAFE
+  pthread_mutex_destroy(&iterator->lock);
+  pthread_cond_destroy(&iterator->cond);
+#endif
+  HLHDF_FREE(iterator);
+}
+
+int HLChunkIterator_next(HL_ChunkIterator* iterator)
+{
+  HLChunkBlock_t* block = NULL;
+  hsize_t npoints = 1;
+  double start = HLCountersPrivate_now();
+  int i, status = -1;
+
+  if (iterator == NULL) {
+    HL_ERROR0("Inparameters NULL");
+    return -1;
+  }
+  if (iterator->ahead) {
+    HLIteratorInternal_wait(iterator);
+    iterator->ahead = 0;
+    iterator->current = 1 - iterator->current;
+  } else if (iterator->remaining) {
+    iterator->current = (iterator->current == 0) ? 1 : 0;
+    HLIteratorInternal_prepare(iterator, &iterator->blocks[iterator->current]);
+    HLIteratorInternal_read(iterator, &iterator->blocks[iterator->current]);
+  } else {
+    if (iterator->current >= 0) {
+      HL_STATS_INC(datasetsRead);
+      HL_STATS_ADD(rawBytesRead, H5Dget_storage_size(iterator->obj));
+    }
+    iterator->current = -1;
+    return 0;
+  }
+
+  block = &iterator->blocks[iterator->current];
+  if (!block->status) {
+    iterator->current = -1;
+    iterator->remaining = 0;
+    goto done;
+  }
+  for (i = 0; i < iterator->rank; i++) {
+    npoints *= block->count[i];
+  }
+  HL_STATS_ADD(bytesRead, npoints * iterator->typesize);
+
+  if (iterator->readahead && iterator->remaining) {
+    HLIteratorInternal_readAhead(iterator);
+  }
+  status = 1;
+done:
+  HL_STATS_ADD_TIME(fetchTime, start);
+  return status;
+}
+
+int HLChunkIterator_getRank(HL_ChunkIterator* iterator)
+{
+  return (iterator != NULL) ? iterator->rank : -1;
+}
+
+hsize_t HLChunkIterator_getOffset(HL_ChunkIterator* iterator, int index)
+{
+  if (iterator == NULL || iterator->current < 0 || index < 0 || index >= iterator->rank) {
+    return 0;
+  }
+  return iterator->blocks[iterator->current].offset[index];
+}
+
+hsize_t HLChunkIterator_getDimension(HL_ChunkIterator* iterator, int index)
+{
+  if (iterator == NULL || iterator->current < 0 || index < 0 || index >= iterator->rank) {
+    return 0;
+  }
+  return iterator->blocks[iterator->current].count[index];
+}
+
+HL_FormatSpecifier HLChunkIterator_getFormat(HL_ChunkIterator* iterator)
+{
+  return (iterator != NULL) ? iterator->format : HLHDF_UNDEFINED;
+}
+
+size_t HLChunkIterator_getDataSize(HL_ChunkIterator* iterator)
+{
+  return (iterator != NULL) ? iterator->typesize : 0;
+}
+
+unsigned char* HLChunkIterator_getData(HL_ChunkIterator* iterator)
+{
+  if (iterator == NULL || iterator->current < 0) {
+    return NULL;
+  }
+  return iterator->blocks[iterator->current].data;
+}
+
+/*@} End of Interface functions */
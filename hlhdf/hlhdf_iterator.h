@@ -0,0 +1,122 @@
+/* --------------------------------------------------------------------
+Copyright (C) 2026 Swedish Meteorological and Hydrological Institute, SMHI,
+
+This file is part of HLHDF.
+
+HLHDF is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+HLHDF is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with HLHDF.  If not, see <http://www.gnu.org/licenses/>.
+------------------------------------------------------------------------*/
+
+
+/**
+ * Iteration over datasets a block at a time so that datasets larger than the
+ * available memory can be processed.
+ * @file
+ * @date 2026-10-19
+ */
+#ifndef HLHDF_ITERATOR_H
+#define HLHDF_ITERATOR_H
+#include "hlhdf_types.h"
+
+/**
+ * Creates an iterator over the blocks of a dataset. For chunked datasets each block
+ * is one chunk of the chunk grid, clipped to the extent of the dataset. Chunks larger
+ * than 1 MB are split into equally sized blocks along their outermost dimensions, the
+ * chunk is then decompressed once and kept in the HDF5 chunk cache while its blocks are
+ * visited. Other datasets are divided into blocks of whole rows (along the first
+ * dimension) of about 1 MB. The file opened by \ref HLNodeList_open is used if the
+ * nodelist has been opened.
+ * The blocks are visited in C order of their offsets and the data is decoded and converted
+ * to the same native type as when the dataset is fetched. Only fixed size types can be iterated.
+ *
+ * With read-ahead the next block is read and decoded on a background thread while the
+ * current block is processed. The thread is started when the first block is read ahead
+ * and runs until the iterator is released. Read-ahead requires a thread-safe HDF5 library and is
+ * silently turned off otherwise.
+ * @ingroup hlhdf_c_apis
+ * @param[in] nodelist the nodelist, must have been read from a file
+ * @param[in] name the name of the dataset
+ * @param[in] readahead 1 if the next block should be read in advance, otherwise 0
+ * @return the iterator positioned before the first block (<b>caller takes ownership, release with
+ * HLChunkIterator_free</b>) or NULL on failure.
+ */
+HL_ChunkIterator* HLNodeList_iterateChunks(HL_NodeList* nodelist, const char* name, int readahead);
+
+/**
+ * Releases the iterator and closes the dataset. Waits for any read-ahead to finish and
+ * stops the read-ahead thread.
+ * @ingroup hlhdf_c_apis
+ * @param[in] iterator the iterator, may be NULL
+ */
+void HLChunkIterator_free(HL_ChunkIterator* iterator);
+
+/**
+ * Moves to the next block. The data of the previous block is overwritten.
+ * @ingroup hlhdf_c_apis
+ * @param[in] iterator the iterator
+ * @return 1 if the iterator is positioned at a new block, 0 if there are no more blocks and -1 on failure
+ */
+int HLChunkIterator_next(HL_ChunkIterator* iterator);
+
+/**
+ * Returns the rank of the dataset.
+ * @ingroup hlhdf_c_apis
+ * @param[in] iterator the iterator
+ * @return the rank
+ */
+int HLChunkIterator_getRank(HL_ChunkIterator* iterator);
+
+/**
+ * Returns the offset of the current block in the dataset.
+ * @ingroup hlhdf_c_apis
+ * @param[in] iterator the iterator
+ * @param[in] index the dimension index
+ * @return the offset along the specified dimension (If index < 0 or >= the rank then 0 is returned).
+ */
+hsize_t HLChunkIterator_getOffset(HL_ChunkIterator* iterator, int index);
+
+/**
+ * Returns the dimension of the current block.
+ * @ingroup hlhdf_c_apis
+ * @param[in] iterator the iterator
+ * @param[in] index the dimension index
+ * @return the size along the specified dimension (If index < 0 or >= the rank then 0 is returned).
+ */
+hsize_t HLChunkIterator_getDimension(HL_ChunkIterator* iterator, int index);
+
+/**
+ * Returns the format of the data.
+ * @ingroup hlhdf_c_apis
+ * @param[in] iterator the iterator
+ * @return the format specifier
+ */
+HL_FormatSpecifier HLChunkIterator_getFormat(HL_ChunkIterator* iterator);
+
+/**
+ * Returns the size of one value.
+ * @ingroup hlhdf_c_apis
+ * @param[in] iterator the iterator
+ * @return the type size
+ */
+size_t HLChunkIterator_getDataSize(HL_ChunkIterator* iterator);
+
+/**
+ * Returns the data of the current block, packed in C order with the dimensions of the block.
+ * @ingroup hlhdf_c_apis
+ * @param[in] iterator the iterator
+ * @return the data (<b>Do not release, the buffer is reused by the next call to HLChunkIterator_next</b>)
+ * or NULL if the iterator is not positioned at a block.
+ */
+unsigned char* HLChunkIterator_getData(HL_ChunkIterator* iterator);
+
+#endif /* HLHDF_ITERATOR_H */
@@ -28,6 +28,8 @@ along with HLHDF.  If not, see <http://www.gnu.org/licenses/>.
 #include "hlhdf_private.h"
 #include "hlhdf_defines_private.h"
 #include "hlhdf_node_private.h"
+#include "hlhdf_cache_private.h"
+#include "hlhdf_compound_private.h"
 #include "hlhdf_debug.h"
 #include <string.h>
 #include <stdlib.h>
@@ -46,6 +48,7 @@ struct _HL_Node {
    unsigned char* rawdata;     /**< Unconverted data, exactly as read from the file */
    HL_FormatSpecifier format;  /**< @ref ValidFormatSpecifiers "Format specifier" */
    hid_t typeId;               /**< HDF5 type identifier */
+   int sharedTypeId;           /**< 1 if typeId is a reference to a shared type that must not be modified */
    size_t dSize;               /**< Size for data (fixed type) */
    size_t rdSize;              /**< Size for rawdata */
    HL_DataType dataType;       /**< Type of data */
@@ -54,6 +57,15 @@ struct _HL_Node {
    int fetched;                /**< 0 if the data has not been fetched from disk, otherwise 0 */
    HL_CompoundTypeDescription* compoundDescription; /**< The compound type description if this is a TYPE node*/
    HL_Compression* compression; /**< Compression settings for this node */
+   int evictable;              /**< 1 if the data may be released when the memory budget is exceeded */
+   int evicted;                /**< 1 if the data has been released due to the memory budget */
+   HL_SharedBuffer* sharedData;    /**< Set when data is shared with the data cache or memory mapped, copied on write */
+   HL_SharedBuffer* sharedRawdata; /**< Set when rawdata is shared with the data cache, copied on write */
+   HL_StatisticsOptions* statisticsOptions; /**< Statistics to compute when the data is read, NULL if none */
+   HL_Statistics* statistics;  /**< Statistics of the current data, NULL if not computed */
+   hsize_t inlineDims[HLNODE_INLINE_RANK];               /**< Storage for dims when the rank is small enough */
+   unsigned char inlineData[HLNODE_INLINE_DATA_SIZE];    /**< Storage for data when it is small enough */
+   unsigned char inlineRawdata[HLNODE_INLINE_DATA_SIZE]; /**< Storage for rawdata when it is small enough */
 };
 
 /*@{ End of Structs */
@@ -87,13 +99,122 @@ static hid_t HLNode_createStringType(size_t length)
 }
 
 
+/**
+ * Releases a data buffer unless it is pointing at the inline storage. If the
+ * buffer is shared, the reference is released instead.
+ * @param[in,out] ptr the buffer pointer, will be set to NULL
+ * @param[in] inlinebuf the inline storage that should not be released
+ * @param[in,out] shared the shared buffer if any, will be set to NULL
+ * @return 1 if the memory was freed, 0 if nothing was freed or other references remain
+ */
+static int HLNodeInternal_releaseBuffer(unsigned char** ptr, unsigned char* inlinebuf, HL_SharedBuffer** shared)
+{
+  int freed = 0;
+  if (*shared != NULL) {
+    freed = HLSharedBuffer_release(*shared);
+    *shared = NULL;
+  } else if (*ptr != NULL && *ptr != inlinebuf) {
+    HLHDF_FREE(*ptr);
+    freed = 1;
+  }
+  *ptr = NULL;
+  return freed;
+}
+
+/**
+ * Copies nbytes from src into either the inline storage, if it fits, or into a
+ * newly allocated buffer. The inline storage is only overwritten on success.
+ * @param[in] current the buffer currently in use (will be released unless same as result)
+ * @param[in] inlinebuf the inline storage
+ * @param[in,out] shared the shared buffer for current if any
+ * @param[in] src the bytes to copy, may point into the current buffer
+ * @param[in] nbytes the number of bytes to copy
+ * @param[out] result the new buffer
+ * @return 1 on success, otherwise 0
+ */
+static int HLNodeInternal_storeBuffer(unsigned char* current, unsigned char* inlinebuf,
+  HL_SharedBuffer** shared, const unsigned char* src, size_t nbytes, unsigned char** result)
+{
+  unsigned char* buf = NULL;
+  if (nbytes <= HLNODE_INLINE_DATA_SIZE) {
+    if (src != NULL && nbytes > 0) {
+      memmove(inlinebuf, src, nbytes);
+    }
+    buf = inlinebuf;
+  } else {
+    if ((buf = (unsigned char*)HLHDF_MALLOC(nbytes)) == NULL) {
+      HL_ERROR0("Failed to allocate memory");
+      return 0;
+    }
+    if (src != NULL) {
+      memcpy(buf, src, nbytes);
+    }
+  }
+  if (current != buf) {
+    HLNodeInternal_releaseBuffer(&current, inlinebuf, shared);
+  }
+  *result = buf;
+  return 1;
+}
+
+/**
+ * Gives the node a private copy of a buffer that is referred to by someone else, so that
+ * it can be modified without affecting the data cache or other nodes.
+ * @param[in,out] ptr the buffer pointer
+ * @param[in] inlinebuf the inline storage
+ * @param[in,out] shared the shared buffer if any, set to NULL when copied
+ * @return 1 on success, otherwise 0
+ */
+static int HLNodeInternal_unshare(unsigned char** ptr, unsigned char* inlinebuf, HL_SharedBuffer** shared)
+{
+  if (*shared == NULL || HLSharedBuffer_isExclusive(*shared)) {
+    return 1;
+  }
+  return HLNodeInternal_storeBuffer(*ptr, inlinebuf, shared, HLSharedBuffer_getData(*shared),
+                                    HLSharedBuffer_getSize(*shared), ptr);
+}
+
+/**
+ * Gives the node a private copy of its compound description if the description is
+ * held by other nodes or the data cache, or can be looked up by other nodelists.
+ * The copy is never registered for sharing.
+ * @param[in] node the node
+ * @return 1 on success, otherwise 0
+ */
+static int HLNodeInternal_unshareCompoundDescription(HL_Node* node)
+{
+  HL_CompoundTypeDescription* descr = NULL;
+  if (node->compoundDescription == NULL || !HLCompoundPrivate_isShared(node->compoundDescription)) {
+    return 1;
+  }
+  if ((descr = copyHL_CompoundTypeDescription(node->compoundDescription)) == NULL) {
+    HL_ERROR1("Failed to copy compound description for %s", node->name);
+    return 0;
+  }
+  freeHL_CompoundTypeDescription(node->compoundDescription);
+  node->compoundDescription = descr;
+  return 1;
+}
+
 /*@} End of Static functions */
 
 /*@{ Private functions */
+void HLNodePrivate_setStatistics(HL_Node* node, HL_Statistics* stats)
+{
+  HL_ASSERT((node != NULL), "node was NULL");
+  if (stats != node->statistics) {
+    HLStatistics_free(node->statistics);
+    node->statistics = stats;
+  }
+}
+
 void HLNodePrivate_setData(HL_Node* node, size_t datasize, unsigned char* data)
 {
   HL_ASSERT((node != NULL), "node was NULL");
-  HLHDF_FREE(node->data);
+  HLNodePrivate_setStatistics(node, NULL);
+  if (data != node->data) {
+    HLNodeInternal_releaseBuffer(&node->data, node->inlineData, &node->sharedData);
+  }
   node->data = data;
   node->dSize = datasize;
 }
@@ -101,11 +222,129 @@ void HLNodePrivate_setData(HL_Node* node, size_t datasize, unsigned char* data)
 void HLNodePrivate_setRawdata(HL_Node* node, size_t datasize, unsigned char* data)
 {
   HL_ASSERT((node != NULL), "node was NULL");
-  HLHDF_FREE(node->rawdata);
+  if (data != node->rawdata) {
+    HLNodeInternal_releaseBuffer(&node->rawdata, node->inlineRawdata, &node->sharedRawdata);
+  }
   node->rawdata = data;
   node->rdSize = datasize;
 }
 
+int HLNodePrivate_copyData(HL_Node* node, size_t datasize, size_t nbytes, const unsigned char* data)
+{
+  HL_ASSERT((node != NULL), "node was NULL");
+  HLNodePrivate_setStatistics(node, NULL);
+  if (!HLNodeInternal_storeBuffer(node->data, node->inlineData, &node->sharedData, data, nbytes, &node->data)) {
+    return 0;
+  }
+  node->dSize = datasize;
+  return 1;
+}
+
+int HLNodePrivate_copyRawdata(HL_Node* node, size_t datasize, size_t nbytes, const unsigned char* data)
+{
+  HL_ASSERT((node != NULL), "node was NULL");
+  if (!HLNodeInternal_storeBuffer(node->rawdata, node->inlineRawdata, &node->sharedRawdata, data, nbytes, &node->rawdata)) {
+    return 0;
+  }
+  node->rdSize = datasize;
+  return 1;
+}
+
+/**
+ * Returns a new reference to a shared buffer holding the bytes in *ptr. If the data
+ * is not shared already, heap data is handed over to a new shared buffer and inline
+ * data is copied.
+ */
+static HL_SharedBuffer* HLNodeInternal_share(unsigned char** ptr, unsigned char* inlinebuf,
+  HL_SharedBuffer** shared, size_t nbytes)
+{
+  if (*ptr == NULL) {
+    return NULL;
+  }
+  if (*shared == NULL) {
+    if (*ptr == inlinebuf) {
+      unsigned char* copy = NULL;
+      HL_SharedBuffer* result = NULL;
+      if ((copy = HLHDF_MALLOC(nbytes > 0 ? nbytes : 1)) == NULL) {
+        HL_ERROR0("Failed to allocate memory");
+        return NULL;
+      }
+      memcpy(copy, *ptr, nbytes);
+      if ((result = HLSharedBuffer_adopt(copy, nbytes)) == NULL) {
+        HLHDF_FREE(copy);
+      }
+      return result;
+    }
+    if ((*shared = HLSharedBuffer_adopt(*ptr, nbytes)) == NULL) {
+      return NULL;
+    }
+  }
+  return HLSharedBuffer_ref(*shared);
+}
+
+/**
+ * Lets the node refer to the shared buffer. Small values are copied into the node.
+ */
+static int HLNodeInternal_setShared(unsigned char** ptr, unsigned char* inlinebuf,
+  HL_SharedBuffer** shared, HL_SharedBuffer* buffer)
+{
+  if (HLSharedBuffer_getSize(buffer) <= HLNODE_INLINE_DATA_SIZE) {
+    return HLNodeInternal_storeBuffer(*ptr, inlinebuf, shared, HLSharedBuffer_getData(buffer),
+                                      HLSharedBuffer_getSize(buffer), ptr);
+  }
+  HLSharedBuffer_ref(buffer);
+  HLNodeInternal_releaseBuffer(ptr, inlinebuf, shared);
+  *shared = buffer;
+  *ptr = HLSharedBuffer_getData(buffer);
+  return 1;
+}
+
+int HLNodePrivate_detach(HL_Node* node)
+{
+  HL_ASSERT((node != NULL), "node was NULL");
+  if (!HLNodeInternal_unshare(&node->data, node->inlineData, &node->sharedData) ||
+      !HLNodeInternal_unshare(&node->rawdata, node->inlineRawdata, &node->sharedRawdata)) {
+    HL_ERROR1("Failed to copy shared data for %s", node->name);
+    return 0;
+  }
+  return HLNodeInternal_unshareCompoundDescription(node);
+}
+
+HL_SharedBuffer* HLNodePrivate_shareData(HL_Node* node)
+{
+  HL_ASSERT((node != NULL), "node was NULL");
+  return HLNodeInternal_share(&node->data, node->inlineData, &node->sharedData,
+                              HLNode_getNumberOfPoints(node) * node->dSize);
+}
+
+HL_SharedBuffer* HLNodePrivate_shareRawdata(HL_Node* node)
+{
+  HL_ASSERT((node != NULL), "node was NULL");
+  return HLNodeInternal_share(&node->rawdata, node->inlineRawdata, &node->sharedRawdata,
+                              HLNode_getNumberOfPoints(node) * node->rdSize);
+}
+
+int HLNodePrivate_setSharedData(HL_Node* node, size_t datasize, HL_SharedBuffer* buffer)
+{
+  HL_ASSERT((node != NULL && buffer != NULL), "node or buffer was NULL");
+  HLNodePrivate_setStatistics(node, NULL);
+  if (!HLNodeInternal_setShared(&node->data, node->inlineData, &node->sharedData, buffer)) {
+    return 0;
+  }
+  node->dSize = datasize;
+  return 1;
+}
+
+int HLNodePrivate_setSharedRawdata(HL_Node* node, size_t datasize, HL_SharedBuffer* buffer)
+{
+  HL_ASSERT((node != NULL && buffer != NULL), "node or buffer was NULL");
+  if (!HLNodeInternal_setShared(&node->rawdata, node->inlineRawdata, &node->sharedRawdata, buffer)) {
+    return 0;
+  }
+  node->rdSize = datasize;
+  return 1;
+}
+
 int HLNodePrivate_setTypeIdAndDeriveFormat(HL_Node* node, hid_t type)
 {
   hid_t tcopy = -1;
@@ -121,6 +360,7 @@ int HLNodePrivate_setTypeIdAndDeriveFormat(HL_Node* node, hid_t type)
 
   HL_H5T_CLOSE(node->typeId)
   node->typeId = tcopy;
+  node->sharedTypeId = 0;
   node->format = format;
   return 1;
 fail:
@@ -128,6 +368,20 @@ fail:
   return 0;
 }
 
+int HLNodePrivate_setSharedTypeId(HL_Node* node, hid_t type, HL_FormatSpecifier format)
+{
+  HL_ASSERT((node != NULL), "node was NULL");
+  if (format == HLHDF_UNDEFINED || H5Iinc_ref(type) < 0) {
+    HL_ERROR0("Could not set shared type");
+    return 0;
+  }
+  HL_H5T_CLOSE(node->typeId)
+  node->typeId = type;
+  node->sharedTypeId = 1;
+  node->format = format;
+  return 1;
+}
+
 void HLNodePrivate_setHdfID(HL_Node* node, hid_t hdfid)
 {
   HL_ASSERT((node != NULL), "HLNodePrivate_setHdfID called with node == NULL");
@@ -173,6 +427,30 @@ hid_t HLNodePrivate_getTypeId(HL_Node* node)
   HL_ASSERT((node != NULL), "HLNodePrivate_getDims called with node == NULL");
   return node->typeId;
 }
+
+void HLNodePrivate_setFormat(HL_Node* node, HL_FormatSpecifier format)
+{
+  HL_ASSERT((node != NULL), "HLNodePrivate_setFormat called with node == NULL");
+  node->format = format;
+}
+
+size_t HLNodePrivate_evict(HL_Node* node)
+{
+  size_t released = 0;
+  hsize_t npts = 0;
+  HL_ASSERT((node != NULL), "HLNodePrivate_evict called with node == NULL");
+  npts = HLNode_getNumberOfPoints(node);
+  /* Buffers still referenced by the cache or another node are not freed */
+  if (HLNodeInternal_releaseBuffer(&node->data, node->inlineData, &node->sharedData)) {
+    released += npts * node->dSize;
+  }
+  if (HLNodeInternal_releaseBuffer(&node->rawdata, node->inlineRawdata, &node->sharedRawdata)) {
+    released += npts * node->rdSize;
+  }
+  node->fetched = 0;
+  node->evicted = 1;
+  return released;
+}
 /*@} End of Private functions */
 
 /*@{ Interface functions */
@@ -197,6 +475,7 @@ HL_Node* HLNode_new(const char* name)
   retv->data = NULL;
   retv->rawdata = NULL;
   retv->typeId = -1;
+  retv->sharedTypeId = 0;
   retv->dSize = 0;
   retv->rdSize = 0;
   retv->dataType = DTYPE_UNDEFINED_ID;
@@ -205,6 +484,12 @@ HL_Node* HLNode_new(const char* name)
   retv->fetched = 0;
   retv->compoundDescription = NULL;
   retv->compression = NULL;
+  retv->evictable = 0;
+  retv->evicted = 0;
+  retv->sharedData = NULL;
+  retv->sharedRawdata = NULL;
+  retv->statisticsOptions = NULL;
+  retv->statistics = NULL;
 
   if (retv->name == NULL) {
     HL_ERROR0("Could not allocate memory when creating node");
@@ -233,11 +518,15 @@ void HLNode_free(HL_Node* node)
   HLNodePrivate_setHdfID(node, -1);
 
   HLHDF_FREE(node->name);
-  HLHDF_FREE(node->dims);
-  HLHDF_FREE(node->data);
-  HLHDF_FREE(node->rawdata);
+  if (node->dims != node->inlineDims) {
+    HLHDF_FREE(node->dims);
+  }
+  HLNodeInternal_releaseBuffer(&node->data, node->inlineData, &node->sharedData);
+  HLNodeInternal_releaseBuffer(&node->rawdata, node->inlineRawdata, &node->sharedRawdata);
   freeHL_CompoundTypeDescription(node->compoundDescription);
   HLCompression_free(node->compression);
+  HLHDF_FREE(node->statisticsOptions);
+  HLStatistics_free(node->statistics);
   HLHDF_FREE(node);
 }
 
@@ -278,46 +567,59 @@ HL_Node* HLNode_copy(HL_Node* node)
   if (retv == NULL) {
     goto fail;
   }
-  if (!HLNode_setDimensions(retv, node->ndims, node->dims)) {
-    goto fail;
-  }
   retv->type = node->type;
-  retv->dSize = node->dSize;
-  retv->rdSize = node->rdSize;
   if(!HLNode_setDimensions(retv, node->ndims, node->dims)) {
     goto fail;
   }
   npts = HLNode_getNumberOfPoints(retv);
 
-  retv->data = (unsigned char*)HLHDF_MALLOC(npts*retv->dSize);
-  memcpy(retv->data,node->data,npts*retv->dSize);
+  if (node->data != NULL) {
+    if (!HLNodePrivate_copyData(retv, node->dSize, npts*node->dSize, node->data)) {
+      goto fail;
+    }
+  } else {
+    retv->dSize = node->dSize;
+  }
 
   if(node->rawdata!=NULL) {
-    retv->rawdata = (unsigned char*)HLHDF_MALLOC(npts*retv->rdSize);
-    memcpy(retv->rawdata,node->rawdata,npts*retv->rdSize);
-  } else {
-    retv->rdSize = 0;
-    retv->rawdata = NULL;
+    if (!HLNodePrivate_copyRawdata(retv, node->rdSize, npts*node->rdSize, node->rawdata)) {
+      goto fail;
+    }
   }
   retv->format = node->format;
 
-  if(node->typeId>=0) {
+  if (node->typeId >= 0 && node->sharedTypeId) {
+    if (H5Iinc_ref(node->typeId) >= 0) {
+      retv->typeId = node->typeId;
+      retv->sharedTypeId = 1;
+    }
+  } else if(node->typeId>=0) {
     retv->typeId=H5Tcopy(node->typeId);
   }
   retv->dataType=node->dataType;
   retv->hdfId=-1; //node->hdfId;
   retv->mark=node->mark;
 
-  retv->compoundDescription=copyHL_CompoundTypeDescription(node->compoundDescription);
+  retv->compoundDescription=HLCompoundPrivate_ref(node->compoundDescription);
+
+  if (node->statisticsOptions != NULL && !HLNode_setStatisticsOptions(retv, node->statisticsOptions)) {
+    goto fail;
+  }
+  if (node->statistics != NULL) {
+    if ((retv->statistics = HLStatistics_clone(node->statistics)) == NULL) {
+      goto fail;
+    }
+  }
 
-fail:
   return retv;
+fail:
+  HLNode_free(retv);
+  return NULL;
 }
 
 int HLNode_setScalarValue(HL_Node* node, size_t sz, unsigned char* value,
   const char* fmt, hid_t typid)
 {
-  unsigned char* data = NULL;
   hid_t tmptypeid = -1;
   HL_FormatSpecifier format = HLHDF_UNDEFINED;
   int status = 0;
@@ -331,12 +633,6 @@ int HLNode_setScalarValue(HL_Node* node, size_t sz, unsigned char* value,
     goto fail;
   }
 
-  if ((data = (unsigned char*) HLHDF_MALLOC(sz))==NULL) {
-    HL_ERROR0("Failed to allocate memory");
-    goto fail;
-  }
-  memcpy(data, value, sz);
-
   if (format == HLHDF_STRING && typid < 0) {
     tmptypeid = HLNode_createStringType(sz);
     if (tmptypeid < 0) {
@@ -354,13 +650,15 @@ int HLNode_setScalarValue(HL_Node* node, size_t sz, unsigned char* value,
     }
   }
 
-  HLHDF_FREE(node->data);
+  if (!HLNodePrivate_copyData(node, sz, sz, value)) {
+    HL_ERROR0("Failed to allocate memory");
+    goto fail;
+  }
+
   HL_H5T_CLOSE(node->typeId);
-  node->data = data;
   node->format = format;
-  node->dSize = sz;
   node->typeId = tmptypeid;
-  data = NULL;
+  node->sharedTypeId = 0;
   tmptypeid = -1;
   node->dataType = HL_SIMPLE;
   if (node->mark != NMARK_CREATED)
@@ -368,7 +666,6 @@ int HLNode_setScalarValue(HL_Node* node, size_t sz, unsigned char* value,
 
   status = 1;
 fail:
-  HLHDF_FREE(data);
   HL_H5T_CLOSE(tmptypeid);
   return status;
 }
@@ -378,7 +675,6 @@ int HLNode_setArrayValue(HL_Node* node, size_t sz, int ndims, hsize_t* dims,
 {
   int i;
   size_t npts = 0;
-  unsigned char* data = NULL;
   HL_FormatSpecifier format = HLHDF_UNDEFINED;
   hid_t tmptypeid = -1;
   int status = 0;
@@ -399,12 +695,6 @@ int HLNode_setArrayValue(HL_Node* node, size_t sz, int ndims, hsize_t* dims,
     npts *= dims[i];
   }
 
-  if ((data = (unsigned char*) HLHDF_MALLOC(npts * sz)) == NULL) {
-    HL_ERROR0("Failed to allocate memory when setting value");
-    goto fail;
-  }
-  memcpy(data, value, npts * sz);
-
   if (format == HLHDF_STRING && typid < 0) {
     tmptypeid = HLNode_createStringType(sz);
     if (tmptypeid < 0) {
@@ -422,18 +712,20 @@ int HLNode_setArrayValue(HL_Node* node, size_t sz, int ndims, hsize_t* dims,
     }
   }
 
+  if (!HLNodePrivate_copyData(node, sz, npts * sz, value)) {
+    HL_ERROR0("Failed to allocate memory when setting value");
+    goto fail;
+  }
+
   if (!HLNode_setDimensions(node, ndims, dims)) {
     HL_ERROR0("Failed to set dimensions");
     goto fail;
   }
 
-  HLHDF_FREE(node->data);
   HL_H5T_CLOSE(node->typeId);
-  node->data = data;
   node->format = format;
-  node->dSize = sz;
   node->typeId = tmptypeid;
-  data = NULL;
+  node->sharedTypeId = 0;
   tmptypeid = -1;
 
   node->dataType = HL_ARRAY;
@@ -443,7 +735,6 @@ int HLNode_setArrayValue(HL_Node* node, size_t sz, int ndims, hsize_t* dims,
 
   status = 1;
 fail:
-  HLHDF_FREE(data);
   HL_H5T_CLOSE(tmptypeid);
   return status;
 }
@@ -457,6 +748,16 @@ const char* HLNode_getName(HL_Node* node)
 unsigned char* HLNode_getData(HL_Node* node)
 {
   HL_ASSERT((node != NULL), "HLNode_getData called with node == NULL");
+  if (!HLNodeInternal_unshare(&node->data, node->inlineData, &node->sharedData)) {
+    HL_ERROR1("Failed to copy shared data for %s", node->name);
+    return NULL;
+  }
+  return node->data;
+}
+
+const unsigned char* HLNode_getConstData(HL_Node* node)
+{
+  HL_ASSERT((node != NULL), "HLNode_getConstData called with node == NULL");
   return node->data;
 }
 
@@ -469,6 +770,16 @@ size_t HLNode_getDataSize(HL_Node* node)
 unsigned char* HLNode_getRawdata(HL_Node* node)
 {
   HL_ASSERT((node != NULL), "HLNode_getRawdata called with node == NULL");
+  if (!HLNodeInternal_unshare(&node->rawdata, node->inlineRawdata, &node->sharedRawdata)) {
+    HL_ERROR1("Failed to copy shared rawdata for %s", node->name);
+    return NULL;
+  }
+  return node->rawdata;
+}
+
+const unsigned char* HLNode_getConstRawdata(HL_Node* node)
+{
+  HL_ASSERT((node != NULL), "HLNode_getConstRawdata called with node == NULL");
   return node->rawdata;
 }
 
@@ -511,6 +822,9 @@ void HLNode_setFetched(HL_Node* node, int fetched)
 {
   HL_ASSERT((node != NULL), "HLNode_fetched called with node == NULL");
   node->fetched = fetched;
+  if (fetched) {
+    node->evicted = 0;
+  }
 }
 
 HL_Type HLNode_getType(HL_Node* node)
@@ -551,22 +865,27 @@ int HLNode_setDimensions(HL_Node* node, int ndims, hsize_t* dims)
   int status = 0;
 
   if (ndims > 0 && dims != NULL) {
-    tmpdims = (hsize_t*)HLHDF_MALLOC(sizeof(hsize_t)*ndims);
-    if (tmpdims != NULL) {
-      memcpy(tmpdims, dims, sizeof(hsize_t)*ndims);
+    if (ndims <= HLNODE_INLINE_RANK) {
+      memmove(node->inlineDims, dims, sizeof(hsize_t)*ndims);
+      tmpdims = node->inlineDims;
     } else {
-      HL_ERROR0("Failed to allocate memory for dimensions");
-      goto fail;
+      tmpdims = (hsize_t*)HLHDF_MALLOC(sizeof(hsize_t)*ndims);
+      if (tmpdims != NULL) {
+        memcpy(tmpdims, dims, sizeof(hsize_t)*ndims);
+      } else {
+        HL_ERROR0("Failed to allocate memory for dimensions");
+        goto fail;
+      }
     }
   }
 
-  HLHDF_FREE(node->dims);
+  if (node->dims != node->inlineDims && node->dims != tmpdims) {
+    HLHDF_FREE(node->dims);
+  }
   node->dims = tmpdims;
   node->ndims = ndims;
-  tmpdims = NULL;
   status = 1;
 fail:
-  HLHDF_FREE(tmpdims);
   return status;
 }
 
@@ -633,9 +952,55 @@ void HLNode_setCompoundDescription(HL_Node* node, HL_CompoundTypeDescription* de
 HL_CompoundTypeDescription* HLNode_getCompoundDescription(HL_Node* node)
 {
   HL_ASSERT((node != NULL), "HLNode_getCompoundDescription called with node == NULL");
+  if (!HLNodeInternal_unshareCompoundDescription(node)) {
+    return NULL;
+  }
   return node->compoundDescription;
 }
 
+const HL_CompoundTypeDescription* HLNode_getConstCompoundDescription(HL_Node* node)
+{
+  HL_ASSERT((node != NULL), "HLNode_getConstCompoundDescription called with node == NULL");
+  return node->compoundDescription;
+}
+
+int HLNode_getCompoundMemberColumn(HL_Node* node, const char* member, void* out)
+{
+  const HL_CompoundTypeAttribute* attr = NULL;
+  const unsigned char* data = NULL;
+  unsigned char* column = (unsigned char*)out;
+  hsize_t npoints = 0, i = 0;
+  size_t nbytes = 0;
+  int j = 0;
+
+  HL_ASSERT((node != NULL), "HLNode_getCompoundMemberColumn called with node == NULL");
+  HL_ASSERT((member != NULL), "HLNode_getCompoundMemberColumn called with member == NULL");
+  HL_ASSERT((out != NULL), "HLNode_getCompoundMemberColumn called with out == NULL");
+
+  if ((attr = findHL_CompoundTypeAttribute(node->compoundDescription, member)) == NULL) {
+    HL_ERROR2("Node %s has no compound member named %s", node->name, member);
+    return 0;
+  }
+  if ((data = node->data) == NULL) {
+    HL_ERROR1("Node %s has not been fetched", node->name);
+    return 0;
+  }
+  nbytes = attr->size;
+  for (j = 0; j < attr->ndims; j++) {
+    nbytes *= attr->dims[j];
+  }
+  if (attr->offset + nbytes > node->dSize) {
+    HL_ERROR1("Compound member %s does not fit in the node data size", member);
+    return 0;
+  }
+
+  npoints = HLNode_getNumberOfPoints(node);
+  for (i = 0; i < npoints; i++) {
+    memcpy(column + i * nbytes, data + i * node->dSize + attr->offset, nbytes);
+  }
+  return 1;
+}
+
 HL_Compression* HLNode_getCompression(HL_Node* node)
 {
   HL_ASSERT((node != NULL), "HLNode_getCompression called with node == NULL");
@@ -655,3 +1020,79 @@ int HLNode_commitType(HL_Node* node, hid_t thid)
   HLNodePrivate_setHdfID(node, H5Tcopy(thid));
   return 1;
 }
+
+void HLNode_setEvictable(HL_Node* node, int evictable)
+{
+  HL_ASSERT((node != NULL), "HLNode_setEvictable called with node == NULL");
+  node->evictable = evictable ? 1 : 0;
+}
+
+int HLNode_isEvictable(HL_Node* node)
+{
+  HL_ASSERT((node != NULL), "HLNode_isEvictable called with node == NULL");
+  return node->evictable;
+}
+
+int HLNode_isEvicted(HL_Node* node)
+{
+  HL_ASSERT((node != NULL), "HLNode_isEvicted called with node == NULL");
+  return node->evicted;
+}
+
+int HLNode_setStatisticsOptions(HL_Node* node, const HL_StatisticsOptions* options)
+{
+  HL_StatisticsOptions* copy = NULL;
+  HL_ASSERT((node != NULL), "HLNode_setStatisticsOptions called with node == NULL");
+  if (options != NULL) {
+    if ((copy = HLHDF_MALLOC(sizeof(HL_StatisticsOptions))) == NULL) {
+      HL_ERROR0("Failed to allocate memory for statistics options");
+      return 0;
+    }
+    *copy = *options;
+  }
+  HLHDF_FREE(node->statisticsOptions);
+  node->statisticsOptions = copy;
+  return 1;
+}
+
+const HL_StatisticsOptions* HLNode_getStatisticsOptions(HL_Node* node)
+{
+  HL_ASSERT((node != NULL), "HLNode_getStatisticsOptions called with node == NULL");
+  return node->statisticsOptions;
+}
+
+const HL_Statistics* HLNode_getStatistics(HL_Node* node)
+{
+  HL_ASSERT((node != NULL), "HLNode_getStatistics called with node == NULL");
+  return node->statistics;
+}
+
+void HLNode_getMemoryUsage(HL_Node* node, HL_MemoryUsage* usage)
+{
+  hsize_t npts = 0;
+  HL_ASSERT((node != NULL), "HLNode_getMemoryUsage called with node == NULL");
+  HL_ASSERT((usage != NULL), "HLNode_getMemoryUsage called with usage == NULL");
+  memset(usage, 0, sizeof(HL_MemoryUsage));
+
+  npts = HLNode_getNumberOfPoints(node);
+  usage->other = sizeof(HL_Node);
+  if (node->data != NULL && node->data != node->inlineData) {
+    usage->data = npts * node->dSize;
+  }
+  if (node->rawdata != NULL && node->rawdata != node->inlineRawdata) {
+    usage->rawdata = npts * node->rdSize;
+  }
+  if (node->name != NULL) {
+    usage->names = strlen(node->name) + 1;
+  }
+  if (node->dims != NULL && node->dims != node->inlineDims) {
+    usage->other += sizeof(hsize_t) * node->ndims;
+  }
+  if (node->compoundDescription != NULL) {
+    usage->compound = HLCompoundPrivate_getMemoryUsage(node->compoundDescription);
+  }
+  if (node->compression != NULL) {
+    usage->other += sizeof(HL_Compression);
+  }
+  usage->total = usage->data + usage->rawdata + usage->names + usage->compound + usage->other;
+}
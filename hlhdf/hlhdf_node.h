@@ -125,12 +125,23 @@ int HLNode_setArrayValue(HL_Node* node,size_t sz,int ndims,hsize_t* dims,unsigne
 const char* HLNode_getName(HL_Node* node);
 
 /**
- * Returns the internal data pointer for this node.
+ * Returns the internal data pointer for this node. If the data is shared with the
+ * data cache or another node, the node first gets a private copy so that the
+ * returned data can be modified. Use @ref HLNode_getConstData when the data only is read.
  * @param[in] node the node
  * @return the internal data (<b>Do not release and be careful so that the node does not change when holding the data pointer.</b>).
  */
 unsigned char* HLNode_getData(HL_Node* node);
 
+/**
+ * Returns the data of this node without copying it, even if it is shared with the
+ * data cache, another node or a memory mapped file.
+ * @ingroup hlhdf_c_apis
+ * @param[in] node the node
+ * @return the internal data (<b>Must not be modified or released and is only valid as long as the node data is not changed.</b>).
+ */
+const unsigned char* HLNode_getConstData(HL_Node* node);
+
 /**
  * Returns the type size for the data format.
  * @param[in] node the node
@@ -139,12 +150,21 @@ unsigned char* HLNode_getData(HL_Node* node);
 size_t HLNode_getDataSize(HL_Node* node);
 
 /**
- * Returns the internal rawdata pointer for this node.
+ * Returns the internal rawdata pointer for this node. Shared rawdata is copied like
+ * in @ref HLNode_getData.
  * @param[in] node the node
  * @return the internal data (<b>Do not release and be careful so that the node does not change when holding the data pointer.</b>).
  */
 unsigned char* HLNode_getRawdata(HL_Node* node);
 
+/**
+ * Same as @ref HLNode_getConstData but for the rawdata.
+ * @ingroup hlhdf_c_apis
+ * @param[in] node the node
+ * @return the internal rawdata (<b>Must not be modified or released and is only valid as long as the node data is not changed.</b>).
+ */
+const unsigned char* HLNode_getConstRawdata(HL_Node* node);
+
 /**
  * Returns the type size for the raw data format.
  * @param[in] node the node
@@ -276,12 +296,36 @@ hsize_t HLNode_getNumberOfPoints(HL_Node* node);
 void HLNode_setCompoundDescription(HL_Node* node, HL_CompoundTypeDescription* descr);
 
 /**
- * Returns the compound description for the node (if any).
+ * Returns the compound description for the node (if any). Descriptions read from a file
+ * are shared between nodes with the same compound type, in that case the node first gets
+ * a private copy so that the returned description can be modified. Use
+ * @ref HLNode_getConstCompoundDescription when the description only is read.
  * @param[in] node the node
  * @return the compound description if any, otherwise NULL. (<b>Do not release since it points to internal memory</b>
  */
 HL_CompoundTypeDescription* HLNode_getCompoundDescription(HL_Node* node);
 
+/**
+ * Returns the compound description for the node (if any) without copying it, even if
+ * it is shared with other nodes.
+ * @ingroup hlhdf_c_apis
+ * @param[in] node the node
+ * @return the compound description if any, otherwise NULL. (<b>Must not be modified or released</b>)
+ */
+const HL_CompoundTypeDescription* HLNode_getConstCompoundDescription(HL_Node* node);
+
+/**
+ * Extracts one member from every value of a fetched compound node into a contiguous
+ * array, i.e. out[i] is the member of the i:th compound value. The member format, size
+ * and dimensions are found with \ref findHL_CompoundTypeAttribute on the compound description.
+ * @ingroup hlhdf_c_apis
+ * @param[in] node the node
+ * @param[in] member the name of the member
+ * @param[out] out the column, must be able to hold \ref HLNode_getNumberOfPoints * member size * member dims bytes
+ * @return 1 on success, otherwise 0
+ */
+int HLNode_getCompoundMemberColumn(HL_Node* node, const char* member, void* out);
+
 /**
  * Returns the compression object for this node.
  * @param[in] node the node
@@ -306,4 +350,63 @@ void HLNode_setCompression(HL_Node* node, HL_Compression* compression);
  */
 int HLNode_commitType(HL_Node* node,hid_t typid);
 
+/**
+ * Sets if the data for this node may be released when the node list it belongs to
+ * exceeds its memory budget. Only fetched dataset nodes that have not been changed
+ * are released, see @ref HLNodeList_setMemoryBudget.
+ * @param[in] node the node
+ * @param[in] evictable 1 if the data may be released, otherwise 0
+ */
+void HLNode_setEvictable(HL_Node* node, int evictable);
+
+/**
+ * Returns if the data for this node may be released when the memory budget is exceeded.
+ * @param[in] node the node
+ * @return 1 if evictable, otherwise 0
+ */
+int HLNode_isEvictable(HL_Node* node);
+
+/**
+ * Returns if the data for this node has been released due to the memory budget.
+ * The data will be read again by @ref HLNodeList_fetchNode or @ref HLNodeList_getNodeWithData.
+ * @param[in] node the node
+ * @return 1 if the data has been evicted, otherwise 0
+ */
+int HLNode_isEvicted(HL_Node* node);
+
+/**
+ * Sets the statistics that should be computed while the data for this dataset node is
+ * read, see \ref hlhdf_stats.h.
+ * @ingroup hlhdf_c_apis
+ * @param[in] node the node
+ * @param[in] options the options (copied), NULL if no statistics should be computed
+ * @return 1 on success, otherwise 0
+ */
+int HLNode_setStatisticsOptions(HL_Node* node, const HL_StatisticsOptions* options);
+
+/**
+ * Returns the statistics options for this node.
+ * @ingroup hlhdf_c_apis
+ * @param[in] node the node
+ * @return the options or NULL if no statistics should be computed (<b>points to internal memory so do not release</b>)
+ */
+const HL_StatisticsOptions* HLNode_getStatisticsOptions(HL_Node* node);
+
+/**
+ * Returns the statistics computed when the data was read. The statistics are released
+ * when the data of the node is changed.
+ * @ingroup hlhdf_c_apis
+ * @param[in] node the node
+ * @return the statistics or NULL if none has been computed (<b>points to internal memory so do not release</b>)
+ */
+const HL_Statistics* HLNode_getStatistics(HL_Node* node);
+
+/**
+ * Returns the memory held by this node.
+ * @ingroup hlhdf_c_apis
+ * @param[in] node the node
+ * @param[out] usage the memory usage, the values will be overwritten
+ */
+void HLNode_getMemoryUsage(HL_Node* node, HL_MemoryUsage* usage);
+
 #endif
@@ -25,6 +25,14 @@ along with HLHDF.  If not, see <http://www.gnu.org/licenses/>.
  */
 #ifndef HLHDF_NODE_PRIVATE_H
 #define HLHDF_NODE_PRIVATE_H
+#include "hlhdf_cache_private.h"
+
+/**
+ * Sets the statistics of the data in the node. Statistics are released whenever the data is changed.
+ * @param[in] node the node (MAY NOT BE NULL)
+ * @param[in] stats the statistics (<b>responsibility taken over so do not release after call</b>), may be NULL
+ */
+void HLNodePrivate_setStatistics(HL_Node* node, HL_Statistics* stats);
 
 /**
  * Sets data and datasize in the node. When this function has been called,
@@ -44,6 +52,70 @@ void HLNodePrivate_setData(HL_Node* node, size_t datasize, unsigned char* data);
  */
 void HLNodePrivate_setRawdata(HL_Node* node, size_t datasize, unsigned char* data);
 
+/**
+ * Copies nbytes of data into the node. Small values are stored directly in the
+ * node without any separate allocation.
+ * @param[in] node the node (MAY NOT BE NULL)
+ * @param[in] datasize the size of the data type as get by H5Tget_size.
+ * @param[in] nbytes the total number of bytes to copy
+ * @param[in] data the data (not taken over)
+ * @return 1 on success, otherwise 0
+ */
+int HLNodePrivate_copyData(HL_Node* node, size_t datasize, size_t nbytes, const unsigned char* data);
+
+/**
+ * Copies nbytes of rawdata into the node. Small values are stored directly in the
+ * node without any separate allocation.
+ * @param[in] node the node (MAY NOT BE NULL)
+ * @param[in] datasize the size of the data type as get by H5Tget_size.
+ * @param[in] nbytes the total number of bytes to copy
+ * @param[in] data the rawdata (not taken over)
+ * @return 1 on success, otherwise 0
+ */
+int HLNodePrivate_copyRawdata(HL_Node* node, size_t datasize, size_t nbytes, const unsigned char* data);
+
+/**
+ * Gives the node its own copy of everything it shares with other nodes or the data cache,
+ * i.e. data, rawdata and the compound type description. Used before a node is handed over
+ * to another thread.
+ * @param[in] node the node (MAY NOT BE NULL)
+ * @return 1 on success, otherwise 0
+ */
+int HLNodePrivate_detach(HL_Node* node);
+
+/**
+ * Returns a shared buffer with the data of the node. If the data not already is shared,
+ * it will be handed over to a new shared buffer that the node refers to.
+ * @param[in] node the node (MAY NOT BE NULL)
+ * @return a new reference to the shared buffer (release with @ref HLSharedBuffer_release) or NULL if no data
+ */
+HL_SharedBuffer* HLNodePrivate_shareData(HL_Node* node);
+
+/**
+ * Same as @ref HLNodePrivate_shareData but for rawdata.
+ * @param[in] node the node (MAY NOT BE NULL)
+ * @return a new reference to the shared buffer or NULL if no rawdata
+ */
+HL_SharedBuffer* HLNodePrivate_shareRawdata(HL_Node* node);
+
+/**
+ * Lets the node refer to the data in the shared buffer. Small values are copied into the node instead.
+ * @param[in] node the node (MAY NOT BE NULL)
+ * @param[in] datasize the size of the data type as get by H5Tget_size.
+ * @param[in] buffer the shared buffer (reference count will be increased)
+ * @return 1 on success, otherwise 0
+ */
+int HLNodePrivate_setSharedData(HL_Node* node, size_t datasize, HL_SharedBuffer* buffer);
+
+/**
+ * Same as @ref HLNodePrivate_setSharedData but for rawdata.
+ * @param[in] node the node (MAY NOT BE NULL)
+ * @param[in] datasize the size of the data type as get by H5Tget_size.
+ * @param[in] buffer the shared buffer (reference count will be increased)
+ * @return 1 on success, otherwise 0
+ */
+int HLNodePrivate_setSharedRawdata(HL_Node* node, size_t datasize, HL_SharedBuffer* buffer);
+
 /**
  * Copies the typid and sets it in the node and also atempts to derive
  * the format name.
@@ -53,6 +125,16 @@ void HLNodePrivate_setRawdata(HL_Node* node, size_t datasize, unsigned char* dat
  */
 int HLNodePrivate_setTypeIdAndDeriveFormat(HL_Node* node, hid_t typid);
 
+/**
+ * Sets a shared type, see \ref getSharedFixedType. The node gets its own
+ * reference to the type instead of a copy.
+ * @param[in] node the node
+ * @param[in] type the shared type identifier
+ * @param[in] format the format of the type
+ * @return 1 on success, otherwise 0.
+ */
+int HLNodePrivate_setSharedTypeId(HL_Node* node, hid_t type, HL_FormatSpecifier format);
+
 /**
  * Sets the HDF identifier.
  * @param[in] node the node
@@ -81,4 +163,20 @@ const hsize_t* HLNodePrivate_getDims(HL_Node* node);
  */
 hid_t HLNodePrivate_getTypeId(HL_Node* node);
 
+/**
+ * Sets the format without setting the type id. Used when restoring the structure
+ * of a node that has not been fetched yet.
+ * @param[in] node the node
+ * @param[in] format the format
+ */
+void HLNodePrivate_setFormat(HL_Node* node, HL_FormatSpecifier format);
+
+/**
+ * Releases the data and rawdata of the node and marks it as evicted so that
+ * it can be fetched again.
+ * @param[in] node the node
+ * @return the number of bytes released
+ */
+size_t HLNodePrivate_evict(HL_Node* node);
+
 #endif /* HLHDF_NODE_PRIVATE_H */
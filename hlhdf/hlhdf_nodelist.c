@@ -28,6 +28,9 @@ along with HLHDF.  If not, see <http://www.gnu.org/licenses/>.
 #include "hlhdf_defines_private.h"
 #include "hlhdf_debug.h"
 #include "hlhdf_node.h"
+#include "hlhdf_node_private.h"
+#include "hlhdf_nodelist_private.h"
+#include "hlhdf_private.h"
 #include <string.h>
 #include <stdlib.h>
 
@@ -41,10 +44,45 @@ struct  _HL_NodeList {
    int nNodes;         /**< Number of nodes */
    int nAllocNodes;    /**< Number of allocated nodes */
    HL_Node** nodes;    /**< The list of nodes (max size is nNodes - 1) */
+   size_t memoryBudget; /**< Max number of bytes to hold before evicting data, 0 means no limit */
+   hid_t file_id;      /**< The file kept open by HLNodeList_open or the file image, -1 if not open */
+   int opened;         /**< If the file has been opened by HLNodeList_open */
+   size_t imageSize;   /**< Size of the file image kept by file_id, 0 if file_id is not a file image */
 };
 
 /*@{ End of Structs */
 
+/*@{ Private functions */
+hid_t HLNodeListPrivate_getFile(HL_NodeList* nodelist)
+{
+  return nodelist->file_id;
+}
+
+void HLNodeListPrivate_setFileImage(HL_NodeList* nodelist, hid_t file_id, size_t size)
+{
+  HLNodeList_close(nodelist);
+  nodelist->file_id = file_id;
+  nodelist->imageSize = size;
+}
+
+void HLNodeListPrivate_enforceMemoryBudget(HL_NodeList* nodelist, HL_Node* keep, hid_t* file_id)
+{
+  int session = (*file_id >= 0 && *file_id == nodelist->file_id);
+  HLNodeList_enforceMemoryBudget(nodelist, keep);
+  if (session && nodelist->file_id < 0) {
+    *file_id = -1;
+  }
+}
+
+void HLNodeListPrivate_releaseFile(HL_NodeList* nodelist, hid_t* file_id)
+{
+  if (nodelist == NULL || *file_id != nodelist->file_id) {
+    HL_H5F_CLOSE(*file_id);
+  }
+  *file_id = -1;
+}
+/*@} End of Private functions */
+
 /*@{ Interface functions */
 HL_NodeList* HLNodeList_new(void)
 {
@@ -67,6 +105,10 @@ HL_NodeList* HLNodeList_new(void)
   }
   retv->nNodes = 0;
   retv->nAllocNodes = DEFAULT_SIZE_NODELIST;
+  retv->memoryBudget = 0;
+  retv->file_id = -1;
+  retv->opened = 0;
+  retv->imageSize = 0;
   return retv;
 }
 
@@ -77,6 +119,7 @@ void HLNodeList_free(HL_NodeList* nodelist)
   if (!nodelist)
     return;
 
+  HLNodeList_close(nodelist);
   if (nodelist->nodes) {
     for (i = 0; i < nodelist->nNodes; i++) {
       HLNode_free(nodelist->nodes[i]);
@@ -101,6 +144,9 @@ int HLNodeList_setFileName(HL_NodeList* nodelist, const char* filename)
     HL_ERROR1("Failed to allocate memory for file %s", filename);
     goto fail;
   }
+  if (nodelist->filename == NULL || strcmp(nodelist->filename, filename) != 0) {
+    HLNodeList_close(nodelist);
+  }
   HLHDF_FREE(nodelist->filename);
   nodelist->filename = newfilename;
   newfilename = NULL; // Hand over memory
@@ -129,6 +175,41 @@ char* HLNodeList_getFileName(HL_NodeList* nodelist)
   return retv;
 }
 
+int HLNodeList_open(HL_NodeList* nodelist)
+{
+  if (nodelist == NULL) {
+    HL_ERROR0("Inparameters NULL");
+    return 0;
+  }
+  if (nodelist->file_id < 0) {
+    if (nodelist->filename == NULL) {
+      HL_ERROR0("Nodelist has no filename");
+      return 0;
+    }
+    if ((nodelist->file_id = openHlHdfFile(nodelist->filename, "r")) < 0) {
+      HL_ERROR1("Could not open file '%s'", nodelist->filename);
+      return 0;
+    }
+  }
+  nodelist->opened = 1;
+  return 1;
+}
+
+void HLNodeList_close(HL_NodeList* nodelist)
+{
+  if (nodelist != NULL) {
+    HL_H5F_CLOSE(nodelist->file_id);
+    nodelist->opened = 0;
+    nodelist->imageSize = 0;
+  }
+}
+
+int HLNodeList_isOpen(HL_NodeList* nodelist)
+{
+  HL_ASSERT((nodelist != NULL), "HLNodeList_isOpen called with nodelist == NULL");
+  return nodelist->opened;
+}
+
 int HLNodeList_getNumberOfNodes(HL_NodeList* nodelist)
 {
   if (nodelist == NULL) {
@@ -285,10 +366,10 @@ HL_CompoundTypeDescription* HLNodeList_findCompoundDescription(
   HL_SPEWDEBUG0("ENTER: findHL_CompoundTypeDescription");
   for (i = 0; i < nodelist->nNodes; i++) {
     if (HLNode_getType(nodelist->nodes[i]) == TYPE_ID) {
-      HL_CompoundTypeDescription* descr = HLNode_getCompoundDescription(nodelist->nodes[i]);
+      const HL_CompoundTypeDescription* descr = HLNode_getConstCompoundDescription(nodelist->nodes[i]);
       if (descr != NULL) {
         if (objno0 == descr->objno[0] && objno1 == descr->objno[1]) {
-          retv = descr;
+          retv = HLNode_getCompoundDescription(nodelist->nodes[i]);
           goto done;
         }
       }
@@ -298,3 +379,87 @@ done:
   HL_SPEWDEBUG0("EXIT: findHL_CompoundTypeDescription");
   return retv;
 }
+
+void HLNodeList_getMemoryUsage(HL_NodeList* nodelist, HL_MemoryUsage* usage)
+{
+  int i = 0, j = 0, nseen = 0;
+  const HL_CompoundTypeDescription** seen = NULL;
+  HL_ASSERT((nodelist != NULL), "HLNodeList_getMemoryUsage called with nodelist == NULL");
+  HL_ASSERT((usage != NULL), "HLNodeList_getMemoryUsage called with usage == NULL");
+  memset(usage, 0, sizeof(HL_MemoryUsage));
+
+  usage->other = sizeof(HL_NodeList) + sizeof(HL_Node*) * nodelist->nAllocNodes;
+  if (nodelist->filename != NULL) {
+    usage->names = strlen(nodelist->filename) + 1;
+  }
+  for (i = 0; i < nodelist->nNodes; i++) {
+    HL_MemoryUsage nodeusage;
+    const HL_CompoundTypeDescription* descr = HLNode_getConstCompoundDescription(nodelist->nodes[i]);
+    HLNode_getMemoryUsage(nodelist->nodes[i], &nodeusage);
+    usage->data += nodeusage.data;
+    usage->rawdata += nodeusage.rawdata;
+    usage->names += nodeusage.names;
+    usage->other += nodeusage.other;
+    if (descr != NULL) {
+      /* Shared compound descriptions are only counted once */
+      if (seen == NULL) {
+        seen = (const HL_CompoundTypeDescription**)HLHDF_MALLOC(sizeof(HL_CompoundTypeDescription*) * nodelist->nNodes);
+      }
+      for (j = 0; j < nseen && seen[j] != descr; j++);
+      if (j == nseen) {
+        usage->compound += nodeusage.compound;
+        if (seen != NULL) {
+          seen[nseen++] = descr;
+        }
+      }
+    }
+  }
+  HLHDF_FREE(seen);
+  usage->file = nodelist->imageSize;
+  usage->total = usage->data + usage->rawdata + usage->names + usage->compound + usage->other + usage->file;
+}
+
+void HLNodeList_setMemoryBudget(HL_NodeList* nodelist, size_t budget)
+{
+  HL_ASSERT((nodelist != NULL), "HLNodeList_setMemoryBudget called with nodelist == NULL");
+  nodelist->memoryBudget = budget;
+}
+
+size_t HLNodeList_getMemoryBudget(HL_NodeList* nodelist)
+{
+  HL_ASSERT((nodelist != NULL), "HLNodeList_getMemoryBudget called with nodelist == NULL");
+  return nodelist->memoryBudget;
+}
+
+int HLNodeList_enforceMemoryBudget(HL_NodeList* nodelist, HL_Node* keep)
+{
+  HL_MemoryUsage usage;
+  int i = 0;
+  int nevicted = 0;
+
+  HL_ASSERT((nodelist != NULL), "HLNodeList_enforceMemoryBudget called with nodelist == NULL");
+  if (nodelist->memoryBudget == 0) {
+    return 0;
+  }
+
+  HLNodeList_getMemoryUsage(nodelist, &usage);
+  if (usage.total > nodelist->memoryBudget && usage.file > 0 && !nodelist->opened) {
+    /* The file image is released before any data, later fetches read from the file */
+    HLNodeList_close(nodelist);
+    usage.total -= usage.file;
+  }
+  for (i = 0; i < nodelist->nNodes && usage.total > nodelist->memoryBudget; i++) {
+    HL_Node* node = nodelist->nodes[i];
+    if (node != keep &&
+        HLNode_isEvictable(node) &&
+        HLNode_getType(node) == DATASET_ID &&
+        HLNode_fetched(node) &&
+        HLNode_getMark(node) == NMARK_ORIGINAL) {
+      size_t released = HLNodePrivate_evict(node);
+      HL_DEBUG2("Evicted %ld bytes from node %s", (long)released, HLNode_getName(node));
+      usage.total -= (released < usage.total) ? released : usage.total;
+      nevicted++;
+    }
+  }
+  return nevicted;
+}
@@ -56,6 +56,34 @@ int HLNodeList_setFileName(HL_NodeList* nodelist, const char* filename);
  */
 char* HLNodeList_getFileName(HL_NodeList* nodelist);
 
+/**
+ * Opens the file of the nodelist and keeps it open until \ref HLNodeList_close is called.
+ * While open, fetching (\ref HLNodeList_fetchNode, \ref HLNodeList_fetchMarkedNodes,
+ * \ref HLNodeList_readCompoundMemberColumn and \ref HLNodeList_fetchScaledDataset) reuses the file
+ * instead of opening and closing it each time, and HDF5 keeps its metadata cache warm between
+ * the calls. The file is closed when the nodelist is written, updated, given another
+ * filename or freed.
+ * @ingroup hlhdf_c_apis
+ * @param[in] nodelist - the nodelist
+ * @return 1 on success, otherwise 0
+ */
+int HLNodeList_open(HL_NodeList* nodelist);
+
+/**
+ * Closes the file opened by \ref HLNodeList_open. Also releases a file image kept in memory,
+ * see \ref HL_setWholeFileReadLimit. Does nothing if the file is not open.
+ * @ingroup hlhdf_c_apis
+ * @param[in] nodelist - the nodelist
+ */
+void HLNodeList_close(HL_NodeList* nodelist);
+
+/**
+ * Returns if the file of the nodelist has been opened with \ref HLNodeList_open.
+ * @param[in] nodelist - the nodelist
+ * @return 1 if open, otherwise 0
+ */
+int HLNodeList_isOpen(HL_NodeList* nodelist);
+
 /**
  * Returns the number of nodes that exists in the provided nodelist.
  * @param[in] nodelist - the node list
@@ -117,4 +145,40 @@ HL_CompoundTypeDescription* HLNodeList_findCompoundDescription(HL_NodeList* node
                   unsigned long objno0,
                   unsigned long objno1);
 
+/**
+ * Returns the memory held by the nodelist and all its nodes. Use @ref HLNode_getMemoryUsage
+ * for the usage of individual nodes.
+ * @ingroup hlhdf_c_apis
+ * @param[in] nodelist the nodelist
+ * @param[out] usage the memory usage, the values will be overwritten
+ */
+void HLNodeList_getMemoryUsage(HL_NodeList* nodelist, HL_MemoryUsage* usage);
+
+/**
+ * Sets the max number of bytes the nodelist should hold. When a fetch causes the nodelist
+ * to exceed the budget, the data of fetched dataset nodes that have been marked as evictable
+ * (@ref HLNode_setEvictable) will be released until the nodelist fits within the budget again.
+ * Evicted nodes are read again by @ref HLNodeList_fetchNode or @ref HLNodeList_getNodeWithData.
+ * @ingroup hlhdf_c_apis
+ * @param[in] nodelist the nodelist
+ * @param[in] budget the budget in bytes, 0 means no limit (default)
+ */
+void HLNodeList_setMemoryBudget(HL_NodeList* nodelist, size_t budget);
+
+/**
+ * Returns the memory budget.
+ * @param[in] nodelist the nodelist
+ * @return the budget in bytes, 0 if no limit
+ */
+size_t HLNodeList_getMemoryBudget(HL_NodeList* nodelist);
+
+/**
+ * Releases the data of evictable nodes until the nodelist fits within the memory budget
+ * or there are no more nodes that can be evicted. Is called automatically after fetching.
+ * @param[in] nodelist the nodelist
+ * @param[in] keep a node that never should be evicted, may be NULL
+ * @return the number of nodes that got their data released
+ */
+int HLNodeList_enforceMemoryBudget(HL_NodeList* nodelist, HL_Node* keep);
+
 #endif /* HLHDF_NODELIST_H */
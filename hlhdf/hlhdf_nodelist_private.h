@@ -0,0 +1,68 @@
+/* --------------------------------------------------------------------
+Copyright (C) 2026 Swedish Meteorological and Hydrological Institute, SMHI,
+
+This file is part of HLHDF.
+
+HLHDF is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+HLHDF is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with HLHDF.  If not, see <http://www.gnu.org/licenses/>.
+------------------------------------------------------------------------*/
+
+
+/**
+ * Private functions for working with HL_NodeList's.
+ * @file
+ * @date 2026-10-19
+ */
+#ifndef HLHDF_NODELIST_PRIVATE_H
+#define HLHDF_NODELIST_PRIVATE_H
+#include "hlhdf_types.h"
+#include <hdf5.h>
+
+/**
+ * Returns the file opened by \ref HLNodeList_open or the file image kept by
+ * \ref HLNodeListPrivate_setFileImage.
+ * @param[in] nodelist the nodelist
+ * @return the file identifier or -1 if the nodelist keeps no file open
+ */
+hid_t HLNodeListPrivate_getFile(HL_NodeList* nodelist);
+
+/**
+ * Lets the nodelist keep a file that has been read into memory open so that fetches
+ * are served from memory. The image is counted by \ref HLNodeList_getMemoryUsage,
+ * released first when the memory budget is exceeded and closed by \ref HLNodeList_close,
+ * but the nodelist is not reported as opened by \ref HLNodeList_isOpen. Any file
+ * already kept open is closed.
+ * @param[in] nodelist the nodelist
+ * @param[in] file_id the file identifier, the nodelist takes ownership
+ * @param[in] size the size of the file image in bytes
+ */
+void HLNodeListPrivate_setFileImage(HL_NodeList* nodelist, hid_t file_id, size_t size);
+
+/**
+ * Same as \ref HLNodeList_enforceMemoryBudget for a fetch that reads from file_id.
+ * If the budget released the file image that file_id refers to, file_id is set to
+ * -1 so that the file is opened again when needed.
+ * @param[in] nodelist the nodelist
+ * @param[in] keep a node that never should be evicted, may be NULL
+ * @param[in,out] file_id the file the fetch reads from
+ */
+void HLNodeListPrivate_enforceMemoryBudget(HL_NodeList* nodelist, HL_Node* keep, hid_t* file_id);
+
+/**
+ * Closes a file unless it is the file opened by \ref HLNodeList_open.
+ * @param[in] nodelist the nodelist
+ * @param[in,out] file_id the file identifier, set to -1
+ */
+void HLNodeListPrivate_releaseFile(HL_NodeList* nodelist, hid_t* file_id);
+
+#endif /* HLHDF_NODELIST_PRIVATE_H */
@@ -36,6 +36,14 @@ along with HLHDF.  If not, see <http://www.gnu.org/licenses/>.
  */
 hid_t openHlHdfFile(const char* filename,const char* how);
 
+/**
+ * Opens a HDF5 file for reading with the core driver so that the whole file is read
+ * into memory with one sequential read when it is opened. Nothing is written back.
+ * @param[in] filename the filename
+ * @return the file identifier or -1 on failure.
+ */
+hid_t openHlHdfFileInMemory(const char* filename);
+
 /**
  * Creates a HDF5 file. If the filename already exists this file will be truncated.
  * @param[in] filename the name of the file to create
@@ -52,6 +60,18 @@ hid_t createHlHdfFile(const char* filename, HL_FileCreationProperty* property);
  */
 hid_t getFixedType(hid_t type);
 
+/**
+ * Same as \ref getFixedType but for integer, float and string types the native type is
+ * taken from a process wide cache so that all nodes with the same type share the same
+ * type identifier. The returned identifier is a new reference to the shared type and
+ * <b>must not be modified</b>, release it with H5Tclose as usual.
+ * @param[in] type the type that should be translated
+ * @param[out] format the format of the native type
+ * @return the shared native type identifier or <0 if the type can not be shared, in which
+ * case \ref getFixedType should be used.
+ */
+hid_t getSharedFixedType(hid_t type, HL_FormatSpecifier* format);
+
 /**
  * Returns a native data type from the format specifier.
  * @param[in] dataType Format specifier. See @ref ValidFormatSpecifiers "here" for valid format specifiers.
@@ -123,4 +143,27 @@ int extractParentChildName(HL_Node* node, char** parent, char** child);
  */
 int openGroupOrDataset(hid_t file_id, const char* name, hid_t* lid, HL_Type* type);
 
+/**
+ * Called for each slab read by \ref readDatasetInSlabs.
+ * @param[in] ctx the user context
+ * @param[in] data the values in the slab
+ * @param[in] first the index of the first value in the slab
+ * @param[in] n the number of values in the slab
+ * @return 1 to continue, 0 to abort the read
+ */
+typedef int (*HL_SlabConsumer)(void* ctx, const unsigned char* data, hsize_t first, hsize_t n);
+
+/**
+ * Reads a dataset a few rows at a time, about HLHDF_SLAB_BYTES per read. For chunked
+ * datasets the rows are aligned to whole chunks.
+ * @param[in] obj the dataset
+ * @param[in] mtype the memory type to read as
+ * @param[in] dest if not NULL each slab is read directly into its place in dest which must hold
+ * the whole dataset, otherwise the slabs are read into a temporary buffer
+ * @param[in] consume called after each slab has been read, may be NULL
+ * @param[in] ctx passed on to consume
+ * @return 1 on success, otherwise 0
+ */
+int readDatasetInSlabs(hid_t obj, hid_t mtype, unsigned char* dest, HL_SlabConsumer consume, void* ctx);
+
 #endif /* HLHDF_PRIVATE_H_ */
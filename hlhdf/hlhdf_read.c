@@ -29,8 +29,19 @@ along with HLHDF.  If not, see <http://www.gnu.org/licenses/>.
 #include "hlhdf_debug.h"
 #include "hlhdf_defines_private.h"
 #include "hlhdf_node_private.h"
+#include "hlhdf_nodelist_private.h"
+#include "hlhdf_cache_private.h"
+#include "hlhdf_index_private.h"
+#include "hlhdf_compound_private.h"
+#include "hlhdf_stats_private.h"
+#include "hlhdf_counters_private.h"
+#include "hlhdf_trace_private.h"
 #include <string.h>
 #include <stdlib.h>
+#include <sys/stat.h>
+#ifdef H5_HAVE_THREADSAFE
+#include <pthread.h>
+#endif
 
 /*@{ Typedefs */
 
@@ -50,16 +61,125 @@ typedef struct ReferenceLookup
   struct ReferenceLookup* next; /**< next reference */
 } ReferenceLookup;
 
+/**
+ * One segment in a path or in a path pattern, i.e. the part between two '/'.
+ */
+typedef struct PathSegment {
+  const char* str; /**< start of segment (not nul terminated) */
+  size_t len;      /**< length of segment */
+} PathSegment;
+
+/**
+ * A glob pattern used to filter which nodes that should be read.
+ */
+typedef struct PathPattern {
+  int exclude;         /**< if the pattern was prefixed with '!' */
+  char* pattern;       /**< the pattern, always starting with '/' */
+  int nsegs;           /**< number of segments */
+  PathSegment* segs;   /**< the segments, pointing into pattern */
+} PathPattern;
+
+/**
+ * Include and exclude patterns used when reading.
+ */
+typedef struct PathFilter {
+  int npatterns;          /**< number of patterns */
+  int nincludes;          /**< number of include patterns */
+  PathPattern* patterns;  /**< the patterns */
+} PathFilter;
+
+/**
+ * Identifies an object in a file, the object token with the 1.12 API and the address otherwise.
+ */
+#ifdef USE_HDF5_1_12_API
+typedef H5O_token_t HLObjectAddr;
+#define HLHDF_OBJECT_ADDR(info) ((info).token)
+#else
+typedef haddr_t HLObjectAddr;
+#define HLHDF_OBJECT_ADDR(info) ((info).addr)
+#endif
+
+/**
+ * Gets the object info without the header and attribute information that requires the whole
+ * object header to be read. Older libraries than 1.10.3 always read everything.
+ */
+#ifdef USE_HDF5_1_12_API
+#define HLHDF_GET_BASIC_INFO(loc, name, info) H5Oget_info_by_name(loc, name, info, H5O_INFO_BASIC, H5P_DEFAULT)
+#elif H5_VERSION_GE(1,10,3)
+#define HLHDF_GET_BASIC_INFO(loc, name, info) H5Oget_info_by_name2(loc, name, info, H5O_INFO_BASIC, H5P_DEFAULT)
+#else
+#define HLHDF_GET_BASIC_INFO(loc, name, info) H5Oget_info_by_name(loc, name, info, H5P_DEFAULT)
+#endif
+
+/**
+ * Objects with more than one hard link that already have been visited during a filtered read.
+ */
+typedef struct VisitedObjects {
+  int nobjs;            /**< number of objects */
+  int nalloc;           /**< allocated size of objs */
+  HLObjectAddr* objs;   /**< the visited objects */
+} VisitedObjects;
+
 /**
  * Used when traversing over the different nodes during reading.
  */
 typedef struct VisitorStruct {
   char* path; /**< the root path initiating the visitor */
   HL_NodeList* nodelist; /**< the nodelist where to add nodes */
+  PathFilter* filter; /**< filter deciding what nodes to read, NULL for all */
+  int included; /**< if the object the attributes belong to is included by the filter */
+  int metadata; /**< if attribute values and dataset dimensions, type and format should be read */
+  hid_t file_id; /**< the file identifier */
+  VisitedObjects* visited; /**< set when groups are walked link by link (filtered reads), otherwise NULL */
 } VisitorStruct;
 
+/**
+ * Where the data of a node to fetch is stored, used for ordering the reads.
+ */
+typedef struct FetchOrderEntry {
+  haddr_t addr;   /**< the address of the data, 0 for nodes that are not read from a dataset */
+  int index;      /**< the index of the node */
+  int ordered;    /**< if the data is read from a dataset, i.e. not served by the data cache */
+  hid_t dataset;  /**< the dataset opened when ordering, -1 if not opened */
+} FetchOrderEntry;
+
+/**
+ * A fetch running on a background I/O thread.
+ */
+struct _HL_FetchHandle {
+  HL_NodeList* nodelist;     /**< the node list */
+  char* filename;            /**< the file to read from */
+  int nnodes;                /**< number of nodes to fetch */
+  HL_Node** nodes;           /**< the nodes to fetch */
+  int* states;               /**< per node, 0 = pending, 1 = fetched, -1 = failed */
+  int ncompleted;            /**< number of nodes that are no longer pending */
+  int done;                  /**< 1 when all nodes have been processed */
+  int status;                /**< 1 if all nodes were fetched */
+  int waited;                /**< 0 until waited for, 1 while the I/O thread is joined, 2 when joined */
+  HL_FetchCallback callback; /**< called for each node */
+  void* userdata;            /**< passed on to the callback */
+  H5E_auto2_t efunc;         /**< HDF5 error reporting of the creating thread */
+  void* edata;               /**< HDF5 error reporting data of the creating thread */
+#ifdef H5_HAVE_THREADSAFE
+  int threaded;              /**< 1 if the I/O thread was started */
+  pthread_t thread;          /**< the I/O thread */
+  pthread_mutex_t lock;      /**< protects states, ncompleted, done and waited */
+  pthread_cond_t cond;       /**< signalled when a node has completed */
+#endif
+};
+
 /*@} End of Typedefs */
 
+/**
+ * If uncompressed datasets should be memory mapped, see \ref HL_setMemoryMappedReads.
+ */
+static int hlhdfMappedReads = 0;
+
+/**
+ * Max size of files that are read into memory as a whole, see \ref HL_setWholeFileReadLimit.
+ */
+static size_t hlhdfWholeFileReadLimit = 0;
+
 /*@{ Private functions */
 static HL_CompoundTypeDescription* buildTypeDescriptionFromTypeHid(hid_t type_id)
 {
@@ -151,6 +271,41 @@ fail:
   return NULL;
 }
 
+/**
+ * Returns the compound type description for a compound attribute or dataset type. Nodes with
+ * the same committed type, or the same structure if the type is not committed, share one
+ * description so it is only built once.
+ * @param[in] type the file type
+ * @param[in] mtype the native compound type
+ * @return a reference to the description (release with freeHL_CompoundTypeDescription) or NULL on failure
+ */
+static HL_CompoundTypeDescription* hlhdf_read_getCompoundDescription(hid_t type, hid_t mtype)
+{
+  HL_CompoundTypeDescription* descr = NULL;
+  unsigned long objno[2] = {0, 0};
+
+  if (H5Tcommitted(type) > 0) {
+    H5G_stat_t statbuf;
+    H5Gget_objinfo(type, ".", TRUE, &statbuf);
+    objno[0] = statbuf.objno[0];
+    objno[1] = statbuf.objno[1];
+  }
+
+  if ((descr = HLCompoundPrivate_findShared(mtype, objno[0], objno[1])) != NULL) {
+    return descr;
+  }
+  if ((descr = buildTypeDescriptionFromTypeHid(mtype)) == NULL) {
+    return NULL;
+  }
+  descr->objno[0] = objno[0];
+  descr->objno[1] = objno[1];
+  if (!HLCompoundPrivate_registerShared(mtype, descr)) {
+    /* Still usable, it is just not shared */
+    HL_INFO0("Failed to register shared compound description");
+  }
+  return descr;
+}
+
 static int checkIfReferenceMatch(hid_t loc_id, char* path, hobj_ref_t* ref)
 {
   hobj_ref_t matchref;
@@ -187,6 +342,7 @@ static herr_t refGroupLocationIterator(hid_t gid, const char* name,
   switch (statbuf.type) {
   case H5G_GROUP:
     if ((obj = H5Gopen(gid, name, H5P_DEFAULT)) >= 0) {
+      HL_STATS_INC(objectsOpened);
       snprintf(tmp2, 1024, "%s/%s", lookup->tmp_name, name);
       strcpy(lookup->tmp_name, tmp2);
       if (checkIfReferenceMatch(lookup->file_id, lookup->tmp_name, lookup->ref) == 1) {
@@ -200,6 +356,7 @@ static herr_t refGroupLocationIterator(hid_t gid, const char* name,
     break;
   case H5G_DATASET:
     if ((obj = H5Dopen(gid, name, H5P_DEFAULT)) >= 0) {
+      HL_STATS_INC(objectsOpened);
       snprintf(tmp2, 1024, "%s/%s", lookup->tmp_name, name);
       strcpy(lookup->tmp_name, tmp2);
       if (checkIfReferenceMatch(lookup->file_id, lookup->tmp_name, lookup->ref)
@@ -345,6 +502,40 @@ fail:
   return status;
 }
 
+/**
+ * Translates a type into a native type. Integer, float and string types are
+ * taken from the shared type cache.
+ * @param[in] type the type
+ * @param[out] sharedFormat the format if the returned type is shared, otherwise HLHDF_UNDEFINED
+ * @return the native type or <0 on failure, release with H5Tclose
+ */
+static hid_t hlhdf_read_getFixedType(hid_t type, HL_FormatSpecifier* sharedFormat)
+{
+  double start = HLCountersPrivate_now();
+  hid_t mtype = getSharedFixedType(type, sharedFormat);
+  if (mtype < 0) {
+    *sharedFormat = HLHDF_UNDEFINED;
+    mtype = getFixedType(type);
+  }
+  HL_STATS_ADD_TIME(convertTime, start);
+  return mtype;
+}
+
+/**
+ * Sets a type returned by \ref hlhdf_read_getFixedType in the node.
+ * @param[in] node the node
+ * @param[in] mtype the native type
+ * @param[in] sharedFormat the format if the type is shared, otherwise HLHDF_UNDEFINED
+ * @return 1 on success, otherwise 0
+ */
+static int hlhdf_read_setFixedType(HL_Node* node, hid_t mtype, HL_FormatSpecifier sharedFormat)
+{
+  if (sharedFormat != HLHDF_UNDEFINED) {
+    return HLNodePrivate_setSharedTypeId(node, mtype, sharedFormat);
+  }
+  return HLNodePrivate_setTypeIdAndDeriveFormat(node, mtype);
+}
+
 /**
  * Fills the attribute with the data or the rawdata depending on rawdata-attribute
  * @param[in] node the node
@@ -359,6 +550,31 @@ static int hlhdf_read_fillAttributeNodeWithData(HL_Node* node, hid_t obj, hid_t
   unsigned char* dataptr = NULL;
   int status = 0;
 
+  dSize = H5Tget_size(type);
+  if (dSize * npoints < HLNODE_INLINE_DATA_SIZE &&
+      !(H5Tget_class(type) == H5T_STRING && H5Tis_variable_str(type) == 1)) {
+    /* Small values are read on the stack and copied into the node, avoids heap allocations.
+     * The buffer has room for one extra byte in case a nullterminator is missing. */
+    unsigned char buf[HLNODE_INLINE_DATA_SIZE];
+    size_t nbytes = dSize * npoints;
+    if (H5Aread(obj, type, buf) < 0) {
+      HL_ERROR0("Could not read attribute data\n");
+      goto fail;
+    }
+    if (H5Tget_class(type) == H5T_STRING && dSize > 0 &&
+        H5Tget_strpad(type) == H5T_STR_NULLTERM && buf[dSize - 1] != '\0') {
+      buf[dSize] = '\0';
+      dSize = dSize + 1;
+      nbytes = nbytes + 1;
+    }
+    if (!rawdata) {
+      status = HLNodePrivate_copyData(node, dSize, nbytes, buf);
+    } else {
+      status = HLNodePrivate_copyRawdata(node, dSize, nbytes, buf);
+    }
+    return status;
+  }
+
   if (!hlhdf_read_readAttributeData(obj, type, npoints, &dSize, &dataptr)) {
     HL_ERROR0("Failed to read attribute data");
     goto fail;
@@ -382,10 +598,10 @@ fail:
  * @param[in] spaceid the space identifier
  * @param[out] ndims the rank
  * @param[out] npoints the number of values
- * @param[out] the dimensions
- * @return 1 on success, 0 on failure and in that case dims is guaranteed to be NULL
+ * @param[out] dims the dimensions, must be able to hold H5S_MAX_RANK values
+ * @return 1 on success, 0 on failure
  */
-static int hlhdf_read_getSpaceDimensions(hid_t spaceid, int* ndims, hsize_t* npoints, hsize_t** dims)
+static int hlhdf_read_getSpaceDimensions(hid_t spaceid, int* ndims, hsize_t* npoints, hsize_t* dims)
 {
   int status = 0;
 
@@ -393,10 +609,12 @@ static int hlhdf_read_getSpaceDimensions(hid_t spaceid, int* ndims, hsize_t* npo
 
   *ndims = H5Sget_simple_extent_ndims(spaceid);
   *npoints = H5Sget_simple_extent_npoints(spaceid);
-  *dims = NULL;
+  if (*ndims < 0 || *ndims > H5S_MAX_RANK) {
+    HL_ERROR0("Could not get rank from space");
+    goto fail;
+  }
   if (*ndims > 0) {
-    *dims = (hsize_t*)HLHDF_MALLOC(sizeof(hsize_t)* (*ndims));
-    if (H5Sget_simple_extent_dims(spaceid, *dims, NULL) != *ndims) {
+    if (H5Sget_simple_extent_dims(spaceid, dims, NULL) != *ndims) {
       HL_ERROR0("Could not get dimensions from space");
       goto fail;
     }
@@ -406,83 +624,55 @@ fail:
   if (status == 0) {
     *ndims = 0;
     *npoints = 0;
-    HLHDF_FREE(*dims);
   }
   return status;
 }
 
 /**
- * Fills an attribute with data
+ * Fills an attribute node with dimensions, type, format, data and rawdata from an open attribute.
+ * @param[in] node the node
+ * @param[in] obj the attribute identifier
+ * @return 1 on success, otherwise 0
  */
-static int fillAttributeNode(hid_t file_id, HL_Node* node)
+static int hlhdf_read_fillAttribute(HL_Node* node, hid_t obj)
 {
-  hid_t obj = -1;
-  hid_t loc_id = -1;
   hid_t type = -1, mtype = -1;
   hid_t f_space = -1;
-  char* parent = NULL;
-  char* child = NULL;
-  HL_Type parentType = UNDEFINED_ID;
-  H5G_stat_t statbuf;
+  HL_FormatSpecifier sharedFormat = HLHDF_UNDEFINED;
   int result = 0;
 
-  HL_SPEWDEBUG0("ENTER: fillAttributeNode");
-
-  if (!extractParentChildName(node, &parent, &child)) {
-    HL_ERROR0("Failed to extract parent/child");
-    goto fail;
-  }
-
-  if (!openGroupOrDataset(file_id, parent, &loc_id, &parentType)) {
-    HL_ERROR1("Failed to determine and open '%s'", parent);
-    goto fail;
-  }
-
-  if ((obj = H5Aopen_name(loc_id, child)) < 0) {
-    goto fail;
-  }
-
   if ((type = H5Aget_type(obj)) < 0) {
     HL_ERROR0("Could not get attribute type");
     goto fail;
   }
 
-  if ((mtype = getFixedType(type)) < 0) {
+  if ((mtype = hlhdf_read_getFixedType(type, &sharedFormat)) < 0) {
     HL_ERROR0("Could not create fixed attribute type");
     goto fail;
   }
 
   if (H5Tget_class(mtype) == H5T_COMPOUND) {
-    HL_CompoundTypeDescription* descr = buildTypeDescriptionFromTypeHid(mtype);
+    HL_CompoundTypeDescription* descr = hlhdf_read_getCompoundDescription(type, mtype);
     if (descr == NULL) {
       HL_ERROR0("Failed to create compound data description for attribute");
       goto fail;
     }
-
-    if (H5Tcommitted(type) > 0) {
-      H5Gget_objinfo(type, ".", TRUE, &statbuf);
-      descr->objno[0] = statbuf.objno[0];
-      descr->objno[1] = statbuf.objno[1];
-    }
-
     HLNode_setCompoundDescription(node, descr);
   }
 
   if ((f_space = H5Aget_space(obj)) >= 0) {
-    hsize_t* all_dims = NULL;
+    hsize_t all_dims[H5S_MAX_RANK];
     hsize_t npoints;
     int ndims;
 
-    if (!hlhdf_read_getSpaceDimensions(f_space, &ndims, &npoints, &all_dims)) {
+    if (!hlhdf_read_getSpaceDimensions(f_space, &ndims, &npoints, all_dims)) {
       HL_ERROR0("Could not read space dimensions");
       goto fail;
     } else {
       if (!HLNode_setDimensions(node, ndims, all_dims)) {
         HL_ERROR0("Failed to set node dimensions");
-        HLHDF_FREE(all_dims);
         goto fail;
       }
-      HLHDF_FREE(all_dims);
     }
 
     if (H5Sis_simple(f_space) >= 0) {
@@ -494,6 +684,9 @@ static int fillAttributeNode(hid_t file_id, HL_Node* node)
         HL_ERROR0("Failed to read fixed attribute data");
         goto fail;
       }
+      HL_STATS_INC(attributesRead);
+      HL_STATS_ADD(bytesRead, npoints * H5Tget_size(mtype));
+      HL_STATS_ADD(rawBytesRead, H5Aget_storage_size(obj));
     } else {
       HL_ERROR0("Attribute dataspace was not simple, can't handle");
       goto fail;
@@ -503,7 +696,7 @@ static int fillAttributeNode(hid_t file_id, HL_Node* node)
     goto fail;
   }
 
-  if (!HLNodePrivate_setTypeIdAndDeriveFormat(node, mtype)) {
+  if (!hlhdf_read_setFixedType(node, mtype, sharedFormat)) {
     HL_ERROR0("Failed to set type and format on node");
     goto fail;
   }
@@ -512,33 +705,26 @@ static int fillAttributeNode(hid_t file_id, HL_Node* node)
 
   result = 1;
 fail:
-  HL_H5A_CLOSE(obj);
-  HL_H5O_CLOSE(loc_id);
   HL_H5T_CLOSE(type);
   HL_H5T_CLOSE(mtype);
   HL_H5S_CLOSE(f_space);
-  HLHDF_FREE(parent);
-  HLHDF_FREE(child);
-
   return result;
 }
 
 /**
- * Fills a reference node
+ * Fills an attribute with data
  */
-static int fillReferenceNode(hid_t file_id, HL_Node* node)
+static int fillAttributeNode(hid_t file_id, HL_Node* node)
 {
-  HL_Type parentType = UNDEFINED_ID;
-  hobj_ref_t ref;
   hid_t obj = -1;
   hid_t loc_id = -1;
   char* parent = NULL;
   char* child = NULL;
-  char* refername = NULL;
-  int status = 0;
-  hid_t strtype = -1;
+  HL_Type parentType = UNDEFINED_ID;
+  int result = 0;
+
+  HL_SPEWDEBUG0("ENTER: fillAttributeNode");
 
-  HL_DEBUG0("ENTER: fillReferenceNode");
   if (!extractParentChildName(node, &parent, &child)) {
     HL_ERROR0("Failed to extract parent/child");
     goto fail;
@@ -552,60 +738,205 @@ static int fillReferenceNode(hid_t file_id, HL_Node* node)
   if ((obj = H5Aopen_name(loc_id, child)) < 0) {
     goto fail;
   }
+  HL_STATS_INC(objectsOpened);
+
+  result = hlhdf_read_fillAttribute(node, obj);
+fail:
+  HL_H5A_CLOSE(obj);
+  HL_H5O_CLOSE(loc_id);
+  HLHDF_FREE(parent);
+  HLHDF_FREE(child);
+
+  return result;
+}
+
+/**
+ * Fills a reference node with the name of the referenced object from an open attribute.
+ * @param[in] file_id the file identifier, used for locating the referenced object
+ * @param[in] node the node
+ * @param[in] obj the attribute identifier
+ * @return 1 on success, otherwise 0
+ */
+static int hlhdf_read_fillReference(hid_t file_id, HL_Node* node, hid_t obj)
+{
+  hobj_ref_t ref;
+  char* refername = NULL;
+  int status = 0;
+  hid_t strtype = -1, mtype = -1;
+  HL_FormatSpecifier sharedFormat = HLHDF_UNDEFINED;
+
   if (H5Aread(obj, H5T_STD_REF_OBJ, &ref) < 0) {
     HL_ERROR0("Could not read reference\n");
     goto fail;
   }
 
   if (!(refername = locateNameForReference(file_id, &ref))) {
-    HL_INFO2("WARNING: Could not locate name of object referenced by: %s/%s"
-             " will set referenced object to UNKNOWN.", parent, child);
+    HL_INFO1("WARNING: Could not locate name of object referenced by: %s"
+             " will set referenced object to UNKNOWN.", HLNode_getName(node));
     refername = strdup("UNKNOWN");
   }
 
-  HLNodePrivate_setData(node, strlen(refername)+1, (unsigned char*)HLHDF_STRDUP(refername));
-  HLNodePrivate_setRawdata(node, strlen(refername)+1, (unsigned char*)HLHDF_STRDUP(refername));
+  if (!HLNodePrivate_copyData(node, strlen(refername)+1, strlen(refername)+1, (unsigned char*)refername) ||
+      !HLNodePrivate_copyRawdata(node, strlen(refername)+1, strlen(refername)+1, (unsigned char*)refername)) {
+    HL_ERROR0("Failed to set reference name");
+    goto fail;
+  }
   HLNode_setDimensions(node, 0, NULL);
   HLNode_setMark(node, NMARK_ORIGINAL);
   HLNode_setFetched(node, 1);
 
   strtype = H5Tcopy(H5T_C_S1);
   H5Tset_size(strtype, strlen(refername)+1);
-  if(!HLNodePrivate_setTypeIdAndDeriveFormat(node, strtype)) {
+  if ((mtype = hlhdf_read_getFixedType(strtype, &sharedFormat)) < 0 ||
+      !hlhdf_read_setFixedType(node, mtype, sharedFormat)) {
     HL_ERROR0("Failed to set type and format");
     goto fail;
   }
 
   status = 1;
+fail:
+  HLHDF_FREE(refername);
+  HL_H5T_CLOSE(strtype);
+  HL_H5T_CLOSE(mtype);
+  return status;
+}
+
+/**
+ * Fills a reference node
+ */
+static int fillReferenceNode(hid_t file_id, HL_Node* node)
+{
+  HL_Type parentType = UNDEFINED_ID;
+  hid_t obj = -1;
+  hid_t loc_id = -1;
+  char* parent = NULL;
+  char* child = NULL;
+  int status = 0;
+
+  HL_DEBUG0("ENTER: fillReferenceNode");
+  if (!extractParentChildName(node, &parent, &child)) {
+    HL_ERROR0("Failed to extract parent/child");
+    goto fail;
+  }
+
+  if (!openGroupOrDataset(file_id, parent, &loc_id, &parentType)) {
+    HL_ERROR1("Failed to determine and open '%s'", parent);
+    goto fail;
+  }
+
+  if ((obj = H5Aopen_name(loc_id, child)) < 0) {
+    goto fail;
+  }
+  HL_STATS_INC(objectsOpened);
+
+  status = hlhdf_read_fillReference(file_id, node, obj);
 fail:
   HL_H5A_CLOSE(obj);
   HL_H5O_CLOSE(loc_id);
   HLHDF_FREE(parent);
   HLHDF_FREE(child);
-  HLHDF_FREE(refername);
-  HL_H5T_CLOSE(strtype);
 
   return status;
 }
 
 /**
- * Fills a dataset node
+ * What is needed for computing statistics on the slabs read by readDatasetInSlabs.
+ */
+typedef struct HLReadStatisticsContext_t {
+  const HL_StatisticsOptions* options; /**< the options */
+  HL_FormatSpecifier format;           /**< the format of the data */
+  HL_Statistics* stats;                /**< the statistics */
+} HLReadStatisticsContext_t;
+
+/**
+ * Adds the values in a slab to the statistics directly after it has been read, see \ref HL_SlabConsumer.
  */
-static int fillDatasetNode(hid_t file_id, HL_Node* node)
+static int hlhdf_read_accumulateStatistics(void* ctx, const unsigned char* data, hsize_t first, hsize_t n)
 {
-  hid_t obj = -1;
+  HLReadStatisticsContext_t* sctx = (HLReadStatisticsContext_t*)ctx;
+  HLStatisticsPrivate_accumulate(sctx->stats, sctx->options, sctx->format, data, (size_t)n);
+  return 1;
+}
+
+/**
+ * Lets the node data point into a memory map of the dataset in the file if the
+ * stored data can be used as it is, i.e. it is contiguous, unfiltered and of a
+ * simple type that equals the native type.
+ * @param[in] node the node
+ * @param[in] obj the dataset identifier
+ * @param[in] type the stored type
+ * @param[in] mtype the native type
+ * @param[in] nbytes the size of the data
+ * @return 1 if the data was mapped, 0 if it should be read
+ */
+static int hlhdf_read_mapDataset(HL_Node* node, hid_t obj, hid_t type, hid_t mtype, size_t nbytes)
+{
+  H5T_class_t tclass = H5Tget_class(type);
+  hid_t plist = -1, file_id = -1, fapl = -1;
+  haddr_t offset = HADDR_UNDEF;
+  HL_SharedBuffer* buffer = NULL;
+  char* filename = NULL;
+  ssize_t len = 0;
+  int result = 0;
+
+  /* Small values are copied into the node anyway */
+  if (nbytes <= HLNODE_INLINE_DATA_SIZE) {
+    return 0;
+  }
+  if (tclass != H5T_INTEGER && tclass != H5T_FLOAT && (tclass != H5T_STRING || H5Tis_variable_str(type) > 0)) {
+    return 0;
+  }
+  if (H5Tequal(type, mtype) <= 0) {
+    return 0;
+  }
+  if ((plist = H5Dget_create_plist(obj)) < 0 ||
+      H5Pget_layout(plist) != H5D_CONTIGUOUS || H5Pget_nfilters(plist) != 0) {
+    goto done;
+  }
+  /* The offset is only meaningful when the file is stored as one file on disk */
+  if ((file_id = H5Iget_file_id(obj)) < 0 || (fapl = H5Fget_access_plist(file_id)) < 0 ||
+      H5Pget_driver(fapl) != H5FD_SEC2) {
+    goto done;
+  }
+  if ((offset = H5Dget_offset(obj)) == HADDR_UNDEF) {
+    goto done;
+  }
+  if ((len = H5Fget_name(obj, NULL, 0)) <= 0 || (filename = HLHDF_MALLOC(len + 1)) == NULL ||
+      H5Fget_name(obj, filename, len + 1) != len) {
+    goto done;
+  }
+  if ((buffer = HLSharedBuffer_map(filename, (size_t)offset, nbytes)) == NULL) {
+    goto done;
+  }
+  if (!HLNodePrivate_setSharedData(node, H5Tget_size(mtype), buffer)) {
+    goto done;
+  }
+  HL_STATS_ADD(bytesMapped, nbytes);
+  result = 1;
+done:
+  HLSharedBuffer_release(buffer);
+  HLHDF_FREE(filename);
+  HL_H5P_CLOSE(fapl);
+  HL_H5F_CLOSE(file_id);
+  HL_H5P_CLOSE(plist);
+  return result;
+}
+
+/**
+ * Fills a dataset node from an open dataset.
+ * @param[in] node the node
+ * @param[in] obj the dataset identifier
+ * @param[in] metaonly if 1, only dimensions, type and format are set, otherwise the data is read as well
+ * @return 1 on success, otherwise 0
+ */
+static int hlhdf_read_fillDataset(HL_Node* node, hid_t obj, int metaonly)
+{
+  HL_FormatSpecifier sharedFormat = HLHDF_UNDEFINED;
   hid_t type = -1;
-  H5G_stat_t statbuf;
   hid_t f_space = -1;
   hid_t mtype = -1;
   int status = 0;
 
-  HL_DEBUG0("ENTER: fillDatasetNode");
-
-  if ((obj = H5Dopen(file_id, HLNode_getName(node), H5P_DEFAULT)) < 0) {
-    goto fail;
-  }
-
   /* What datatype was this dataset stored as? */
   if ((type = H5Dget_type(obj)) < 0) {
     HL_ERROR0("Failed to get type from dataset");
@@ -614,50 +945,40 @@ static int fillDatasetNode(hid_t file_id, HL_Node* node)
 
   /* What size does the type have? */
   if ((f_space = H5Dget_space(obj)) > 0) { /*Get the space description for the dataset */
-    hsize_t* all_dims = NULL;
+    hsize_t all_dims[H5S_MAX_RANK];
     hsize_t npoints;
     int ndims;
 
-    if (!hlhdf_read_getSpaceDimensions(f_space, &ndims, &npoints, &all_dims)) {
+    if (!hlhdf_read_getSpaceDimensions(f_space, &ndims, &npoints, all_dims)) {
       HL_ERROR0("Could not read space dimensions");
       goto fail;
     } else {
       if (!HLNode_setDimensions(node, ndims, all_dims)) {
         HL_ERROR0("Failed to set node dimensions");
-        HLHDF_FREE(all_dims);
         goto fail;
       }
-      HLHDF_FREE(all_dims);
     }
 
     /* Translate the type into a native dataspace */
-    mtype = getFixedType(type);
+    mtype = hlhdf_read_getFixedType(type, &sharedFormat);
 
     if (H5Tget_class(mtype) == H5T_COMPOUND) {
-      HL_CompoundTypeDescription* descr = buildTypeDescriptionFromTypeHid(mtype);
+      HL_CompoundTypeDescription* descr = hlhdf_read_getCompoundDescription(type, mtype);
       if (descr == NULL) {
-        HL_ERROR0("Failed to create compound data description for attribute");
+        HL_ERROR0("Failed to create compound data description for dataset");
         goto fail;
       }
-
-      if (H5Tcommitted(type) > 0) {
-        H5Gget_objinfo(type, ".", TRUE, &statbuf);
-        descr->objno[0] = statbuf.objno[0];
-        descr->objno[1] = statbuf.objno[1];
-      }
-
       HLNode_setCompoundDescription(node, descr);
     }
 
-    if(!HLNodePrivate_setTypeIdAndDeriveFormat(node, mtype)) {
+    if(!hlhdf_read_setFixedType(node, mtype, sharedFormat)) {
       HL_ERROR0("Failed to set type and format");
       goto fail;
     }
 
     /* If we are fetching dataset meta, we need to leave after type has been set. */
-    if (HLNode_getMark(node) == NMARK_SELECTMETA) {
+    if (metaonly) {
       HLNode_setMark(node, NMARK_ORIGINAL);
-      HL_H5D_CLOSE(obj);
       HL_H5T_CLOSE(type);
       HL_H5S_CLOSE(f_space);
       HL_H5T_CLOSE(mtype);
@@ -667,19 +988,45 @@ static int fillDatasetNode(hid_t file_id, HL_Node* node)
     if (H5Sis_simple(f_space) >= 0) { /*Only allow simple dataspace, nothing else supported by HDF5 anyway */
       unsigned char* dataptr = NULL;
       size_t dSize = H5Tget_size(mtype);
-      dataptr = (unsigned char*) HLHDF_MALLOC(dSize * npoints);
-      if (dataptr == NULL) {
+      if (hlhdfMappedReads && hlhdf_read_mapDataset(node, obj, type, mtype, dSize * npoints)) {
+        if (HLNode_getStatisticsOptions(node) != NULL &&
+            HLStatisticsPrivate_isSupported(HLNode_getFormat(node)) &&
+            !HLNode_computeStatistics(node, HLNode_getStatisticsOptions(node))) {
+          goto fail;
+        }
+      } else if ((dataptr = (unsigned char*) HLHDF_MALLOC(dSize * npoints)) == NULL) {
         HL_ERROR0("Failed to allocate memory for dataset arrray");
         goto fail;
+      } else if (HLNode_getStatisticsOptions(node) != NULL &&
+          HLStatisticsPrivate_isSupported(HLNode_getFormat(node))) {
+        HLReadStatisticsContext_t ctx;
+        ctx.options = HLNode_getStatisticsOptions(node);
+        ctx.format = HLNode_getFormat(node);
+        if ((ctx.stats = HLStatisticsPrivate_begin(ctx.options)) == NULL) {
+          HLHDF_FREE(dataptr);
+          goto fail;
+        }
+        if (!readDatasetInSlabs(obj, mtype, dataptr, hlhdf_read_accumulateStatistics, &ctx)) {
+          HL_ERROR0("Failed to read dataset");
+          HLStatistics_free(ctx.stats);
+          HLHDF_FREE(dataptr);
+          goto fail;
+        }
+        HLStatisticsPrivate_end(ctx.stats);
+        HLNodePrivate_setData(node, dSize, dataptr);
+        HLNodePrivate_setStatistics(node, ctx.stats);
+      } else {
+        H5Sselect_all(f_space);
+        if (H5Dread(obj, mtype, H5S_ALL, H5S_ALL, H5P_DEFAULT, dataptr) < 0) {
+          HL_ERROR0("Failed to read dataset");
+          HLHDF_FREE(dataptr);
+          goto fail;
+        }
+        HLNodePrivate_setData(node, dSize, dataptr);
       }
-      H5Sselect_all(f_space);
-      if (H5Dread(obj, mtype, H5S_ALL, H5S_ALL, H5P_DEFAULT, dataptr) < 0) {
-        HL_ERROR0("Failed to read dataset");
-        HLHDF_FREE(dataptr);
-        goto fail;
-      }
-
-      HLNodePrivate_setData(node, dSize, dataptr);
+      HL_STATS_INC(datasetsRead);
+      HL_STATS_ADD(bytesRead, dSize * npoints);
+      HL_STATS_ADD(rawBytesRead, H5Dget_storage_size(obj));
     } else {
       HL_ERROR0("Dataspace for dataset was not simple, this is not supported");
       goto fail;
@@ -695,13 +1042,42 @@ static int fillDatasetNode(hid_t file_id, HL_Node* node)
 
   status = 1;
 fail:
-  HL_H5D_CLOSE(obj);
   HL_H5T_CLOSE(type);
   HL_H5S_CLOSE(f_space);
   HL_H5T_CLOSE(mtype);
   return status;
 }
 
+/**
+ * Fills a dataset node
+ * @param[in] file_id the file
+ * @param[in] node the node
+ * @param[in] dataset the dataset if it already is open, otherwise -1. Not closed.
+ * @param[in] event the traced fetch that should get the filters of the dataset, may be NULL
+ */
+static int fillDatasetNode(hid_t file_id, HL_Node* node, hid_t dataset, HL_TraceEvent* event)
+{
+  hid_t obj = dataset;
+  int status = 0;
+
+  HL_DEBUG0("ENTER: fillDatasetNode");
+
+  if (obj < 0) {
+    if ((obj = H5Dopen(file_id, HLNode_getName(node), H5P_DEFAULT)) < 0) {
+      return 0;
+    }
+    HL_STATS_INC(objectsOpened);
+  }
+  if (event != NULL) {
+    HLTracePrivate_setFilters(event, obj);
+  }
+  status = hlhdf_read_fillDataset(node, obj, HLNode_getMark(node) == NMARK_SELECTMETA);
+  if (obj != dataset) {
+    HL_H5D_CLOSE(obj);
+  }
+  return status;
+}
+
 /**
  * Fills a group node
  */
@@ -712,6 +1088,7 @@ static int fillGroupNode(hid_t file_id, HL_Node* node)
   if ((obj = H5Gopen(file_id, HLNode_getName(node), H5P_DEFAULT)) < 0) {
     return 0;
   }
+  HL_STATS_INC(objectsOpened);
 
   HLNode_setMark(node, NMARK_ORIGINAL);
   HLNode_setFetched(node, 1);
@@ -720,19 +1097,17 @@ static int fillGroupNode(hid_t file_id, HL_Node* node)
   return 1;
 }
 
-/* ---------------------------------------
- * FILL_TYPE_NODE
- * --------------------------------------- */
-static int fillTypeNode(hid_t file_id, HL_Node* node)
+/**
+ * Fills a named datatype node from an open datatype.
+ * @param[in] node the node
+ * @param[in] obj the datatype identifier, kept by the node on success
+ * @return 1 on success, otherwise 0
+ */
+static int hlhdf_read_fillType(HL_Node* node, hid_t obj)
 {
-  hid_t obj = -1;
   HL_CompoundTypeDescription* typelist = NULL;
   H5G_stat_t statbuf;
 
-  if ((obj = H5Topen(file_id, HLNode_getName(node), H5P_DEFAULT)) < 0) {
-    HL_ERROR1("Failed to open %s ", HLNode_getName(node));
-    return 0;
-  }
   H5Gget_objinfo(obj, ".", TRUE, &statbuf);
 
   if (!(typelist = buildTypeDescriptionFromTypeHid(obj))) {
@@ -753,22 +1128,44 @@ static int fillTypeNode(hid_t file_id, HL_Node* node)
   //@todo This causes the file not to be closed when atempting to update a file.
   return 1;
 fail:
-  HL_H5T_CLOSE(obj);
   freeHL_CompoundTypeDescription(typelist);
   return 0;
 }
 
+/* ---------------------------------------
+ * FILL_TYPE_NODE
+ * --------------------------------------- */
+static int fillTypeNode(hid_t file_id, HL_Node* node)
+{
+  hid_t obj = -1;
+
+  if ((obj = H5Topen(file_id, HLNode_getName(node), H5P_DEFAULT)) < 0) {
+    HL_ERROR1("Failed to open %s ", HLNode_getName(node));
+    return 0;
+  }
+  HL_STATS_INC(objectsOpened);
+  if (!hlhdf_read_fillType(node, obj)) {
+    HL_H5T_CLOSE(obj);
+    return 0;
+  }
+  return 1;
+}
+
 /**
  * Fills the node with the appropriate data.
+ * @param[in] file_id the file
+ * @param[in] node the node
+ * @param[in] dataset the dataset of a dataset node if it already is open, otherwise -1
+ * @param[in] event the traced fetch, may be NULL
  */
-static int fillNodeWithData(hid_t file_id, HL_Node* node)
+static int fillNodeWithData(hid_t file_id, HL_Node* node, hid_t dataset, HL_TraceEvent* event)
 {
   HL_SPEWDEBUG0("ENTER: fillNodeWithData");
   switch (HLNode_getType(node)) {
   case ATTRIBUTE_ID:
     return fillAttributeNode(file_id, node);
   case DATASET_ID:
-    return fillDatasetNode(file_id, node);
+    return fillDatasetNode(file_id, node, dataset, event);
   case GROUP_ID:
     return fillGroupNode(file_id, node);
   case TYPE_ID:
@@ -782,6 +1179,63 @@ static int fillNodeWithData(hid_t file_id, HL_Node* node)
   return 0;
 }
 
+/**
+ * Fills the node with data, either from the data cache or from the file. The file
+ * is opened first time it is needed.
+ * @param[in] filename the name of the file
+ * @param[in,out] file_id the file identifier, if < 0 the file will be opened
+ * @param[in] fkey the data cache key for the file, NULL if the cache should not be used
+ * @param[in] node the node to fill
+ * @param[in] dataset the dataset of a dataset node if it already is open, otherwise -1. Not closed.
+ * @return 1 on success, otherwise 0
+ */
+static int fillNodeWithDataCached(const char* filename, hid_t* file_id, HL_DataCacheFileKey* fkey,
+  HL_Node* node, hid_t dataset)
+{
+  int cacheable = 0;
+  int status = 0;
+  int traced = HL_TRACE_ENABLED();
+  double start = HLCountersPrivate_now();
+  unsigned long long bytes = HL_STATS_GET(bytesRead), rawBytes = HL_STATS_GET(rawBytesRead);
+  HL_TraceEvent event;
+  HL_Type type = HLNode_getType(node);
+
+  cacheable = (fkey != NULL &&
+               (type == ATTRIBUTE_ID || (type == DATASET_ID && HLNode_getMark(node) != NMARK_SELECTMETA)));
+  if (cacheable && HLDataCachePrivate_fillNode(fkey, node)) {
+    status = 1;
+    if (type == DATASET_ID && HLNode_getStatisticsOptions(node) != NULL &&
+        HLStatisticsPrivate_isSupported(HLNode_getFormat(node))) {
+      status = HLNode_computeStatistics(node, HLNode_getStatisticsOptions(node));
+    }
+    goto done;
+  }
+
+  if (*file_id < 0 && (*file_id = openHlHdfFile(filename, "r")) < 0) {
+    HL_ERROR1("Could not open file '%s' when fetching data",filename);
+    goto done;
+  }
+  if (traced) {
+    HLTracePrivate_begin(&event, HL_TRACE_FETCH, filename, HLNode_getName(node));
+  }
+  status = fillNodeWithData(*file_id, node, dataset, traced ? &event : NULL);
+  if (traced) {
+    event.bytes = HL_STATS_GET(bytesRead) - bytes;
+    event.rawBytes = HL_STATS_GET(rawBytesRead) - rawBytes;
+    HLTracePrivate_end(&event, status);
+  }
+  if (!status) {
+    goto done;
+  }
+  if (cacheable) {
+    HLDataCachePrivate_addNode(fkey, node);
+  }
+  status = 1;
+done:
+  HL_STATS_ADD_TIME(fetchTime, start);
+  return status;
+}
+
 /**
  * Creates an absolute path from <b>root</b> and <b>name</b> parts.
  * @param[in] root - the root path
@@ -840,6 +1294,295 @@ fail:
   return newpath;
 }
 
+/**
+ * Splits a path into segments. A trailing '/' is ignored so "/" becomes one
+ * empty segment and "/a/b" becomes "", "a" and "b".
+ * @param[in] path the path
+ * @param[out] nsegs the number of segments
+ * @return the segments pointing into path, must be released by caller. NULL on failure.
+ */
+static PathSegment* hlhdf_filter_split(const char* path, int* nsegs)
+{
+  PathSegment* segs = NULL;
+  const char* p = path;
+  size_t len = strlen(path);
+  int n = 1, i = 0;
+
+  if (len > 0 && path[len - 1] == '/') {
+    len--;
+  }
+  for (i = 0; i < (int)len; i++) {
+    if (path[i] == '/') {
+      n++;
+    }
+  }
+  if ((segs = HLHDF_MALLOC(sizeof(PathSegment) * n)) == NULL) {
+    HL_ERROR0("Failed to allocate memory for path segments");
+    return NULL;
+  }
+  for (i = 0; i < n; i++) {
+    const char* e = memchr(p, '/', len - (p - path));
+    if (e == NULL || i == n - 1) {
+      e = path + len;
+    }
+    segs[i].str = p;
+    segs[i].len = e - p;
+    p = e + 1;
+  }
+  *nsegs = n;
+  return segs;
+}
+
+/**
+ * Matches one path segment against a pattern segment where '*' matches any
+ * number of characters and '?' one character.
+ * @param[in] p the pattern segment
+ * @param[in] s the path segment
+ * @return 1 if matching, otherwise 0
+ */
+static int hlhdf_filter_matchSegment(const PathSegment* p, const PathSegment* s)
+{
+  size_t pi = 0, si = 0, star = (size_t)-1, mark = 0;
+
+  while (si < s->len) {
+    if (pi < p->len && (p->str[pi] == '?' || p->str[pi] == s->str[si])) {
+      pi++;
+      si++;
+    } else if (pi < p->len && p->str[pi] == '*') {
+      star = pi++;
+      mark = si;
+    } else if (star != (size_t)-1) {
+      pi = star + 1;
+      si = ++mark;
+    } else {
+      return 0;
+    }
+  }
+  while (pi < p->len && p->str[pi] == '*') {
+    pi++;
+  }
+  return (pi == p->len);
+}
+
+/**
+ * Matches path segments against pattern segments where a "**" segment matches
+ * zero or more path segments.
+ * @param[in] p the pattern segments
+ * @param[in] np number of pattern segments
+ * @param[in] s the path segments
+ * @param[in] ns number of path segments
+ * @param[in] below if 1, matches if some path below s would match instead of s itself
+ * @return 1 if matching, otherwise 0
+ */
+static int hlhdf_filter_matchSegments(const PathSegment* p, int np, const PathSegment* s, int ns, int below)
+{
+  int k = 0;
+  if (np == 0) {
+    return (ns == 0 && !below);
+  }
+  if (p->len == 2 && p->str[0] == '*' && p->str[1] == '*') {
+    if (below) {
+      return 1;
+    }
+    for (k = 0; k <= ns; k++) {
+      if (hlhdf_filter_matchSegments(p + 1, np - 1, s + k, ns - k, below)) {
+        return 1;
+      }
+    }
+    return 0;
+  }
+  if (ns == 0) {
+    return below;
+  }
+  if (!hlhdf_filter_matchSegment(p, s)) {
+    return 0;
+  }
+  return hlhdf_filter_matchSegments(p + 1, np - 1, s + 1, ns - 1, below);
+}
+
+/**
+ * Checks if any pattern of the requested kind matches the path or one of its ancestors.
+ * @param[in] filter the filter
+ * @param[in] exclude 1 to test exclude patterns, 0 to test include patterns
+ * @param[in] segs the path segments
+ * @param[in] nsegs the number of path segments
+ * @param[in] ancestors if ancestors of the path also should be tested
+ * @return 1 if there is a match, otherwise 0
+ */
+static int hlhdf_filter_matches(PathFilter* filter, int exclude, const PathSegment* segs, int nsegs, int ancestors)
+{
+  int i = 0, k = 0;
+  for (i = 0; i < filter->npatterns; i++) {
+    PathPattern* pattern = &filter->patterns[i];
+    if (pattern->exclude != exclude) {
+      continue;
+    }
+    for (k = ancestors ? 1 : nsegs; k <= nsegs; k++) {
+      if (hlhdf_filter_matchSegments(pattern->segs, pattern->nsegs, segs, k, 0)) {
+        return 1;
+      }
+    }
+  }
+  return 0;
+}
+
+/**
+ * Checks if any include pattern might match something below the path.
+ * @param[in] filter the filter
+ * @param[in] segs the path segments
+ * @param[in] nsegs the number of path segments
+ * @return 1 if something below the path might be included, otherwise 0
+ */
+static int hlhdf_filter_includesBelow(PathFilter* filter, const PathSegment* segs, int nsegs)
+{
+  int i = 0;
+  for (i = 0; i < filter->npatterns; i++) {
+    PathPattern* pattern = &filter->patterns[i];
+    if (!pattern->exclude && hlhdf_filter_matchSegments(pattern->segs, pattern->nsegs, segs, nsegs, 1)) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/**
+ * Releases a filter.
+ * @param[in] filter the filter
+ */
+static void hlhdf_filter_free(PathFilter* filter)
+{
+  int i = 0;
+  if (filter != NULL) {
+    for (i = 0; i < filter->npatterns; i++) {
+      HLHDF_FREE(filter->patterns[i].pattern);
+      HLHDF_FREE(filter->patterns[i].segs);
+    }
+    HLHDF_FREE(filter->patterns);
+    HLHDF_FREE(filter);
+  }
+}
+
+/**
+ * Creates a filter from a list of patterns. Patterns prefixed with '!' are exclude patterns
+ * and patterns not starting with '/' are treated as if they did.
+ * @param[in] patterns the patterns
+ * @param[in] npatterns the number of patterns
+ * @return the filter or NULL on failure
+ */
+static PathFilter* hlhdf_filter_new(const char** patterns, int npatterns)
+{
+  PathFilter* filter = NULL;
+  int i = 0;
+
+  if (npatterns < 0 || (npatterns > 0 && patterns == NULL)) {
+    HL_ERROR0("Invalid patterns");
+    return NULL;
+  }
+  if ((filter = HLHDF_MALLOC(sizeof(PathFilter))) == NULL) {
+    HL_ERROR0("Failed to allocate memory for filter");
+    return NULL;
+  }
+  filter->npatterns = 0;
+  filter->nincludes = 0;
+  if ((filter->patterns = HLHDF_CALLOC(npatterns + 1, sizeof(PathPattern))) == NULL) {
+    HL_ERROR0("Failed to allocate memory for filter");
+    HLHDF_FREE(filter);
+    return NULL;
+  }
+  for (i = 0; i < npatterns; i++) {
+    PathPattern* pattern = &filter->patterns[i];
+    const char* str = patterns[i];
+    if (str == NULL) {
+      HL_ERROR1("Pattern %d is NULL", i);
+      goto fail;
+    }
+    if (str[0] == '!') {
+      pattern->exclude = 1;
+      str++;
+    }
+    if ((pattern->pattern = HLHDF_MALLOC(strlen(str) + 2)) == NULL) {
+      HL_ERROR0("Failed to allocate memory for pattern");
+      goto fail;
+    }
+    strcpy(pattern->pattern, (str[0] == '/') ? "" : "/");
+    strcat(pattern->pattern, str);
+    filter->npatterns++;
+    if ((pattern->segs = hlhdf_filter_split(pattern->pattern, &pattern->nsegs)) == NULL) {
+      goto fail;
+    }
+    if (!pattern->exclude) {
+      filter->nincludes++;
+    }
+  }
+  return filter;
+fail:
+  hlhdf_filter_free(filter);
+  return NULL;
+}
+
+/**
+ * Decides what to do with a group, dataset or named datatype when reading with a filter.
+ * An object is excluded together with everything below it if an exclude pattern matches
+ * the object or one of its ancestors. Otherwise it is included if there are no include
+ * patterns or if an include pattern matches it or one of its ancestors.
+ * @param[in] filter the filter, if NULL everything is included
+ * @param[in] path the name of the object
+ * @param[out] included if the object is included
+ * @param[out] visit if the object and its attributes needs to be visited, either because it is
+ * included or because something below it might be included.
+ * @return 1 on success, otherwise 0
+ */
+static int hlhdf_filter_object(PathFilter* filter, const char* path, int* included, int* visit)
+{
+  PathSegment* segs = NULL;
+  int nsegs = 0;
+
+  *included = *visit = 1;
+  if (filter == NULL) {
+    return 1;
+  }
+  if ((segs = hlhdf_filter_split(path, &nsegs)) == NULL) {
+    return 0;
+  }
+  if (hlhdf_filter_matches(filter, 1, segs, nsegs, 1)) {
+    *included = *visit = 0;
+  } else if (filter->nincludes > 0 && !hlhdf_filter_matches(filter, 0, segs, nsegs, 1)) {
+    *included = 0;
+    *visit = hlhdf_filter_includesBelow(filter, segs, nsegs);
+  }
+  HLHDF_FREE(segs);
+  return 1;
+}
+
+/**
+ * Decides if an attribute should be included when reading with a filter.
+ * @param[in] filter the filter, if NULL everything is included
+ * @param[in] path the name of the attribute
+ * @param[in] parentIncluded if the object the attribute belongs to is included
+ * @param[out] included if the attribute is included
+ * @return 1 on success, otherwise 0
+ */
+static int hlhdf_filter_attribute(PathFilter* filter, const char* path, int parentIncluded, int* included)
+{
+  PathSegment* segs = NULL;
+  int nsegs = 0;
+
+  *included = 1;
+  if (filter == NULL) {
+    return 1;
+  }
+  if ((segs = hlhdf_filter_split(path, &nsegs)) == NULL) {
+    return 0;
+  }
+  if (hlhdf_filter_matches(filter, 1, segs, nsegs, 0)) {
+    *included = 0;
+  } else if (!parentIncluded) {
+    *included = hlhdf_filter_matches(filter, 0, segs, nsegs, 0);
+  }
+  HLHDF_FREE(segs);
+  return 1;
+}
+
 /**
  * Called by H5Aiterate_by_name when iterating over all attributes in a group.
  * @param[in] location_id - the root group from where the iterator started
@@ -855,16 +1598,27 @@ static herr_t hlhdf_node_attribute_visitor(hid_t location_id, const char *name,
   char* path = hlhdf_read_createPath(vsp->path, name);
   hid_t attrid = -1;
   hid_t typeid = -1;
+  int included = 1;
+  HL_Node* node = NULL;
 
   if (path == NULL) {
     HL_ERROR0("Could not create path");
     goto fail;
   }
 
+  if (!hlhdf_filter_attribute(vsp->filter, path, vsp->included, &included)) {
+    goto fail;
+  }
+  if (!included) {
+    status = 0;
+    goto fail;
+  }
+
   if ((attrid = H5Aopen(location_id, name, H5P_DEFAULT))<0) {
     HL_ERROR1("Could not open attribute: %s", name);
     goto fail;
   }
+  HL_STATS_INC(objectsOpened);
 
   if ((typeid = H5Aget_type(attrid)) < 0) {
     HL_ERROR1("Could not get type for %s", name);
@@ -872,58 +1626,138 @@ static herr_t hlhdf_node_attribute_visitor(hid_t location_id, const char *name,
   }
 
   if (H5Tget_class(typeid) == H5T_REFERENCE) {
-    HLNodeList_addNode(vsp->nodelist, HLNode_newReference(path));
+    node = HLNode_newReference(path);
   } else {
-    HLNodeList_addNode(vsp->nodelist, HLNode_newAttribute(path));
+    node = HLNode_newAttribute(path);
+  }
+
+  if (vsp->metadata && node != NULL) {
+    int filled = (HLNode_getType(node) == REFERENCE_ID) ?
+        hlhdf_read_fillReference(vsp->file_id, node, attrid) :
+        hlhdf_read_fillAttribute(node, attrid);
+    if (!filled) {
+      HL_ERROR1("Failed to read attribute %s", path);
+      goto fail;
+    }
+  }
+
+  if (HLNodeList_addNode(vsp->nodelist, node)) {
+    node = NULL;
   }
 
   status = 0;
 fail:
   HL_H5A_CLOSE(attrid);
   HL_H5T_CLOSE(typeid);
+  HLNode_free(node);
   HLHDF_FREE(path);
   return status;
 }
 
 /**
- * Called by H5Ovisit_by_name when iterating over all group/dataasets.
- * @param[in] location_id - the root group from where the iterator started
- * @param[in] name - the name of the attribute
- * @param[in] info - the object info
- * @param[in] op_data - the \ref VisitorStruct
+ * Marks an object as visited.
+ * @param[in] visited the visited objects
+ * @param[in] addr the object
+ * @return 1 if the object was marked, 0 if it already had been visited and -1 on failure
+ */
+static int hlhdf_read_markVisited(VisitedObjects* visited, const HLObjectAddr* addr)
+{
+  int i = 0;
+  for (i = 0; i < visited->nobjs; i++) {
+    if (memcmp(&visited->objs[i], addr, sizeof(HLObjectAddr)) == 0) {
+      return 0;
+    }
+  }
+  if (visited->nobjs == visited->nalloc) {
+    int nalloc = (visited->nalloc == 0) ? 16 : visited->nalloc * 2;
+    HLObjectAddr* objs = HLHDF_REALLOC(visited->objs, nalloc * sizeof(HLObjectAddr));
+    if (objs == NULL) {
+      HL_ERROR0("Failed to allocate memory for visited objects");
+      return -1;
+    }
+    visited->objs = objs;
+    visited->nalloc = nalloc;
+  }
+  memcpy(&visited->objs[visited->nobjs++], addr, sizeof(HLObjectAddr));
+  return 1;
+}
+
+static herr_t hlhdf_link_visitor(hid_t g_id, const char *name, const H5L_info_t *info, void *op_data);
+
+/**
+ * Adds the node for a group, dataset or named datatype and its attributes. When the read is
+ * walked link by link the members of a group are visited as well.
+ * @param[in] vsp the \ref VisitorStruct of the parent
+ * @param[in] g_id the location the name is relative to
+ * @param[in] name the name of the object
+ * @param[in] path the full name of the object, taken over by this function
+ * @param[in] type the object type
+ * @param[in] included if the object is included by the filter
  * @return -1 on failure, otherwise 0.
  */
-static herr_t hlhdf_node_visitor(hid_t g_id, const char *name, const H5O_info_t *info, void *op_data)
+static herr_t hlhdf_read_visitObject(VisitorStruct* vsp, hid_t g_id, const char* name, char* path,
+  H5O_type_t type, int included)
 {
-  VisitorStruct* vsp = (VisitorStruct*)op_data;
   VisitorStruct vs;
   herr_t status = -1;
-  char* path = hlhdf_read_createPath(vsp->path, name);
-
-  if (path == NULL) {
-    HL_ERROR0("Could not create path");
-    goto fail;
-  }
 
   vs.nodelist = vsp->nodelist;
   vs.path = path;
-  switch (info->type) {
+  vs.filter = vsp->filter;
+  vs.included = included;
+  vs.metadata = vsp->metadata;
+  vs.file_id = vsp->file_id;
+  vs.visited = vsp->visited;
+
+  // Groups and datasets that are not included but might have included nodes
+  // below them are added anyway since the tree structure must be complete.
+  switch (type) {
   case H5O_TYPE_GROUP: {
     hsize_t n=0;
     // The visitor also visits the root-node but that is not a valid
     // node to write since it always should exist.
     if (strcmp("/", path) != 0) {
-      HLNodeList_addNode(vsp->nodelist, HLNode_newGroup(vs.path));
+      HL_Node* node = HLNode_newGroup(vs.path);
+      if (vsp->metadata && node != NULL) {
+        HLNode_setFetched(node, 1);
+      }
+      if (!HLNodeList_addNode(vsp->nodelist, node)) {
+        HLNode_free(node);
+      }
     }
     if (H5Aiterate_by_name(g_id, name, H5_INDEX_NAME, H5_ITER_INC, &n, hlhdf_node_attribute_visitor, &vs, H5P_DEFAULT) < 0) {
       HL_ERROR1("Failed to iterate over %s", vs.path);
       goto fail;
     }
+    if (vs.visited != NULL) {
+      n = 0;
+      if (H5Literate_by_name(g_id, name, H5_INDEX_NAME, H5_ITER_INC, &n, hlhdf_link_visitor, &vs, H5P_DEFAULT) < 0) {
+        HL_ERROR1("Failed to iterate over members of %s", vs.path);
+        goto fail;
+      }
+    }
     break;
   }
   case H5O_TYPE_DATASET: {
     hsize_t n=0;
-    HLNodeList_addNode(vsp->nodelist, HLNode_newDataset(vs.path));
+    HL_Node* node = HLNode_newDataset(vs.path);
+    if (vsp->metadata && node != NULL) {
+      hid_t obj = H5Dopen(g_id, name, H5P_DEFAULT);
+      int filled = 0;
+      if (obj >= 0) {
+        HL_STATS_INC(objectsOpened);
+        filled = hlhdf_read_fillDataset(node, obj, 1);
+      }
+      HL_H5D_CLOSE(obj);
+      if (!filled) {
+        HL_ERROR1("Failed to read dataset %s", vs.path);
+        HLNode_free(node);
+        goto fail;
+      }
+    }
+    if (!HLNodeList_addNode(vsp->nodelist, node)) {
+      HLNode_free(node);
+    }
     if (H5Aiterate_by_name(g_id,  name, H5_INDEX_NAME, H5_ITER_INC, &n, hlhdf_node_attribute_visitor, &vs, H5P_DEFAULT) < 0) {
       HL_ERROR1("Failed to iterate over %s", vs.path);
       goto fail;
@@ -931,7 +1765,24 @@ static herr_t hlhdf_node_visitor(hid_t g_id, const char *name, const H5O_info_t
     break;
   }
   case H5O_TYPE_NAMED_DATATYPE: {
-    HLNodeList_addNode(vsp->nodelist, HLNode_newDatatype(vs.path));
+    if (vs.included) {
+      HL_Node* node = HLNode_newDatatype(vs.path);
+      if (vsp->metadata && node != NULL) {
+        hid_t obj = H5Topen(g_id, name, H5P_DEFAULT);
+        if (obj >= 0) {
+          HL_STATS_INC(objectsOpened);
+        }
+        if (obj < 0 || !hlhdf_read_fillType(node, obj)) {
+          HL_ERROR1("Failed to read datatype %s", vs.path);
+          HL_H5T_CLOSE(obj);
+          HLNode_free(node);
+          goto fail;
+        }
+      }
+      if (!HLNodeList_addNode(vsp->nodelist, node)) {
+        HLNode_free(node);
+      }
+    }
     break;
   }
   default: {
@@ -945,32 +1796,136 @@ fail:
   return status;
 }
 
-/*@} End of Private functions */
+/**
+ * Called by H5Ovisit_by_name when iterating over all group/dataasets.
+ * @param[in] location_id - the root group from where the iterator started
+ * @param[in] name - the name of the attribute
+ * @param[in] info - the object info
+ * @param[in] op_data - the \ref VisitorStruct
+ * @return -1 on failure, otherwise 0.
+ */
+static herr_t hlhdf_node_visitor(hid_t g_id, const char *name, const H5O_info_t *info, void *op_data)
+{
+  VisitorStruct* vsp = (VisitorStruct*)op_data;
+  char* path = hlhdf_read_createPath(vsp->path, name);
+  int included = 1, visit = 1;
 
-/*@{ Interface functions */
-HL_NodeList* HLNodeList_readFrom(const char* filename, const char* fromPath)
+  if (path == NULL) {
+    HL_ERROR0("Could not create path");
+    return -1;
+  }
+  if (!hlhdf_filter_object(vsp->filter, path, &included, &visit)) {
+    HLHDF_FREE(path);
+    return -1;
+  }
+  if (!visit) {
+    HLHDF_FREE(path);
+    return 0;
+  }
+  return hlhdf_read_visitObject(vsp, g_id, name, path, info->type, included);
+}
+
+/**
+ * Called by H5Literate_by_name for each member of a group during a filtered read. The filter
+ * is applied to the name of the link before the object is opened, so nothing in a subtree
+ * that can't contain any included node is read. Like H5Ovisit only hard links are followed
+ * and an object with several links is only visited the first time.
+ * @param[in] g_id - the group
+ * @param[in] name - the name of the link
+ * @param[in] info - the link info
+ * @param[in] op_data - the \ref VisitorStruct of the group
+ * @return -1 on failure, otherwise 0.
+ */
+static herr_t hlhdf_link_visitor(hid_t g_id, const char *name, const H5L_info_t *info, void *op_data)
+{
+  VisitorStruct* vsp = (VisitorStruct*)op_data;
+  char* path = NULL;
+  H5O_info_t objectInfo;
+  int included = 1, visit = 1;
+
+  if (info->type != H5L_TYPE_HARD) {
+    return 0;
+  }
+  if ((path = hlhdf_read_createPath(vsp->path, name)) == NULL) {
+    HL_ERROR0("Could not create path");
+    return -1;
+  }
+  if (!hlhdf_filter_object(vsp->filter, path, &included, &visit)) {
+    HLHDF_FREE(path);
+    return -1;
+  }
+  if (!visit) {
+    HLHDF_FREE(path);
+    return 0;
+  }
+  if (HLHDF_GET_BASIC_INFO(g_id, name, &objectInfo) < 0) {
+    HL_ERROR1("Could not get object info for %s", path);
+    HLHDF_FREE(path);
+    return -1;
+  }
+  if (objectInfo.rc > 1) {
+    int marked = hlhdf_read_markVisited(vsp->visited, &HLHDF_OBJECT_ADDR(objectInfo));
+    if (marked <= 0) {
+      HLHDF_FREE(path);
+      return marked;
+    }
+  }
+  return hlhdf_read_visitObject(vsp, g_id, name, path, objectInfo.type, included);
+}
+
+/**
+ * Reads the structure of a file from fromPath and downwards.
+ * @param[in] filename the name of the HDF5 file
+ * @param[in] fromPath the path from where the file should be read
+ * @param[in] filter the filter deciding what nodes to read, NULL for all nodes
+ * @param[in] metadata if attribute values and dataset dimensions, type and format should be read
+ * @return the read data structure on success, otherwise NULL.
+ */
+static HL_NodeList* hlhdf_read_nodelist(const char* filename, const char* fromPath, PathFilter* filter, int metadata)
 {
   hid_t file_id = -1, gid = -1;
   HL_NodeList* retv = NULL;
   VisitorStruct vs;
+  VisitedObjects visited = {0, 0, NULL};
   H5O_info_t objectInfo;
+  struct stat st;
+  int inMemory = 0;
+  double start = HLCountersPrivate_now();
+  int traced = HL_TRACE_ENABLED();
+  HL_TraceEvent event;
 
   HL_DEBUG0("ENTER: readHL_NodeListFrom");
+  if (traced) {
+    HLTracePrivate_begin(&event, HL_TRACE_TRAVERSE, filename, fromPath);
+  }
 
   if (fromPath == NULL) {
     HL_ERROR0("fromPath == NULL");
     goto fail;
   }
 
-  if ((file_id = openHlHdfFile(filename, "r")) < 0) {
+  if (filter == NULL && !metadata && (retv = HLIndexPrivate_load(filename, fromPath)) != NULL) {
+    HL_STATS_ADD_TIME(traverseTime, start);
+    if (traced) {
+      HLTracePrivate_end(&event, 1);
+    }
+    HL_DEBUG0("EXIT: readHL_NodeListFrom using index");
+    return retv;
+  }
+
+  if (hlhdfWholeFileReadLimit > 0 && stat(filename, &st) == 0 &&
+      (size_t)st.st_size <= hlhdfWholeFileReadLimit) {
+    /* Fails if the file already is open with another driver in this process */
+    inMemory = ((file_id = openHlHdfFileInMemory(filename)) >= 0);
+  }
+  if (file_id < 0) {
+    file_id = openHlHdfFile(filename, "r");
+  }
+  if (file_id < 0) {
     HL_ERROR1("Failed to open file %s",filename);
     goto fail;
   }
-#ifdef USE_HDF5_1_12_API    
-  if (H5Oget_info_by_name(file_id, fromPath, &objectInfo, H5O_INFO_ALL, H5P_DEFAULT)<0) {
-#else
-  if (H5Oget_info_by_name(file_id, fromPath, &objectInfo, H5P_DEFAULT)<0) {
-#endif  
+  if (HLHDF_GET_BASIC_INFO(file_id, fromPath, &objectInfo)<0) {
     HL_ERROR0("fromPath needs to be a dataset or group when opening a file.");
     goto fail;
   }
@@ -983,31 +1938,351 @@ HL_NodeList* HLNodeList_readFrom(const char* filename, const char* fromPath)
 
   vs.path = (char*)fromPath;
   vs.nodelist = retv;
-
-#ifdef USE_HDF5_1_12_API 
-  if (H5Ovisit_by_name(file_id, fromPath, H5_INDEX_NAME, H5_ITER_INC, hlhdf_node_visitor, &vs, H5O_INFO_ALL, H5P_DEFAULT)<0) {
+  vs.filter = filter;
+  vs.included = 1;
+  vs.metadata = metadata;
+  vs.file_id = file_id;
+  vs.visited = NULL;
+
+  if (filter != NULL) {
+    /* H5Ovisit can't be told to skip a subtree, so filtered reads walk the groups themselves
+     * and never descend into groups where nothing can be included */
+    char* path = hlhdf_read_createPath(fromPath, ".");
+    int included = 1, visit = 1;
+    vs.visited = &visited;
+    if (path == NULL || !hlhdf_filter_object(filter, path, &included, &visit) ||
+        (objectInfo.rc > 1 && hlhdf_read_markVisited(&visited, &HLHDF_OBJECT_ADDR(objectInfo)) < 0)) {
+      HLHDF_FREE(path);
+      goto fail;
+    }
+    if (!visit) {
+      HLHDF_FREE(path);
+    } else if (hlhdf_read_visitObject(&vs, file_id, fromPath, path, objectInfo.type, included) < 0) {
+      HL_ERROR0("Could not iterate over file");
+      goto fail;
+    }
+#ifdef USE_HDF5_1_12_API
+  } else if (H5Ovisit_by_name(file_id, fromPath, H5_INDEX_NAME, H5_ITER_INC, hlhdf_node_visitor, &vs, H5O_INFO_BASIC, H5P_DEFAULT)<0) {
+#elif H5_VERSION_GE(1,10,3)
+  } else if (H5Ovisit_by_name2(file_id, fromPath, H5_INDEX_NAME, H5_ITER_INC, hlhdf_node_visitor, &vs, H5O_INFO_BASIC, H5P_DEFAULT)<0) {
 #else
-  if (H5Ovisit_by_name(file_id, fromPath, H5_INDEX_NAME, H5_ITER_INC, hlhdf_node_visitor, &vs, H5P_DEFAULT)<0) {
-#endif  
+  } else if (H5Ovisit_by_name(file_id, fromPath, H5_INDEX_NAME, H5_ITER_INC, hlhdf_node_visitor, &vs, H5P_DEFAULT)<0) {
+#endif
     HL_ERROR0("Could not iterate over file");
     goto fail;
   }
 
   HLNodeList_markNodes(retv, NMARK_ORIGINAL);
+  if (filter == NULL) {
+    HLIndexPrivate_store(retv, fromPath);
+  }
+  if (inMemory) {
+    /* Keep the file image so that later fetches are served from memory */
+    HLNodeListPrivate_setFileImage(retv, file_id, (size_t)st.st_size);
+    file_id = -1;
+  }
 
   HL_H5F_CLOSE(file_id);
   HL_H5G_CLOSE(gid);
+  HLHDF_FREE(visited.objs);
+  HL_STATS_ADD_TIME(traverseTime, start);
+  if (traced) {
+    HLTracePrivate_end(&event, 1);
+  }
   HL_DEBUG0("EXIT: readHL_NodeListFrom ");
   return retv;
 
 fail:
   HL_H5F_CLOSE(file_id);
   HL_H5G_CLOSE(gid);
+  HLHDF_FREE(visited.objs);
   HLNodeList_free(retv);
+  HL_STATS_ADD_TIME(traverseTime, start);
+  if (traced) {
+    HLTracePrivate_end(&event, 0);
+  }
   HL_DEBUG0("EXIT: readHL_NodeListFrom with Error");
   return NULL;
 }
 
+/**
+ * Returns the address in the file where the data of a dataset begins. For chunked datasets
+ * this is the address of the first chunk and for compact datasets the data is stored
+ * in the object header so 0 is returned. H5Dget_chunk_info is available from HDF5 1.10.5,
+ * with older versions the address of chunked datasets is unknown.
+ * @param[in] file_id the file identifier
+ * @param[in] name the name of the dataset
+ * @param[out] dataset the opened dataset (<b>caller takes ownership</b>) or -1 if it could not be opened
+ * @return the address or HADDR_UNDEF if the dataset has no data stored, the address is unknown or on failure
+ */
+static haddr_t hlhdf_read_getStorageAddress(hid_t file_id, const char* name, hid_t* dataset)
+{
+  hid_t obj = -1, plist = -1, space = -1;
+  haddr_t addr = HADDR_UNDEF;
+#if H5_VERSION_GE(1,10,5)
+  hsize_t size = 0;
+  unsigned filter_mask = 0;
+#endif
+
+  /* Errors are reported when the node is fetched */
+  H5E_BEGIN_TRY {
+    if ((obj = H5Dopen(file_id, name, H5P_DEFAULT)) >= 0 && (plist = H5Dget_create_plist(obj)) >= 0) {
+      switch (H5Pget_layout(plist)) {
+      case H5D_CONTIGUOUS:
+        addr = H5Dget_offset(obj);
+        break;
+      case H5D_CHUNKED:
+#if H5_VERSION_GE(1,10,5)
+        if ((space = H5Dget_space(obj)) < 0 ||
+            H5Dget_chunk_info(obj, space, 0, NULL, &filter_mask, &addr, &size) < 0) {
+          addr = HADDR_UNDEF;
+        }
+#endif
+        break;
+      case H5D_COMPACT:
+        addr = 0;
+        break;
+      default:
+        break;
+      }
+    }
+  } H5E_END_TRY;
+  if (obj >= 0) {
+    HL_STATS_INC(objectsOpened);
+  }
+  HL_H5S_CLOSE(space);
+  HL_H5P_CLOSE(plist);
+  *dataset = obj;
+  return addr;
+}
+
+/**
+ * Compares two fetch order entries by address and then by index.
+ * @param[in] a the first entry
+ * @param[in] b the second entry
+ * @return < 0, 0 or > 0
+ */
+static int hlhdf_read_compareFetchOrder(const void* a, const void* b)
+{
+  const FetchOrderEntry* ea = (const FetchOrderEntry*)a;
+  const FetchOrderEntry* eb = (const FetchOrderEntry*)b;
+  if (ea->addr != eb->addr) {
+    return (ea->addr < eb->addr) ? -1 : 1;
+  }
+  return ea->index - eb->index;
+}
+
+/**
+ * Decides in which order the nodes should be fetched. Attributes, groups, datasets that
+ * are served by the data cache and other nodes that are read from the object headers come
+ * first in nodelist order, followed by the datasets ordered by where their data is stored
+ * in the file. That way the dataset reads become a mostly sequential scan of the file
+ * instead of seeking back and forth in name order. Datasets whose address is unknown come
+ * last in nodelist order. The file is only opened when there is more than one dataset to
+ * order, and the datasets are then left open in the entries so that they are not opened
+ * again when fetched.
+ * @param[in] filename the name of the file
+ * @param[in,out] file_id the file identifier, if < 0 the file will be opened when needed
+ * @param[in] fkey the data cache key for the file, may be NULL
+ * @param[in] nodes the nodes to fetch
+ * @param[in] nnodes the number of nodes
+ * @return the nodes in the order to fetch them (<b>caller takes ownership</b>, release with
+ * \ref hlhdf_read_freeFetchOrder) or NULL on failure
+ */
+static FetchOrderEntry* hlhdf_read_createFetchOrder(const char* filename, hid_t* file_id,
+  HL_DataCacheFileKey* fkey, HL_Node** nodes, int nnodes)
+{
+  FetchOrderEntry* entries = NULL;
+  int i, ndatasets = 0;
+
+  if ((entries = HLHDF_MALLOC(sizeof(FetchOrderEntry) * (nnodes > 0 ? nnodes : 1))) == NULL) {
+    HL_ERROR0("Failed to allocate memory for fetch order");
+    return NULL;
+  }
+  for (i = 0; i < nnodes; i++) {
+    entries[i].addr = 0;
+    entries[i].index = i;
+    entries[i].dataset = -1;
+    entries[i].ordered = (HLNode_getType(nodes[i]) == DATASET_ID &&
+                          HLNode_getMark(nodes[i]) == NMARK_SELECT &&
+                          !HLDataCachePrivate_containsNode(fkey, nodes[i]));
+    ndatasets += entries[i].ordered;
+  }
+  if (ndatasets < 2) {
+    return entries;
+  }
+  if (*file_id < 0 && (*file_id = openHlHdfFile(filename, "r")) < 0) {
+    return entries; /* Reported when the nodes are fetched */
+  }
+  for (i = 0; i < nnodes; i++) {
+    if (entries[i].ordered) {
+      entries[i].addr = hlhdf_read_getStorageAddress(*file_id, HLNode_getName(nodes[i]), &entries[i].dataset);
+    }
+  }
+  qsort(entries, nnodes, sizeof(FetchOrderEntry), hlhdf_read_compareFetchOrder);
+  return entries;
+}
+
+/**
+ * Closes the datasets that still are open and releases the fetch order.
+ * @param[in] entries the fetch order, may be NULL
+ * @param[in] nnodes the number of nodes
+ */
+static void hlhdf_read_freeFetchOrder(FetchOrderEntry* entries, int nnodes)
+{
+  int i;
+  if (entries != NULL) {
+    for (i = 0; i < nnodes; i++) {
+      HL_H5D_CLOSE(entries[i].dataset);
+    }
+    HLHDF_FREE(entries);
+  }
+}
+
+/**
+ * Locks the fetch handle.
+ * @param[in] handle the fetch handle
+ */
+static void HLFetchInternal_lock(HL_FetchHandle* handle)
+{
+#ifdef H5_HAVE_THREADSAFE
+  pthread_mutex_lock(&handle->lock);
+#endif
+}
+
+/**
+ * Unlocks the fetch handle.
+ * @param[in] handle the fetch handle
+ */
+static void HLFetchInternal_unlock(HL_FetchHandle* handle)
+{
+#ifdef H5_HAVE_THREADSAFE
+  pthread_mutex_unlock(&handle->lock);
+#endif
+}
+
+/**
+ * Waits for the next node to complete. Must be called with the handle locked.
+ * @param[in] handle the fetch handle
+ */
+static void HLFetchInternal_waitForChange(HL_FetchHandle* handle)
+{
+#ifdef H5_HAVE_THREADSAFE
+  pthread_cond_wait(&handle->cond, &handle->lock);
+#endif
+}
+
+/**
+ * Records the outcome of one node and notifies waiters and the callback.
+ * @param[in] handle the fetch handle
+ * @param[in] index the index of the node
+ * @param[in] status 1 if the node was fetched, otherwise 0
+ */
+static void HLFetchInternal_complete(HL_FetchHandle* handle, int index, int status)
+{
+  HLFetchInternal_lock(handle);
+  handle->states[index] = status ? 1 : -1;
+  handle->ncompleted++;
+#ifdef H5_HAVE_THREADSAFE
+  pthread_cond_broadcast(&handle->cond);
+#endif
+  HLFetchInternal_unlock(handle);
+  if (handle->callback != NULL) {
+    handle->callback(handle->nodes[index], status, handle->userdata);
+  }
+}
+
+/**
+ * Fetches the nodes of the handle, runs on the I/O thread. When a node fails, the
+ * remaining nodes are reported as failed without being read.
+ * @param[in] arg the fetch handle
+ * @return NULL
+ */
+static void* HLFetchInternal_run(void* arg)
+{
+  HL_FetchHandle* handle = (HL_FetchHandle*)arg;
+  HL_DataCacheFileKey* fkey = NULL;
+  hid_t file_id = -1;
+  FetchOrderEntry* order = NULL;
+  int i, status = 1;
+
+  H5Eset_auto2(H5E_DEFAULT, handle->efunc, handle->edata);
+  fkey = HLDataCachePrivate_createFileKey(handle->filename);
+  if ((order = hlhdf_read_createFetchOrder(handle->filename, &file_id, fkey, handle->nodes, handle->nnodes)) == NULL) {
+    status = 0;
+  }
+  for (i = 0; i < handle->nnodes; i++) {
+    int index = (order != NULL) ? order[i].index : i;
+    hid_t dataset = (order != NULL) ? order[i].dataset : -1;
+    if (status && !fillNodeWithDataCached(handle->filename, &file_id, fkey, handle->nodes[index], dataset)) {
+      HL_ERROR1("Error occured when trying to fill node '%s'", HLNode_getName(handle->nodes[index]));
+      status = 0;
+      HLFetchInternal_complete(handle, index, 0);
+    } else {
+      if (status && HLNode_getType(handle->nodes[index]) == DATASET_ID) {
+        HLNodeList_enforceMemoryBudget(handle->nodelist, handle->nodes[index]);
+      }
+      HLFetchInternal_complete(handle, index, status);
+    }
+    if (order != NULL) {
+      HL_H5D_CLOSE(order[i].dataset);
+    }
+  }
+  hlhdf_read_freeFetchOrder(order, handle->nnodes);
+  HL_H5F_CLOSE(file_id);
+  HLDataCachePrivate_freeFileKey(fkey);
+
+  HLFetchInternal_lock(handle);
+  handle->status = status;
+  handle->done = 1;
+#ifdef H5_HAVE_THREADSAFE
+  pthread_cond_broadcast(&handle->cond);
+#endif
+  HLFetchInternal_unlock(handle);
+  return NULL;
+}
+
+/*@} End of Private functions */
+
+/*@{ Interface functions */
+void HL_setWholeFileReadLimit(size_t limit)
+{
+  hlhdfWholeFileReadLimit = limit;
+}
+
+size_t HL_getWholeFileReadLimit(void)
+{
+  return hlhdfWholeFileReadLimit;
+}
+
+void HL_setMemoryMappedReads(int enable)
+{
+  hlhdfMappedReads = (enable != 0);
+}
+
+int HL_getMemoryMappedReads(void)
+{
+  return hlhdfMappedReads;
+}
+
+HL_NodeList* HLNodeList_readFrom(const char* filename, const char* fromPath)
+{
+  return hlhdf_read_nodelist(filename, fromPath, NULL, 0);
+}
+
+HL_NodeList* HLNodeList_readFromFiltered(const char* filename, const char* fromPath, const char** patterns, int npatterns)
+{
+  HL_NodeList* retv = NULL;
+  PathFilter* filter = NULL;
+
+  if ((filter = hlhdf_filter_new(patterns, npatterns)) == NULL) {
+    return NULL;
+  }
+  retv = hlhdf_read_nodelist(filename, fromPath, filter, 0);
+  hlhdf_filter_free(filter);
+  return retv;
+}
+
 /* ---------------------------------------
  * READ_HL_NODE_LIST
  * --------------------------------------- */
@@ -1022,6 +2297,11 @@ HL_NodeList* HLNodeList_read(const char* filename)
   return retv;
 }
 
+HL_NodeList* HLNodeList_readWithMetadata(const char* filename)
+{
+  return hlhdf_read_nodelist(filename, ".", NULL, 1);
+}
+
 /* ---------------------------------------
  * SELECT_NODE
  * --------------------------------------- */
@@ -1146,9 +2426,11 @@ int HLNodeList_fetchMarkedNodes(HL_NodeList* nodelist)
 {
   int i;
   hid_t file_id = -1;
-  hid_t gid = -1;
   char* filename = NULL;
-  int nNodes = 0;
+  HL_DataCacheFileKey* fkey = NULL;
+  HL_Node** nodes = NULL;
+  FetchOrderEntry* order = NULL;
+  int nNodes = 0, nMarked = 0;
   int result = 0;
 
   HL_DEBUG0("ENTER: fetchMarkedNodes");
@@ -1162,21 +2444,18 @@ int HLNodeList_fetchMarkedNodes(HL_NodeList* nodelist)
     goto fail;
   }
 
-  if ((file_id = openHlHdfFile(filename, "r")) < 0) {
-    HL_ERROR1("Could not open file '%s' when fetching data",filename);
-    goto fail;
-  }
-
-  if ((gid = H5Gopen(file_id, ".", H5P_DEFAULT)) < 0) {
-    HL_ERROR0("Could not open root group\n");
-    goto fail;
-  }
+  fkey = HLDataCachePrivate_createFileKey(filename);
+  file_id = HLNodeListPrivate_getFile(nodelist);
 
   if ((nNodes =  HLNodeList_getNumberOfNodes(nodelist)) < 0) {
     HL_ERROR0("Failed to get number of nodes");
     goto fail;
   }
 
+  if ((nodes = HLHDF_MALLOC(sizeof(HL_Node*) * (nNodes > 0 ? nNodes : 1))) == NULL) {
+    HL_ERROR0("Failed to allocate memory for nodes");
+    goto fail;
+  }
   for (i = 0; i < nNodes; i++) {
     HL_Node* node = NULL;
     if ((node = HLNodeList_getNodeByIndex(nodelist, i)) == NULL) {
@@ -1184,16 +2463,30 @@ int HLNodeList_fetchMarkedNodes(HL_NodeList* nodelist)
       goto fail;
     }
     if (HLNode_getMark(node) == NMARK_SELECT || HLNode_getMark(node) == NMARK_SELECTMETA) {
-      if (!fillNodeWithData(file_id, node)) {
-        HL_ERROR1("Error occured when trying to fill node '%s'",HLNode_getName(node));
-        goto fail;
-      }
+      nodes[nMarked++] = node;
+    }
+  }
+
+  if ((order = hlhdf_read_createFetchOrder(filename, &file_id, fkey, nodes, nMarked)) == NULL) {
+    goto fail;
+  }
+  for (i = 0; i < nMarked; i++) {
+    HL_Node* node = nodes[order[i].index];
+    if (!fillNodeWithDataCached(filename, &file_id, fkey, node, order[i].dataset)) {
+      HL_ERROR1("Error occured when trying to fill node '%s'",HLNode_getName(node));
+      goto fail;
+    }
+    HL_H5D_CLOSE(order[i].dataset);
+    if (HLNode_getType(node) == DATASET_ID) {
+      HLNodeListPrivate_enforceMemoryBudget(nodelist, node, &file_id);
     }
   }
   result = 1;
 fail:
-  HL_H5F_CLOSE(file_id);
-  HL_H5G_CLOSE(gid);
+  hlhdf_read_freeFetchOrder(order, nMarked);
+  HLHDF_FREE(nodes);
+  HLNodeListPrivate_releaseFile(nodelist, &file_id);
+  HLDataCachePrivate_freeFileKey(fkey);
   HLHDF_FREE(filename);
   HL_DEBUG1("EXIT: fetchMarkedNodes with status = %d", result);
   return result;
@@ -1208,6 +2501,7 @@ HL_Node* HLNodeList_fetchNode(HL_NodeList* nodelist, const char* name)
   HL_Node* result = NULL;
   HL_Node* foundnode = NULL;
   char* filename = NULL;
+  HL_DataCacheFileKey* fkey = NULL;
 
   HL_DEBUG0("ENTER: fetchNode");
   if (name == NULL || nodelist == NULL) {
@@ -1224,23 +2518,316 @@ HL_Node* HLNodeList_fetchNode(HL_NodeList* nodelist, const char* name)
     goto fail;
   }
 
-  if ((file_id = openHlHdfFile(filename, "r")) < 0) {
-    HL_ERROR1("Could not open file '%s' when fetching data",filename);
-    goto fail;
-  }
+  fkey = HLDataCachePrivate_createFileKey(filename);
+  file_id = HLNodeListPrivate_getFile(nodelist);
 
-  if (!fillNodeWithData(file_id, foundnode)) {
+  if (!fillNodeWithDataCached(filename, &file_id, fkey, foundnode, -1)) {
     HL_ERROR1("Error occured when trying to fill node '%s'", name);
     goto fail;
   }
+  HLNodeListPrivate_enforceMemoryBudget(nodelist, foundnode, &file_id);
 
   result = foundnode;
 fail:
-  HL_H5F_CLOSE(file_id);
+  HLNodeListPrivate_releaseFile(nodelist, &file_id);
+  HLDataCachePrivate_freeFileKey(fkey);
   HLHDF_FREE(filename);
   HL_DEBUG0("EXIT: fetchNode");
   return result;
 }
+
+HL_FetchHandle* HLNodeList_fetchMarkedNodesAsync(HL_NodeList* nodelist, HL_FetchCallback callback, void* userdata)
+{
+  HL_FetchHandle* handle = NULL;
+  int i, nNodes = 0;
+
+  HL_DEBUG0("ENTER: fetchMarkedNodesAsync");
+  if (nodelist == NULL) {
+    HL_ERROR0("Inparameters NULL");
+    goto fail;
+  }
+  if ((nNodes = HLNodeList_getNumberOfNodes(nodelist)) < 0) {
+    HL_ERROR0("Failed to get number of nodes");
+    goto fail;
+  }
+
+  handle = HLHDF_MALLOC(sizeof(HL_FetchHandle));
+  if (handle == NULL) {
+    HL_ERROR0("Failed to allocate memory for fetch handle");
+    goto fail;
+  }
+  memset(handle, 0, sizeof(HL_FetchHandle));
+  handle->nodelist = nodelist;
+  handle->callback = callback;
+  handle->userdata = userdata;
+  if ((handle->filename = HLNodeList_getFileName(nodelist)) == NULL) {
+    HL_ERROR0("Could not get filename from nodelist");
+    goto fail;
+  }
+  handle->nodes = (HL_Node**)HLHDF_MALLOC(sizeof(HL_Node*) * (nNodes > 0 ? nNodes : 1));
+  handle->states = (int*)HLHDF_MALLOC(sizeof(int) * (nNodes > 0 ? nNodes : 1));
+  if (handle->nodes == NULL || handle->states == NULL) {
+    HL_ERROR0("Failed to allocate memory for fetch handle");
+    goto fail;
+  }
+  for (i = 0; i < nNodes; i++) {
+    HL_Node* node = HLNodeList_getNodeByIndex(nodelist, i);
+    if (node == NULL) {
+      HL_ERROR1("Error occured when fetching node at index %d", i);
+      goto fail;
+    }
+    if (HLNode_getMark(node) == NMARK_SELECT || HLNode_getMark(node) == NMARK_SELECTMETA) {
+      handle->states[handle->nnodes] = 0;
+      handle->nodes[handle->nnodes++] = node;
+    }
+  }
+  H5Eget_auto2(H5E_DEFAULT, &handle->efunc, &handle->edata);
+
+#ifdef H5_HAVE_THREADSAFE
+  pthread_mutex_init(&handle->lock, NULL);
+  pthread_cond_init(&handle->cond, NULL);
+  if (handle->nnodes > 0 && pthread_create(&handle->thread, NULL, HLFetchInternal_run, handle) == 0) {
+    handle->threaded = 1;
+  }
+  if (!handle->threaded) {
+    HLFetchInternal_run(handle);
+  }
+#else
+  HLFetchInternal_run(handle);
+#endif
+  HL_DEBUG0("EXIT: fetchMarkedNodesAsync");
+  return handle;
+fail:
+  if (handle != NULL) {
+    HLHDF_FREE(handle->filename);
+    HLHDF_FREE(handle->nodes);
+    HLHDF_FREE(handle->states);
+    HLHDF_FREE(handle);
+  }
+  HL_DEBUG0("EXIT: fetchMarkedNodesAsync with Error");
+  return NULL;
+}
+
+int HLFetchHandle_getNumberOfNodes(HL_FetchHandle* handle)
+{
+  HL_ASSERT((handle != NULL), "HLFetchHandle_getNumberOfNodes called with handle == NULL");
+  return handle->nnodes;
+}
+
+int HLFetchHandle_getNumberOfCompletedNodes(HL_FetchHandle* handle)
+{
+  int result = 0;
+  HL_ASSERT((handle != NULL), "HLFetchHandle_getNumberOfCompletedNodes called with handle == NULL");
+  HLFetchInternal_lock(handle);
+  result = handle->ncompleted;
+  HLFetchInternal_unlock(handle);
+  return result;
+}
+
+int HLFetchHandle_waitForNode(HL_FetchHandle* handle, const char* name)
+{
+  int i, result = 0;
+  if (handle == NULL || name == NULL) {
+    HL_ERROR0("Inparameters NULL");
+    return 0;
+  }
+  for (i = 0; i < handle->nnodes; i++) {
+    if (strcmp(HLNode_getName(handle->nodes[i]), name) == 0) {
+      break;
+    }
+  }
+  if (i == handle->nnodes) {
+    HL_ERROR1("Node '%s' is not part of the fetch", name);
+    return 0;
+  }
+  HLFetchInternal_lock(handle);
+  while (handle->states[i] == 0) {
+    HLFetchInternal_waitForChange(handle);
+  }
+  result = (handle->states[i] == 1);
+  HLFetchInternal_unlock(handle);
+  return result;
+}
+
+int HLFetchHandle_wait(HL_FetchHandle* handle)
+{
+  HL_ASSERT((handle != NULL), "HLFetchHandle_wait called with handle == NULL");
+  HLFetchInternal_lock(handle);
+  while (!handle->done) {
+    HLFetchInternal_waitForChange(handle);
+  }
+  if (handle->waited == 0) {
+    /* The first waiter joins the I/O thread, any other waiter blocks until it is joined */
+    handle->waited = 1;
+    HLFetchInternal_unlock(handle);
+#ifdef H5_HAVE_THREADSAFE
+    if (handle->threaded) {
+      pthread_join(handle->thread, NULL);
+    }
+#endif
+    HLFetchInternal_lock(handle);
+    handle->waited = 2;
+#ifdef H5_HAVE_THREADSAFE
+    pthread_cond_broadcast(&handle->cond);
+#endif
+  }
+  while (handle->waited != 2) {
+    HLFetchInternal_waitForChange(handle);
+  }
+  HLFetchInternal_unlock(handle);
+  return handle->status;
+}
+
+void HLFetchHandle_free(HL_FetchHandle* handle)
+{
+  if (handle != NULL) {
+    HLFetchHandle_wait(handle);
+#ifdef H5_HAVE_THREADSAFE
+    pthread_mutex_destroy(&handle->lock);
+    pthread_cond_destroy(&handle->cond);
+#endif
+    HLHDF_FREE(handle->filename);
+    HLHDF_FREE(handle->nodes);
+    HLHDF_FREE(handle->states);
+    HLHDF_FREE(handle);
+  }
+}
+
+HL_Node* HLNodeList_getNodeWithData(HL_NodeList* nodelist, const char* name)
+{
+  HL_Node* node = NULL;
+  if (name == NULL || nodelist == NULL) {
+    HL_ERROR0("Inparameters NULL");
+    return NULL;
+  }
+  if ((node = HLNodeList_getNodeByName(nodelist, name)) != NULL && HLNode_isEvicted(node)) {
+    node = HLNodeList_fetchNode(nodelist, name);
+  }
+  return node;
+}
+
+HL_Node* HLNodeList_readCompoundMemberColumn(HL_NodeList* nodelist, const char* name, const char* member)
+{
+  hid_t file_id = -1, obj = -1, type = -1, mtype = -1, membertype = -1, ptype = -1, f_space = -1;
+  HL_Node* column = NULL;
+  HL_Node* result = NULL;
+  unsigned char* data = NULL;
+  char* filename = NULL;
+  hsize_t dims[H5S_MAX_RANK];
+  hsize_t npoints = 0;
+  int ndims = 0, idx = 0;
+  size_t size = 0;
+  double start = HLCountersPrivate_now();
+
+  HL_DEBUG0("ENTER: readCompoundMemberColumn");
+  if (nodelist == NULL || name == NULL || member == NULL) {
+    HL_ERROR0("Inparameters NULL");
+    goto fail;
+  }
+  if ((filename = HLNodeList_getFileName(nodelist)) == NULL) {
+    HL_ERROR0("Could not get filename from nodelist");
+    goto fail;
+  }
+  if ((file_id = HLNodeListPrivate_getFile(nodelist)) < 0 && (file_id = openHlHdfFile(filename, "r")) < 0) {
+    HL_ERROR1("Could not open file %s", filename);
+    goto fail;
+  }
+  if ((obj = H5Dopen(file_id, name, H5P_DEFAULT)) < 0) {
+    HL_ERROR1("Could not open dataset %s", name);
+    goto fail;
+  }
+  HL_STATS_INC(objectsOpened);
+  if ((type = H5Dget_type(obj)) < 0 || H5Tget_class(type) != H5T_COMPOUND) {
+    HL_ERROR1("Dataset %s is not of compound type", name);
+    goto fail;
+  }
+  if ((mtype = getFixedType(type)) < 0) {
+    HL_ERROR0("Failed to convert to fixed type");
+    goto fail;
+  }
+  if ((idx = H5Tget_member_index(mtype, member)) < 0) {
+    HL_ERROR2("Dataset %s has no compound member named %s", name, member);
+    goto fail;
+  }
+  if ((membertype = H5Tget_member_type(mtype, (unsigned)idx)) < 0) {
+    HL_ERROR1("Could not get type of compound member %s", member);
+    goto fail;
+  }
+  if ((f_space = H5Dget_space(obj)) < 0 || !hlhdf_read_getSpaceDimensions(f_space, &ndims, &npoints, dims)) {
+    HL_ERROR1("Could not get dimensions of dataset %s", name);
+    goto fail;
+  }
+
+  /* A compound with only the wanted member, so that HDF5 skips all other fields */
+  size = H5Tget_size(membertype);
+  if ((ptype = H5Tcreate(H5T_COMPOUND, size)) < 0 || H5Tinsert(ptype, member, 0, membertype) < 0) {
+    HL_ERROR1("Could not create partial compound type for member %s", member);
+    goto fail;
+  }
+
+  if (H5Tget_class(membertype) == H5T_ARRAY) {
+    /* Array members are returned as extra dimensions of the base type */
+    hsize_t adims[H5S_MAX_RANK];
+    int andims = H5Tget_array_ndims(membertype), i = 0;
+    hid_t basetype = -1;
+    if (andims < 0 || ndims + andims > H5S_MAX_RANK || H5Tget_array_dims(membertype, adims) != andims ||
+        (basetype = H5Tget_super(membertype)) < 0) {
+      HL_ERROR1("Could not get array dimensions of compound member %s", member);
+      goto fail;
+    }
+    for (i = 0; i < andims; i++) {
+      dims[ndims++] = adims[i];
+      npoints *= adims[i];
+    }
+    HL_H5T_CLOSE(membertype);
+    membertype = basetype;
+  }
+  if (H5Tget_class(membertype) == H5T_COMPOUND || H5Tis_variable_str(membertype) > 0 ||
+      HL_getFormatSpecifierFromType(membertype) == HLHDF_UNDEFINED) {
+    HL_ERROR1("Unsupported type of compound member %s", member);
+    goto fail;
+  }
+
+  if ((data = (unsigned char*)HLHDF_MALLOC(npoints * H5Tget_size(membertype) + 1)) == NULL) {
+    HL_ERROR0("Failed to allocate memory for compound member column");
+    goto fail;
+  }
+  if (npoints > 0 && H5Dread(obj, ptype, H5S_ALL, H5S_ALL, H5P_DEFAULT, data) < 0) {
+    HL_ERROR2("Failed to read member %s from dataset %s", member, name);
+    goto fail;
+  }
+  HL_STATS_INC(datasetsRead);
+  HL_STATS_ADD(bytesRead, npoints * H5Tget_size(membertype));
+  HL_STATS_ADD(rawBytesRead, H5Dget_storage_size(obj));
+
+  if ((column = HLNode_newDataset(name)) == NULL ||
+      !HLNode_setDimensions(column, ndims, dims) ||
+      !HLNodePrivate_setTypeIdAndDeriveFormat(column, membertype)) {
+    HL_ERROR0("Failed to create compound member column node");
+    goto fail;
+  }
+  HLNodePrivate_setData(column, H5Tget_size(membertype), data);
+  data = NULL; /* Ownership transfered */
+  HLNode_setMark(column, NMARK_ORIGINAL);
+  HLNode_setFetched(column, 1);
+
+  result = column;
+  column = NULL;
+fail:
+  HLNode_free(column);
+  HLHDF_FREE(data);
+  HL_H5S_CLOSE(f_space);
+  HL_H5T_CLOSE(ptype);
+  HL_H5T_CLOSE(membertype);
+  HL_H5T_CLOSE(mtype);
+  HL_H5T_CLOSE(type);
+  HL_H5D_CLOSE(obj);
+  HLNodeListPrivate_releaseFile(nodelist, &file_id);
+  HLHDF_FREE(filename);
+  HL_STATS_ADD_TIME(fetchTime, start);
+  HL_DEBUG0("EXIT: readCompoundMemberColumn");
+  return result;
+}
 /*@} End of Interface functions */
 
 
@@ -27,6 +27,52 @@ along with HLHDF.  If not, see <http://www.gnu.org/licenses/>.
 #define HLHDF_READ_H
 #include "hlhdf_types.h"
 
+/**
+ * Sets if uncompressed datasets should be memory mapped instead of read. When enabled,
+ * datasets with contiguous layout, no filters and a stored integer, float or fixed
+ * string type that equals the native type are fetched by mapping the file region
+ * copy-on-write. \ref HLNode_getData then points into the map, which is kept alive
+ * by the node, so the data is not copied and the pages are shared with the page
+ * cache and other processes reading the same file. Other datasets are read as usual.
+ * Mapped datasets are not added to the data cache (\ref HL_setDataCacheLimit).
+ * Until a node's data is modified, pages that have not been written to follow the
+ * file: data that is updated in place, by another process or by \ref HLNodeList_update
+ * on the same file, is seen by the node. A file must not be truncated or rewritten
+ * while nodes mapping it are alive, since accessing the data would then fail with
+ * SIGBUS. Disabled by default.
+ * @ingroup hlhdf_c_apis
+ * @param[in] enable 1 to enable memory mapped reads, 0 to disable
+ */
+void HL_setMemoryMappedReads(int enable);
+
+/**
+ * Returns if memory mapped reads are enabled, see \ref HL_setMemoryMappedReads.
+ * @ingroup hlhdf_c_apis
+ * @return 1 if enabled, otherwise 0
+ */
+int HL_getMemoryMappedReads(void);
+
+/**
+ * Sets the max size of files that are read into memory as a whole when a nodelist is read.
+ * A file at or below the limit is opened with the HDF5 core driver, which reads the file
+ * with one sequential read, and the returned nodelist keeps the image in memory so that
+ * traversal and later fetches are served from memory instead of issuing many small reads.
+ * The image is counted as file in \ref HLNodeList_getMemoryUsage and released by
+ * \ref HLNodeList_close, or before any data when the memory budget is exceeded.
+ * It does not make \ref HLNodeList_isOpen return 1. Useful for small files on network file systems. Memory mapped reads
+ * (\ref HL_setMemoryMappedReads) do not apply to files read into memory.
+ * @ingroup hlhdf_c_apis
+ * @param[in] limit the max file size in bytes, 0 disables (default)
+ */
+void HL_setWholeFileReadLimit(size_t limit);
+
+/**
+ * Returns the max size of files that are read into memory, see \ref HL_setWholeFileReadLimit.
+ * @ingroup hlhdf_c_apis
+ * @return the limit in bytes, 0 if disabled
+ */
+size_t HL_getWholeFileReadLimit(void);
+
 /**
  * Reads an HDF5 file with name filename from the group fromPath and downwards.
  * This function will not fetch the actual data but will only read the structure.
@@ -38,6 +84,30 @@ along with HLHDF.  If not, see <http://www.gnu.org/licenses/>.
  */
 HL_NodeList* HLNodeList_readFrom(const char* filename, const char* fromPath);
 
+/**
+ * Same as \ref HLNodeList_readFrom but only the nodes matching the patterns are read.
+ * Patterns are matched against the full node names where '*' matches any characters
+ * except '/', '?' matches one character except '/' and a "**" path segment matches any
+ * number of path segments. Patterns not starting with '/' are treated as if they did.
+ * A pattern prefixed with '!' is an exclude pattern, e.g. "!**&#47;how" or "!**&#47;how&#47;*".
+ * <ul>
+ *  <li>An object matching an exclude pattern is skipped together with everything below it,
+ *      including its attributes, which are never iterated over.</li>
+ *  <li>If there are include patterns, a node is read if it or one of its ancestors matches an
+ *      include pattern, e.g. "/dataset1" or "/dataset*&#47;data1&#47;**". Groups and datasets that
+ *      might have included nodes below them are also read since the tree structure must be
+ *      complete.</li>
+ *  <li>If there are no include patterns, everything that is not excluded is read.</li>
+ * </ul>
+ * @ingroup hlhdf_c_apis
+ * @param[in] filename the name of the HDF5 file
+ * @param[in] fromPath the path from where the file should be read.
+ * @param[in] patterns the include and exclude patterns
+ * @param[in] npatterns the number of patterns
+ * @return the read data structure on success, otherwise NULL.
+ */
+HL_NodeList* HLNodeList_readFromFiltered(const char* filename, const char* fromPath, const char** patterns, int npatterns);
+
 /**
  * Reads an HDF5 file with name filename from the root group ("/") and downwards.
  * This function will not fetch the actual data but will only read the structure.
@@ -48,6 +118,19 @@ HL_NodeList* HLNodeList_readFrom(const char* filename, const char* fromPath);
  */
 HL_NodeList* HLNodeList_read(const char* filename);
 
+/**
+ * Reads an HDF5 file with name filename from the root group ("/") and downwards
+ * and fills all attributes with their values, and all datasets with dimensions, type
+ * and format, while traversing the file. The result is the same as calling
+ * \ref HLNodeList_read followed by \ref HLNodeList_selectAllMetadataNodes and
+ * \ref HLNodeList_fetchMarkedNodes but each object is only opened once.
+ * The dataset data is not read, use selectNode/fetchMarkedNodes or fetchNode for that.
+ * @ingroup hlhdf_c_apis
+ * @param[in] filename the name of the HDF5 file
+ * @return the read data structure on success, otherwise NULL.
+ */
+HL_NodeList* HLNodeList_readWithMetadata(const char* filename);
+
 /**
  * Selects the node named 'name' from which to fetch data.
  * @ingroup hlhdf_c_apis
@@ -118,4 +201,86 @@ int HLNodeList_fetchMarkedNodes(HL_NodeList* nodelist);
  */
 HL_Node* HLNodeList_fetchNode(HL_NodeList* nodelist, const char* name);
 
+/**
+ * Fills all nodes (marked as select) with data like \ref HLNodeList_fetchMarkedNodes but
+ * performs the reads on a background I/O thread and returns immediately. Each time a node
+ * has been fetched, <b>callback</b> is called from the I/O thread. The caller can also poll
+ * the handle with \ref HLFetchHandle_getNumberOfCompletedNodes or wait for a single node
+ * with \ref HLFetchHandle_waitForNode.
+ * The node list must not be used, modified or freed until the fetch has completed, but the
+ * data of nodes that have been fetched may be used. The memory budget is enforced by the
+ * I/O thread each time a dataset has been filled, so the data of evictable nodes, including
+ * nodes fetched earlier by the same call, may be released before the fetch has completed.
+ * If HDF5 has not been built thread-safe, the nodes are fetched before this function returns.
+ * @ingroup hlhdf_c_apis
+ * @param[in] nodelist the node list
+ * @param[in] callback called for each fetched node, may be NULL
+ * @param[in] userdata passed on to the callback
+ * @return the handle (<b>release with HLFetchHandle_free</b>) or NULL on failure
+ */
+HL_FetchHandle* HLNodeList_fetchMarkedNodesAsync(HL_NodeList* nodelist, HL_FetchCallback callback, void* userdata);
+
+/**
+ * Returns the number of nodes that are fetched by the handle.
+ * @ingroup hlhdf_c_apis
+ * @param[in] handle the fetch handle
+ * @return the number of nodes
+ */
+int HLFetchHandle_getNumberOfNodes(HL_FetchHandle* handle);
+
+/**
+ * Returns the number of nodes that have been fetched, or failed to be fetched, so far.
+ * @ingroup hlhdf_c_apis
+ * @param[in] handle the fetch handle
+ * @return the number of completed nodes
+ */
+int HLFetchHandle_getNumberOfCompletedNodes(HL_FetchHandle* handle);
+
+/**
+ * Waits until the node named <b>name</b> has been fetched.
+ * @ingroup hlhdf_c_apis
+ * @param[in] handle the fetch handle
+ * @param[in] name the name of the node
+ * @return 1 if the node was fetched, 0 if it failed or is not part of the fetch
+ */
+int HLFetchHandle_waitForNode(HL_FetchHandle* handle, const char* name);
+
+/**
+ * Waits until all nodes have been fetched. May be called from several threads at once.
+ * @ingroup hlhdf_c_apis
+ * @param[in] handle the fetch handle
+ * @return 1 if all nodes were fetched, otherwise 0
+ */
+int HLFetchHandle_wait(HL_FetchHandle* handle);
+
+/**
+ * Waits for the fetch to complete and releases the handle.
+ * @ingroup hlhdf_c_apis
+ * @param[in] handle the fetch handle
+ */
+void HLFetchHandle_free(HL_FetchHandle* handle);
+
+/**
+ * Same as @ref HLNodeList_getNodeByName but if the data of the node has been evicted due
+ * to the memory budget (see @ref HLNodeList_setMemoryBudget), it will be fetched again.
+ * @ingroup hlhdf_c_apis
+ * @param[in] nodelist the node list
+ * @param[in] name the name of the node
+ * @return the found node or NULL on failure.
+ */
+HL_Node* HLNodeList_getNodeWithData(HL_NodeList* nodelist, const char* name);
+
+/**
+ * Reads one member of a compound dataset directly from the file without reading the other
+ * members or the dataset into the node list. The result is a new dataset node with the same
+ * name and dimensions as the dataset where each value is the member of the corresponding
+ * compound value.
+ * @ingroup hlhdf_c_apis
+ * @param[in] nodelist the node list
+ * @param[in] name the name of the compound dataset
+ * @param[in] member the name of the member
+ * @return the column node (<b>caller takes ownership, release with HLNode_free</b>) or NULL on failure.
+ */
+HL_Node* HLNodeList_readCompoundMemberColumn(HL_NodeList* nodelist, const char* name, const char* member);
+
 #endif
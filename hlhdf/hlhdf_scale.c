@@ -0,0 +1,422 @@
+/* --------------------------------------------------------------------
+Copyright (C) 2026 Swedish Meteorological and Hydrological Institute, SMHI,
+
+This file is part of HLHDF.
+
+HLHDF is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+HLHDF is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with HLHDF.  If not, see <http://www.gnu.org/licenses/>.
+------------------------------------------------------------------------*/
+
+/**
+ * Reading of integer datasets converted to physical floating point values in one pass.
+ * @file
+ * @date 2026-10-19
+ */
+#include "hlhdf.h"
+#include "hlhdf_alloc.h"
+#include "hlhdf_private.h"
+#include "hlhdf_debug.h"
+#include "hlhdf_defines_private.h"
+#include "hlhdf_node_private.h"
+#include "hlhdf_nodelist_private.h"
+#include "hlhdf_counters_private.h"
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+
+/**
+ * The ODIM attributes that defines the scaling, in the order gain, offset, nodata and undetect.
+ */
+static const char* HLHDF_ODIM_SCALING_ATTRIBUTES[] = {"gain", "offset", "nodata", "undetect"};
+
+/*@{ Private functions */
+/**
+ * Returns the value of a numeric scalar node as a double.
+ * @param[in] node the node
+ * @param[out] value the value
+ * @return 1 on success, 0 if the node does not contain a numeric value
+ */
+static int HLScaleInternal_getDouble(HL_Node* node, double* value)
+{
+  const unsigned char* data = HLNode_getConstData(node);
+  if (data == NULL) {
+    return 0;
+  }
+  switch (HLNode_getFormat(node)) {
+  case HLHDF_CHAR: *value = (double)*(const char*)data; break;
+  case HLHDF_SCHAR: *value = (double)*(const signed char*)data; break;
+  case HLHDF_UCHAR: *value = (double)*(const unsigned char*)data; break;
+  case HLHDF_SHORT: *value = (double)*(const short*)data; break;
+  case HLHDF_USHORT: *value = (double)*(const unsigned short*)data; break;
+  case HLHDF_INT: *value = (double)*(const int*)data; break;
+  case HLHDF_UINT: *value = (double)*(const unsigned int*)data; break;
+  case HLHDF_LONG: *value = (double)*(const long*)data; break;
+  case HLHDF_ULONG: *value = (double)*(const unsigned long*)data; break;
+  case HLHDF_LLONG: *value = (double)*(const long long*)data; break;
+  case HLHDF_ULLONG: *value = (double)*(const unsigned long long*)data; break;
+  case HLHDF_FLOAT: *value = (double)*(const float*)data; break;
+  case HLHDF_DOUBLE: *value = *(const double*)data; break;
+  default:
+    return 0;
+  }
+  return 1;
+}
+
+/**
+ * Applies the scaling to one value.
+ * @param[in] s the scaling
+ * @param[in] v the stored value
+ * @return the physical value
+ */
+static double HLScaleInternal_scaleValue(const HL_LinearScaling* s, double v)
+{
+  if (s->useNodata && v == s->nodata) {
+    return s->nodataValue;
+  } else if (s->useUndetect && v == s->undetect) {
+    return s->undetectValue;
+  }
+  return s->offset + s->gain * v;
+}
+
+/**
+ * Converts n values with a lookup table, used for 8-bit data.
+ */
+#define HLSCALE_LOOKUP(T, O) do { \
+  const T* src = (const T*)in; \
+  O* dst = (O*)out; \
+  const O* tbl = (const O*)table; \
+  for (i = 0; i < n; i++) { \
+    dst[i] = tbl[(unsigned char)src[i]]; \
+  } \
+} while (0)
+
+/**
+ * Converts n values arithmetically. The masking is written as selects without branches
+ * so that the compiler can vectorize the loop. Unused masks compare against NaN which
+ * never is equal to anything. Nodata is selected last so that it wins when nodata and
+ * undetect are equal, like in \ref HLScaleInternal_scaleValue.
+ */
+#define HLSCALE_ARITHMETIC(T, O) do { \
+  const T* src = (const T*)in; \
+  O* dst = (O*)out; \
+  for (i = 0; i < n; i++) { \
+    double v = (double)src[i]; \
+    double r = offset + gain * v; \
+    r = (v == undetect) ? undetectValue : r; \
+    r = (v == nodata) ? nodataValue : r; \
+    dst[i] = (O)r; \
+  } \
+} while (0)
+
+/**
+ * Converts n values of the given input format into the output type O.
+ */
+#define HLSCALE_DISPATCH(O) do { \
+  switch (informat) { \
+  case HLHDF_CHAR: HLSCALE_LOOKUP(char, O); break; \
+  case HLHDF_SCHAR: HLSCALE_LOOKUP(signed char, O); break; \
+  case HLHDF_UCHAR: HLSCALE_LOOKUP(unsigned char, O); break; \
+  case HLHDF_SHORT: HLSCALE_ARITHMETIC(short, O); break; \
+  case HLHDF_USHORT: HLSCALE_ARITHMETIC(unsigned short, O); break; \
+  case HLHDF_INT: HLSCALE_ARITHMETIC(int, O); break; \
+  case HLHDF_UINT: HLSCALE_ARITHMETIC(unsigned int, O); break; \
+  case HLHDF_LONG: HLSCALE_ARITHMETIC(long, O); break; \
+  case HLHDF_ULONG: HLSCALE_ARITHMETIC(unsigned long, O); break; \
+  case HLHDF_LLONG: HLSCALE_ARITHMETIC(long long, O); break; \
+  case HLHDF_ULLONG: HLSCALE_ARITHMETIC(unsigned long long, O); break; \
+  case HLHDF_FLOAT: HLSCALE_ARITHMETIC(float, O); break; \
+  case HLHDF_DOUBLE: HLSCALE_ARITHMETIC(double, O); break; \
+  default: break; \
+  } \
+} while (0)
+
+/**
+ * Returns if a stored format can be scaled.
+ * @param[in] format the format
+ * @return 1 if the format is supported, otherwise 0
+ */
+static int HLScaleInternal_isSupported(HL_FormatSpecifier format)
+{
+  return (format >= HLHDF_CHAR && format <= HLHDF_DOUBLE);
+}
+
+/**
+ * Returns if a stored format is converted with a lookup table.
+ * @param[in] format the format
+ * @return 1 if a lookup table is used, otherwise 0
+ */
+static int HLScaleInternal_useTable(HL_FormatSpecifier format)
+{
+  return (format == HLHDF_CHAR || format == HLHDF_SCHAR || format == HLHDF_UCHAR);
+}
+
+/**
+ * Builds the 256 entry lookup table for 8-bit data, indexed by the value as unsigned char.
+ * @param[in] s the scaling
+ * @param[in] informat the stored format
+ * @param[in] outformat HLHDF_FLOAT or HLHDF_DOUBLE
+ * @param[out] table the table, must hold 256 values of the output type
+ */
+static void HLScaleInternal_buildTable(const HL_LinearScaling* s, HL_FormatSpecifier informat,
+  HL_FormatSpecifier outformat, void* table)
+{
+  int k;
+  for (k = 0; k < 256; k++) {
+    double v = (informat == HLHDF_UCHAR) ? (double)k : (double)(signed char)k;
+    if (informat == HLHDF_CHAR) {
+      v = (double)(char)k;
+    }
+    if (outformat == HLHDF_FLOAT) {
+      ((float*)table)[k] = (float)HLScaleInternal_scaleValue(s, v);
+    } else {
+      ((double*)table)[k] = HLScaleInternal_scaleValue(s, v);
+    }
+  }
+}
+
+/**
+ * Scales n stored values into the output buffer.
+ * @param[in] s the scaling
+ * @param[in] informat the stored format
+ * @param[in] in the stored values
+ * @param[in] n the number of values
+ * @param[in] outformat HLHDF_FLOAT or HLHDF_DOUBLE
+ * @param[in] table the lookup table if informat is an 8-bit format
+ * @param[out] out the scaled values
+ */
+static void HLScaleInternal_convert(const HL_LinearScaling* s, HL_FormatSpecifier informat,
+  const void* in, size_t n, HL_FormatSpecifier outformat, const void* table, void* out)
+{
+  size_t i = 0;
+  const double gain = s->gain, offset = s->offset;
+  const double nodata = s->useNodata ? s->nodata : NAN;
+  const double undetect = s->useUndetect ? s->undetect : NAN;
+  const double nodataValue = s->nodataValue, undetectValue = s->undetectValue;
+
+  if (outformat == HLHDF_FLOAT) {
+    HLSCALE_DISPATCH(float);
+  } else {
+    HLSCALE_DISPATCH(double);
+  }
+}
+/**
+ * What is needed for scaling the slabs read by readDatasetInSlabs.
+ */
+typedef struct HLScaleContext_t {
+  const HL_LinearScaling* scaling; /**< the scaling */
+  HL_FormatSpecifier informat;     /**< the stored format */
+  HL_FormatSpecifier outformat;    /**< HLHDF_FLOAT or HLHDF_DOUBLE */
+  const void* table;               /**< lookup table for 8-bit data */
+  unsigned char* out;              /**< the scaled values */
+} HLScaleContext_t;
+
+/**
+ * Scales one slab into its place in the output, see \ref HL_SlabConsumer.
+ */
+static int HLScaleInternal_consumeSlab(void* ctx, const unsigned char* data, hsize_t first, hsize_t n)
+{
+  HLScaleContext_t* sctx = (HLScaleContext_t*)ctx;
+  size_t outsize = (sctx->outformat == HLHDF_FLOAT) ? sizeof(float) : sizeof(double);
+  double start = HLCountersPrivate_now();
+  HLScaleInternal_convert(sctx->scaling, sctx->informat, data, (size_t)n, sctx->outformat, sctx->table,
+                          sctx->out + first * outsize);
+  HL_STATS_ADD_TIME(convertTime, start);
+  return 1;
+}
+/*@} End of Private functions */
+
+/*@{ Interface functions */
+void HLLinearScaling_init(HL_LinearScaling* scaling)
+{
+  HL_ASSERT((scaling != NULL), "HLLinearScaling_init called with scaling == NULL");
+  scaling->gain = 1.0;
+  scaling->offset = 0.0;
+  scaling->useNodata = 0;
+  scaling->nodata = 0.0;
+  scaling->nodataValue = NAN;
+  scaling->useUndetect = 0;
+  scaling->undetect = 0.0;
+  scaling->undetectValue = NAN;
+}
+
+int HLNodeList_getOdimScaling(HL_NodeList* nodelist, const char* name, HL_LinearScaling* scaling)
+{
+  char* path = NULL;
+  char* attrname = NULL;
+  char* p = NULL;
+  double values[4] = {1.0, 0.0, 0.0, 0.0};
+  int found[4] = {0, 0, 0, 0};
+  int k = 0, result = 0;
+  size_t len = 0;
+
+  if (nodelist == NULL || name == NULL || scaling == NULL) {
+    HL_ERROR0("Inparameters NULL");
+    return 0;
+  }
+  HLLinearScaling_init(scaling);
+
+  len = strlen(name) + 32;
+  if ((path = HLHDF_STRDUP(name)) == NULL || (attrname = HLHDF_MALLOC(len)) == NULL) {
+    HL_ERROR0("Failed to allocate memory for attribute names");
+    goto fail;
+  }
+
+  while ((p = strrchr(path, '/')) != NULL) {
+    *p = '\0';
+    for (k = 0; k < 4; k++) {
+      HL_Node* node = NULL;
+      if (found[k]) {
+        continue;
+      }
+      snprintf(attrname, len, "%s/what/%s", path, HLHDF_ODIM_SCALING_ATTRIBUTES[k]);
+      if ((node = HLNodeList_getNodeByName(nodelist, attrname)) == NULL) {
+        continue;
+      }
+      if ((!HLNode_fetched(node) || HLNode_getConstData(node) == NULL) &&
+          (node = HLNodeList_fetchNode(nodelist, attrname)) == NULL) {
+        HL_ERROR1("Failed to fetch %s", attrname);
+        goto fail;
+      }
+      found[k] = HLScaleInternal_getDouble(node, &values[k]);
+    }
+  }
+
+  if (found[0]) {
+    scaling->gain = values[0];
+  }
+  if (found[1]) {
+    scaling->offset = values[1];
+  }
+  if (found[2]) {
+    scaling->useNodata = 1;
+    scaling->nodata = values[2];
+  }
+  if (found[3]) {
+    scaling->useUndetect = 1;
+    scaling->undetect = values[3];
+  }
+  result = 1;
+fail:
+  HLHDF_FREE(path);
+  HLHDF_FREE(attrname);
+  return result;
+}
+
+HL_Node* HLNodeList_fetchScaledDataset(HL_NodeList* nodelist, const char* name,
+  const HL_LinearScaling* scaling, HL_FormatSpecifier format)
+{
+  hid_t file_id = -1, obj = -1, type = -1, mtype = -1, f_space = -1;
+  HL_Node* node = NULL;
+  HL_Node* result = NULL;
+  HLScaleContext_t ctx;
+  char* filename = NULL;
+  unsigned char* out = NULL;
+  double table[256];
+  hsize_t dims[H5S_MAX_RANK];
+  hsize_t npoints = 0;
+  size_t outsize = 0;
+  int ndims = 0;
+  double start = HLCountersPrivate_now();
+
+  HL_DEBUG0("ENTER: fetchScaledDataset");
+  if (nodelist == NULL || name == NULL || scaling == NULL) {
+    HL_ERROR0("Inparameters NULL");
+    goto fail;
+  }
+  if (format != HLHDF_FLOAT && format != HLHDF_DOUBLE) {
+    HL_ERROR0("Scaled data can only be fetched as float or double");
+    goto fail;
+  }
+  outsize = (format == HLHDF_FLOAT) ? sizeof(float) : sizeof(double);
+
+  if ((filename = HLNodeList_getFileName(nodelist)) == NULL) {
+    HL_ERROR0("Could not get filename from nodelist");
+    goto fail;
+  }
+  if ((file_id = HLNodeListPrivate_getFile(nodelist)) < 0 && (file_id = openHlHdfFile(filename, "r")) < 0) {
+    HL_ERROR1("Could not open file %s", filename);
+    goto fail;
+  }
+  if ((obj = H5Dopen(file_id, name, H5P_DEFAULT)) < 0) {
+    HL_ERROR1("Could not open dataset %s", name);
+    goto fail;
+  }
+  HL_STATS_INC(objectsOpened);
+  if ((type = H5Dget_type(obj)) < 0 ||
+      (H5Tget_class(type) != H5T_INTEGER && H5Tget_class(type) != H5T_FLOAT)) {
+    HL_ERROR1("Dataset %s is not of integer or floating point type", name);
+    goto fail;
+  }
+  if ((mtype = getFixedType(type)) < 0) {
+    HL_ERROR0("Failed to convert to fixed type");
+    goto fail;
+  }
+  ctx.scaling = scaling;
+  ctx.informat = HL_getFormatSpecifierFromType(mtype);
+  ctx.outformat = format;
+  ctx.table = table;
+  if (!HLScaleInternal_isSupported(ctx.informat)) {
+    HL_ERROR1("Can not scale data of format %s", HL_getFormatSpecifierString(ctx.informat));
+    goto fail;
+  }
+  if (HLScaleInternal_useTable(ctx.informat)) {
+    HLScaleInternal_buildTable(scaling, ctx.informat, format, table);
+  }
+
+  if ((f_space = H5Dget_space(obj)) < 0 || (ndims = H5Sget_simple_extent_ndims(f_space)) < 0 ||
+      H5Sget_simple_extent_dims(f_space, dims, NULL) < 0) {
+    HL_ERROR1("Could not get dimensions of dataset %s", name);
+    goto fail;
+  }
+  npoints = (hsize_t)H5Sget_simple_extent_npoints(f_space);
+  if ((out = HLHDF_MALLOC(npoints * outsize + 1)) == NULL) {
+    HL_ERROR0("Failed to allocate memory for scaled data");
+    goto fail;
+  }
+  ctx.out = out;
+  if (!readDatasetInSlabs(obj, mtype, NULL, HLScaleInternal_consumeSlab, &ctx)) {
+    HL_ERROR1("Failed to read dataset %s", name);
+    goto fail;
+  }
+  HL_STATS_INC(datasetsRead);
+  HL_STATS_ADD(bytesRead, npoints * H5Tget_size(mtype));
+  HL_STATS_ADD(rawBytesRead, H5Dget_storage_size(obj));
+
+  if ((node = HLNode_newDataset(name)) == NULL ||
+      !HLNode_setDimensions(node, ndims, dims) ||
+      !HLNodePrivate_setTypeIdAndDeriveFormat(node, (format == HLHDF_FLOAT) ? H5T_NATIVE_FLOAT : H5T_NATIVE_DOUBLE)) {
+    HL_ERROR0("Failed to create scaled node");
+    goto fail;
+  }
+  HLNodePrivate_setData(node, outsize, out);
+  out = NULL; /* Ownership transfered */
+  HLNode_setMark(node, NMARK_ORIGINAL);
+  HLNode_setFetched(node, 1);
+
+  result = node;
+  node = NULL;
+fail:
+  HLNode_free(node);
+  HLHDF_FREE(out);
+  HL_H5S_CLOSE(f_space);
+  HL_H5T_CLOSE(mtype);
+  HL_H5T_CLOSE(type);
+  HL_H5D_CLOSE(obj);
+  HLNodeListPrivate_releaseFile(nodelist, &file_id);
+  HLHDF_FREE(filename);
+  HL_STATS_ADD_TIME(fetchTime, start);
+  HL_DEBUG0("EXIT: fetchScaledDataset");
+  return result;
+}
+/*@} End of Interface functions */
@@ -0,0 +1,66 @@
+/* --------------------------------------------------------------------
+Copyright (C) 2026 Swedish Meteorological and Hydrological Institute, SMHI,
+
+This file is part of HLHDF.
+
+HLHDF is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+HLHDF is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with HLHDF.  If not, see <http://www.gnu.org/licenses/>.
+------------------------------------------------------------------------*/
+
+/**
+ * Reading of integer datasets converted to physical floating point values in one pass.
+ * @file
+ * @date 2026-10-19
+ */
+#ifndef HLHDF_SCALE_H
+#define HLHDF_SCALE_H
+#include "hlhdf_types.h"
+
+/**
+ * Initializes a scaling to gain 1, offset 0 and no masking. The fill values are set to NaN.
+ * @ingroup hlhdf_c_apis
+ * @param[in] scaling the scaling to initialize
+ */
+void HLLinearScaling_init(HL_LinearScaling* scaling);
+
+/**
+ * Sets up a scaling from the ODIM attributes gain, offset, nodata and undetect that
+ * belongs to a dataset. The attributes are looked up in the what group next to the
+ * dataset and then in the what groups of the ancestors, i.e. for /dataset1/data1/data
+ * in /dataset1/data1/what, /dataset1/what and /what. Attributes that have not been
+ * fetched are fetched. Attributes that can not be found keep their initial values,
+ * see \ref HLLinearScaling_init.
+ * @ingroup hlhdf_c_apis
+ * @param[in] nodelist the node list
+ * @param[in] name the name of the dataset
+ * @param[out] scaling the scaling
+ * @return 1 on success, otherwise 0
+ */
+int HLNodeList_getOdimScaling(HL_NodeList* nodelist, const char* name, HL_LinearScaling* scaling);
+
+/**
+ * Reads a dataset and converts it to physical values in the same pass. The dataset is
+ * read a few rows (or chunks) at a time and each part is scaled directly into the result,
+ * so the unscaled data is never held in full. The node list itself is not modified.
+ * @ingroup hlhdf_c_apis
+ * @param[in] nodelist the node list
+ * @param[in] name the name of the dataset, must be of integer or floating point type
+ * @param[in] scaling the scaling
+ * @param[in] format the result format, HLHDF_FLOAT or HLHDF_DOUBLE
+ * @return a new dataset node with the same name and dimensions as the dataset that holds
+ * the scaled data (<b>caller takes ownership, release with HLNode_free</b>) or NULL on failure.
+ */
+HL_Node* HLNodeList_fetchScaledDataset(HL_NodeList* nodelist, const char* name,
+  const HL_LinearScaling* scaling, HL_FormatSpecifier format);
+
+#endif /* HLHDF_SCALE_H */
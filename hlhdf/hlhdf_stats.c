@@ -0,0 +1,351 @@
+/* --------------------------------------------------------------------
+Copyright (C) 2026 Swedish Meteorological and Hydrological Institute, SMHI,
+
+This file is part of HLHDF.
+
+HLHDF is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+HLHDF is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with HLHDF.  If not, see <http://www.gnu.org/licenses/>.
+------------------------------------------------------------------------*/
+
+/**
+ * Statistics computed while datasets are read.
+ * @file
+ * @date 2026-10-19
+ */
+#include "hlhdf.h"
+#include "hlhdf_alloc.h"
+#include "hlhdf_private.h"
+#include "hlhdf_debug.h"
+#include "hlhdf_node_private.h"
+#include "hlhdf_stats_private.h"
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+
+/*@{ Private functions */
+/**
+ * Adds n values of type T to the statistics. Values that are NaN, nodata or undetect
+ * are not valid. Unused nodata and undetect compare against NaN which never is equal
+ * to anything.
+ */
+#define HLSTATS_ACCUMULATE(T) do { \
+  const T* src = (const T*)data; \
+  for (i = 0; i < n; i++) { \
+    double v = (double)src[i]; \
+    if (v != v) { \
+      continue; \
+    } else if (v == nodata) { \
+      nodataCount++; \
+      continue; \
+    } else if (v == undetect) { \
+      undetectCount++; \
+      continue; \
+    } \
+    count++; \
+    sum += v; \
+    minv = (v < minv) ? v : minv; \
+    maxv = (v > maxv) ? v : maxv; \
+    if (histogram != NULL && v >= histMin && v <= histMax) { \
+      int bin = (v == histMax) ? nbins - 1 : (int)((v - histMin) * binscale); \
+      histogram[(bin < nbins) ? bin : nbins - 1]++; \
+    } \
+  } \
+} while (0)
+
+int HLStatisticsPrivate_isSupported(HL_FormatSpecifier format)
+{
+  return (format >= HLHDF_CHAR && format <= HLHDF_DOUBLE);
+}
+
+HL_Statistics* HLStatisticsPrivate_begin(const HL_StatisticsOptions* options)
+{
+  HL_Statistics* stats = NULL;
+  HL_ASSERT((options != NULL), "HLStatisticsPrivate_begin called with options == NULL");
+  if ((stats = HLHDF_MALLOC(sizeof(HL_Statistics))) == NULL) {
+    HL_ERROR0("Failed to allocate memory for statistics");
+    return NULL;
+  }
+  stats->count = 0;
+  stats->nodataCount = 0;
+  stats->undetectCount = 0;
+  stats->min = INFINITY;
+  stats->max = -INFINITY;
+  stats->sum = 0.0;
+  stats->mean = NAN;
+  stats->nbins = 0;
+  stats->histMin = options->histMin;
+  stats->histMax = options->histMax;
+  stats->histogram = NULL;
+  if (options->nbins > 0 && options->histMax > options->histMin) {
+    if ((stats->histogram = HLHDF_CALLOC(options->nbins, sizeof(size_t))) == NULL) {
+      HL_ERROR0("Failed to allocate memory for histogram");
+      HLHDF_FREE(stats);
+      return NULL;
+    }
+    stats->nbins = options->nbins;
+  }
+  return stats;
+}
+
+void HLStatisticsPrivate_accumulate(HL_Statistics* stats, const HL_StatisticsOptions* options,
+  HL_FormatSpecifier format, const unsigned char* data, size_t n)
+{
+  size_t i = 0;
+  size_t count = stats->count, nodataCount = stats->nodataCount, undetectCount = stats->undetectCount;
+  double sum = stats->sum, minv = stats->min, maxv = stats->max;
+  const double nodata = options->useNodata ? options->nodata : NAN;
+  const double undetect = options->useUndetect ? options->undetect : NAN;
+  const double histMin = stats->histMin, histMax = stats->histMax;
+  const int nbins = stats->nbins;
+  const double binscale = (nbins > 0) ? (double)nbins / (histMax - histMin) : 0.0;
+  size_t* histogram = stats->histogram;
+
+  switch (format) {
+  case HLHDF_CHAR: HLSTATS_ACCUMULATE(char); break;
+  case HLHDF_SCHAR: HLSTATS_ACCUMULATE(signed char); break;
+  case HLHDF_UCHAR: HLSTATS_ACCUMULATE(unsigned char); break;
+  case HLHDF_SHORT: HLSTATS_ACCUMULATE(short); break;
+  case HLHDF_USHORT: HLSTATS_ACCUMULATE(unsigned short); break;
+  case HLHDF_INT: HLSTATS_ACCUMULATE(int); break;
+  case HLHDF_UINT: HLSTATS_ACCUMULATE(unsigned int); break;
+  case HLHDF_LONG: HLSTATS_ACCUMULATE(long); break;
+  case HLHDF_ULONG: HLSTATS_ACCUMULATE(unsigned long); break;
+  case HLHDF_LLONG: HLSTATS_ACCUMULATE(long long); break;
+  case HLHDF_ULLONG: HLSTATS_ACCUMULATE(unsigned long long); break;
+  case HLHDF_FLOAT: HLSTATS_ACCUMULATE(float); break;
+  case HLHDF_DOUBLE: HLSTATS_ACCUMULATE(double); break;
+  default: break;
+  }
+
+  stats->count = count;
+  stats->nodataCount = nodataCount;
+  stats->undetectCount = undetectCount;
+  stats->sum = sum;
+  stats->min = minv;
+  stats->max = maxv;
+}
+
+void HLStatisticsPrivate_end(HL_Statistics* stats)
+{
+  if (stats->count > 0) {
+    stats->mean = stats->sum / (double)stats->count;
+  } else {
+    stats->min = NAN;
+    stats->max = NAN;
+    stats->mean = NAN;
+  }
+}
+
+/**
+ * Adds or updates a numeric attribute of a dataset.
+ * @param[in] nodelist the node list
+ * @param[in] dsname the dataset name
+ * @param[in] name the attribute name
+ * @param[in] fmt the format of the value
+ * @param[in] ndims 0 for a scalar, otherwise 1
+ * @param[in] n the number of values if ndims is 1
+ * @param[in] value the value
+ * @param[in] sz the size of one value
+ * @return 1 on success, otherwise 0
+ */
+static int HLStatisticsInternal_setAttribute(HL_NodeList* nodelist, const char* dsname, const char* name,
+  const char* fmt, int ndims, hsize_t n, const void* value, size_t sz)
+{
+  char* attrname = NULL;
+  HL_Node* node = NULL;
+  HL_Node* created = NULL;
+  size_t len = strlen(dsname) + strlen(name) + 2;
+  int result = 0;
+
+  if ((attrname = HLHDF_MALLOC(len)) == NULL) {
+    HL_ERROR0("Failed to allocate memory for attribute name");
+    goto fail;
+  }
+  snprintf(attrname, len, "%s/%s", dsname, name);
+  if ((node = HLNodeList_getNodeByName(nodelist, attrname)) == NULL) {
+    if ((created = HLNode_newAttribute(attrname)) == NULL) {
+      HL_ERROR1("Failed to create attribute %s", attrname);
+      goto fail;
+    }
+    node = created;
+  } else if (HLNode_getType(node) != ATTRIBUTE_ID) {
+    HL_ERROR1("%s exists and is not an attribute", attrname);
+    goto fail;
+  }
+  if (ndims == 0) {
+    if (!HLNode_setScalarValue(node, sz, (unsigned char*)value, fmt, -1)) {
+      HL_ERROR1("Failed to set value of %s", attrname);
+      goto fail;
+    }
+  } else {
+    if (!HLNode_setArrayValue(node, sz, 1, &n, (unsigned char*)value, fmt, -1)) {
+      HL_ERROR1("Failed to set value of %s", attrname);
+      goto fail;
+    }
+  }
+  if (created != NULL) {
+    if (!HLNodeList_addNode(nodelist, created)) {
+      HL_ERROR1("Failed to add %s", attrname);
+      goto fail;
+    }
+    created = NULL;
+  }
+  result = 1;
+fail:
+  HLNode_free(created);
+  HLHDF_FREE(attrname);
+  return result;
+}
+/*@} End of Private functions */
+
+/*@{ Interface functions */
+void HLStatisticsOptions_init(HL_StatisticsOptions* options)
+{
+  HL_ASSERT((options != NULL), "HLStatisticsOptions_init called with options == NULL");
+  options->nbins = 0;
+  options->histMin = 0.0;
+  options->histMax = 0.0;
+  options->useNodata = 0;
+  options->nodata = 0.0;
+  options->useUndetect = 0;
+  options->undetect = 0.0;
+}
+
+HL_Statistics* HLStatistics_clone(const HL_Statistics* stats)
+{
+  HL_Statistics* result = NULL;
+  if (stats == NULL) {
+    return NULL;
+  }
+  if ((result = HLHDF_MALLOC(sizeof(HL_Statistics))) == NULL) {
+    HL_ERROR0("Failed to allocate memory for statistics");
+    return NULL;
+  }
+  *result = *stats;
+  result->histogram = NULL;
+  if (stats->histogram != NULL) {
+    if ((result->histogram = HLHDF_MALLOC(sizeof(size_t) * stats->nbins)) == NULL) {
+      HL_ERROR0("Failed to allocate memory for histogram");
+      HLHDF_FREE(result);
+      return NULL;
+    }
+    memcpy(result->histogram, stats->histogram, sizeof(size_t) * stats->nbins);
+  }
+  return result;
+}
+
+void HLStatistics_free(HL_Statistics* stats)
+{
+  if (stats != NULL) {
+    HLHDF_FREE(stats->histogram);
+    HLHDF_FREE(stats);
+  }
+}
+
+int HLNode_computeStatistics(HL_Node* node, const HL_StatisticsOptions* options)
+{
+  HL_Statistics* stats = NULL;
+  HL_FormatSpecifier format = HLHDF_UNDEFINED;
+
+  if (node == NULL || options == NULL) {
+    HL_ERROR0("Inparameters NULL");
+    return 0;
+  }
+  format = HLNode_getFormat(node);
+  if (!HLStatisticsPrivate_isSupported(format) || HLNode_getConstData(node) == NULL) {
+    HL_ERROR1("Can not compute statistics for %s", HLNode_getName(node));
+    return 0;
+  }
+  if ((stats = HLStatisticsPrivate_begin(options)) == NULL) {
+    return 0;
+  }
+  HLStatisticsPrivate_accumulate(stats, options, format, HLNode_getConstData(node),
+                                 (size_t)HLNode_getNumberOfPoints(node));
+  HLStatisticsPrivate_end(stats);
+  HLNodePrivate_setStatistics(node, stats);
+  return 1;
+}
+
+int HLNodeList_setStatisticsOptions(HL_NodeList* nodelist, const HL_StatisticsOptions* options)
+{
+  int i = 0, n = 0;
+  if (nodelist == NULL) {
+    HL_ERROR0("Inparameters NULL");
+    return 0;
+  }
+  n = HLNodeList_getNumberOfNodes(nodelist);
+  for (i = 0; i < n; i++) {
+    HL_Node* node = HLNodeList_getNodeByIndex(nodelist, i);
+    if (HLNode_getType(node) == DATASET_ID && !HLNode_setStatisticsOptions(node, options)) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+int HLNodeList_addStatisticsAttributes(HL_NodeList* nodelist)
+{
+  int i = 0, n = 0;
+  if (nodelist == NULL) {
+    HL_ERROR0("Inparameters NULL");
+    return 0;
+  }
+  n = HLNodeList_getNumberOfNodes(nodelist);
+  for (i = 0; i < n; i++) {
+    /* The node array may be reallocated when attributes are added so fetch the node each time */
+    HL_Node* node = HLNodeList_getNodeByIndex(nodelist, i);
+    const HL_StatisticsOptions* options = NULL;
+    const HL_Statistics* stats = NULL;
+    const char* name = NULL;
+    long long count = 0;
+
+    if (HLNode_getType(node) != DATASET_ID || (options = HLNode_getStatisticsOptions(node)) == NULL ||
+        HLNode_getConstData(node) == NULL || !HLStatisticsPrivate_isSupported(HLNode_getFormat(node))) {
+      continue;
+    }
+    if ((stats = HLNode_getStatistics(node)) == NULL) {
+      if (!HLNode_computeStatistics(node, options)) {
+        return 0;
+      }
+      stats = HLNode_getStatistics(node);
+    }
+    name = HLNode_getName(node);
+    count = (long long)stats->count;
+    if (!HLStatisticsInternal_setAttribute(nodelist, name, "stat_count", "llong", 0, 0, &count, sizeof(long long)) ||
+        !HLStatisticsInternal_setAttribute(nodelist, name, "stat_min", "double", 0, 0, &stats->min, sizeof(double)) ||
+        !HLStatisticsInternal_setAttribute(nodelist, name, "stat_max", "double", 0, 0, &stats->max, sizeof(double)) ||
+        !HLStatisticsInternal_setAttribute(nodelist, name, "stat_mean", "double", 0, 0, &stats->mean, sizeof(double))) {
+      return 0;
+    }
+    if (stats->histogram != NULL) {
+      long long* histogram = NULL;
+      int k = 0, status = 0;
+      if ((histogram = HLHDF_MALLOC(sizeof(long long) * stats->nbins)) == NULL) {
+        HL_ERROR0("Failed to allocate memory for histogram");
+        return 0;
+      }
+      for (k = 0; k < stats->nbins; k++) {
+        histogram[k] = (long long)stats->histogram[k];
+      }
+      status = HLStatisticsInternal_setAttribute(nodelist, name, "stat_histogram", "llong", 1,
+                                                 (hsize_t)stats->nbins, histogram, sizeof(long long));
+      HLHDF_FREE(histogram);
+      if (!status) {
+        return 0;
+      }
+    }
+  }
+  return 1;
+}
+/*@} End of Interface functions */
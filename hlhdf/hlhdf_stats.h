@@ -0,0 +1,85 @@
+/* --------------------------------------------------------------------
+Copyright (C) 2026 Swedish Meteorological and Hydrological Institute, SMHI,
+
+This file is part of HLHDF.
+
+HLHDF is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+HLHDF is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with HLHDF.  If not, see <http://www.gnu.org/licenses/>.
+------------------------------------------------------------------------*/
+
+/**
+ * Statistics computed while datasets are read. When a dataset node has statistics
+ * options (see \ref HLNode_setStatisticsOptions) the dataset is read a few rows at
+ * a time and min, max, mean, counts and a histogram are computed for each part
+ * directly after it has been read.
+ * @file
+ * @date 2026-10-19
+ */
+#ifndef HLHDF_STATS_H
+#define HLHDF_STATS_H
+#include "hlhdf_types.h"
+
+/**
+ * Initializes the options to no histogram and no excluded values.
+ * @ingroup hlhdf_c_apis
+ * @param[in] options the options to initialize
+ */
+void HLStatisticsOptions_init(HL_StatisticsOptions* options);
+
+/**
+ * Creates a copy of the statistics.
+ * @ingroup hlhdf_c_apis
+ * @param[in] stats the statistics to copy
+ * @return the copy or NULL if stats was NULL or memory could not be allocated
+ */
+HL_Statistics* HLStatistics_clone(const HL_Statistics* stats);
+
+/**
+ * Deallocates the statistics.
+ * @ingroup hlhdf_c_apis
+ * @param[in] stats the statistics, may be NULL
+ */
+void HLStatistics_free(HL_Statistics* stats);
+
+/**
+ * Computes the statistics for the data that a node already holds and attaches them
+ * to the node.
+ * @ingroup hlhdf_c_apis
+ * @param[in] node the node, must have integer or floating point data
+ * @param[in] options the options
+ * @return 1 on success, otherwise 0
+ */
+int HLNode_computeStatistics(HL_Node* node, const HL_StatisticsOptions* options);
+
+/**
+ * Sets the statistics options on all dataset nodes in the node list so that statistics
+ * are computed when they are fetched.
+ * @ingroup hlhdf_c_apis
+ * @param[in] nodelist the node list
+ * @param[in] options the options, NULL turns statistics off
+ * @return 1 on success, otherwise 0
+ */
+int HLNodeList_setStatisticsOptions(HL_NodeList* nodelist, const HL_StatisticsOptions* options);
+
+/**
+ * Stores the statistics of all dataset nodes that has statistics options and data as attributes
+ * of the datasets so that they are written with the next write or update. The attributes are
+ * stat_count, stat_min, stat_max and stat_mean and, when a histogram is computed, stat_histogram.
+ * Statistics that have not been computed yet are computed from the data of the node.
+ * @ingroup hlhdf_c_apis
+ * @param[in] nodelist the node list
+ * @return 1 on success, otherwise 0
+ */
+int HLNodeList_addStatisticsAttributes(HL_NodeList* nodelist);
+
+#endif /* HLHDF_STATS_H */
@@ -0,0 +1,60 @@
+/* --------------------------------------------------------------------
+Copyright (C) 2026 Swedish Meteorological and Hydrological Institute, SMHI,
+
+This file is part of HLHDF.
+
+HLHDF is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+HLHDF is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with HLHDF.  If not, see <http://www.gnu.org/licenses/>.
+------------------------------------------------------------------------*/
+
+/**
+ * Private functions for accumulating statistics part by part.
+ * @file
+ * @date 2026-10-19
+ */
+#ifndef HLHDF_STATS_PRIVATE_H
+#define HLHDF_STATS_PRIVATE_H
+#include "hlhdf.h"
+
+/**
+ * Returns if statistics can be computed for a format.
+ * @param[in] format the format
+ * @return 1 if supported, otherwise 0
+ */
+int HLStatisticsPrivate_isSupported(HL_FormatSpecifier format);
+
+/**
+ * Creates empty statistics.
+ * @param[in] options the options
+ * @return the statistics or NULL on failure
+ */
+HL_Statistics* HLStatisticsPrivate_begin(const HL_StatisticsOptions* options);
+
+/**
+ * Adds values to the statistics.
+ * @param[in] stats the statistics
+ * @param[in] options the options
+ * @param[in] format the format of the values
+ * @param[in] data the values
+ * @param[in] n the number of values
+ */
+void HLStatisticsPrivate_accumulate(HL_Statistics* stats, const HL_StatisticsOptions* options,
+  HL_FormatSpecifier format, const unsigned char* data, size_t n);
+
+/**
+ * Finishes the statistics when all values have been added.
+ * @param[in] stats the statistics
+ */
+void HLStatisticsPrivate_end(HL_Statistics* stats);
+
+#endif /* HLHDF_STATS_PRIVATE_H */
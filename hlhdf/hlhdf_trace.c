@@ -0,0 +1,300 @@
+/* --------------------------------------------------------------------
+Copyright (C) 2026 Swedish Meteorological and Hydrological Institute, SMHI,
+
+This file is part of HLHDF.
+
+HLHDF is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+HLHDF is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with HLHDF.  If not, see <http://www.gnu.org/licenses/>.
+------------------------------------------------------------------------*/
+
+
+/**
+ * Begin and end hooks around traced operations and the Chrome trace sink.
+ * @file
+ * @date 2026-10-19
+ */
+#include "hlhdf.h"
+#include "hlhdf_alloc.h"
+#include "hlhdf_debug.h"
+#include "hlhdf_defines_private.h"
+#include "hlhdf_trace_private.h"
+#include "hlhdf_counters_private.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+
+/*@{ Private variables */
+int hlhdfTraceEnabled = 0;
+
+static HL_TraceHook traceBegin = NULL;
+
+static HL_TraceHook traceEnd = NULL;
+
+static void* traceUserdata = NULL;
+
+/**
+ * The Chrome trace being written, NULL if none.
+ */
+static FILE* traceFile = NULL;
+
+static char* traceFilename = NULL;
+
+/**
+ * Number of events written to the trace file.
+ */
+static long traceEvents = 0;
+
+static int traceAtexit = 0;
+
+/**
+ * Serializes the writing of the trace file, events are reported from background threads as well.
+ */
+static pthread_mutex_t traceLock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Number of threads that have written events, used for giving each thread its own track.
+ */
+static int traceThreads = 0;
+
+#if defined(__GNUC__)
+/**
+ * The track of the calling thread, 0 until the thread writes its first event.
+ */
+static __thread int traceThreadId = 0;
+#endif
+/*@} End of Private variables */
+
+/*@{ Private functions */
+static void HLTraceInternal_update(void)
+{
+  hlhdfTraceEnabled = (traceBegin != NULL || traceEnd != NULL || traceFile != NULL);
+}
+
+static const char* HLTraceInternal_operationName(HL_TraceOperation operation)
+{
+  switch (operation) {
+  case HL_TRACE_OPEN:
+    return "open";
+  case HL_TRACE_TRAVERSE:
+    return "traverse";
+  case HL_TRACE_FETCH:
+    return "fetch";
+  case HL_TRACE_WRITE:
+    return "write";
+  default:
+    return "unknown";
+  }
+}
+
+/**
+ * Writes a JSON string without the surrounding quotes.
+ */
+static void HLTraceInternal_writeString(const char* str)
+{
+  const unsigned char* c = (const unsigned char*)str;
+  for (; *c != '\0'; c++) {
+    if (*c == '"' || *c == '\\') {
+      fprintf(traceFile, "\\%c", *c);
+    } else if (*c < 0x20) {
+      fprintf(traceFile, "\\u%04x", *c);
+    } else {
+      fputc(*c, traceFile);
+    }
+  }
+}
+
+/**
+ * Writes one begin ('B') or end ('E') event to the trace file. The span is named
+ * after the operation and the path so that outliers can be identified directly
+ * in the viewer.
+ */
+static void HLTraceInternal_writeEvent(const HL_TraceEvent* event, char phase)
+{
+  int pid = (int)getpid(), tid = pid;
+#if defined(__GNUC__)
+  if (traceThreadId == 0) {
+    traceThreadId = ++traceThreads;
+  }
+  tid = pid + traceThreadId - 1;
+#endif
+  if (traceEvents++ > 0) {
+    fputs(",\n", traceFile);
+  }
+  fprintf(traceFile, "{\"name\":\"%s", HLTraceInternal_operationName(event->operation));
+  if (event->path != NULL) {
+    fputc(' ', traceFile);
+    HLTraceInternal_writeString(event->path);
+  }
+  fprintf(traceFile, "\",\"cat\":\"hlhdf\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":%d,\"tid\":%d,\"args\":{",
+          phase, HLCountersPrivate_now() * 1e6, pid, tid);
+  fputs("\"file\":\"", traceFile);
+  HLTraceInternal_writeString(event->filename != NULL ? event->filename : "");
+  fputs("\",\"path\":\"", traceFile);
+  HLTraceInternal_writeString(event->path != NULL ? event->path : "");
+  fputc('"', traceFile);
+  if (phase == 'E') {
+    fprintf(traceFile, ",\"bytes\":%llu,\"raw_bytes\":%llu,\"filters\":\"", event->bytes, event->rawBytes);
+    HLTraceInternal_writeString(event->filters);
+    fprintf(traceFile, "\",\"status\":%d", event->status);
+  }
+  fputs("}}", traceFile);
+}
+
+/**
+ * Finishes and closes the trace file, must be called with traceLock held.
+ */
+static void HLTraceInternal_close(void)
+{
+  if (traceFile != NULL) {
+    fputs("\n]\n", traceFile);
+    fclose(traceFile);
+    traceFile = NULL;
+  }
+  HLHDF_FREE(traceFilename);
+  HLTraceInternal_update();
+}
+
+static void HLTraceInternal_atexit(void)
+{
+  HL_stopTrace();
+}
+
+void HLTracePrivate_begin(HL_TraceEvent* event, HL_TraceOperation operation, const char* filename, const char* path)
+{
+  event->operation = operation;
+  event->filename = filename;
+  event->path = path;
+  event->bytes = 0;
+  event->rawBytes = 0;
+  event->filters[0] = '\0';
+  event->status = 0;
+  if (traceFile != NULL) {
+    pthread_mutex_lock(&traceLock);
+    if (traceFile != NULL) {
+      HLTraceInternal_writeEvent(event, 'B');
+    }
+    pthread_mutex_unlock(&traceLock);
+  }
+  if (traceBegin != NULL) {
+    traceBegin(event, traceUserdata);
+  }
+}
+
+void HLTracePrivate_end(HL_TraceEvent* event, int status)
+{
+  event->status = status;
+  if (traceEnd != NULL) {
+    traceEnd(event, traceUserdata);
+  }
+  if (traceFile != NULL) {
+    pthread_mutex_lock(&traceLock);
+    if (traceFile != NULL) {
+      HLTraceInternal_writeEvent(event, 'E');
+    }
+    pthread_mutex_unlock(&traceLock);
+  }
+}
+
+void HLTracePrivate_setFilters(HL_TraceEvent* event, hid_t dataset)
+{
+  hid_t plist = -1;
+  int nfilters = 0, i = 0;
+  size_t len = 0;
+
+  event->filters[0] = '\0';
+  if ((plist = H5Dget_create_plist(dataset)) < 0) {
+    return;
+  }
+  nfilters = H5Pget_nfilters(plist);
+  for (i = 0; i < nfilters; i++) {
+    char name[32];
+    unsigned int flags = 0;
+    size_t nelmts = 0;
+    unsigned int config = 0;
+    name[0] = '\0';
+    if (H5Pget_filter2(plist, (unsigned)i, &flags, &nelmts, NULL, sizeof(name), name, &config) < 0) {
+      break;
+    }
+    name[sizeof(name) - 1] = '\0';
+    if (len + strlen(name) + 2 > sizeof(event->filters)) {
+      break;
+    }
+    len += snprintf(event->filters + len, sizeof(event->filters) - len, "%s%s", (i > 0) ? "," : "", name);
+  }
+  HL_H5P_CLOSE(plist);
+}
+
+void HLTracePrivate_initialize(void)
+{
+  const char* filename = getenv("HLHDF_TRACE");
+  if (filename != NULL && *filename != '\0' && traceFile == NULL) {
+    HL_startTrace(filename);
+  }
+}
+/*@} End of Private functions */
+
+/*@{ Interface functions */
+void HL_setTraceHooks(HL_TraceHook begin, HL_TraceHook end, void* userdata)
+{
+  traceBegin = begin;
+  traceEnd = end;
+  traceUserdata = userdata;
+  HLTraceInternal_update();
+}
+
+int HL_startTrace(const char* filename)
+{
+  if (filename == NULL) {
+    HL_ERROR0("HL_startTrace called with filename == NULL");
+    return 0;
+  }
+  pthread_mutex_lock(&traceLock);
+  HLTraceInternal_close();
+  if ((traceFilename = HLHDF_STRDUP(filename)) == NULL) {
+    pthread_mutex_unlock(&traceLock);
+    HL_ERROR0("Failed to allocate memory for trace filename");
+    return 0;
+  }
+  if ((traceFile = fopen(filename, "w")) == NULL) {
+    HLHDF_FREE(traceFilename);
+    pthread_mutex_unlock(&traceLock);
+    HL_ERROR1("Failed to open trace file %s", filename);
+    return 0;
+  }
+  fputs("[\n", traceFile);
+  traceEvents = 0;
+  HLTraceInternal_update();
+  pthread_mutex_unlock(&traceLock);
+  if (!traceAtexit) {
+    traceAtexit = 1;
+    if (atexit(HLTraceInternal_atexit) != 0) {
+      HL_printf("Could not set atexit function");
+    }
+  }
+  return 1;
+}
+
+void HL_stopTrace(void)
+{
+  pthread_mutex_lock(&traceLock);
+  HLTraceInternal_close();
+  pthread_mutex_unlock(&traceLock);
+}
+
+const char* HL_getTraceFile(void)
+{
+  return traceFilename;
+}
+/*@} End of Interface functions */
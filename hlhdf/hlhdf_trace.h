@@ -0,0 +1,73 @@
+/* --------------------------------------------------------------------
+Copyright (C) 2026 Swedish Meteorological and Hydrological Institute, SMHI,
+
+This file is part of HLHDF.
+
+HLHDF is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+HLHDF is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with HLHDF.  If not, see <http://www.gnu.org/licenses/>.
+------------------------------------------------------------------------*/
+
+
+/**
+ * Begin and end hooks around file opening, traversal, fetching and writing of
+ * datasets, and a built-in sink writing the spans as Chrome trace events.
+ * @file
+ * @date 2026-10-19
+ */
+#ifndef HLHDF_TRACE_H
+#define HLHDF_TRACE_H
+#include "hlhdf_types.h"
+
+/**
+ * Flag that can be or:ed into the flag given to \ref HL_setDebugMode to write a
+ * Chrome trace to the file named by the environment variable HLHDF_TRACE_FILE,
+ * or hlhdf_trace.json if not set.
+ * @ingroup hlhdf_c_apis
+ */
+#define HLHDF_DEBUG_TRACE 4
+
+/**
+ * Sets the hooks that are called when a traced operation begins and ends.
+ * @ingroup hlhdf_c_apis
+ * @param[in] begin called when an operation begins, may be NULL
+ * @param[in] end called when an operation ends, may be NULL
+ * @param[in] userdata passed on to the hooks
+ */
+void HL_setTraceHooks(HL_TraceHook begin, HL_TraceHook end, void* userdata);
+
+/**
+ * Starts writing all traced operations to a file in the Chrome trace event format,
+ * which can be viewed in chrome://tracing or Perfetto. The hooks set with
+ * \ref HL_setTraceHooks are still called. Tracing is also started by \ref HL_init
+ * when the environment variable HLHDF_TRACE is set to a filename.
+ * @ingroup hlhdf_c_apis
+ * @param[in] filename the file to write, a trace already being written is stopped first
+ * @return 1 on success, otherwise 0
+ */
+int HL_startTrace(const char* filename);
+
+/**
+ * Stops writing the trace file and completes it. Done automatically when the
+ * process exits.
+ * @ingroup hlhdf_c_apis
+ */
+void HL_stopTrace(void);
+
+/**
+ * Returns the name of the trace file being written.
+ * @ingroup hlhdf_c_apis
+ * @return the filename or NULL if no trace is being written
+ */
+const char* HL_getTraceFile(void);
+
+#endif /* HLHDF_TRACE_H */
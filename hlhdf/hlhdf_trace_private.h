@@ -0,0 +1,70 @@
+/* --------------------------------------------------------------------
+Copyright (C) 2026 Swedish Meteorological and Hydrological Institute, SMHI,
+
+This file is part of HLHDF.
+
+HLHDF is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+HLHDF is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with HLHDF.  If not, see <http://www.gnu.org/licenses/>.
+------------------------------------------------------------------------*/
+
+
+/**
+ * Private functions for reporting traced operations.
+ * @file
+ * @date 2026-10-19
+ */
+#ifndef HLHDF_TRACE_PRIVATE_H
+#define HLHDF_TRACE_PRIVATE_H
+#include "hlhdf_types.h"
+#include <hdf5.h>
+
+/**
+ * If any hook or the trace file is active, 0 otherwise.
+ */
+extern int hlhdfTraceEnabled;
+
+/**
+ * Returns if operations should be traced. Checked before preparing an event so
+ * that tracing costs nothing when it is off.
+ */
+#define HL_TRACE_ENABLED() (hlhdfTraceEnabled != 0)
+
+/**
+ * Initializes an event and reports that the operation begins.
+ * @param[in] event the event to initialize
+ * @param[in] operation the operation
+ * @param[in] filename the file, may be NULL
+ * @param[in] path the node path, may be NULL
+ */
+void HLTracePrivate_begin(HL_TraceEvent* event, HL_TraceOperation operation, const char* filename, const char* path);
+
+/**
+ * Reports that the operation ends.
+ * @param[in] event the event given to \ref HLTracePrivate_begin with bytes, rawBytes and filters filled in
+ * @param[in] status 1 if the operation succeeded, otherwise 0
+ */
+void HLTracePrivate_end(HL_TraceEvent* event, int status);
+
+/**
+ * Fills in the filters of a dataset in the event.
+ * @param[in] event the event
+ * @param[in] dataset the dataset identifier
+ */
+void HLTracePrivate_setFilters(HL_TraceEvent* event, hid_t dataset);
+
+/**
+ * Called by \ref HL_init, starts the trace if HLHDF_TRACE is set.
+ */
+void HLTracePrivate_initialize(void);
+
+#endif /* HLHDF_TRACE_PRIVATE_H */
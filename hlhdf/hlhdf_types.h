@@ -134,6 +134,19 @@ typedef struct {
    unsigned lk; /**< Symbol table node size. */
 } HL_PropertySymK;
 
+/**
+ * How free space in a file is handled, see hdf5 documentation for H5Pset_file_space_strategy
+ * for purpose.
+ * @ingroup hlhdf_c_apis
+ */
+typedef enum HL_FileSpaceStrategy {
+  HL_FSPACE_DEFAULT=0, /**< Use the HDF5 default (HL_FSPACE_FSM_AGGR) */
+  HL_FSPACE_FSM_AGGR,  /**< Free-space managers, aggregators and the file driver */
+  HL_FSPACE_PAGE,      /**< Paged aggregation, metadata and raw data are stored in separate pages */
+  HL_FSPACE_AGGR,      /**< Aggregators and the file driver */
+  HL_FSPACE_NONE       /**< Only the file driver */
+} HL_FileSpaceStrategy;
+
 /**
  * Properties that can be finely tuned when creating a HDF5 file.
  * @ingroup hlhdf_c_apis
@@ -172,6 +185,32 @@ typedef struct {
    */
   hsize_t meta_block_size;
 
+  /**
+   * See @ref #HL_FileSpaceStrategy. With HL_FSPACE_PAGE the metadata is aggregated into a few
+   * pages that readers can fetch with one I/O each, see \ref HL_setPageBufferSize.
+   * This and the following fields require HDF5 1.10.1 or later, creating a file fails
+   * with older versions unless they have their default values.
+   */
+  HL_FileSpaceStrategy fs_strategy;
+
+  /**
+   * If free space should be tracked across file close, see hdf5 documentation for
+   * H5Pset_file_space_strategy. Only used when fs_strategy is not HL_FSPACE_DEFAULT.
+   */
+  int fs_persist;
+
+  /**
+   * The page size used by HL_FSPACE_PAGE, see hdf5 documentation for H5Pset_file_space_page_size.
+   * 0 means the HDF5 default (4096).
+   */
+  hsize_t fs_page_size;
+
+  /**
+   * Size of the page buffer used while writing the file, see hdf5 documentation for
+   * H5Pset_page_buffer_size. Requires HL_FSPACE_PAGE, 0 means no page buffer.
+   */
+  size_t page_buffer_size;
+
 } HL_FileCreationProperty;
 
 /**
@@ -271,6 +310,8 @@ typedef struct {
  * This type is a list of <b>HL_CompoundTypeAttribute</b>s. The reason why it's
  * called "Description" is that it acts more like meta data than actual
  * data.
+ * Descriptions read from a file are shared between all nodes with the same compound
+ * type, see \ref HLNode_getCompoundDescription and \ref HLNode_getConstCompoundDescription.
  * @ingroup hlhdf_c_apis
  */
 typedef struct {
@@ -282,6 +323,139 @@ typedef struct {
    HL_CompoundTypeAttribute** attrs; /**< points at the different attributes that defines this type, max index is always nAttrs-1 */
 } HL_CompoundTypeDescription;
 
+/**
+ * Memory held by a node or a node list, all values are in bytes.
+ * @ingroup hlhdf_c_apis
+ */
+typedef struct {
+   size_t data;     /**< data in fixed-type format */
+   size_t rawdata;  /**< unconverted data */
+   size_t names;    /**< node names (and file name for a node list) */
+   size_t compound; /**< compound type descriptions */
+   size_t other;    /**< node structures, dimensions and other bookkeeping */
+   size_t file;     /**< file image read into memory by a node list, see \ref HL_setWholeFileReadLimit */
+   size_t total;    /**< sum of all above */
+} HL_MemoryUsage;
+
+/**
+ * Linear scaling from stored values to physical values, value = offset + gain * stored,
+ * as used by for example ODIM quantities. Stored values equal to nodata or undetect
+ * are replaced with the corresponding fill value instead of being scaled.
+ * @ingroup hlhdf_c_apis
+ */
+typedef struct {
+   double gain;           /**< the gain */
+   double offset;         /**< the offset */
+   int useNodata;         /**< if stored values equal to nodata should be masked */
+   double nodata;         /**< stored value meaning no data */
+   double nodataValue;    /**< the value used for masked nodata */
+   int useUndetect;       /**< if stored values equal to undetect should be masked */
+   double undetect;       /**< stored value meaning undetected */
+   double undetectValue;  /**< the value used for masked undetect */
+} HL_LinearScaling;
+
+/**
+ * Operation counters and the cumulative wall time spent in each phase since the
+ * process started or since the last \ref HL_resetStats.
+ * @ingroup hlhdf_c_apis
+ */
+typedef struct {
+   unsigned long long filesOpened;       /**< files opened or created */
+   unsigned long long objectsOpened;     /**< groups, datasets, attributes and named types opened */
+   unsigned long long attributesRead;    /**< attribute values read */
+   unsigned long long datasetsRead;      /**< dataset values read */
+   unsigned long long attributesWritten; /**< attributes written */
+   unsigned long long datasetsWritten;   /**< datasets written */
+   unsigned long long bytesRead;         /**< bytes of data read, as decompressed in memory */
+   unsigned long long rawBytesRead;      /**< bytes of data read, as stored in the file */
+   unsigned long long bytesWritten;      /**< bytes of data written, as in memory */
+   unsigned long long rawBytesWritten;   /**< bytes of data written, as stored in the file */
+   unsigned long long bytesMapped;       /**< bytes of data read by memory mapping the file, part of bytesRead */
+   unsigned long long allocations;       /**< memory allocations made by HLHDF */
+   double traverseTime;                  /**< seconds spent reading file structures */
+   double fetchTime;                     /**< seconds spent fetching data, includes decompression and conversions done by HDF5 */
+   double convertTime;                   /**< seconds spent translating types and converting values in HLHDF, part of fetchTime when done while fetching */
+   double writeTime;                     /**< seconds spent writing and updating files */
+} HL_Stats;
+
+/**
+ * The operations that are reported to the trace hooks.
+ * @ingroup hlhdf_c_apis
+ */
+typedef enum HL_TraceOperation {
+  HL_TRACE_OPEN = 0, /**< a file is opened or created */
+  HL_TRACE_TRAVERSE, /**< the structure of a file is read */
+  HL_TRACE_FETCH,    /**< the data of a node is fetched from a file */
+  HL_TRACE_WRITE     /**< a dataset is written */
+} HL_TraceOperation;
+
+/**
+ * Describes one traced operation. The same event is passed to both the begin and
+ * the end hook, bytes, rawBytes, filters and status are only set when the operation ends.
+ * @ingroup hlhdf_c_apis
+ */
+typedef struct {
+   HL_TraceOperation operation;  /**< the operation */
+   const char* filename;         /**< the file, may be NULL */
+   const char* path;             /**< the node path or the path traversed from, may be NULL */
+   unsigned long long bytes;     /**< bytes of data, as in memory */
+   unsigned long long rawBytes;  /**< bytes of data, as stored in the file */
+   char filters[64];             /**< the filters of the dataset, e.g. "shuffle,deflate", empty if none */
+   int status;                   /**< 1 if the operation succeeded, otherwise 0 */
+} HL_TraceEvent;
+
+/**
+ * Called when a traced operation begins or ends.
+ * @ingroup hlhdf_c_apis
+ * @param[in] event the operation
+ * @param[in] userdata the userdata given to \ref HL_setTraceHooks
+ */
+typedef void (*HL_TraceHook)(const HL_TraceEvent* event, void* userdata);
+
+/**
+ * What statistics to compute while a dataset is read.
+ * @ingroup hlhdf_c_apis
+ */
+typedef struct {
+   int nbins;             /**< number of histogram bins, 0 for no histogram */
+   double histMin;        /**< lower limit of the first bin */
+   double histMax;        /**< upper limit of the last bin */
+   int useNodata;         /**< if values equal to nodata should be excluded */
+   double nodata;         /**< the nodata value */
+   int useUndetect;       /**< if values equal to undetect should be excluded */
+   double undetect;       /**< the undetect value */
+} HL_StatisticsOptions;
+
+/**
+ * Statistics of the values in a dataset. NaN values and values excluded as nodata
+ * or undetect are not counted as valid.
+ * @ingroup hlhdf_c_apis
+ */
+typedef struct {
+   size_t count;          /**< number of valid values */
+   size_t nodataCount;    /**< number of nodata values */
+   size_t undetectCount;  /**< number of undetect values */
+   double min;            /**< the smallest valid value, NaN if there are no valid values */
+   double max;            /**< the largest valid value, NaN if there are no valid values */
+   double sum;            /**< the sum of the valid values */
+   double mean;           /**< the mean of the valid values, NaN if there are no valid values */
+   int nbins;             /**< number of histogram bins */
+   double histMin;        /**< lower limit of the first bin */
+   double histMax;        /**< upper limit of the last bin */
+   size_t* histogram;     /**< the number of valid values in each bin, values outside the limits are not counted */
+} HL_Statistics;
+
+/**
+ * Defines if and where the structure of a read file should be indexed so that
+ * the file does not have to be traversed the next time it is read.
+ * @ingroup hlhdf_c_apis
+ */
+typedef enum HL_IndexMode {
+  HL_INDEX_NONE=0,  /**< No indexing, the file is always traversed (default) */
+  HL_INDEX_MEMORY,  /**< Index is kept in memory for the lifetime of the process */
+  HL_INDEX_SIDECAR  /**< As HL_INDEX_MEMORY but the index is also stored in a sidecar file */
+} HL_IndexMode;
+
 /**
  * Each entry and type in a HDF5 file is represented by a HL_Node.
  * @ingroup hlhdf_c_apis
@@ -294,4 +468,42 @@ typedef struct _HL_Node HL_Node;
  */
 typedef struct _HL_NodeList HL_NodeList;
 
+/**
+ * Iterates over a dataset in blocks, see \ref HLNodeList_iterateChunks.
+ * @ingroup hlhdf_c_apis
+ */
+typedef struct _HL_ChunkIterator HL_ChunkIterator;
+
+/**
+ * Handle to a fetch running in the background, see \ref HLNodeList_fetchMarkedNodesAsync.
+ * @ingroup hlhdf_c_apis
+ */
+typedef struct _HL_FetchHandle HL_FetchHandle;
+
+/**
+ * Called each time a node has been fetched by \ref HLNodeList_fetchMarkedNodesAsync.
+ * The callback is called from the I/O thread.
+ * @ingroup hlhdf_c_apis
+ * @param[in] node the node
+ * @param[in] status 1 if the node was fetched, 0 on failure
+ * @param[in] userdata the user data given when the fetch was started
+ */
+typedef void (*HL_FetchCallback)(HL_Node* node, int status, void* userdata);
+
+/**
+ * Handle to a write running in the background, see \ref HLNodeList_writeAsync.
+ * @ingroup hlhdf_c_apis
+ */
+typedef struct _HL_WriteHandle HL_WriteHandle;
+
+/**
+ * Called when a write started with \ref HLNodeList_writeAsync has finished.
+ * The callback is called from the writing thread.
+ * @ingroup hlhdf_c_apis
+ * @param[in] filename the name of the file that was written
+ * @param[in] status 1 if the file was written, 0 on failure
+ * @param[in] userdata the user data given when the write was started
+ */
+typedef void (*HL_WriteCallback)(const char* filename, int status, void* userdata);
+
 #endif
@@ -29,8 +29,38 @@ along with HLHDF.  If not, see <http://www.gnu.org/licenses/>.
 #include "hlhdf_debug.h"
 #include "hlhdf_private.h"
 #include "hlhdf_defines_private.h"
+#include "hlhdf_counters_private.h"
+#include "hlhdf_trace_private.h"
 #include <stdlib.h>
 #include <string.h>
+#ifdef H5_HAVE_THREADSAFE
+#include <pthread.h>
+#endif
+
+/*@{ Structs */
+/**
+ * A write running on a background thread.
+ */
+struct _HL_WriteHandle {
+  HL_NodeList* nodelist;            /**< the node list, released when written */
+  char* filename;                   /**< the name of the file */
+  HL_FileCreationProperty property; /**< copy of the file creation properties */
+  int hasProperty;                  /**< 1 if property should be used */
+  HL_Compression* compression;      /**< copy of the compression, may be NULL */
+  HL_WriteCallback callback;        /**< called when the write has finished */
+  void* userdata;                   /**< passed on to the callback */
+  int done;                         /**< 1 when the write has finished */
+  int status;                       /**< 1 if the file was written */
+  int joined;                       /**< 1 when the thread has been joined */
+  H5E_auto2_t efunc;                /**< HDF5 error reporting of the creating thread */
+  void* edata;                      /**< HDF5 error reporting data of the creating thread */
+#ifdef H5_HAVE_THREADSAFE
+  int threaded;                     /**< 1 if the thread was started */
+  pthread_t thread;                 /**< the writing thread */
+  pthread_mutex_t lock;             /**< protects done */
+#endif
+};
+/*@} End of Structs */
 
 /*@{ Private functions */
 /**
@@ -132,6 +162,9 @@ static herr_t writeScalarDataAttribute(hid_t loc_id, hid_t type_id,
     HL_ERROR0("Failed to write scalar data to file");
     goto fail;
   }
+  HL_STATS_INC(attributesWritten);
+  HL_STATS_ADD(bytesWritten, H5Tget_size(type_id));
+  HL_STATS_ADD(rawBytesWritten, H5Aget_storage_size(attr_id));
 
   status = 0;
 fail:
@@ -173,6 +206,9 @@ static herr_t writeSimpleDataAttribute(hid_t loc_id, hid_t type_id, const char*
     HL_ERROR0("Failed to write simple data attribute to file");
     goto fail;
   }
+  HL_STATS_INC(attributesWritten);
+  HL_STATS_ADD(bytesWritten, H5Sget_simple_extent_npoints(dataspace) * H5Tget_size(type_id));
+  HL_STATS_ADD(rawBytesWritten, H5Aget_storage_size(attr_id));
   status = 0;
 
 fail:
@@ -183,6 +219,8 @@ fail:
 
 /**
  * Creates a simple dataset and if buf != NULL, the dataset will get the data filled in.
+ * The write is traced as the node path.
+ * @param[in] path The path of the node being written, only used for tracing
  * @param[in] loc_id  The location the dataset should be created in
  * @param[in] type_id The type of the data
  * @param[in] ndims The rank of the data
@@ -191,14 +229,20 @@ fail:
  * @param[in] compress  The compression that should be used.
  * @return <0 on failure, otherwise success.
  */
-static hid_t createSimpleDataset(hid_t loc_id, hid_t type_id, const char* name,
+static hid_t createSimpleDataset(const char* path, hid_t loc_id, hid_t type_id, const char* name,
   int ndims, const hsize_t* dims, const void* buf, HL_Compression* compress)
 {
   hid_t dataset = -1;
   hid_t dataspace = -1;
   hid_t props = -1;
+  int traced = HL_TRACE_ENABLED(), written = 0;
+  unsigned long long bytes = HL_STATS_GET(bytesWritten), rawBytes = HL_STATS_GET(rawBytesWritten);
+  HL_TraceEvent event;
 
   HL_SPEWDEBUG0("ENTER: createSimpleDataset");
+  if (traced) {
+    HLTracePrivate_begin(&event, HL_TRACE_WRITE, NULL, path);
+  }
 
   if ((dataspace = H5Screate_simple(ndims, dims, NULL)) < 0) {
     HL_ERROR0("Failed to create simple dataspace for dataset");
@@ -247,9 +291,21 @@ static hid_t createSimpleDataset(hid_t loc_id, hid_t type_id, const char* name,
       HL_ERROR0("Failed to write dataset");
       goto done;
     }
+    HL_STATS_INC(datasetsWritten);
+    HL_STATS_ADD(bytesWritten, H5Sget_simple_extent_npoints(dataspace) * H5Tget_size(type_id));
+    HL_STATS_ADD(rawBytesWritten, H5Dget_storage_size(dataset));
   }
+  written = 1;
 
 done:
+  if (traced) {
+    if (dataset >= 0) {
+      HLTracePrivate_setFilters(&event, dataset);
+    }
+    event.bytes = HL_STATS_GET(bytesWritten) - bytes;
+    event.rawBytes = HL_STATS_GET(rawBytesWritten) - rawBytes;
+    HLTracePrivate_end(&event, written);
+  }
   HL_H5S_CLOSE(dataspace);
   HL_H5P_CLOSE(props);
 
@@ -286,7 +342,7 @@ static int doWriteHdf5Attribute(hid_t rootGrp, HL_Node* parentNode, char* parent
     if (writeScalarDataAttribute(tmpLocId,
                                  HLNodePrivate_getTypeId(childNode),
                                  childName,
-                                 HLNode_getData(childNode)) < 0) {
+                                 HLNode_getConstData(childNode)) < 0) {
       HL_ERROR1("Failed to write scalar data attribute '%s'",HLNode_getName(childNode));
       return 0;
     }
@@ -296,7 +352,7 @@ static int doWriteHdf5Attribute(hid_t rootGrp, HL_Node* parentNode, char* parent
                                  childName,
                                  HLNode_getRank(childNode),
                                  HLNodePrivate_getDims(childNode),
-                                 HLNode_getData(childNode)) < 0) {
+                                 HLNode_getConstData(childNode)) < 0) {
       HL_ERROR1("Failed to write simple data attribute '%s'",HLNode_getName(childNode));
       return 0;
     }
@@ -368,12 +424,12 @@ static int doWriteHdf5Dataset(hid_t rootGrp, HL_Node* parentNode, char* parentNa
     tmpLocId = HLNodePrivate_getHdfID(parentNode);
   }
 
-  hdfid = createSimpleDataset(tmpLocId,
+  hdfid = createSimpleDataset(HLNode_getName(childNode), tmpLocId,
                               HLNodePrivate_getTypeId(childNode),
                               childName,
                               HLNode_getRank(childNode),
                               HLNodePrivate_getDims(childNode),
-                              HLNode_getData(childNode),
+                              HLNode_getConstData(childNode),
                               compression);
   if (hdfid < 0) {
     HL_ERROR1("Failed to create dataset %s",HLNode_getName(childNode));
@@ -438,9 +494,9 @@ static int doWriteHdf5Reference(hid_t rootGrp, hid_t file_id, HL_Node* parentNod
   } else {
     tmpLocId = HLNodePrivate_getHdfID(parentNode);
   }
-  if (createReference(tmpLocId, file_id, childName, (char*) HLNode_getData(childNode)) < 0) {
+  if (createReference(tmpLocId, file_id, childName, (const char*) HLNode_getConstData(childNode)) < 0) {
     HL_ERROR3("Failed to create reference from '%s/%s' to '%s'",
-        parentName,childName, (char*)HLNode_getData(childNode));
+        parentName,childName, (const char*)HLNode_getConstData(childNode));
     return 0;
   }
   return 1;
@@ -478,7 +534,7 @@ static int doAppendHdf5Attribute(hid_t file_id, HL_Node* parentNode, char* paren
     if (writeScalarDataAttribute(loc_id,
                                  HLNodePrivate_getTypeId(childNode),
                                  childName,
-                                 HLNode_getData(childNode)) < 0) {
+                                 HLNode_getConstData(childNode)) < 0) {
       HL_ERROR1("Failed to write scalar data attribute '%s'\n",
                 HLNode_getName(childNode));
       goto fail;
@@ -489,7 +545,7 @@ static int doAppendHdf5Attribute(hid_t file_id, HL_Node* parentNode, char* paren
                                  childName,
                                  HLNode_getRank(childNode),
                                  HLNodePrivate_getDims(childNode),
-                                 HLNode_getData(childNode)) < 0) {
+                                 HLNode_getConstData(childNode)) < 0) {
       HL_ERROR1("Failed to write simple data attribute '%s'\n",
                 HLNode_getName(childNode));
       goto fail;
@@ -588,12 +644,12 @@ static int doAppendHdf5Dataset(hid_t file_id, HL_Node* parentNode, char* parentN
     }
   }
 
-  new_id = createSimpleDataset(loc_id,
+  new_id = createSimpleDataset(HLNode_getName(childNode), loc_id,
                                HLNodePrivate_getTypeId(childNode),
                                childName,
                                HLNode_getRank(childNode),
                                HLNodePrivate_getDims(childNode),
-                               HLNode_getData(childNode),
+                               HLNode_getConstData(childNode),
                                compression);
   if (new_id < 0) {
     HL_ERROR1("Failed to create dataset %s\n", HLNode_getName(childNode));
@@ -632,14 +688,45 @@ static int doAppendHdf5Reference(hid_t rootGrp, hid_t file_id, HL_Node* parentNo
   } else {
     tmpLocId = HLNodePrivate_getHdfID(parentNode);
   }
-  if (createReference(tmpLocId, file_id, childName, (char*) HLNode_getData(childNode)) < 0) {
+  if (createReference(tmpLocId, file_id, childName, (const char*) HLNode_getConstData(childNode)) < 0) {
     HL_ERROR3("Failed to create reference from '%s/%s' to '%s'",
-        parentName, childName, (char*)HLNode_getData(childNode));
+        parentName, childName, (const char*)HLNode_getConstData(childNode));
     return 0;
   }
   return 1;
 }
 
+/**
+ * Writes the node list of the handle and releases it, runs on the writing thread.
+ * @param[in] arg the write handle
+ * @return NULL
+ */
+static void* HLWriteInternal_run(void* arg)
+{
+  HL_WriteHandle* handle = (HL_WriteHandle*)arg;
+  int status = 0;
+
+  H5Eset_auto2(H5E_DEFAULT, handle->efunc, handle->edata);
+  status = HLNodeList_write(handle->nodelist, handle->hasProperty ? &handle->property : NULL, handle->compression);
+  if (!status) {
+    HL_ERROR1("Failed to write '%s'", handle->filename);
+  }
+  HLNodeList_free(handle->nodelist);
+  handle->nodelist = NULL;
+  handle->status = status;
+  if (handle->callback != NULL) {
+    handle->callback(handle->filename, status, handle->userdata);
+  }
+#ifdef H5_HAVE_THREADSAFE
+  pthread_mutex_lock(&handle->lock);
+#endif
+  handle->done = 1;
+#ifdef H5_HAVE_THREADSAFE
+  pthread_mutex_unlock(&handle->lock);
+#endif
+  return NULL;
+}
+
 /*@} End of Private functions */
 
 /*@{ Interface functions */
@@ -655,6 +742,7 @@ int HLNodeList_write(HL_NodeList* nodelist, HL_FileCreationProperty* property,
   int status = 0;
   char* filename = NULL;
   int nNodes = 0;
+  double start = HLCountersPrivate_now();
 
   HL_DEBUG0("ENTER: writeHL_NodeList");
 
@@ -668,6 +756,7 @@ int HLNodeList_write(HL_NodeList* nodelist, HL_FileCreationProperty* property,
     goto fail;
   }
 
+  HLNodeList_close(nodelist);
   if ((file_id = createHlHdfFile(filename, property)) < 0) {
     HL_DEBUG0("Failed to create HDF5 file");
     goto fail;
@@ -756,11 +845,113 @@ fail:
   HL_H5G_CLOSE(gid);
   HL_H5F_CLOSE(file_id);
   HLHDF_FREE(filename);
+  HL_STATS_ADD_TIME(writeTime, start);
   HL_DEBUG1("EXIT: writeHL_NodeList with status %d", status);
 
   return status;
 }
 
+HL_WriteHandle* HLNodeList_writeAsync(HL_NodeList* nodelist, HL_FileCreationProperty* property,
+                                      HL_Compression* compression, HL_WriteCallback callback, void* userdata)
+{
+  HL_WriteHandle* handle = NULL;
+  int i = 0;
+
+  HL_DEBUG0("ENTER: writeAsync");
+  if (nodelist == NULL) {
+    HL_ERROR0("Inparameters NULL");
+    goto fail;
+  }
+  if ((handle = HLHDF_MALLOC(sizeof(HL_WriteHandle))) == NULL) {
+    HL_ERROR0("Failed to allocate memory for write handle");
+    goto fail;
+  }
+  memset(handle, 0, sizeof(HL_WriteHandle));
+  if ((handle->filename = HLNodeList_getFileName(nodelist)) == NULL) {
+    HL_ERROR0("Could not get filename from nodelist");
+    goto fail;
+  }
+  if (compression != NULL && (handle->compression = HLCompression_clone(compression)) == NULL) {
+    HL_ERROR0("Failed to copy compression");
+    goto fail;
+  }
+  if (property != NULL) {
+    handle->property = *property;
+    handle->hasProperty = 1;
+  }
+  for (i = 0; i < HLNodeList_getNumberOfNodes(nodelist); i++) {
+    if (!HLNodePrivate_detach(HLNodeList_getNodeByIndex(nodelist, i))) {
+      goto fail;
+    }
+  }
+  handle->nodelist = nodelist;
+  handle->callback = callback;
+  handle->userdata = userdata;
+  H5Eget_auto2(H5E_DEFAULT, &handle->efunc, &handle->edata);
+
+#ifdef H5_HAVE_THREADSAFE
+  pthread_mutex_init(&handle->lock, NULL);
+  if (pthread_create(&handle->thread, NULL, HLWriteInternal_run, handle) == 0) {
+    handle->threaded = 1;
+  } else {
+    HLWriteInternal_run(handle);
+  }
+#else
+  HLWriteInternal_run(handle);
+#endif
+  HL_DEBUG0("EXIT: writeAsync");
+  return handle;
+fail:
+  if (handle != NULL) {
+    HLHDF_FREE(handle->filename);
+    HLCompression_free(handle->compression);
+    HLHDF_FREE(handle);
+  }
+  HL_DEBUG0("EXIT: writeAsync with Error");
+  return NULL;
+}
+
+int HLWriteHandle_isDone(HL_WriteHandle* handle)
+{
+  int result = 0;
+  HL_ASSERT((handle != NULL), "HLWriteHandle_isDone called with handle == NULL");
+#ifdef H5_HAVE_THREADSAFE
+  pthread_mutex_lock(&handle->lock);
+#endif
+  result = handle->done;
+#ifdef H5_HAVE_THREADSAFE
+  pthread_mutex_unlock(&handle->lock);
+#endif
+  return result;
+}
+
+int HLWriteHandle_wait(HL_WriteHandle* handle)
+{
+  HL_ASSERT((handle != NULL), "HLWriteHandle_wait called with handle == NULL");
+  if (!handle->joined) {
+#ifdef H5_HAVE_THREADSAFE
+    if (handle->threaded) {
+      pthread_join(handle->thread, NULL);
+    }
+#endif
+    handle->joined = 1;
+  }
+  return handle->status;
+}
+
+void HLWriteHandle_free(HL_WriteHandle* handle)
+{
+  if (handle != NULL) {
+    HLWriteHandle_wait(handle);
+#ifdef H5_HAVE_THREADSAFE
+    pthread_mutex_destroy(&handle->lock);
+#endif
+    HLHDF_FREE(handle->filename);
+    HLCompression_free(handle->compression);
+    HLHDF_FREE(handle);
+  }
+}
+
 int HLNodeList_update(HL_NodeList* nodelist, HL_Compression* compression)
 {
   int i;
@@ -772,6 +963,7 @@ int HLNodeList_update(HL_NodeList* nodelist, HL_Compression* compression)
   int status = 0;
   char* filename = NULL;
   int nNodes = 0;
+  double start = HLCountersPrivate_now();
 
   HL_DEBUG0("ENTER: updateHL_NodeList");
 
@@ -785,6 +977,7 @@ int HLNodeList_update(HL_NodeList* nodelist, HL_Compression* compression)
     goto fail;
   }
 
+  HLNodeList_close(nodelist);
   if ((file_id = openHlHdfFile(filename, "rw")) < 0) {
     HL_ERROR1("Failed to open file %s\n", filename);
     goto fail;
@@ -876,6 +1069,7 @@ fail:
   HL_H5G_CLOSE(gid);
   HL_H5F_CLOSE(file_id);
   HLHDF_FREE(filename);
+  HL_STATS_ADD_TIME(writeTime, start);
   HL_DEBUG1("EXIT: updateHL_NodeList with status = %d", status);
   return status;
 }
@@ -37,6 +37,50 @@ along with HLHDF.  If not, see <http://www.gnu.org/licenses/>.
  */
 int HLNodeList_write(HL_NodeList* nodelist, HL_FileCreationProperty* property, HL_Compression* compr);
 
+/**
+ * Writes a HDF5 file from a nodelist like \ref HLNodeList_write but on a background thread.
+ * The handle takes ownership of the nodelist and releases it when the file has been written,
+ * the caller must not access the nodelist or its nodes after this call has succeeded. Data and
+ * compound type descriptions that the nodes share with other nodes or with the data cache
+ * are copied first, so the caller may keep using those. <b>property</b> and
+ * <b>compression</b> are copied. When the write has finished, <b>callback</b> is called from
+ * the writing thread.
+ * If HDF5 has not been built thread-safe, the file is written before this function returns.
+ * @ingroup hlhdf_c_apis
+ * @param[in] nodelist the node list to write
+ * @param[in] property the file creation properties, may be NULL
+ * @param[in] compression the wanted compression type and level, may be NULL
+ * @param[in] callback called when the write has finished, may be NULL
+ * @param[in] userdata passed on to the callback
+ * @return the handle (<b>release with HLWriteHandle_free</b>) or NULL on failure in which case
+ * the caller keeps the ownership of the nodelist
+ */
+HL_WriteHandle* HLNodeList_writeAsync(HL_NodeList* nodelist, HL_FileCreationProperty* property,
+                                      HL_Compression* compression, HL_WriteCallback callback, void* userdata);
+
+/**
+ * Returns if the write has finished.
+ * @ingroup hlhdf_c_apis
+ * @param[in] handle the write handle
+ * @return 1 if the write has finished, otherwise 0
+ */
+int HLWriteHandle_isDone(HL_WriteHandle* handle);
+
+/**
+ * Waits until the write has finished.
+ * @ingroup hlhdf_c_apis
+ * @param[in] handle the write handle
+ * @return 1 if the file was written, otherwise 0
+ */
+int HLWriteHandle_wait(HL_WriteHandle* handle);
+
+/**
+ * Waits for the write to finish and releases the handle.
+ * @ingroup hlhdf_c_apis
+ * @param[in] handle the write handle
+ */
+void HLWriteHandle_free(HL_WriteHandle* handle);
+
 /**
  * Updates a HDF5 file from a nodelist.
  * @ingroup hlhdf_c_apis
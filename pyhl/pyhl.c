@@ -78,6 +78,7 @@ static PyObject *ErrorObject;
 typedef struct {
    PyObject_HEAD /*Always have to be on top*/
    HL_NodeList* nodelist; /**< the node list */
+   PyObject* fetch; /**< the PyhlFetchHandle of the fetch in progress (borrowed), NULL if none */
 } PyhlNodelist;
 
 /**
@@ -104,11 +105,51 @@ typedef struct {
    HL_Compression* compr; /**< the compression instance */
 } PyhlCompression;
 
+/**
+ * The pyhl chunk iterator object.
+ */
+typedef struct {
+   PyObject_HEAD /*Always have to be on top*/
+   HL_ChunkIterator* iterator; /**< the iterator */
+} PyhlChunkIterator;
+
+/**
+ * The pyhl fetch handle object.
+ */
+typedef struct {
+   PyObject_HEAD /*Always have to be on top*/
+   HL_FetchHandle* handle; /**< the fetch handle */
+   PyObject* nodelist; /**< the nodelist being fetched, kept alive by the handle */
+} PyhlFetchHandle;
+
+/**
+ * The pyhl write handle object.
+ */
+typedef struct {
+   PyObject_HEAD /*Always have to be on top*/
+   HL_WriteHandle* handle; /**< the write handle */
+} PyhlWriteHandle;
+
 /**
  * PyhlNodelist represents a HL_NodeList
  */
 static PyTypeObject PyhlNodelist_Type;
 
+/**
+ * PyhlChunkIterator represents a HL_ChunkIterator
+ */
+static PyTypeObject PyhlChunkIterator_Type;
+
+/**
+ * PyhlFetchHandle represents a HL_FetchHandle
+ */
+static PyTypeObject PyhlFetchHandle_Type;
+
+/**
+ * PyhlWriteHandle represents a HL_WriteHandle
+ */
+static PyTypeObject PyhlWriteHandle_Type;
+
 /**
  * PyhlNode represents a HL_Node.
  */
@@ -186,6 +227,50 @@ static void _dealloc_pyhlfilecreationproperty(PyhlFileCreationProperty* val)
   PyObject_Del(val);
 }
 
+/**
+ * Deallocates the pyhl chunk iterator.
+ * @param[in] val the object to deallocate.
+ */
+static void _dealloc_pyhlchunkiterator(PyhlChunkIterator* val)
+{
+  if (!val)
+    return;
+  HLChunkIterator_free(val->iterator);
+  PyObject_Del(val);
+}
+
+/**
+ * Deallocates the pyhl fetch handle, waits for the fetch to complete.
+ * @param[in] val the object to deallocate.
+ */
+static void _dealloc_pyhlfetchhandle(PyhlFetchHandle* val)
+{
+  if (!val)
+    return;
+  Py_BEGIN_ALLOW_THREADS
+  HLFetchHandle_free(val->handle);
+  Py_END_ALLOW_THREADS
+  if (val->nodelist != NULL && ((PyhlNodelist*)val->nodelist)->fetch == (PyObject*)val) {
+    ((PyhlNodelist*)val->nodelist)->fetch = NULL;
+  }
+  Py_XDECREF(val->nodelist);
+  PyObject_Del(val);
+}
+
+/**
+ * Deallocates the pyhl write handle, waits for the write to finish.
+ * @param[in] val the object to deallocate.
+ */
+static void _dealloc_pyhlwritehandle(PyhlWriteHandle* val)
+{
+  if (!val)
+    return;
+  Py_BEGIN_ALLOW_THREADS
+  HLWriteHandle_free(val->handle);
+  Py_END_ALLOW_THREADS
+  PyObject_Del(val);
+}
+
 /**
  * Deallocates the pyhl compression instance.
  * @param[in] val the object to deallocate.
@@ -210,6 +295,7 @@ static PyObject* _pyhl_new_nodelist(PyObject* self, PyObject* args)
   retv = PyObject_NEW(PyhlNodelist,&PyhlNodelist_Type);
   if (!retv)
     return NULL;
+  retv->fetch = NULL;
 
   if (!(retv->nodelist = HLNodeList_new())) {
     setException(PyExc_MemoryError,"Failed to create HL NodeList\n");
@@ -338,11 +424,43 @@ static PyObject* _pyhl_read_nodelist(PyObject* self, PyObject* args)
   PyhlNodelist* retv = NULL;
   char* filename = NULL;
   char* frompath = NULL;
+  PyObject* pypatterns = NULL;
+  PyObject* pytuple = NULL;
+  const char** patterns = NULL;
+  Py_ssize_t npatterns = 0, i = 0;
 
-  if (!PyArg_ParseTuple(args, "s|s", &filename, &frompath))
+  if (!PyArg_ParseTuple(args, "s|zO", &filename, &frompath, &pypatterns))
     return NULL;
 
-  if (!frompath) {
+  if (pypatterns != NULL && pypatterns != Py_None) {
+    if (!PySequence_Check(pypatterns) || PyString_Check(pypatterns) ||
+        (pytuple = PySequence_Tuple(pypatterns)) == NULL) {
+      setException(PyExc_TypeError, "patterns must be a sequence of strings");
+      return NULL;
+    }
+    npatterns = PyTuple_Size(pytuple);
+    if ((patterns = HLHDF_MALLOC(sizeof(const char*) * (npatterns + 1))) == NULL) {
+      Py_DECREF(pytuple);
+      setException(PyExc_MemoryError, "Could not allocate patterns");
+      return NULL;
+    }
+    for (i = 0; i < npatterns; i++) {
+      PyObject* item = PyTuple_GET_ITEM(pytuple, i);
+      patterns[i] = PyString_Check(item) ? PyString_AsString(item) : NULL;
+      if (patterns[i] == NULL) {
+        HLHDF_FREE(patterns);
+        Py_DECREF(pytuple);
+        setException(PyExc_TypeError, "patterns must be a sequence of strings");
+        return NULL;
+      }
+    }
+  }
+
+  if (patterns != NULL) {
+    nodelist = HLNodeList_readFromFiltered(filename, frompath ? frompath : ".", patterns, (int)npatterns);
+    HLHDF_FREE(patterns);
+    Py_DECREF(pytuple);
+  } else if (!frompath) {
     nodelist = HLNodeList_read(filename);
   } else {
     nodelist = HLNodeList_readFrom(filename, frompath);
@@ -374,6 +492,33 @@ fail:
   return NULL;
 }
 
+static PyObject* _pyhl_read_nodelist_with_metadata(PyObject* self, PyObject* args)
+{
+  HL_NodeList* nodelist = NULL;
+  PyhlNodelist* retv = NULL;
+  char* filename = NULL;
+
+  if (!PyArg_ParseTuple(args, "s", &filename))
+    return NULL;
+
+  if (!(nodelist = HLNodeList_readWithMetadata(filename))) {
+    char errmsg[256];
+    snprintf(errmsg, sizeof(errmsg), "Could not read file '%s'", filename);
+    setException(PyExc_IOError,errmsg);
+    return NULL;
+  }
+
+  if (!(retv = (PyhlNodelist*) _pyhl_new_nodelist(NULL, NULL))) {
+    HLNodeList_free(nodelist);
+    setException(PyExc_MemoryError,"Could not allocate nodelist instance");
+    return NULL;
+  }
+
+  HLNodeList_free(retv->nodelist);
+  retv->nodelist = nodelist;
+  return (PyObject*) retv;
+}
+
 static PyObject* _pyhl_is_file_hdf5(PyObject* self, PyObject* args)
 {
   char* filename;
@@ -425,6 +570,206 @@ static PyObject* _pyhl_get_hdf5version(PyObject* self, PyObject* args)
   }
 }
 
+static PyObject* _pyhl_set_data_cache_limit(PyObject* self, PyObject* args)
+{
+  Py_ssize_t limit = 0;
+  if (!PyArg_ParseTuple(args, "n", &limit))
+    return NULL;
+  if (limit < 0) {
+    setException(PyExc_ValueError, "Cache limit must be >= 0");
+    return NULL;
+  }
+  HL_setDataCacheLimit((size_t)limit);
+  Py_RETURN_NONE;
+}
+
+static PyObject* _pyhl_get_data_cache_limit(PyObject* self, PyObject* args)
+{
+  return PyLong_FromSize_t(HL_getDataCacheLimit());
+}
+
+static PyObject* _pyhl_get_data_cache_usage(PyObject* self, PyObject* args)
+{
+  return PyLong_FromSize_t(HL_getDataCacheUsage());
+}
+
+static PyObject* _pyhl_get_data_cache_statistics(PyObject* self, PyObject* args)
+{
+  size_t hits = 0, misses = 0;
+  HL_getDataCacheStatistics(&hits, &misses);
+  return Py_BuildValue("(nn)", (Py_ssize_t)hits, (Py_ssize_t)misses);
+}
+
+static PyObject* _pyhl_clear_data_cache(PyObject* self, PyObject* args)
+{
+  HL_clearDataCache();
+  Py_RETURN_NONE;
+}
+
+static PyObject* _pyhl_set_index_mode(PyObject* self, PyObject* args)
+{
+  int mode = 0;
+  if (!PyArg_ParseTuple(args, "i", &mode))
+    return NULL;
+  if (mode != HL_INDEX_NONE && mode != HL_INDEX_MEMORY && mode != HL_INDEX_SIDECAR) {
+    setException(PyExc_ValueError, "Invalid index mode");
+    return NULL;
+  }
+  HL_setIndexMode((HL_IndexMode)mode);
+  Py_RETURN_NONE;
+}
+
+static PyObject* _pyhl_get_index_mode(PyObject* self, PyObject* args)
+{
+  return PyInt_FromLong(HL_getIndexMode());
+}
+
+static PyObject* _pyhl_get_index_statistics(PyObject* self, PyObject* args)
+{
+  size_t hits = 0, misses = 0;
+  HL_getIndexStatistics(&hits, &misses);
+  return Py_BuildValue("(nn)", (Py_ssize_t)hits, (Py_ssize_t)misses);
+}
+
+static PyObject* _pyhl_clear_index_cache(PyObject* self, PyObject* args)
+{
+  HL_clearIndexCache();
+  Py_RETURN_NONE;
+}
+
+static PyObject* _pyhl_set_memory_mapped_reads(PyObject* self, PyObject* args)
+{
+  int enable = 0;
+  if (!PyArg_ParseTuple(args, "i", &enable))
+    return NULL;
+  HL_setMemoryMappedReads(enable);
+  Py_RETURN_NONE;
+}
+
+static PyObject* _pyhl_get_memory_mapped_reads(PyObject* self, PyObject* args)
+{
+  return PyInt_FromLong(HL_getMemoryMappedReads());
+}
+
+static PyObject* _pyhl_set_whole_file_read_limit(PyObject* self, PyObject* args)
+{
+  unsigned long long limit = 0;
+  if (!PyArg_ParseTuple(args, "K", &limit))
+    return NULL;
+  HL_setWholeFileReadLimit((size_t)limit);
+  Py_RETURN_NONE;
+}
+
+static PyObject* _pyhl_get_whole_file_read_limit(PyObject* self, PyObject* args)
+{
+  return PyLong_FromUnsignedLongLong((unsigned long long)HL_getWholeFileReadLimit());
+}
+
+static PyObject* _pyhl_set_page_buffer_size(PyObject* self, PyObject* args)
+{
+  unsigned long long size = 0;
+  if (!PyArg_ParseTuple(args, "K", &size))
+    return NULL;
+  HL_setPageBufferSize((size_t)size);
+  Py_RETURN_NONE;
+}
+
+static PyObject* _pyhl_get_page_buffer_size(PyObject* self, PyObject* args)
+{
+  return PyLong_FromUnsignedLongLong((unsigned long long)HL_getPageBufferSize());
+}
+
+static PyObject* _pyhl_get_stats(PyObject* self, PyObject* args)
+{
+  HL_Stats stats;
+  HL_getStats(&stats);
+  return Py_BuildValue("{s:K,s:K,s:K,s:K,s:K,s:K,s:K,s:K,s:K,s:K,s:K,s:K,s:d,s:d,s:d,s:d}",
+                       "files_opened", stats.filesOpened,
+                       "objects_opened", stats.objectsOpened,
+                       "attributes_read", stats.attributesRead,
+                       "datasets_read", stats.datasetsRead,
+                       "attributes_written", stats.attributesWritten,
+                       "datasets_written", stats.datasetsWritten,
+                       "bytes_read", stats.bytesRead,
+                       "raw_bytes_read", stats.rawBytesRead,
+                       "bytes_written", stats.bytesWritten,
+                       "raw_bytes_written", stats.rawBytesWritten,
+                       "bytes_mapped", stats.bytesMapped,
+                       "allocations", stats.allocations,
+                       "traverse_time", stats.traverseTime,
+                       "fetch_time", stats.fetchTime,
+                       "convert_time", stats.convertTime,
+                       "write_time", stats.writeTime);
+}
+
+static PyObject* _pyhl_reset_stats(PyObject* self, PyObject* args)
+{
+  HL_resetStats();
+  Py_RETURN_NONE;
+}
+
+static PyObject* _pyhl_start_trace(PyObject* self, PyObject* args)
+{
+  char* filename = NULL;
+  if (!PyArg_ParseTuple(args, "s", &filename))
+    return NULL;
+  if (!HL_startTrace(filename)) {
+    setException(PyExc_IOError, "Failed to start trace");
+    return NULL;
+  }
+  Py_RETURN_NONE;
+}
+
+static PyObject* _pyhl_stop_trace(PyObject* self, PyObject* args)
+{
+  HL_stopTrace();
+  Py_RETURN_NONE;
+}
+
+static PyObject* _pyhl_start_async_logging(PyObject* self, PyObject* args)
+{
+  Py_ssize_t nslots = 4096;
+  if (!PyArg_ParseTuple(args, "|n", &nslots))
+    return NULL;
+  if (nslots <= 0) {
+    setException(PyExc_ValueError, "nslots must be > 0");
+    return NULL;
+  }
+  if (!HL_startAsyncLogging((size_t)nslots)) {
+    setException(PyExc_RuntimeError, "Failed to start asynchronous logging");
+    return NULL;
+  }
+  Py_RETURN_NONE;
+}
+
+static PyObject* _pyhl_stop_async_logging(PyObject* self, PyObject* args)
+{
+  Py_BEGIN_ALLOW_THREADS
+  HL_stopAsyncLogging();
+  Py_END_ALLOW_THREADS
+  Py_RETURN_NONE;
+}
+
+/**
+ * Waits for a fetch started with fetchAsync to complete. Every nodelist method calls this
+ * first so that the node list is not used while the I/O thread fills it.
+ * @param[in] self the nodelist
+ */
+static void _pyhl_wait_for_fetch(PyhlNodelist* self)
+{
+  PyObject* fetch = self->fetch;
+  if (fetch != NULL) {
+    Py_INCREF(fetch);
+    Py_BEGIN_ALLOW_THREADS
+    HLFetchHandle_wait(((PyhlFetchHandle*)fetch)->handle);
+    Py_END_ALLOW_THREADS
+    if (self->fetch == fetch) {
+      self->fetch = NULL;
+    }
+    Py_DECREF(fetch);
+  }
+}
+
 /* PyhlNodelist member methods */
 static PyObject* _pyhl_add_node(PyhlNodelist* self, PyObject* args)
 {
@@ -432,6 +777,8 @@ static PyObject* _pyhl_add_node(PyhlNodelist* self, PyObject* args)
   PyhlNode* pyhlNode;
   HL_Node* aNode;
 
+  _pyhl_wait_for_fetch(self);
+
   if (!PyArg_ParseTuple(args, "O", &inp))
     return NULL;
 
@@ -454,49 +801,68 @@ static PyObject* _pyhl_add_node(PyhlNodelist* self, PyObject* args)
   return Py_None;
 }
 
-static PyObject* _pyhl_write(PyhlNodelist* self, PyObject* args)
+/**
+ * Parses the arguments to write and writeAsync, (filename[,zlib compression level(int)][,file creation property]).
+ * @param[in] args the arguments
+ * @param[out] filename the filename
+ * @param[out] doCompress the compression level, -1 if not given
+ * @param[out] props the file creation property, NULL if not given
+ * @return 1 on success, otherwise 0 with an exception set
+ */
+static int _pyhl_parse_write_args(PyObject* args, char** filename, int* doCompress, PyObject** props)
 {
-  char* filename;
   PyObject* obj1 = NULL;
   PyObject* obj2 = NULL;
 
-  int doCompress = -1;
-  PyObject* props = NULL;
-  HL_Compression* theCompression = NULL;
-
-  if (!PyArg_ParseTuple(args, "s|OO", &filename, &obj1, &obj2))
-    return NULL;
+  *doCompress = -1;
+  *props = NULL;
+  if (!PyArg_ParseTuple(args, "s|OO", filename, &obj1, &obj2))
+    return 0;
 
   if (obj1 != NULL) {
     if (PyInt_Check(obj1)) {
-      doCompress = PyInt_AsLong(obj1);
+      *doCompress = PyInt_AsLong(obj1);
     } else if (PyhlFileCreationProperty_Check(obj1)) {
-      props = obj1;
+      *props = obj1;
     } else {
       setException(PyExc_AttributeError,"write method should be called with write(filename[,zlib compression level(int)][,file creation property])");
-      return NULL;
+      return 0;
     }
   }
   if (obj2 != NULL) {
     if (PyInt_Check(obj2)) {
-      if (doCompress != -1) {
+      if (*doCompress != -1) {
         setException(PyExc_AttributeError,"it is not meaningful or possible to call write with both second and third argument as integers, format is: "
             "write(filename[,zlib compression level(int)][,file creation property])");
-        return NULL;
+        return 0;
       }
-      doCompress = PyInt_AsLong(obj2);
+      *doCompress = PyInt_AsLong(obj2);
     } else if (PyhlFileCreationProperty_Check(obj2)) {
-      if (props != NULL) {
+      if (*props != NULL) {
         setException(PyExc_AttributeError,"it is not meaningful or possible to call write with both second and third argument as FileCreationProperty instances"
             ", format is: write(filename[,zlib compression level(int)][,file creation property])");
-        return NULL;
+        return 0;
       }
-      props = obj2;
+      *props = obj2;
     } else {
       setException(PyExc_AttributeError,"write method should be called with write(filename[,zlib compression level(int)][,file creation property])");
-      return NULL;
+      return 0;
     }
   }
+  return 1;
+}
+
+static PyObject* _pyhl_write(PyhlNodelist* self, PyObject* args)
+{
+  char* filename = NULL;
+  int doCompress = -1;
+  PyObject* props = NULL;
+  HL_Compression* theCompression = NULL;
+
+  _pyhl_wait_for_fetch(self);
+
+  if (!_pyhl_parse_write_args(args, &filename, &doCompress, &props))
+    return NULL;
 
   if (!HLNodeList_setFileName(self->nodelist,filename)) {
     setException(PyExc_IOError, "Could not set filename for nodelist");
@@ -526,11 +892,92 @@ static PyObject* _pyhl_write(PyhlNodelist* self, PyObject* args)
   return Py_None;
 }
 
+static PyObject* _pyhl_write_async(PyhlNodelist* self, PyObject* args)
+{
+  char* filename = NULL;
+  int doCompress = -1;
+  PyObject* props = NULL;
+  HL_Compression* theCompression = NULL;
+  HL_NodeList* empty = NULL;
+  HL_WriteHandle* handle = NULL;
+  PyhlWriteHandle* retv = NULL;
+
+  _pyhl_wait_for_fetch(self);
+
+  if (!_pyhl_parse_write_args(args, &filename, &doCompress, &props))
+    return NULL;
+
+  if (!HLNodeList_setFileName(self->nodelist,filename)) {
+    setException(PyExc_IOError, "Could not set filename for nodelist");
+    return NULL;
+  }
+  if ((retv = PyObject_NEW(PyhlWriteHandle, &PyhlWriteHandle_Type)) == NULL ||
+      (empty = HLNodeList_new()) == NULL) {
+    Py_XDECREF(retv);
+    setException(PyExc_MemoryError, "Could not create write handle");
+    return NULL;
+  }
+  retv->handle = NULL;
+
+  if (doCompress != -1) {
+    theCompression = HLCompression_new(CT_ZLIB);
+    theCompression->level = doCompress;
+  }
+  handle = HLNodeList_writeAsync(self->nodelist,
+                                 (props != NULL) ? ((PyhlFileCreationProperty*) props)->props : NULL,
+                                 theCompression, NULL, NULL);
+  if (theCompression) {
+    HLCompression_free(theCompression);
+  }
+  if (handle == NULL) {
+    HLNodeList_free(empty);
+    Py_DECREF(retv);
+    setException(PyExc_IOError,"Could not write hdf file");
+    return NULL;
+  }
+  /* The handle owns the nodes now, the nodelist continues empty */
+  self->nodelist = empty;
+  retv->handle = handle;
+  return (PyObject*)retv;
+}
+
+/**
+ * Returns if the write has finished.
+ * @param[in] self the write handle
+ * @param[in] args N/A
+ * @return True or False
+ */
+static PyObject* _pyhl_write_handle_done(PyhlWriteHandle* self, PyObject* args)
+{
+  return PyBool_FromLong(HLWriteHandle_isDone(self->handle));
+}
+
+/**
+ * Waits for the write to finish.
+ * @param[in] self the write handle
+ * @param[in] args N/A
+ * @return None on success, otherwise NULL
+ */
+static PyObject* _pyhl_write_handle_wait(PyhlWriteHandle* self, PyObject* args)
+{
+  int status = 0;
+  Py_BEGIN_ALLOW_THREADS
+  status = HLWriteHandle_wait(self->handle);
+  Py_END_ALLOW_THREADS
+  if (!status) {
+    setException(PyExc_IOError,"Could not write hdf file");
+    return NULL;
+  }
+  Py_RETURN_NONE;
+}
+
 static PyObject* _pyhl_update(PyhlNodelist* self, PyObject* args)
 {
   int doCompress = 6;
   HL_Compression compression;
 
+  _pyhl_wait_for_fetch(self);
+
   if (!PyArg_ParseTuple(args, "|i", &doCompress))
     return NULL;
   HLCompression_init(&compression, CT_ZLIB);
@@ -551,6 +998,9 @@ static PyObject* _pyhl_get_node_names(PyhlNodelist* self, PyObject* args)
   int nNodes = 0;
 
   char errbuf[256];
+
+  _pyhl_wait_for_fetch(self);
+
   if (!(retv = PyDict_New())) {
     setException(PyExc_MemoryError,"Could not allocate dictionary");
     return NULL;
@@ -611,6 +1061,7 @@ fail:
 
 static PyObject* _pyhl_select_all(PyhlNodelist* self, PyObject* args)
 {
+  _pyhl_wait_for_fetch(self);
   HLNodeList_selectAllNodes(self->nodelist);
   Py_INCREF(Py_None);
   return Py_None;
@@ -618,6 +1069,7 @@ static PyObject* _pyhl_select_all(PyhlNodelist* self, PyObject* args)
 
 static PyObject* _pyhl_select_metadata(PyhlNodelist* self, PyObject* args)
 {
+  _pyhl_wait_for_fetch(self);
   HLNodeList_selectMetadataNodes(self->nodelist);
   Py_INCREF(Py_None);
   return Py_None;
@@ -625,6 +1077,7 @@ static PyObject* _pyhl_select_metadata(PyhlNodelist* self, PyObject* args)
 
 static PyObject* _pyhl_select_all_metadata(PyhlNodelist* self, PyObject* args)
 {
+  _pyhl_wait_for_fetch(self);
   HLNodeList_selectAllMetadataNodes(self->nodelist);
   Py_INCREF(Py_None);
   return Py_None;
@@ -632,137 +1085,629 @@ static PyObject* _pyhl_select_all_metadata(PyhlNodelist* self, PyObject* args)
 
 static PyObject* _pyhl_select_only_datasets(PyhlNodelist* self, PyObject* args)
 {
+  _pyhl_wait_for_fetch(self);
   HLNodeList_selectOnlyDatasetNodes(self->nodelist);
   Py_INCREF(Py_None);
   return Py_None;
 }
 
-static PyObject* _pyhl_select_node(PyhlNodelist* self, PyObject* args)
+static PyObject* _pyhl_select_node(PyhlNodelist* self, PyObject* args)
+{
+  char* nodename;
+  char errbuf[256];
+
+  _pyhl_wait_for_fetch(self);
+
+  if (!PyArg_ParseTuple(args, "s", &nodename))
+    return NULL;
+  if (!HLNodeList_selectNode(self->nodelist, nodename)) {
+    sprintf(errbuf, "Could not select node '%s'", nodename);
+    setException(PyExc_AttributeError,errbuf);
+    goto fail;
+  }
+  Py_INCREF(Py_None);
+  return Py_None;
+fail:
+  return NULL;
+}
+
+static PyObject* _pyhl_deselect_node(PyhlNodelist* self, PyObject* args)
+{
+  char* nodename;
+  char errbuf[256];
+
+  _pyhl_wait_for_fetch(self);
+
+  if (!PyArg_ParseTuple(args, "s", &nodename))
+    return NULL;
+  if (!HLNodeList_deselectNode(self->nodelist, nodename)) {
+    sprintf(errbuf, "Could not select node '%s'", nodename);
+    setException(PyExc_AttributeError,errbuf);
+    goto fail;
+  }
+  Py_INCREF(Py_None);
+  return Py_None;
+fail:
+  return NULL;
+}
+
+static PyObject* _pyhl_open(PyhlNodelist* self, PyObject* args)
+{
+  _pyhl_wait_for_fetch(self);
+  if (!HLNodeList_open(self->nodelist)) {
+    setException(PyExc_IOError,"Could not open file");
+    return NULL;
+  }
+  Py_RETURN_NONE;
+}
+
+static PyObject* _pyhl_close(PyhlNodelist* self, PyObject* args)
+{
+  _pyhl_wait_for_fetch(self);
+  HLNodeList_close(self->nodelist);
+  Py_RETURN_NONE;
+}
+
+static PyObject* _pyhl_enter(PyhlNodelist* self, PyObject* args)
+{
+  _pyhl_wait_for_fetch(self);
+  if (!HLNodeList_open(self->nodelist)) {
+    setException(PyExc_IOError,"Could not open file");
+    return NULL;
+  }
+  Py_INCREF(self);
+  return (PyObject*)self;
+}
+
+static PyObject* _pyhl_exit(PyhlNodelist* self, PyObject* args)
+{
+  _pyhl_wait_for_fetch(self);
+  HLNodeList_close(self->nodelist);
+  Py_RETURN_FALSE;
+}
+
+static PyObject* _pyhl_fetch(PyhlNodelist* self, PyObject* args)
+{
+  _pyhl_wait_for_fetch(self);
+  if (!HLNodeList_fetchMarkedNodes(self->nodelist)) {
+    setException(PyExc_IOError,"Could not fetch selected nodes");
+    goto fail;
+  }
+  Py_INCREF(Py_None);
+  return Py_None;
+fail:
+  return NULL;
+}
+
+static PyObject* _pyhl_fetch_async(PyhlNodelist* self, PyObject* args)
+{
+  PyhlFetchHandle* retv = NULL;
+  HL_FetchHandle* handle = NULL;
+
+  _pyhl_wait_for_fetch(self);
+
+  if ((handle = HLNodeList_fetchMarkedNodesAsync(self->nodelist, NULL, NULL)) == NULL) {
+    setException(PyExc_IOError,"Could not fetch selected nodes");
+    return NULL;
+  }
+  if ((retv = PyObject_NEW(PyhlFetchHandle, &PyhlFetchHandle_Type)) == NULL) {
+    HLFetchHandle_free(handle);
+    setException(PyExc_MemoryError, "Could not create fetch handle");
+    return NULL;
+  }
+  retv->handle = handle;
+  retv->nodelist = (PyObject*)self;
+  Py_INCREF(self);
+  self->fetch = (PyObject*)retv;
+  return (PyObject*)retv;
+}
+
+/**
+ * Returns how far the fetch has come.
+ * @param[in] self the fetch handle
+ * @param[in] args N/A
+ * @return a tuple (completed, total)
+ */
+static PyObject* _pyhl_fetch_handle_poll(PyhlFetchHandle* self, PyObject* args)
+{
+  return Py_BuildValue("(ii)", HLFetchHandle_getNumberOfCompletedNodes(self->handle),
+                       HLFetchHandle_getNumberOfNodes(self->handle));
+}
+
+/**
+ * Waits for one node or for the whole fetch to complete.
+ * @param[in] self the fetch handle
+ * @param[in] args an optional node name
+ * @return None on success, otherwise NULL
+ */
+static PyObject* _pyhl_fetch_handle_wait(PyhlFetchHandle* self, PyObject* args)
+{
+  char* nodename = NULL;
+  int status = 0;
+
+  if (!PyArg_ParseTuple(args, "|z", &nodename))
+    return NULL;
+
+  Py_BEGIN_ALLOW_THREADS
+  if (nodename != NULL) {
+    status = HLFetchHandle_waitForNode(self->handle, nodename);
+  } else {
+    status = HLFetchHandle_wait(self->handle);
+  }
+  Py_END_ALLOW_THREADS
+  if (!status) {
+    setException(PyExc_IOError, "Could not fetch selected nodes");
+    return NULL;
+  }
+  Py_RETURN_NONE;
+}
+
+static PyObject* _pyhl_fetch_node(PyhlNodelist* self, PyObject* args)
+{
+  char* nodename;
+  char errbuf[256];
+  HL_Node* node = NULL;
+  PyhlNode* retv = NULL;
+  PyObject* myArgs = NULL;
+
+  _pyhl_wait_for_fetch(self);
+
+  if (!PyArg_ParseTuple(args, "s", &nodename))
+    return NULL;
+
+  if (!(node = HLNodeList_fetchNode(self->nodelist, nodename))) {
+    sprintf(errbuf, "Could not fetch node '%s'", nodename);
+    setException(PyExc_IOError,errbuf);
+    goto fail;
+  }
+
+  if (!(myArgs = Py_BuildValue("(is)", HLNode_getType(node), HLNode_getName(node)))) {
+    setException(PyExc_AttributeError,"Could not create argument tuple for allocating node");
+    goto fail;
+  }
+
+  if (!(retv = (PyhlNode*) _pyhl_new_node((PyObject*) self, myArgs))) {
+    setException(PyExc_AttributeError,"Could not create node to return");
+    goto fail;
+  }
+
+  HLNode_free(retv->node);
+
+  retv->node = HLNode_copy(node);
+
+  Py_XDECREF(myArgs);
+  return (PyObject*)retv;
+fail:
+  Py_XDECREF(myArgs);
+  _dealloc_pyhlnode(retv);
+  return NULL;
+}
+
+static PyObject* _pyhl_get_node(PyhlNodelist* self, PyObject* args)
+{
+  char* nodename;
+  char errbuf[256];
+  HL_Node* node = NULL;
+  PyhlNode* retv = NULL;
+  PyObject* myArgs = NULL;
+
+  _pyhl_wait_for_fetch(self);
+
+  if (!PyArg_ParseTuple(args, "s", &nodename))
+    return NULL;
+
+
+  if (!(node = HLNodeList_getNodeWithData(self->nodelist, nodename))) {
+    sprintf(errbuf, "Could not get node '%s'", nodename);
+    setException(PyExc_IOError,errbuf);
+    goto fail;
+  }
+
+  if (!(myArgs = Py_BuildValue("(is)", HLNode_getType(node), HLNode_getName(node)))) {
+    setException(PyExc_AttributeError,"Could not create argument tuple for allocating node");
+    goto fail;
+  }
+
+  if (!(retv = (PyhlNode*) _pyhl_new_node((PyObject*) self, myArgs))) {
+    setException(PyExc_AttributeError,"Could not create node to return");
+    goto fail;
+  }
+
+  HLNode_free(retv->node);
+
+  retv->node = HLNode_copy(node);
+
+  Py_XDECREF(myArgs);
+  return (PyObject*)retv;
+fail:
+  Py_XDECREF(myArgs);
+  if(retv)
+    _dealloc_pyhlnode(retv);
+  return NULL;
+}
+
+static PyObject* _pyhl_get_memory_usage(PyhlNodelist* self, PyObject* args)
+{
+  char* nodename = NULL;
+  char errbuf[256];
+  HL_MemoryUsage usage;
+
+  _pyhl_wait_for_fetch(self);
+
+  if (!PyArg_ParseTuple(args, "|s", &nodename))
+    return NULL;
+
+  if (nodename != NULL) {
+    HL_Node* node = HLNodeList_getNodeByName(self->nodelist, nodename);
+    if (node == NULL) {
+      sprintf(errbuf, "Could not get node '%s'", nodename);
+      setException(PyExc_IOError,errbuf);
+      return NULL;
+    }
+    HLNode_getMemoryUsage(node, &usage);
+  } else {
+    HLNodeList_getMemoryUsage(self->nodelist, &usage);
+  }
+
+  return Py_BuildValue("{s:n,s:n,s:n,s:n,s:n,s:n,s:n}",
+                       "data", (Py_ssize_t)usage.data,
+                       "rawdata", (Py_ssize_t)usage.rawdata,
+                       "names", (Py_ssize_t)usage.names,
+                       "compound", (Py_ssize_t)usage.compound,
+                       "other", (Py_ssize_t)usage.other,
+                       "file", (Py_ssize_t)usage.file,
+                       "total", (Py_ssize_t)usage.total);
+}
+
+static PyObject* _pyhl_set_memory_budget(PyhlNodelist* self, PyObject* args)
+{
+  Py_ssize_t budget = 0;
+
+  _pyhl_wait_for_fetch(self);
+  if (!PyArg_ParseTuple(args, "n", &budget))
+    return NULL;
+  if (budget < 0) {
+    setException(PyExc_ValueError, "Memory budget must be >= 0");
+    return NULL;
+  }
+  HLNodeList_setMemoryBudget(self->nodelist, (size_t)budget);
+  HLNodeList_enforceMemoryBudget(self->nodelist, NULL);
+  Py_INCREF(Py_None);
+  return Py_None;
+}
+
+static PyObject* _pyhl_get_memory_budget(PyhlNodelist* self, PyObject* args)
+{
+  _pyhl_wait_for_fetch(self);
+  return PyLong_FromSize_t(HLNodeList_getMemoryBudget(self->nodelist));
+}
+
+static PyObject* _pyhl_set_evictable(PyhlNodelist* self, PyObject* args)
+{
+  char* nodename = NULL;
+  int evictable = 1;
+  char errbuf[256];
+  HL_Node* node = NULL;
+
+  _pyhl_wait_for_fetch(self);
+
+  if (!PyArg_ParseTuple(args, "s|i", &nodename, &evictable))
+    return NULL;
+
+  if (!(node = HLNodeList_getNodeByName(self->nodelist, nodename))) {
+    sprintf(errbuf, "Could not get node '%s'", nodename);
+    setException(PyExc_IOError,errbuf);
+    return NULL;
+  }
+  HLNode_setEvictable(node, evictable);
+  Py_INCREF(Py_None);
+  return Py_None;
+}
+
+static PyObject* _pyhl_write_index(PyhlNodelist* self, PyObject* args)
 {
-  char* nodename;
-  char errbuf[256];
+  char* indexfile = NULL;
 
-  if (!PyArg_ParseTuple(args, "s", &nodename))
+  _pyhl_wait_for_fetch(self);
+
+  if (!PyArg_ParseTuple(args, "|s", &indexfile))
+    return NULL;
+
+  if (!HLNodeList_writeIndex(self->nodelist, indexfile)) {
+    setException(PyExc_IOError, "Failed to write index");
     return NULL;
-  if (!HLNodeList_selectNode(self->nodelist, nodename)) {
-    sprintf(errbuf, "Could not select node '%s'", nodename);
-    setException(PyExc_AttributeError,errbuf);
-    goto fail;
   }
-  Py_INCREF(Py_None);
-  return Py_None;
-fail:
-  return NULL;
+  Py_RETURN_NONE;
 }
 
-static PyObject* _pyhl_deselect_node(PyhlNodelist* self, PyObject* args)
+static PyObject* _pyhl_iterate_chunks(PyhlNodelist* self, PyObject* args)
 {
-  char* nodename;
-  char errbuf[256];
+  char* nodename = NULL;
+  int readahead = 0;
+  PyhlChunkIterator* retv = NULL;
+  HL_ChunkIterator* iterator = NULL;
 
-  if (!PyArg_ParseTuple(args, "s", &nodename))
+  _pyhl_wait_for_fetch(self);
+
+  if (!PyArg_ParseTuple(args, "s|i", &nodename, &readahead))
+    return NULL;
+
+  if ((iterator = HLNodeList_iterateChunks(self->nodelist, nodename, readahead)) == NULL) {
+    setException(PyExc_IOError, "Failed to iterate over dataset");
     return NULL;
-  if (!HLNodeList_deselectNode(self->nodelist, nodename)) {
-    sprintf(errbuf, "Could not select node '%s'", nodename);
-    setException(PyExc_AttributeError,errbuf);
-    goto fail;
   }
-  Py_INCREF(Py_None);
-  return Py_None;
-fail:
-  return NULL;
+  if (pyarraytypeFromHdfType(HL_getFormatSpecifierString(HLChunkIterator_getFormat(iterator))) == -1) {
+    HLChunkIterator_free(iterator);
+    setException(PyExc_TypeError, "Only integer and floating point datasets can be iterated");
+    return NULL;
+  }
+  if ((retv = PyObject_NEW(PyhlChunkIterator, &PyhlChunkIterator_Type)) == NULL) {
+    HLChunkIterator_free(iterator);
+    setException(PyExc_MemoryError, "Could not create chunk iterator");
+    return NULL;
+  }
+  retv->iterator = iterator;
+  return (PyObject*)retv;
 }
 
-static PyObject* _pyhl_fetch(PyhlNodelist* self, PyObject* args)
+/**
+ * Returns the next block of a chunk iterator as a tuple of the offset and the data.
+ * @param[in] self the iterator
+ * @return the tuple or NULL when there are no more blocks or on failure
+ */
+static PyObject* _pyhl_chunk_iterator_next(PyhlChunkIterator* self)
 {
-  if (!HLNodeList_fetchMarkedNodes(self->nodelist)) {
-    setException(PyExc_IOError,"Could not fetch selected nodes");
-    goto fail;
+  npy_intp dims[H5S_MAX_RANK];
+  PyObject* offset = NULL;
+  PyObject* data = NULL;
+  int rank = HLChunkIterator_getRank(self->iterator), status, i;
+  size_t nbytes = HLChunkIterator_getDataSize(self->iterator);
+
+  status = HLChunkIterator_next(self->iterator);
+  if (status == 0) {
+    return NULL; /* StopIteration */
+  } else if (status < 0) {
+    setException(PyExc_IOError, "Failed to read block");
+    return NULL;
   }
-  Py_INCREF(Py_None);
-  return Py_None;
-fail:
-  return NULL;
+  if ((offset = PyTuple_New(rank)) == NULL) {
+    return NULL;
+  }
+  for (i = 0; i < rank; i++) {
+    dims[i] = (npy_intp)HLChunkIterator_getDimension(self->iterator, i);
+    nbytes *= (size_t)dims[i];
+    PyTuple_SET_ITEM(offset, i, PyLong_FromUnsignedLongLong(HLChunkIterator_getOffset(self->iterator, i)));
+  }
+  data = PyArray_SimpleNew(rank, dims,
+                           pyarraytypeFromHdfType(HL_getFormatSpecifierString(HLChunkIterator_getFormat(self->iterator))));
+  if (data == NULL) {
+    Py_DECREF(offset);
+    setException(PyExc_MemoryError, "Could not create array");
+    return NULL;
+  }
+  memcpy(PyArray_DATA((PyArrayObject*)data), HLChunkIterator_getData(self->iterator), nbytes);
+  return Py_BuildValue("(NN)", offset, data);
 }
 
-static PyObject* _pyhl_fetch_node(PyhlNodelist* self, PyObject* args)
+static PyObject* _pyhl_copy(PyhlNodelist* self, PyObject* args)
 {
-  char* nodename;
-  char errbuf[256];
-  HL_Node* node = NULL;
-  PyhlNode* retv = NULL;
-  PyObject* myArgs = NULL;
+  char* filename = NULL;
+  PyObject* props = NULL;
 
-  if (!PyArg_ParseTuple(args, "s", &nodename))
+  _pyhl_wait_for_fetch(self);
+
+  if (!PyArg_ParseTuple(args, "s|O", &filename, &props))
     return NULL;
 
-  if (!(node = HLNodeList_fetchNode(self->nodelist, nodename))) {
-    sprintf(errbuf, "Could not fetch node '%s'", nodename);
-    setException(PyExc_IOError,errbuf);
-    goto fail;
+  if (props != NULL && props != Py_None && !PyhlFileCreationProperty_Check(props)) {
+    setException(PyExc_AttributeError, "copy method should be called with copy(filename[,file creation property])");
+    return NULL;
   }
 
-  if (!(myArgs = Py_BuildValue("(is)", HLNode_getType(node), HLNode_getName(node)))) {
-    setException(PyExc_AttributeError,"Could not create argument tuple for allocating node");
-    goto fail;
+  if (!HLNodeList_copyMarkedNodes(self->nodelist, filename,
+                                  (props != NULL && props != Py_None) ? ((PyhlFileCreationProperty*) props)->props : NULL)) {
+    setException(PyExc_IOError, "Failed to copy nodes");
+    return NULL;
   }
+  Py_RETURN_NONE;
+}
 
-  if (!(retv = (PyhlNode*) _pyhl_new_node((PyObject*) self, myArgs))) {
-    setException(PyExc_AttributeError,"Could not create node to return");
-    goto fail;
+/**
+ * Creates an uninitialized array for a compound member column with the same
+ * dimensions as the node followed by the member dimensions.
+ * @param[in] node the node that defines the dimensions
+ * @param[in] format the format of the member
+ * @param[in] size the size of one member value in bytes
+ * @param[in] mdims the number of member dimensions
+ * @param[in] mdim the member dimensions, ignored if mdims is 0
+ * @return the array or NULL on failure
+ */
+static PyObject* _pyhl_new_column_array(HL_Node* node, const char* format, size_t size, int mdims, const size_t* mdim)
+{
+  npy_intp dims[H5S_MAX_RANK + 4];
+  int rank = HLNode_getRank(node);
+  int iformat = -1, i;
+  char errbuf[256];
+
+  for (i = 0; i < rank; i++) {
+    dims[i] = (npy_intp) HLNode_getDimension(node, i);
+  }
+  if (mdims > 4) {
+    setException(PyExc_TypeError, "Too many member dimensions");
+    return NULL;
+  }
+  if (!(mdims == 1 && mdim[0] == 1)) {
+    for (i = 0; i < mdims; i++) {
+      dims[rank++] = (npy_intp) mdim[i];
+    }
+  }
+  if (strcmp(format, "string") == 0) {
+    return PyArray_New(&PyArray_Type, rank, dims, NPY_STRING, NULL, NULL, (int)size, 0, NULL);
+  }
+  if ((iformat = pyarraytypeFromHdfType(format)) == -1) {
+    snprintf(errbuf, 256, "Unsupported member format %.200s", format);
+    setException(PyExc_TypeError, errbuf);
+    return NULL;
   }
+  return PyArray_SimpleNew(rank, dims, iformat);
+}
 
-  HLNode_free(retv->node);
+static PyObject* _pyhl_read_compound_column(PyhlNodelist* self, PyObject* args)
+{
+  char* nodename = NULL;
+  char* member = NULL;
+  char errbuf[256];
+  HL_Node* column = NULL;
+  PyObject* retv = NULL;
 
-  retv->node = HLNode_copy(node);
+  _pyhl_wait_for_fetch(self);
 
-  Py_XDECREF(myArgs);
-  return (PyObject*)retv;
-fail:
-  Py_XDECREF(myArgs);
-  _dealloc_pyhlnode(retv);
-  return NULL;
+  if (!PyArg_ParseTuple(args, "ss", &nodename, &member))
+    return NULL;
+
+  if ((column = HLNodeList_readCompoundMemberColumn(self->nodelist, nodename, member)) == NULL) {
+    snprintf(errbuf, 256, "Could not read member '%s' of '%s'", member, nodename);
+    setException(PyExc_IOError, errbuf);
+    return NULL;
+  }
+  if ((retv = _pyhl_new_column_array(column, HLNode_getFormatName(column), HLNode_getDataSize(column), 0, NULL)) != NULL) {
+    memcpy(PyArray_DATA((PyArrayObject*)retv), HLNode_getConstData(column),
+           (size_t)HLNode_getNumberOfPoints(column) * HLNode_getDataSize(column));
+  }
+  HLNode_free(column);
+  return retv;
 }
 
-static PyObject* _pyhl_get_node(PyhlNodelist* self, PyObject* args)
+/**
+ * Releases a node that is owned by a numpy array.
+ * @param[in] capsule the capsule holding the node
+ */
+static void _pyhl_release_node_capsule(PyObject* capsule)
 {
-  char* nodename;
+  HLNode_free((HL_Node*)PyCapsule_GetPointer(capsule, NULL));
+}
+
+static PyObject* _pyhl_fetch_scaled(PyhlNodelist* self, PyObject* args, PyObject* kwds)
+{
+  char* nodename = NULL;
+  char* format = "float";
   char errbuf[256];
+  PyObject *pygain = Py_None, *pyoffset = Py_None, *pynodata = Py_None, *pyundetect = Py_None;
+  double nodatavalue = NAN, undetectvalue = NAN;
+  HL_LinearScaling scaling;
+  HL_FormatSpecifier outformat = HLHDF_UNDEFINED;
   HL_Node* node = NULL;
-  PyhlNode* retv = NULL;
-  PyObject* myArgs = NULL;
+  PyObject* retv = NULL;
+  PyObject* capsule = NULL;
+  npy_intp dims[H5S_MAX_RANK];
+  int i = 0;
+  static char* kwlist[] = {"name", "format", "gain", "offset", "nodata", "undetect",
+                           "nodatavalue", "undetectvalue", NULL};
 
-  if (!PyArg_ParseTuple(args, "s", &nodename))
-    return NULL;
+  _pyhl_wait_for_fetch(self);
 
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "s|sOOOOdd", kwlist, &nodename, &format, &pygain,
+                                   &pyoffset, &pynodata, &pyundetect, &nodatavalue, &undetectvalue))
+    return NULL;
 
-  if (!(node = HLNodeList_getNodeByName(self->nodelist, nodename))) {
-    sprintf(errbuf, "Could not get node '%s'", nodename);
-    setException(PyExc_IOError,errbuf);
-    goto fail;
+  outformat = HL_getFormatSpecifier(format);
+  if (outformat != HLHDF_FLOAT && outformat != HLHDF_DOUBLE) {
+    setException(PyExc_ValueError, "format must be float or double");
+    return NULL;
+  }
+  if (!HLNodeList_getOdimScaling(self->nodelist, nodename, &scaling)) {
+    setException(PyExc_IOError, "Failed to read scaling attributes");
+    return NULL;
+  }
+  if (pygain != Py_None) {
+    scaling.gain = PyFloat_AsDouble(pygain);
   }
+  if (pyoffset != Py_None) {
+    scaling.offset = PyFloat_AsDouble(pyoffset);
+  }
+  if (pynodata != Py_None) {
+    scaling.useNodata = 1;
+    scaling.nodata = PyFloat_AsDouble(pynodata);
+  }
+  if (pyundetect != Py_None) {
+    scaling.useUndetect = 1;
+    scaling.undetect = PyFloat_AsDouble(pyundetect);
+  }
+  if (PyErr_Occurred()) {
+    return NULL;
+  }
+  scaling.nodataValue = nodatavalue;
+  scaling.undetectValue = undetectvalue;
 
-  if (!(myArgs = Py_BuildValue("(is)", HLNode_getType(node), HLNode_getName(node)))) {
-    setException(PyExc_AttributeError,"Could not create argument tuple for allocating node");
-    goto fail;
+  if ((node = HLNodeList_fetchScaledDataset(self->nodelist, nodename, &scaling, outformat)) == NULL) {
+    snprintf(errbuf, 256, "Could not fetch scaled data for '%s'", nodename);
+    setException(PyExc_IOError, errbuf);
+    return NULL;
   }
 
-  if (!(retv = (PyhlNode*) _pyhl_new_node((PyObject*) self, myArgs))) {
-    setException(PyExc_AttributeError,"Could not create node to return");
-    goto fail;
+  /* The array uses the node data directly and owns the node through a capsule */
+  for (i = 0; i < HLNode_getRank(node); i++) {
+    dims[i] = (npy_intp) HLNode_getDimension(node, i);
+  }
+  if ((capsule = PyCapsule_New(node, NULL, _pyhl_release_node_capsule)) == NULL) {
+    HLNode_free(node);
+    return NULL;
+  }
+  retv = PyArray_SimpleNewFromData(HLNode_getRank(node), dims,
+                                   (outformat == HLHDF_FLOAT) ? NPY_FLOAT : NPY_DOUBLE, HLNode_getData(node));
+  if (retv == NULL || PyArray_SetBaseObject((PyArrayObject*)retv, capsule) < 0) {
+    Py_XDECREF(retv);
+    Py_DECREF(capsule);
+    return NULL;
   }
+  return retv;
+}
 
-  HLNode_free(retv->node);
+static PyObject* _pyhl_set_statistics_options(PyhlNodelist* self, PyObject* args, PyObject* kwds)
+{
+  int enable = 1;
+  HL_StatisticsOptions options;
+  PyObject *pynodata = Py_None, *pyundetect = Py_None;
+  static char* kwlist[] = {"nbins", "histmin", "histmax", "nodata", "undetect", "enable", NULL};
 
-  retv->node = HLNode_copy(node);
+  _pyhl_wait_for_fetch(self);
 
-  Py_XDECREF(myArgs);
-  return (PyObject*)retv;
-fail:
-  Py_XDECREF(myArgs);
-  if(retv)
-    _dealloc_pyhlnode(retv);
-  return NULL;
+  HLStatisticsOptions_init(&options);
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "|iddOOi", kwlist, &options.nbins, &options.histMin,
+                                   &options.histMax, &pynodata, &pyundetect, &enable))
+    return NULL;
+  if (options.nbins < 0 || (options.nbins > 0 && options.histMax <= options.histMin)) {
+    setException(PyExc_ValueError, "nbins must be >= 0 and histmax must be larger than histmin");
+    return NULL;
+  }
+  if (pynodata != Py_None) {
+    options.useNodata = 1;
+    options.nodata = PyFloat_AsDouble(pynodata);
+  }
+  if (pyundetect != Py_None) {
+    options.useUndetect = 1;
+    options.undetect = PyFloat_AsDouble(pyundetect);
+  }
+  if (PyErr_Occurred()) {
+    return NULL;
+  }
+  if (!HLNodeList_setStatisticsOptions(self->nodelist, enable ? &options : NULL)) {
+    setException(PyExc_MemoryError, "Failed to set statistics options");
+    return NULL;
+  }
+  Py_INCREF(Py_None);
+  return Py_None;
+}
+
+static PyObject* _pyhl_add_statistics_attributes(PyhlNodelist* self, PyObject* args)
+{
+  _pyhl_wait_for_fetch(self);
+  if (!HLNodeList_addStatisticsAttributes(self->nodelist)) {
+    setException(PyExc_IOError, "Failed to add statistics attributes");
+    return NULL;
+  }
+  Py_INCREF(Py_None);
+  return Py_None;
 }
 
 /* PyhlNode member methods */
@@ -1202,23 +2147,23 @@ static PyObject* _pyhl_node_data(PyhlNode* self, PyObject* args)
     case H5T_INTEGER: {
       if (typeSize <= sizeof(char)) {
         char v;
-        memcpy(&v, HLNode_getData(self->node), typeSize);
+        memcpy(&v, HLNode_getConstData(self->node), typeSize);
         retv = PyInt_FromLong((long) v);
       } else if (typeSize <= sizeof(short)) {
         short v;
-        memcpy(&v, HLNode_getData(self->node), typeSize);
+        memcpy(&v, HLNode_getConstData(self->node), typeSize);
         retv = PyInt_FromLong((long) v);
       } else if (typeSize <= sizeof(int)) {
         int v;
-        memcpy(&v, HLNode_getData(self->node), typeSize);
+        memcpy(&v, HLNode_getConstData(self->node), typeSize);
         retv = PyInt_FromLong((long) v);
       } else if (typeSize <= sizeof(long)) {
         long v;
-        memcpy(&v, HLNode_getData(self->node), typeSize);
+        memcpy(&v, HLNode_getConstData(self->node), typeSize);
         retv = PyInt_FromLong((long) v);
       } else if (typeSize <= sizeof(long long)) {
         long long v;
-        memcpy(&v, HLNode_getData(self->node), typeSize);
+        memcpy(&v, HLNode_getConstData(self->node), typeSize);
         retv = PyLong_FromLongLong(v);
       } else {
         sprintf(errbuf, "To big type size: %ld", typeSize);
@@ -1230,11 +2175,11 @@ static PyObject* _pyhl_node_data(PyhlNode* self, PyObject* args)
     case H5T_FLOAT: {
       if (typeSize <= sizeof(float)) {
         float v;
-        memcpy(&v, HLNode_getData(self->node), typeSize);
+        memcpy(&v, HLNode_getConstData(self->node), typeSize);
         retv = PyFloat_FromDouble((double) v);
       } else if (typeSize <= sizeof(double)) {
         double v;
-        memcpy(&v, HLNode_getData(self->node), typeSize);
+        memcpy(&v, HLNode_getConstData(self->node), typeSize);
         retv = PyFloat_FromDouble(v);
       } else {
         fprintf(stderr, "Whoaa, greater float than double not supported\n");
@@ -1242,18 +2187,18 @@ static PyObject* _pyhl_node_data(PyhlNode* self, PyObject* args)
       break;
     }
     case H5T_COMPOUND: {
-      retv = PyByteArray_FromStringAndSize((char*)HLNode_getData(self->node), typeSize);
+      retv = PyByteArray_FromStringAndSize((const char*) HLNode_getConstData(self->node), typeSize);
       break;
     }
     case H5T_STRING: {
-      char* d = (char*)HLNode_getData(self->node);
+      const char* d = (const char*) HLNode_getConstData(self->node);
       if (H5Tis_variable_str(tmpHid)) { /* You can't trust typeSize when variable length. The size will always be size of pointer */
         typeSize = strlen(d);
       }
       if (d[typeSize-1] == '\0') {
-        retv = PyHlhdf_StringOrUnicode_FromASCII((char*)HLNode_getData(self->node), typeSize - 1);
+        retv = PyHlhdf_StringOrUnicode_FromASCII((const char*) HLNode_getConstData(self->node), typeSize - 1);
       } else {
-        retv = PyHlhdf_StringOrUnicode_FromASCII((char*)HLNode_getData(self->node), typeSize);
+        retv = PyHlhdf_StringOrUnicode_FromASCII((const char*) HLNode_getConstData(self->node), typeSize);
       }
       break;
     }
@@ -1289,14 +2234,14 @@ static PyObject* _pyhl_node_data(PyhlNode* self, PyObject* args)
       nbytes = (int)HLNode_getNumberOfPoints(self->node);
       nbytes *= PyArray_ITEMSIZE((PyArrayObject*)retv);
 
-      memcpy(PyArray_DATA((PyArrayObject*)retv), (unsigned char*) HLNode_getData(self->node),
+      memcpy(PyArray_DATA((PyArrayObject*)retv), HLNode_getConstData(self->node),
              nbytes);
       break;
     }
     case H5T_COMPOUND: {
       npts = (size_t)HLNode_getNumberOfPoints(self->node);
       npts *= typeSize;
-      retv = PyByteArray_FromStringAndSize((char*) HLNode_getData(self->node), npts);
+      retv = PyByteArray_FromStringAndSize((const char*) HLNode_getConstData(self->node), npts);
       break;
     }
     case H5T_STRING: {
@@ -1304,9 +2249,9 @@ static PyObject* _pyhl_node_data(PyhlNode* self, PyObject* args)
         /* Don't know how to represent a multi-dim array of strings */
         npts = (size_t)HLNode_getNumberOfPoints(self->node);
         npts *= typeSize;
-        retv = PyString_FromStringAndSize((char*) HLNode_getData(self->node), npts - 1);
+        retv = PyString_FromStringAndSize((const char*) HLNode_getConstData(self->node), npts - 1);
       } else {
-        const unsigned char* data = HLNode_getData(self->node);
+        const unsigned char* data = HLNode_getConstData(self->node);
         retv = PyList_New(0);
         for (i = 0; retv && i < HLNode_getDimension(self->node, 0); i++) {
           PyObject* pyo =
@@ -1352,7 +2297,7 @@ static PyObject* _pyhl_node_rawdata(PyhlNode* self, PyObject* args)
   int i;
   size_t npts;
 
-  if (HLNode_getRawdata(self->node) == NULL) {
+  if (HLNode_getConstRawdata(self->node) == NULL) {
     setException(PyExc_AttributeError,"Rawdata has not been read for this node");
     return NULL;
   }
@@ -1373,23 +2318,23 @@ static PyObject* _pyhl_node_rawdata(PyhlNode* self, PyObject* args)
     case H5T_INTEGER: {
       if (typeSize <= sizeof(char)) {
         char v;
-        memcpy(&v, HLNode_getRawdata(self->node), typeSize);
+        memcpy(&v, HLNode_getConstRawdata(self->node), typeSize);
         retv = PyInt_FromLong((long) v);
       } else if (typeSize <= sizeof(short)) {
         short v;
-        memcpy(&v, HLNode_getRawdata(self->node), typeSize);
+        memcpy(&v, HLNode_getConstRawdata(self->node), typeSize);
         retv = PyInt_FromLong((long) v);
       } else if (typeSize <= sizeof(int)) {
         int v;
-        memcpy(&v, HLNode_getRawdata(self->node), typeSize);
+        memcpy(&v, HLNode_getConstRawdata(self->node), typeSize);
         retv = PyInt_FromLong((long) v);
       } else if (typeSize <= sizeof(long)) {
         long v;
-        memcpy(&v, HLNode_getRawdata(self->node), typeSize);
+        memcpy(&v, HLNode_getConstRawdata(self->node), typeSize);
         retv = PyInt_FromLong((long) v);
       } else if (typeSize <= sizeof(long long)) {
         long long v;
-        memcpy(&v, HLNode_getRawdata(self->node), typeSize);
+        memcpy(&v, HLNode_getConstRawdata(self->node), typeSize);
         retv = PyLong_FromLongLong(v);
       } else {
         setException(PyExc_AttributeError,"Can't handle type size");
@@ -1400,11 +2345,11 @@ static PyObject* _pyhl_node_rawdata(PyhlNode* self, PyObject* args)
     case H5T_FLOAT: {
       if (typeSize <= sizeof(float)) {
         float v;
-        memcpy(&v, HLNode_getRawdata(self->node), typeSize);
+        memcpy(&v, HLNode_getConstRawdata(self->node), typeSize);
         retv = PyFloat_FromDouble((double) v);
       } else if (typeSize <= sizeof(double)) {
         double v;
-        memcpy(&v, HLNode_getRawdata(self->node), typeSize);
+        memcpy(&v, HLNode_getConstRawdata(self->node), typeSize);
         retv = PyFloat_FromDouble(v);
       } else {
         fprintf(stderr, "Whoaa, greater float than double not supported\n");
@@ -1412,11 +2357,11 @@ static PyObject* _pyhl_node_rawdata(PyhlNode* self, PyObject* args)
       break;
     }
     case H5T_COMPOUND: {
-      retv = PyByteArray_FromStringAndSize((char*) HLNode_getRawdata(self->node), typeSize);
+      retv = PyByteArray_FromStringAndSize((const char*) HLNode_getConstRawdata(self->node), typeSize);
       break;
     }
     case H5T_STRING: {
-      retv = PyString_FromStringAndSize((char*) HLNode_getRawdata(self->node), typeSize);
+      retv = PyString_FromStringAndSize((const char*) HLNode_getConstRawdata(self->node), typeSize);
       break;
     }
     default: {
@@ -1450,13 +2395,13 @@ static PyObject* _pyhl_node_rawdata(PyhlNode* self, PyObject* args)
       }
       nbytes = (int)HLNode_getNumberOfPoints(self->node);
       nbytes *= PyArray_ITEMSIZE((PyArrayObject*)retv);
-      memcpy(PyArray_DATA((PyArrayObject*)retv), HLNode_getRawdata(self->node), nbytes);
+      memcpy(PyArray_DATA((PyArrayObject*)retv), HLNode_getConstRawdata(self->node), nbytes);
       break;
     }
     case H5T_COMPOUND: {
       npts = (size_t)HLNode_getNumberOfPoints(self->node);;
       npts *= typeSize;
-      retv = PyByteArray_FromStringAndSize((char*) HLNode_getRawdata(self->node), npts);
+      retv = PyByteArray_FromStringAndSize((const char*) HLNode_getConstRawdata(self->node), npts);
       break;
     }
     case H5T_STRING: {
@@ -1466,9 +2411,9 @@ static PyObject* _pyhl_node_rawdata(PyhlNode* self, PyObject* args)
         for (i = 0; i < HLNode_getRank(self->node); i++)
           npts *= HLNode_getDimension(self->node,i);
         npts *= typeSize;
-        retv = PyString_FromStringAndSize((char*) HLNode_getRawdata(self->node), npts - 1);
+        retv = PyString_FromStringAndSize((const char*) HLNode_getConstRawdata(self->node), npts - 1);
       } else {
-        const unsigned char* data = HLNode_getRawdata(self->node);
+        const unsigned char* data = HLNode_getConstRawdata(self->node);
         retv = PyList_New(0);
         for (i = 0; retv && i < HLNode_getDimension(self->node, 0); i++) {
           PyObject* pyo =
@@ -1505,7 +2450,7 @@ fail:
   return NULL;
 }
 
-static PyObject* getPythonObjectFromNode(HL_CompoundTypeAttribute* descr,
+static PyObject* getPythonObjectFromNode(const HL_CompoundTypeAttribute* descr,
   const unsigned char* data, int idx)
 {
   PyObject* pyo = NULL;
@@ -1589,7 +2534,7 @@ static PyObject* _pyhl_node_get_compound_data(PyhlNode* self, PyObject* args)
   PyObject *pyo = NULL, *pyo2 = NULL;
   int i, j;
   const unsigned char* data;
-  HL_CompoundTypeDescription* descr;
+  const HL_CompoundTypeDescription* descr;
 
   if (HLNodePrivate_getTypeId(self->node) >= 0) {
     tmpHid = H5Tcopy(HLNodePrivate_getTypeId(self->node));
@@ -1606,7 +2551,7 @@ static PyObject* _pyhl_node_get_compound_data(PyhlNode* self, PyObject* args)
   }
 
   if (HLNode_getRank(self->node) == 0 || (HLNode_getRank(self->node) == 1 && HLNode_getDimension(self->node,0) == 1)) { /*Scalar*/
-    if (!HLNode_getCompoundDescription(self->node)) {
+    if (!HLNode_getConstCompoundDescription(self->node)) {
       setException(PyExc_AttributeError,"Node does not have a compound description");
       goto fail;
     }
@@ -1614,8 +2559,8 @@ static PyObject* _pyhl_node_get_compound_data(PyhlNode* self, PyObject* args)
       setException(PyExc_MemoryError,"Could not allocate dicionary\n");
       goto fail;
     }
-    data = HLNode_getData(self->node);
-    descr = HLNode_getCompoundDescription(self->node);
+    data = HLNode_getConstData(self->node);
+    descr = HLNode_getConstCompoundDescription(self->node);
     for (i = 0; i < descr->nAttrs; i++) {
       pyo = NULL;
       if (descr->attrs[i]->ndims == 0 || (descr->attrs[i]->ndims == 1 && descr->attrs[i]->dims[0] == 1)) {
@@ -1662,6 +2607,61 @@ fail:
   return NULL;
 }
 
+static PyObject* _pyhl_node_get_compound_column(PyhlNode* self, PyObject* args)
+{
+  char* member = NULL;
+  char errbuf[256];
+  const HL_CompoundTypeAttribute* attr = NULL;
+  PyObject* retv = NULL;
+
+  if (!PyArg_ParseTuple(args, "s", &member))
+    return NULL;
+
+  if ((attr = findHL_CompoundTypeAttribute(HLNode_getConstCompoundDescription(self->node), member)) == NULL) {
+    snprintf(errbuf, 256, "Node does not have a compound member '%s'", member);
+    setException(PyExc_AttributeError, errbuf);
+    return NULL;
+  }
+  if ((retv = _pyhl_new_column_array(self->node, attr->format, attr->size, attr->ndims, attr->dims)) == NULL) {
+    return NULL;
+  }
+  if (!HLNode_getCompoundMemberColumn(self->node, member, PyArray_DATA((PyArrayObject*)retv))) {
+    setException(PyExc_AttributeError, "Could not extract compound member");
+    Py_DECREF(retv);
+    return NULL;
+  }
+  return retv;
+}
+
+static PyObject* _pyhl_node_statistics(PyhlNode* self, PyObject* args)
+{
+  const HL_Statistics* stats = HLNode_getStatistics(self->node);
+  PyObject* histogram = NULL;
+  PyObject* retv = NULL;
+  int i = 0;
+
+  if (stats == NULL) {
+    Py_INCREF(Py_None);
+    return Py_None;
+  }
+  if ((histogram = PyList_New(stats->nbins)) == NULL) {
+    return NULL;
+  }
+  for (i = 0; i < stats->nbins; i++) {
+    PyList_SET_ITEM(histogram, i, PyLong_FromSize_t(stats->histogram[i]));
+  }
+  retv = Py_BuildValue("{s:n,s:n,s:n,s:d,s:d,s:d,s:O}",
+                       "count", (Py_ssize_t)stats->count,
+                       "nodata_count", (Py_ssize_t)stats->nodataCount,
+                       "undetect_count", (Py_ssize_t)stats->undetectCount,
+                       "min", stats->min,
+                       "max", stats->max,
+                       "mean", stats->mean,
+                       "histogram", histogram);
+  Py_DECREF(histogram);
+  return retv;
+}
+
 static PyObject* _pyhl_node_get_compound_type(PyhlNode* self, PyObject* args)
 {
   PyObject* retv = NULL;
@@ -1673,11 +2673,11 @@ static PyObject* _pyhl_node_get_compound_type(PyhlNode* self, PyObject* args)
   }
 
   if (H5Tcommitted(HLNodePrivate_getTypeId(self->node)) > 0) {
-    if (HLNode_getCompoundDescription(self->node) == NULL) {
+    if (HLNode_getConstCompoundDescription(self->node) == NULL) {
       setException(PyExc_AttributeError,"Node does not have a compound description");
       goto fail;
     }
-    retv = PyString_FromString(HLNode_getCompoundDescription(self->node)->hltypename);
+    retv = PyString_FromString(HLNode_getConstCompoundDescription(self->node)->hltypename);
   } else {
     Py_INCREF(Py_None);
     retv = Py_None; // So that we can return retv
@@ -1705,6 +2705,15 @@ Parameters:
 Returns:
   N/A.
 
+Function: writeAsync(filename, compression=None)
+  Writes the file like write() but on a background thread. The nodes are handed over to
+  the write and the nodelist is empty afterwards.
+Parameters:
+  filename - the full path of the HDF5 file to be written
+  compression - Optional compression object
+Returns:
+  A write handle.
+
 Function: update(compression=None)
 Parameters:
   compression - Optional compression object
@@ -1720,41 +2729,158 @@ Function: selectAll()
 Returns:
   N/A.
 
-Function: selectMetadata()
-  Marks all nodes (except the actual dataset) for data reading when executing fetch()
+Function: selectMetadata()
+  Marks all nodes (except the actual dataset) for data reading when executing fetch()
+Returns:
+  N/A.
+
+Function: HLNodeList_selectNode(name)
+  Marks the specified node for retrival when executing fetch
+Parameters:
+  name - the node that should be marked for retrival
+Returns:
+  N/A.
+
+Function: HLNodeList_deselectNode(name)
+  Unmarks the specified node so that it is not read when executing fetch.
+Parameters:
+  name - the node that should be deselected
+Returns:
+  N/A.
+
+Function: fetch()
+  Reads the data for all nodes that has been marked for selection.
+Returns:
+  N/A.
+
+Function: HLNodeList_fetchNode()
+  Reads the data for the specified node and returns it.
+Returns:
+  The read node.
+
+Function: getNode(name)
+  Reads the data for the specified node and returns it.
+Parameters:
+  name - the node that should be returned. Note, that if node not has been fetched it will not contain any data.
+         If the data has been evicted due to the memory budget it will be fetched again.
+Returns:
+  The read node.
+
+Function: getMemoryUsage(name=None)
+  Returns the memory held by the nodelist or by the specified node.
+Parameters:
+  name - Optional node name, if not specified the usage for the whole nodelist is returned.
+Returns:
+  A dictionary with the keys data, rawdata, names, compound, other, file and total. All values
+  are in bytes. file is the size of a file image kept in memory, see set_whole_file_read_limit().
+
+Function: setMemoryBudget(budget)
+  Sets the max number of bytes the nodelist should hold. When exceeded, the data of fetched
+  dataset nodes that are evictable will be released until the nodelist fits within the budget.
+Parameters:
+  budget - the budget in bytes, 0 means no limit.
+Returns:
+  N/A.
+
+Function: getMemoryBudget()
+Returns:
+  The memory budget in bytes, 0 means no limit.
+
+Function: setEvictable(name, evictable=1)
+  Sets if the data for the specified node may be released when the memory budget is exceeded.
+Parameters:
+  name - the name of the node
+  evictable - 1 if the data may be released, otherwise 0
+Returns:
+  N/A.
+
+Function: open()
+  Keeps the file open so that fetch(), fetchNode(), readCompoundColumn() and fetchScaled()
+  does not have to open and close it each time. The file is closed by close(), write(),
+  update() or when the nodelist is released. The nodelist can also be used as a context
+  manager, "with _pyhl.read_nodelist(filename) as a:", that opens and closes the file.
+Returns:
+  N/A.
+
+Function: close()
+  Closes the file opened by open(). Also releases a file image kept in memory, see
+  set_whole_file_read_limit().
 Returns:
   N/A.
 
-Function: HLNodeList_selectNode(name)
-  Marks the specified node for retrival when executing fetch
+Function: fetchAsync()
+  Fetches the selected nodes like fetch() but the data is read on a background thread.
+  Until the fetch has completed, every nodelist method blocks until it has, so use the
+  fetch handle below to wait for single nodes. The memory budget is enforced as the
+  nodes are filled.
+Returns:
+  A fetch handle.
+
+Function: writeIndex(indexfile=None)
+  Writes an index with the structure of the file that this nodelist was read from.
+  Dimensions and formats of fetched nodes are included.
 Parameters:
-  name - the node that should be marked for retrival
+  indexfile - the index file, default is the filename + ".hlidx"
 Returns:
   N/A.
 
-Function: HLNodeList_deselectNode(name)
-  Unmarks the specified node so that it is not read when executing fetch.
+Function: copy(filename, fcp=None)
+  Copies the selected nodes into a new file. Chunked datasets are copied as they are
+  stored without being decompressed and keep their chunking and compression. Groups needed
+  by the selected nodes are created. Datasets only selected for metadata are created empty.
 Parameters:
-  name - the node that should be deselected
+  filename - the file to create
+  fcp - Optional file creation property
 Returns:
   N/A.
 
-Function: fetch()
-  Reads the data for all nodes that has been marked for selection.
+Function: iterateChunks(name, readahead=0)
+  Iterates over an integer or floating point dataset a block at a time without reading
+  the whole dataset. Chunked datasets are iterated chunk by chunk, other datasets in blocks
+  of whole rows.
+Parameters:
+  name - the name of the dataset
+  readahead - 1 if the next block should be read on a background thread
 Returns:
-  N/A.
+  An iterator yielding a tuple (offset, data) for each block where offset is the position of
+  the block in the dataset and data an array with the values of the block.
 
-Function: HLNodeList_fetchNode()
-  Reads the data for the specified node and returns it.
+Function: readCompoundColumn(name, member)
+  Reads one member of a compound dataset directly from the file. The other members
+  are not read and the nodelist is not modified.
+Parameters:
+  name - the name of the compound dataset
+  member - the name of the member
 Returns:
-  The read node.
+  A numpy array with the same dimensions as the dataset.
+
+Function: fetchScaled(name, format="float", gain=None, offset=None, nodata=None, undetect=None,
+                      nodatavalue=nan, undetectvalue=nan)
+  Reads a dataset and converts it to physical values, offset + gain * value, in one pass
+  without reading the stored data into the nodelist. The scaling is taken from the ODIM
+  what attributes of the dataset and its ancestors, any scaling argument that is given
+  overrides the attribute. Values equal to nodata or undetect are set to nodatavalue and
+  undetectvalue.
+Parameters:
+  name - the name of the dataset
+  format - "float" or "double"
+Returns:
+  A numpy array with the same dimensions as the dataset.
 
-Function: getNode(name)
-  Reads the data for the specified node and returns it.
+Function: setStatisticsOptions(nbins=0, histmin=0.0, histmax=0.0, nodata=None, undetect=None, enable=1)
+  Computes statistics for all datasets in the nodelist while they are fetched, see
+  node.statistics(). Values equal to nodata or undetect are counted separately.
 Parameters:
-  name - the node that should be returned. Note, that if node not has been fetched it will not contain any data.
+  nbins - number of histogram bins between histmin and histmax, 0 for no histogram
+  enable - 0 turns statistics off
 Returns:
-  The read node.
+  N/A.
+
+Function: addStatisticsAttributes()
+  Adds the statistics of fetched datasets as the attributes stat_count, stat_min, stat_max,
+  stat_mean and stat_histogram of each dataset so that they are stored by the next write.
+Returns:
+  N/A.
 
 \endverbatim
 */
@@ -1762,6 +2888,7 @@ static struct PyMethodDef methods[] =
 {
   { "addNode", (PyCFunction) _pyhl_add_node, 1 },
   { "write", (PyCFunction) _pyhl_write, 1 },
+  { "writeAsync", (PyCFunction) _pyhl_write_async, 1 },
   { "update", (PyCFunction) _pyhl_update, 1 },
   { "getNodeNames", (PyCFunction) _pyhl_get_node_names, 1 },
   { "selectAll", (PyCFunction) _pyhl_select_all, 1 },
@@ -1770,9 +2897,25 @@ static struct PyMethodDef methods[] =
   { "selectOnlyDatasets", (PyCFunction) _pyhl_select_only_datasets, 1 },
   { "selectNode", (PyCFunction) _pyhl_select_node, 1 },
   { "deselectNode", (PyCFunction) _pyhl_deselect_node, 1 },
+  { "open", (PyCFunction) _pyhl_open, 1 },
+  { "close", (PyCFunction) _pyhl_close, 1 },
+  { "__enter__", (PyCFunction) _pyhl_enter, 1 },
+  { "__exit__", (PyCFunction) _pyhl_exit, 1 },
   { "fetch", (PyCFunction) _pyhl_fetch, 1 },
+  { "fetchAsync", (PyCFunction) _pyhl_fetch_async, 1 },
   { "fetchNode", (PyCFunction) _pyhl_fetch_node, 1 },
   { "getNode", (PyCFunction) _pyhl_get_node, 1 },
+  { "getMemoryUsage", (PyCFunction) _pyhl_get_memory_usage, 1 },
+  { "setMemoryBudget", (PyCFunction) _pyhl_set_memory_budget, 1 },
+  { "getMemoryBudget", (PyCFunction) _pyhl_get_memory_budget, 1 },
+  { "setEvictable", (PyCFunction) _pyhl_set_evictable, 1 },
+  { "writeIndex", (PyCFunction) _pyhl_write_index, 1 },
+  { "copy", (PyCFunction) _pyhl_copy, 1 },
+  { "iterateChunks", (PyCFunction) _pyhl_iterate_chunks, 1 },
+  { "readCompoundColumn", (PyCFunction) _pyhl_read_compound_column, 1 },
+  { "fetchScaled", (PyCFunction) _pyhl_fetch_scaled, METH_VARARGS|METH_KEYWORDS },
+  { "setStatisticsOptions", (PyCFunction) _pyhl_set_statistics_options, METH_VARARGS|METH_KEYWORDS },
+  { "addStatisticsAttributes", (PyCFunction) _pyhl_add_statistics_attributes, 1 },
   { NULL, NULL } /* sentinel */
 };
 
@@ -1859,6 +3002,20 @@ Function: compound_data()
 Returns:
   the compound data as a dictionary
 
+Function: compound_column(member)
+  Returns one member of every value in a fetched compound node. Works for both
+  scalar and array compound nodes.
+Parameters:
+  member - the name of the member
+Returns:
+  A numpy array with the same dimensions as the node.
+
+Function: statistics()
+  Returns the statistics computed when the dataset was fetched.
+Returns:
+  A dictionary with count, nodata_count, undetect_count, min, max, mean and histogram
+  or None if no statistics has been computed.
+
 \endverbatim
  */
 static struct PyMethodDef node_methods[] =
@@ -1875,7 +3032,57 @@ static struct PyMethodDef node_methods[] =
   { "data", (PyCFunction) _pyhl_node_data, 1 },
   { "rawdata", (PyCFunction) _pyhl_node_rawdata, 1 },
   { "compound_data", (PyCFunction) _pyhl_node_get_compound_data, 1 },
+  { "compound_column", (PyCFunction) _pyhl_node_get_compound_column, 1 },
   { "compound_type", (PyCFunction) _pyhl_node_get_compound_type, 1 },
+  { "statistics", (PyCFunction) _pyhl_node_statistics, 1 },
+  { NULL, NULL } /* sentinel */
+};
+
+/**
+ * @addtogroup pyhl_api
+ * \section _pyhl_fetchhandle_interfaces _pyhl fetch handle interfaces
+ * Returned by nodelist.fetchAsync().
+\verbatim
+Function: poll()
+Returns:
+  A tuple (completed, total) with the number of nodes that have been fetched so far and
+  the number of nodes being fetched.
+
+Function: wait(name=None)
+  Waits until the node called name, or all nodes if name is None, has been fetched.
+  Raises IOError if the fetch failed.
+Returns:
+  N/A.
+
+\endverbatim
+ */
+/**
+ * @addtogroup pyhl_api
+ * \section _pyhl_writehandle_interfaces _pyhl write handle interfaces
+ * Returned by nodelist.writeAsync().
+\verbatim
+Function: done()
+Returns:
+  True if the write has finished.
+
+Function: wait()
+  Waits until the file has been written. Raises IOError if the write failed.
+Returns:
+  N/A.
+
+\endverbatim
+ */
+static struct PyMethodDef writehandle_methods[] =
+{
+  { "done", (PyCFunction) _pyhl_write_handle_done, 1 },
+  { "wait", (PyCFunction) _pyhl_write_handle_wait, 1 },
+  { NULL, NULL } /* sentinel */
+};
+
+static struct PyMethodDef fetchhandle_methods[] =
+{
+  { "poll", (PyCFunction) _pyhl_fetch_handle_poll, 1 },
+  { "wait", (PyCFunction) _pyhl_fetch_handle_wait, 1 },
   { NULL, NULL } /* sentinel */
 };
 
@@ -1896,6 +3103,14 @@ static struct PyMethodDef node_methods[] =
  * \li <b>meta_block_size</b>: This is actually a file access property but have been inserted
  * here anyway, If the value is set to 2048, then the default file access property will
  * be used. For more information about meta_block_size, see the hdf5 documentation.
+ * \li <b>fs_strategy</b>: How free space is handled, one of FSPACE_STRATEGY_DEFAULT,
+ * FSPACE_STRATEGY_FSM_AGGR, FSPACE_STRATEGY_PAGE, FSPACE_STRATEGY_AGGR or FSPACE_STRATEGY_NONE.
+ * With FSPACE_STRATEGY_PAGE the metadata is aggregated into pages that readers can fetch
+ * with one I/O each, see set_page_buffer_size.
+ * \li <b>fs_persist</b>: 1 if free space should be tracked across file close.
+ * \li <b>fs_page_size</b>: The page size used with FSPACE_STRATEGY_PAGE, 0 for the hdf5 default.
+ * \li <b>page_buffer_size</b>: Size of the page buffer used while writing, requires
+ * FSPACE_STRATEGY_PAGE. 0 means no page buffer.
  */
 static struct PyMemberDef filecreationproperty_members[] =
 {
@@ -1905,6 +3120,10 @@ static struct PyMemberDef filecreationproperty_members[] =
   { "sym_k", 0 },
   { "istore_k", 0 },
   { "meta_block_size", 0 },
+  { "fs_strategy", 0 },
+  { "fs_persist", 0 },
+  { "fs_page_size", 0 },
+  { "page_buffer_size", 0 },
   { NULL, 0 }
 };
 
@@ -1989,6 +3208,14 @@ static PyObject* _getattr_filecreationpropertyo(PyhlFileCreationProperty* self,
     return PyInt_FromLong(self->props->istore_k);
   } else if (PY_COMPARE_ATTRO_NAME_WITH_STRING(name, "meta_block_size") == 0) {
     return PyInt_FromLong(self->props->meta_block_size);
+  } else if (PY_COMPARE_ATTRO_NAME_WITH_STRING(name, "fs_strategy") == 0) {
+    return PyInt_FromLong(self->props->fs_strategy);
+  } else if (PY_COMPARE_ATTRO_NAME_WITH_STRING(name, "fs_persist") == 0) {
+    return PyInt_FromLong(self->props->fs_persist);
+  } else if (PY_COMPARE_ATTRO_NAME_WITH_STRING(name, "fs_page_size") == 0) {
+    return PyLong_FromUnsignedLongLong(self->props->fs_page_size);
+  } else if (PY_COMPARE_ATTRO_NAME_WITH_STRING(name, "page_buffer_size") == 0) {
+    return PyLong_FromUnsignedLongLong(self->props->page_buffer_size);
   }
   return PyObject_GenericGetAttr((PyObject*)self, name);
 }
@@ -2057,6 +3284,23 @@ static int _setattr_filecreationpropertyo(PyhlFileCreationProperty* self,
   } else if (PY_COMPARE_ATTRO_NAME_WITH_STRING(name, "meta_block_size") == 0) {
     self->props->meta_block_size = PyInt_AsLong(val);
     return 0;
+  } else if (PY_COMPARE_ATTRO_NAME_WITH_STRING(name, "fs_strategy") == 0) {
+    long strategy = PyInt_AsLong(val);
+    if (strategy < HL_FSPACE_DEFAULT || strategy > HL_FSPACE_NONE) {
+      setException(PyExc_AttributeError,"fs_strategy should be one of the FSPACE_STRATEGY_ constants\n");
+      return -1;
+    }
+    self->props->fs_strategy = (HL_FileSpaceStrategy)strategy;
+    return 0;
+  } else if (PY_COMPARE_ATTRO_NAME_WITH_STRING(name, "fs_persist") == 0) {
+    self->props->fs_persist = PyInt_AsLong(val);
+    return 0;
+  } else if (PY_COMPARE_ATTRO_NAME_WITH_STRING(name, "fs_page_size") == 0) {
+    self->props->fs_page_size = PyInt_AsLong(val);
+    return 0;
+  } else if (PY_COMPARE_ATTRO_NAME_WITH_STRING(name, "page_buffer_size") == 0) {
+    self->props->page_buffer_size = PyInt_AsLong(val);
+    return 0;
   }
 
   sprintf(errmsg,
@@ -2346,6 +3590,141 @@ static PyTypeObject PyhlCompression_Type =
   0,                            /*tp_is_gc*/
 };
 
+static PyTypeObject PyhlChunkIterator_Type =
+{
+  PyVarObject_HEAD_INIT(NULL, 0) /*ob_size*/
+  "PyhlChunkIterator", /*tp_name*/
+  sizeof(PyhlChunkIterator), /*tp_size*/
+  0, /*tp_itemsize*/
+  /* methods */
+  (destructor)_dealloc_pyhlchunkiterator,/*tp_dealloc*/
+  0, /*tp_print*/
+  (getattrfunc)0,               /*tp_getattr*/
+  (setattrfunc)0,               /*tp_setattr*/
+  0,                            /*tp_compare*/
+  0,                            /*tp_repr*/
+  0,                            /*tp_as_number */
+  0,
+  0,                            /*tp_as_mapping */
+  0,                            /*tp_hash*/
+  (ternaryfunc)0,               /*tp_call*/
+  (reprfunc)0,                  /*tp_str*/
+  (getattrofunc)0,              /*tp_getattro*/
+  (setattrofunc)0,              /*tp_setattro*/
+  0,                            /*tp_as_buffer*/
+  Py_TPFLAGS_DEFAULT,           /*tp_flags*/
+  0,                            /*tp_doc*/
+  (traverseproc)0,              /*tp_traverse*/
+  (inquiry)0,                   /*tp_clear*/
+  0,                            /*tp_richcompare*/
+  0,                            /*tp_weaklistoffset*/
+  PyObject_SelfIter,            /*tp_iter*/
+  (iternextfunc)_pyhl_chunk_iterator_next, /*tp_iternext*/
+  0,                            /*tp_methods*/
+  0,                            /*tp_members*/
+  0,                            /*tp_getset*/
+  0,                            /*tp_base*/
+  0,                            /*tp_dict*/
+  0,                            /*tp_descr_get*/
+  0,                            /*tp_descr_set*/
+  0,                            /*tp_dictoffset*/
+  0,                            /*tp_init*/
+  0,                            /*tp_alloc*/
+  0,                            /*tp_new*/
+  0,                            /*tp_free*/
+  0,                            /*tp_is_gc*/
+};
+
+static PyTypeObject PyhlFetchHandle_Type =
+{
+  PyVarObject_HEAD_INIT(NULL, 0) /*ob_size*/
+  "PyhlFetchHandle", /*tp_name*/
+  sizeof(PyhlFetchHandle), /*tp_size*/
+  0, /*tp_itemsize*/
+  /* methods */
+  (destructor)_dealloc_pyhlfetchhandle,/*tp_dealloc*/
+  0, /*tp_print*/
+  (getattrfunc)0,               /*tp_getattr*/
+  (setattrfunc)0,               /*tp_setattr*/
+  0,                            /*tp_compare*/
+  0,                            /*tp_repr*/
+  0,                            /*tp_as_number */
+  0,
+  0,                            /*tp_as_mapping */
+  0,                            /*tp_hash*/
+  (ternaryfunc)0,               /*tp_call*/
+  (reprfunc)0,                  /*tp_str*/
+  (getattrofunc)0,              /*tp_getattro*/
+  (setattrofunc)0,              /*tp_setattro*/
+  0,                            /*tp_as_buffer*/
+  Py_TPFLAGS_DEFAULT,           /*tp_flags*/
+  0,                            /*tp_doc*/
+  (traverseproc)0,              /*tp_traverse*/
+  (inquiry)0,                   /*tp_clear*/
+  0,                            /*tp_richcompare*/
+  0,                            /*tp_weaklistoffset*/
+  0,                            /*tp_iter*/
+  0,                            /*tp_iternext*/
+  fetchhandle_methods,          /*tp_methods*/
+  0,                            /*tp_members*/
+  0,                            /*tp_getset*/
+  0,                            /*tp_base*/
+  0,                            /*tp_dict*/
+  0,                            /*tp_descr_get*/
+  0,                            /*tp_descr_set*/
+  0,                            /*tp_dictoffset*/
+  0,                            /*tp_init*/
+  0,                            /*tp_alloc*/
+  0,                            /*tp_new*/
+  0,                            /*tp_free*/
+  0,                            /*tp_is_gc*/
+};
+
+static PyTypeObject PyhlWriteHandle_Type =
+{
+  PyVarObject_HEAD_INIT(NULL, 0) /*ob_size*/
+  "PyhlWriteHandle", /*tp_name*/
+  sizeof(PyhlWriteHandle), /*tp_size*/
+  0, /*tp_itemsize*/
+  /* methods */
+  (destructor)_dealloc_pyhlwritehandle,/*tp_dealloc*/
+  0, /*tp_print*/
+  (getattrfunc)0,               /*tp_getattr*/
+  (setattrfunc)0,               /*tp_setattr*/
+  0,                            /*tp_compare*/
+  0,                            /*tp_repr*/
+  0,                            /*tp_as_number */
+  0,
+  0,                            /*tp_as_mapping */
+  0,                            /*tp_hash*/
+  (ternaryfunc)0,               /*tp_call*/
+  (reprfunc)0,                  /*tp_str*/
+  (getattrofunc)0,              /*tp_getattro*/
+  (setattrofunc)0,              /*tp_setattro*/
+  0,                            /*tp_as_buffer*/
+  Py_TPFLAGS_DEFAULT,           /*tp_flags*/
+  0,                            /*tp_doc*/
+  (traverseproc)0,              /*tp_traverse*/
+  (inquiry)0,                   /*tp_clear*/
+  0,                            /*tp_richcompare*/
+  0,                            /*tp_weaklistoffset*/
+  0,                            /*tp_iter*/
+  0,                            /*tp_iternext*/
+  writehandle_methods,         /*tp_methods*/
+  0,                            /*tp_members*/
+  0,                            /*tp_getset*/
+  0,                            /*tp_base*/
+  0,                            /*tp_dict*/
+  0,                            /*tp_descr_get*/
+  0,                            /*tp_descr_set*/
+  0,                            /*tp_dictoffset*/
+  0,                            /*tp_init*/
+  0,                            /*tp_alloc*/
+  0,                            /*tp_new*/
+  0,                            /*tp_free*/
+  0,                            /*tp_is_gc*/
+};
+
 /**
  * @addtogroup pyhl_api
  * \section _pyhl_interfaces _pyhl interfaces
@@ -2371,10 +3750,20 @@ Function: compression()
 Returns:
   a new instance of the "compression" class.
 
-Function: read_nodelist(filename, frompath=".")
+Function: read_nodelist(filename, frompath=".", patterns=None)
 Reads the hdf5 file named filename. If frompath is specified
 the node structure is read from that path and downwards in the
-hierarchy.
+hierarchy. If patterns is specified, only nodes matching the
+include and exclude glob patterns are read, e.g.
+["/dataset1", "!/dataset1/how"]. See HLNodeList_readFromFiltered.
+Returns:
+  the read nodelist.
+
+Function: read_nodelist_with_metadata(filename)
+Reads the hdf5 file named filename and fills all attributes with
+their values and all datasets with dimensions, type and format
+while traversing the file. Same as read_nodelist followed by
+selectAllMetadata and fetch but faster.
 Returns:
   the read nodelist.
 
@@ -2393,6 +3782,120 @@ Returns:
 Function: show_hlhdferrors(enable)
 Turns HL-HDF error reporting on or off. If enable == 1, then
 HL-HDF error reporting is turned on (in debugging mode). Otherwise it is turned off.
+Returns:
+  N/A.
+
+Function: set_data_cache_limit(limit)
+Sets the max number of bytes the process wide cache of fetched dataset and attribute
+data may hold. Nodelists fetching the same node from the same unmodified file will
+share the cached data. 0 disables the cache (default).
+Returns:
+  N/A.
+
+Function: get_data_cache_limit()
+Returns:
+  the max number of bytes the data cache may hold.
+
+Function: get_data_cache_usage()
+Returns:
+  the number of bytes currently held by the data cache.
+
+Function: get_data_cache_statistics()
+Returns:
+  a tuple (hits, misses) with the number of lookups in the data cache.
+
+Function: clear_data_cache()
+Removes all entries from the data cache and resets the statistics.
+Returns:
+  N/A.
+
+Function: set_index_mode(mode)
+Sets if the structure of read files should be indexed so that an unmodified file
+is not traversed again, INDEX_NONE (default), INDEX_MEMORY or INDEX_SIDECAR. In
+INDEX_SIDECAR mode the index is also stored in filename + ".hlidx".
+Returns:
+  N/A.
+
+Function: get_index_mode()
+Returns:
+  the index mode.
+
+Function: get_index_statistics()
+Returns:
+  a tuple (hits, misses) with the number of reads served from an index.
+
+Function: clear_index_cache()
+Removes all indexes kept in memory and resets the statistics.
+Returns:
+  N/A.
+
+Function: set_memory_mapped_reads(enable)
+Sets if uncompressed contiguous datasets should be memory mapped instead of read,
+so that the data is not copied and the pages are shared with other readers of the
+same file. A file must not be rewritten while nodes mapping it are alive.
+Disabled by default.
+Returns:
+  N/A.
+
+Function: get_memory_mapped_reads()
+Returns:
+  1 if memory mapped reads are enabled, otherwise 0.
+
+Function: set_whole_file_read_limit(limit)
+Files of at most limit bytes are read into memory with one sequential read when
+a nodelist is read, and the nodelist keeps the file open so that later fetches
+are served from memory. 0 disables (default).
+Returns:
+  N/A.
+
+Function: get_whole_file_read_limit()
+Returns:
+  The max size of files that are read into memory, 0 if disabled.
+
+Function: set_page_buffer_size(size)
+Sets the size of the page buffer used when files are opened for reading. Only files
+written with fs_strategy FSPACE_STRATEGY_PAGE are page buffered. 0 disables (default).
+Returns:
+  N/A.
+
+Function: get_page_buffer_size()
+Returns:
+  The size of the page buffer used when reading, 0 if disabled.
+
+Function: get_stats()
+Returns:
+  a dictionary with the operation counters and phase timings collected since
+  start or the last reset_stats(). The keys are files_opened, objects_opened,
+  attributes_read, datasets_read, attributes_written, datasets_written,
+  bytes_read, raw_bytes_read, bytes_written, raw_bytes_written, bytes_mapped, allocations and
+  traverse_time, fetch_time, convert_time, write_time in seconds. The raw bytes
+  are the bytes as stored in the file, i.e. after compression.
+
+Function: reset_stats()
+Sets all operation counters and phase timings to 0.
+Returns:
+  N/A.
+
+Function: start_trace(filename)
+Starts writing file opening, traversal, fetching and writing of datasets as spans
+in the Chrome trace event format to filename. Tracing is also started when the
+environment variable HLHDF_TRACE is set to a filename.
+Returns:
+  N/A.
+
+Function: stop_trace()
+Stops and completes the trace file.
+Returns:
+  N/A.
+
+Function: start_async_logging([nslots])
+Writes the HLHDF printouts to stderr from a background thread through a buffer
+holding nslots messages (default 4096). Messages are dropped if the buffer is full.
+Returns:
+  N/A.
+
+Function: stop_async_logging()
+Writes the buffered messages and stops the background thread.
 Returns:
   N/A.
 \endverbatim
@@ -2404,10 +3907,32 @@ static PyMethodDef functions[] = {
   {"filecreationproperty",(PyCFunction)_pyhl_new_filecreationproperty,1},
   {"compression",(PyCFunction)_pyhl_new_compression,1},
   {"read_nodelist",(PyCFunction)_pyhl_read_nodelist,1},
+  {"read_nodelist_with_metadata",(PyCFunction)_pyhl_read_nodelist_with_metadata,1},
   {"is_file_hdf5",(PyCFunction)_pyhl_is_file_hdf5,1},
   {"show_hdf5errors",(PyCFunction)_pyhl_show_hdf5errors,1},
   {"show_hlhdferrors",(PyCFunction)_pyhl_show_hlhdferrors,1},
   {"get_hdf5version", (PyCFunction)_pyhl_get_hdf5version,1},
+  {"set_data_cache_limit", (PyCFunction)_pyhl_set_data_cache_limit,1},
+  {"get_data_cache_limit", (PyCFunction)_pyhl_get_data_cache_limit,1},
+  {"get_data_cache_usage", (PyCFunction)_pyhl_get_data_cache_usage,1},
+  {"get_data_cache_statistics", (PyCFunction)_pyhl_get_data_cache_statistics,1},
+  {"clear_data_cache", (PyCFunction)_pyhl_clear_data_cache,1},
+  {"set_index_mode", (PyCFunction)_pyhl_set_index_mode,1},
+  {"get_index_mode", (PyCFunction)_pyhl_get_index_mode,1},
+  {"get_index_statistics", (PyCFunction)_pyhl_get_index_statistics,1},
+  {"clear_index_cache", (PyCFunction)_pyhl_clear_index_cache,1},
+  {"set_memory_mapped_reads", (PyCFunction)_pyhl_set_memory_mapped_reads,1},
+  {"get_memory_mapped_reads", (PyCFunction)_pyhl_get_memory_mapped_reads,1},
+  {"set_whole_file_read_limit", (PyCFunction)_pyhl_set_whole_file_read_limit,1},
+  {"get_whole_file_read_limit", (PyCFunction)_pyhl_get_whole_file_read_limit,1},
+  {"set_page_buffer_size", (PyCFunction)_pyhl_set_page_buffer_size,1},
+  {"get_page_buffer_size", (PyCFunction)_pyhl_get_page_buffer_size,1},
+  {"get_stats", (PyCFunction)_pyhl_get_stats,1},
+  {"reset_stats", (PyCFunction)_pyhl_reset_stats,1},
+  {"start_trace", (PyCFunction)_pyhl_start_trace,1},
+  {"stop_trace", (PyCFunction)_pyhl_stop_trace,1},
+  {"start_async_logging", (PyCFunction)_pyhl_start_async_logging,1},
+  {"stop_async_logging", (PyCFunction)_pyhl_stop_async_logging,1},
   {NULL,NULL} /*Sentinel*/
 };
 
@@ -2423,11 +3948,17 @@ MOD_INIT(_pyhl)
   MOD_INIT_SETUP_TYPE(PyhlNode_Type, &PyType_Type);
   MOD_INIT_SETUP_TYPE(PyhlFileCreationProperty_Type, &PyType_Type);
   MOD_INIT_SETUP_TYPE(PyhlCompression_Type, &PyType_Type);
+  MOD_INIT_SETUP_TYPE(PyhlChunkIterator_Type, &PyType_Type);
+  MOD_INIT_SETUP_TYPE(PyhlFetchHandle_Type, &PyType_Type);
+  MOD_INIT_SETUP_TYPE(PyhlWriteHandle_Type, &PyType_Type);
 
   MOD_INIT_VERIFY_TYPE_READY(&PyhlNodelist_Type);
   MOD_INIT_VERIFY_TYPE_READY(&PyhlNode_Type);
   MOD_INIT_VERIFY_TYPE_READY(&PyhlFileCreationProperty_Type);
   MOD_INIT_VERIFY_TYPE_READY(&PyhlCompression_Type);
+  MOD_INIT_VERIFY_TYPE_READY(&PyhlChunkIterator_Type);
+  MOD_INIT_VERIFY_TYPE_READY(&PyhlFetchHandle_Type);
+  MOD_INIT_VERIFY_TYPE_READY(&PyhlWriteHandle_Type);
 
   MOD_INIT_DEF(module, "_pyhl", NULL/*doc*/, functions);
   if (module == NULL) {
@@ -2469,6 +4000,38 @@ MOD_INIT(_pyhl)
   PyDict_SetItemString(dictionary,"COMPRESSION_SZLIB",tmp);
   Py_XDECREF(tmp);
 
+  tmp = PyInt_FromLong(HL_FSPACE_DEFAULT);
+  PyDict_SetItemString(dictionary,"FSPACE_STRATEGY_DEFAULT",tmp);
+  Py_XDECREF(tmp);
+
+  tmp = PyInt_FromLong(HL_FSPACE_FSM_AGGR);
+  PyDict_SetItemString(dictionary,"FSPACE_STRATEGY_FSM_AGGR",tmp);
+  Py_XDECREF(tmp);
+
+  tmp = PyInt_FromLong(HL_FSPACE_PAGE);
+  PyDict_SetItemString(dictionary,"FSPACE_STRATEGY_PAGE",tmp);
+  Py_XDECREF(tmp);
+
+  tmp = PyInt_FromLong(HL_FSPACE_AGGR);
+  PyDict_SetItemString(dictionary,"FSPACE_STRATEGY_AGGR",tmp);
+  Py_XDECREF(tmp);
+
+  tmp = PyInt_FromLong(HL_FSPACE_NONE);
+  PyDict_SetItemString(dictionary,"FSPACE_STRATEGY_NONE",tmp);
+  Py_XDECREF(tmp);
+
+  tmp = PyInt_FromLong(HL_INDEX_NONE);
+  PyDict_SetItemString(dictionary,"INDEX_NONE",tmp);
+  Py_XDECREF(tmp);
+
+  tmp = PyInt_FromLong(HL_INDEX_MEMORY);
+  PyDict_SetItemString(dictionary,"INDEX_MEMORY",tmp);
+  Py_XDECREF(tmp);
+
+  tmp = PyInt_FromLong(HL_INDEX_SIDECAR);
+  PyDict_SetItemString(dictionary,"INDEX_SIDECAR",tmp);
+  Py_XDECREF(tmp);
+
   import_array(); /*To make sure I get access to Numeric*/
   /*Always have to do this*/
   HL_init();
@@ -24,8 +24,12 @@ Created on Jun 5, 2009
 import unittest
 import _pyhl
 import _rave_info_type
+import _varioustests
 import numpy
 import os
+import shutil
+import subprocess
+import sys
 
 class HlhdfReadTest(unittest.TestCase):
   TESTFILE = "fixture_VhlhdfRead_datafile.h5"
@@ -852,6 +856,305 @@ class HlhdfReadTest(unittest.TestCase):
     node = self.h5nodelist.getNode("/rootreferencetolongarray")
     self.assertEqual("/longarray", node.data())
 
+  def testMemoryBudget(self):
+    datasets = ["/group1/doubledset", "/group1/longdset", "/group1/floatdset", "/group1/intdset"]
+    for d in datasets:
+      self.h5nodelist.setEvictable(d)
+    self.assertEqual(0, self.h5nodelist.getMemoryBudget())
+    full = _pyhl.read_nodelist(self.TESTFILE)
+    full.selectAll()
+    full.fetch()
+    budget = full.getMemoryUsage()["total"] - 300
+    self.h5nodelist.setMemoryBudget(budget)
+    self.assertEqual(budget, self.h5nodelist.getMemoryBudget())
+
+    self.h5nodelist.selectAll()
+    self.h5nodelist.fetch()
+
+    usage = self.h5nodelist.getMemoryUsage()
+    self.assertTrue(usage["total"] <= budget)
+    self.assertEqual(usage["total"], usage["data"] + usage["rawdata"] + usage["names"] + usage["compound"] + usage["other"] + usage["file"])
+    evicted = [d for d in datasets if self.h5nodelist.getMemoryUsage(d)["data"] == 0]
+    self.assertTrue("/group1/doubledset" in evicted)
+
+    # Evicted data is fetched again on access
+    node = self.h5nodelist.getNode("/group1/doubledset")
+    self.verifyDataset([5,5], node.data(), numpy.float64)
+    self.assertEqual(200, self.h5nodelist.getMemoryUsage("/group1/doubledset")["data"])
+
+    # Nodes not marked as evictable are kept
+    self.assertEqual(224, self.h5nodelist.getMemoryUsage("/compoundgroup/dataset2")["data"])
+
+  def testCompoundColumn(self):
+    node = self.h5nodelist.fetchNode("/compoundgroup/dataset2")
+    xsize = node.compound_column("xsize")
+    self.assertEqual(numpy.int32, xsize.dtype)
+    self.assertTrue(numpy.all(numpy.array([[99,98],[88,78]]) == xsize))
+    xscale = node.compound_column("xscale")
+    self.assertTrue(numpy.all(numpy.array([[170.0,120.0],[100.0,90.0]]) == xscale))
+    extent = node.compound_column("area_extent")
+    self.assertEqual((2,2,4), extent.shape)
+    self.assertTrue(numpy.all(numpy.array([43.0,42.0,41.0,40.0]) == extent[1][0]))
+    try:
+      node.compound_column("nosuchmember")
+      self.fail("Expected AttributeError")
+    except AttributeError:
+      pass
+
+  def testReadCompoundColumn(self):
+    ysize = self.h5nodelist.readCompoundColumn("/compoundgroup/dataset2", "ysize")
+    self.assertTrue(numpy.all(numpy.array([[109,97],[87,77]]) == ysize))
+    yscale = self.h5nodelist.readCompoundColumn("/compoundgroup/dataset2", "yscale")
+    self.assertTrue(numpy.all(numpy.array([[150.0,130.0],[110.0,91.0]]) == yscale))
+    extent = self.h5nodelist.readCompoundColumn("/compoundgroup/dataset2", "area_extent")
+    self.assertEqual((2,2,4), extent.shape)
+    self.assertTrue(numpy.all(numpy.array([53.0,52.0,51.0,50.0]) == extent[1][1]))
+    self.assertEqual(0, self.h5nodelist.getMemoryUsage("/compoundgroup/dataset2")["data"])
+    try:
+      self.h5nodelist.readCompoundColumn("/compoundgroup/dataset2", "nosuchmember")
+      self.fail("Expected IOError")
+    except IOError:
+      pass
+
+  def testFetchWithStatistics(self):
+    nodelist = _pyhl.read_nodelist(self.TESTFILE)
+    nodelist.setStatisticsOptions(nbins=5, histmin=0.0, histmax=25.0, nodata=3.0)
+    for name in ["/group1/uchardset", "/group1/intdset", "/group1/doubledset"]:
+      stats = nodelist.fetchNode(name).statistics()
+      self.assertEqual(24, stats["count"])
+      self.assertEqual(1, stats["nodata_count"])
+      self.assertEqual(0, stats["undetect_count"])
+      self.assertAlmostEqual(0.0, stats["min"], 4)
+      self.assertAlmostEqual(24.0, stats["max"], 4)
+      self.assertAlmostEqual(297.0/24.0, stats["mean"], 4)
+      self.assertEqual([4, 5, 5, 5, 5], stats["histogram"])
+
+    nodelist.setStatisticsOptions(enable=0)
+    self.assertEqual(None, nodelist.fetchNode("/group1/floatdset").statistics())
+
+  def testCompoundDescriptionsShared(self):
+    nodelist = _pyhl.read_nodelist(self.TESTFILE)
+    nodelist.selectAll()
+    nodelist.fetch()
+    paths = ["/compoundgroup/attribute", "/compoundgroup/attribute2", "/compoundgroup/dataset",
+             "/compoundgroup/dataset2", "/compoundgroup/unnamed_type_attribute"]
+    nodeusage = [nodelist.getMemoryUsage(p)["compound"] for p in paths]
+    self.assertTrue(nodelist.getMemoryUsage()["compound"] < sum(nodeusage))
+
+    # Modifying the description of one node does not affect the others
+    shared, isolated = _varioustests.compoundCopyOnWrite(self.TESTFILE, "/compoundgroup/attribute", "/compoundgroup/attribute2")
+    self.assertEqual(1, shared)
+    self.assertEqual(1, isolated)
+    self.assertEqual(5, len(nodelist.fetchNode("/compoundgroup/attribute").compound_data()))
+
+    # Shared descriptions are still valid after the first nodelist is gone
+    other = _pyhl.read_nodelist(self.TESTFILE)
+    other.selectAll()
+    other.fetch()
+    nodelist = None
+    x = other.fetchNode("/compoundgroup/attribute2").compound_data()
+    self.assertEqual(99, x['xsize'])
+    self.assertEqual(109, x['ysize'])
+
+  def testFetchAsync_compoundWhileOtherNodelistsAreFreed(self):
+    # Compound descriptions are shared between nodelists, the I/O thread must not race
+    # with the main thread creating and freeing them for other nodelists of the same file
+    nodelist = _pyhl.read_nodelist(self.TESTFILE)
+    nodelist.selectAll()
+    h = nodelist.fetchAsync()
+    for i in range(20):
+      other = _pyhl.read_nodelist(self.TESTFILE)
+      other.selectNode("/compoundgroup/attribute2")
+      other.selectNode("/compoundgroup/dataset")
+      other.fetch()
+      self.assertEqual(99, other.getNode("/compoundgroup/attribute2").compound_data()['xsize'])
+      other = None
+    h.wait()
+    h = None
+    x = nodelist.getNode("/compoundgroup/attribute2").compound_data()
+    self.assertEqual(99, x['xsize'])
+    self.assertEqual(109, x['ysize'])
+
+  def testDataCache(self):
+    _pyhl.clear_data_cache()
+    _pyhl.set_data_cache_limit(1024*1024)
+    try:
+      self.h5nodelist.selectAll()
+      self.h5nodelist.fetch()
+      hits, misses = _pyhl.get_data_cache_statistics()
+      self.assertEqual(0, hits)
+      self.assertTrue(misses > 0)
+      self.assertTrue(_pyhl.get_data_cache_usage() > 0)
+
+      other = _pyhl.read_nodelist(self.TESTFILE)
+      other.selectAll()
+      other.fetch()
+      hits, misses2 = _pyhl.get_data_cache_statistics()
+      self.assertEqual(misses, hits)
+      self.assertEqual(misses, misses2)
+
+      node = other.getNode("/group1/doubledset")
+      self.verifyDataset([5,5], node.data(), numpy.float64)
+      self.assertEqual("double", node.format())
+      node = other.fetchNode("/stringvalue")
+      self.assertEqual("My String", node.data())
+      self.assertEqual("My String\x00", node.rawdata())
+      self.assertEqual(self.h5nodelist.getNode("/compoundgroup/dataset").compound_data(),
+                       other.getNode("/compoundgroup/dataset").compound_data())
+
+      _pyhl.set_data_cache_limit(10)
+      self.assertEqual(0, _pyhl.get_data_cache_usage())
+      self.verifyDataset([5,5], other.getNode("/group1/doubledset").data(), numpy.float64)
+    finally:
+      _pyhl.set_data_cache_limit(0)
+      _pyhl.clear_data_cache()
+
+  def testDataCache_copyOnWrite(self):
+    _pyhl.clear_data_cache()
+    _pyhl.set_data_cache_limit(1024*1024)
+    try:
+      shared, isolated, deepcopy = _varioustests.copyOnWrite(self.TESTFILE, "/group1/doubledset")
+      self.assertEqual(1, shared)
+      self.assertEqual(1, isolated)
+      self.assertEqual(1, deepcopy)
+      # The cached data is not affected by the modification
+      other = _pyhl.read_nodelist(self.TESTFILE)
+      self.verifyDataset([5,5], other.fetchNode("/group1/doubledset").data(), numpy.float64)
+    finally:
+      _pyhl.set_data_cache_limit(0)
+      _pyhl.clear_data_cache()
+
+  def testIndex(self):
+    names = self.h5nodelist.getNodeNames()
+    _pyhl.set_index_mode(_pyhl.INDEX_MEMORY)
+    try:
+      a = _pyhl.read_nodelist(self.TESTFILE)
+      b = _pyhl.read_nodelist(self.TESTFILE)
+      self.assertEqual((1, 1), _pyhl.get_index_statistics())
+      self.assertEqual(names, a.getNodeNames())
+      self.assertEqual(names, b.getNodeNames())
+      self.verifyDataset([5,5], b.fetchNode("/group1/doubledset").data(), numpy.float64)
+      self.assertEqual("My String", b.fetchNode("/stringvalue").data())
+    finally:
+      _pyhl.set_index_mode(_pyhl.INDEX_NONE)
+    self.assertEqual((0, 0), _pyhl.get_index_statistics())
+
+  def testIndexSidecar(self):
+    copyname = "fixture_index_copy.h5"
+    shutil.copyfile(self.TESTFILE, copyname)
+    _pyhl.set_index_mode(_pyhl.INDEX_SIDECAR)
+    try:
+      a = _pyhl.read_nodelist(copyname)
+      self.assertTrue(os.path.exists(copyname + ".hlidx"))
+      _pyhl.clear_index_cache()
+      b = _pyhl.read_nodelist(copyname)
+      self.assertEqual((1, 0), _pyhl.get_index_statistics())
+      self.assertEqual(a.getNodeNames(), b.getNodeNames())
+
+      b.selectAll()
+      b.fetch()
+      b.writeIndex()
+      _pyhl.clear_index_cache()
+      c = _pyhl.read_nodelist(copyname)
+      self.assertEqual((1, 0), _pyhl.get_index_statistics())
+      self.verifyDataset([5,5], c.fetchNode("/group1/doubledset").data(), numpy.float64)
+
+      st = os.stat(copyname)
+      os.utime(copyname, (st.st_atime, st.st_mtime + 10))
+      _pyhl.read_nodelist(copyname)
+      self.assertEqual((1, 1), _pyhl.get_index_statistics())
+    finally:
+      _pyhl.set_index_mode(_pyhl.INDEX_NONE)
+      for f in [copyname, copyname + ".hlidx"]:
+        if os.path.exists(f):
+          os.unlink(f)
+
+  def testIndex_replacedFile(self):
+    copyname = "fixture_index_copy.h5"
+    shutil.copyfile(self.TESTFILE, copyname)
+    _pyhl.set_index_mode(_pyhl.INDEX_MEMORY)
+    try:
+      _pyhl.read_nodelist(copyname)
+      self.assertEqual((0, 1), _pyhl.get_index_statistics())
+      # Another file with the same size and modification time is not served from the index
+      st = os.stat(copyname)
+      shutil.copyfile(self.TESTFILE, copyname + ".tmp")
+      os.utime(copyname + ".tmp", ns=(st.st_atime_ns, st.st_mtime_ns))
+      os.replace(copyname + ".tmp", copyname)
+      _pyhl.read_nodelist(copyname)
+      self.assertEqual((0, 2), _pyhl.get_index_statistics())
+    finally:
+      _pyhl.set_index_mode(_pyhl.INDEX_NONE)
+      for f in [copyname, copyname + ".tmp"]:
+        if os.path.exists(f):
+          os.unlink(f)
+
+  def testReadFiltered(self):
+    nodelist = _pyhl.read_nodelist(self.TESTFILE, None, ["/group1/**"])
+    names = nodelist.getNodeNames()
+    self.assertEqual(12, len(names))
+    self.assertTrue("/group1" in names)
+    self.assertTrue("/group1/group11" in names)
+    self.assertTrue("/group1/doubledset" in names)
+    self.verifyDataset([5,5], nodelist.fetchNode("/group1/doubledset").data(), numpy.float64)
+
+  def testReadFiltered_exclude(self):
+    names = _pyhl.read_nodelist(self.TESTFILE, None, ["!group1", "!**/unnamed_type_attribute"]).getNodeNames()
+    allnames = self.h5nodelist.getNodeNames()
+    for name in allnames:
+      excluded = name.startswith("/group1") or name == "/compoundgroup/unnamed_type_attribute"
+      self.assertEqual(not excluded, name in names, name)
+
+  def testReadFiltered_structure(self):
+    names = _pyhl.read_nodelist(self.TESTFILE, None, ["/dataset?/attribute1", "/compoundgroup/attr*"]).getNodeNames()
+    self.assertEqual(["/compoundgroup", "/compoundgroup/attribute", "/compoundgroup/attribute2",
+                      "/dataset1", "/dataset1/attribute1"], sorted(names.keys()))
+
+  def testReadFiltered_sameOrderAsUnfiltered(self):
+    names = _pyhl.read_nodelist(self.TESTFILE, None, ["/**"]).getNodeNames()
+    self.assertEqual(list(self.h5nodelist.getNodeNames().keys()), list(names.keys()))
+
+  def testReadFiltered_badPatterns(self):
+    try:
+      _pyhl.read_nodelist(self.TESTFILE, None, [1])
+      self.fail("Expected TypeError")
+    except TypeError:
+      pass
+
+  def testReadWithMetadata(self):
+    self.h5nodelist.selectAllMetadata()
+    self.h5nodelist.fetch()
+    nodelist = _pyhl.read_nodelist_with_metadata(self.TESTFILE)
+    names = self.h5nodelist.getNodeNames()
+    self.assertEqual(names, nodelist.getNodeNames())
+    for name in names:
+      expected = self.h5nodelist.getNode(name)
+      node = nodelist.getNode(name)
+      self.assertEqual(expected.type(), node.type(), name)
+      self.assertEqual(expected.format(), node.format(), name)
+      self.assertEqual(expected.dims(), node.dims(), name)
+      if node.type() in [_pyhl.ATTRIBUTE_ID, _pyhl.REFERENCE_ID] and node.format() != "compound":
+        self.assertEqual(str(expected.data()), str(node.data()), name)
+    self.assertEqual("/group1/floatdset", nodelist.getNode("/references/floatdset").data())
+    self.verifyDataset([5,5], nodelist.fetchNode("/group1/doubledset").data(), numpy.float64)
+
+  def testSharedTypesAreNotModified(self):
+    self.h5nodelist.selectAll()
+    self.h5nodelist.fetch()
+    other = _pyhl.read_nodelist(self.TESTFILE)
+    other.selectAll()
+    other.fetch()
+    node = self.h5nodelist.getNode("/stringvalue")
+    node.setScalarValue(-1, "A much longer string value", "string", -1)
+    self.assertEqual("A much longer string value", node.data())
+    self.assertEqual("My String", other.getNode("/stringvalue").data())
+    self.assertEqual("string", other.getNode("/stringvalue").format())
+    node = self.h5nodelist.getNode("/intvalue")
+    node.setScalarValue(-1, 7, "llong", -1)
+    self.assertEqual("llong", node.format())
+    self.assertEqual("int", other.getNode("/intvalue").format())
+    self.assertEqual(989898, other.getNode("/intvalue").data())
+
   def testGetNodeNames(self):
     names = self.h5nodelist.getNodeNames()
     self.assertFalse("/" in names);
@@ -889,6 +1192,19 @@ class HlhdfReadTest(unittest.TestCase):
     node= nl.fetchNode("/variable")
     self.assertEqual("this is a variable length string", node.data())
     self.assertEqual("this is a variable length string\x00", node.rawdata())
+
+  def testAsyncLogging(self):
+    script = "\n".join(["import _pyhl",
+                        "_pyhl.show_hlhdferrors(1)",
+                        "_pyhl.start_async_logging(16)",
+                        "try:",
+                        "  _pyhl.read_nodelist('nonexisting_file.h5')",
+                        "except IOError:",
+                        "  pass",
+                        "_pyhl.stop_async_logging()"])
+    result = subprocess.run([sys.executable, "-c", script], stderr=subprocess.PIPE, universal_newlines=True)
+    self.assertEqual(0, result.returncode)
+    self.assertTrue("Failed to open file nonexisting_file.h5" in result.stderr)
       
 if __name__ == "__main__":
     unittest.main()
@@ -26,6 +26,7 @@ import unittest
 import _pyhl
 import numpy
 import os
+import json
 import _varioustests
 import _rave_info_type
 
@@ -113,6 +114,48 @@ class HlhdfWriteTest(unittest.TestCase):
     self.assertEqual(_pyhl.DATASET_ID, b.type())
     self.assertTrue(numpy.all(["abc", "def", "ghi", "jkl"] == b.data()))
   
+  def testWriteInlineAndAllocatedValues(self):
+    # Values below/above the size stored directly in the node
+    shortstr = "x" * 30
+    longstr = "y" * 100
+    a=_pyhl.nodelist()
+    self.addScalarValueNode(a, _pyhl.ATTRIBUTE_ID, "/shortstr", -1, shortstr, "string", -1)
+    self.addScalarValueNode(a, _pyhl.ATTRIBUTE_ID, "/longstr", -1, longstr, "string", -1)
+    self.addArrayValueNode(a, _pyhl.ATTRIBUTE_ID, "/smallarr", -1, [3], [1.0, 2.0, 3.0], "double", -1)
+    self.addArrayValueNode(a, _pyhl.ATTRIBUTE_ID, "/largearr", -1, [10], list(range(10)), "double", -1)
+    self.addArrayValueNode(a, _pyhl.DATASET_ID, "/rank4", -1, [1,2,2,3], numpy.arange(12, dtype=numpy.int32).reshape((1,2,2,3)), "int", -1)
+    a.write(self.TESTFILE)
+
+    #verify
+    a=_pyhl.read_nodelist(self.TESTFILE)
+    self.assertEqual(shortstr, a.fetchNode("/shortstr").data())
+    self.assertEqual(longstr, a.fetchNode("/longstr").data())
+    self.assertTrue(numpy.all([1.0, 2.0, 3.0] == a.fetchNode("/smallarr").data()))
+    self.assertTrue(numpy.all(numpy.arange(10) == a.fetchNode("/largearr").data()))
+    b = a.fetchNode("/rank4").data()
+    self.assertEqual((1,2,2,3), b.shape)
+    self.assertEqual(11, b[0][1][1][2])
+
+  def testDataCacheNotUsedForRewrittenFile(self):
+    _pyhl.clear_data_cache()
+    _pyhl.set_data_cache_limit(1024*1024)
+    try:
+      a=_pyhl.nodelist()
+      self.addArrayValueNode(a, _pyhl.DATASET_ID, "/data", -1, [10], numpy.arange(10, dtype=numpy.int32), "int", -1)
+      a.write(self.TESTFILE)
+      a=_pyhl.read_nodelist(self.TESTFILE)
+      self.assertEqual(9, a.fetchNode("/data").data()[9])
+
+      a=_pyhl.nodelist()
+      self.addArrayValueNode(a, _pyhl.DATASET_ID, "/data", -1, [10], numpy.arange(10, dtype=numpy.int32) * 2, "int", -1)
+      a.write(self.TESTFILE)
+      a=_pyhl.read_nodelist(self.TESTFILE)
+      self.assertEqual(18, a.fetchNode("/data").data()[9])
+      self.assertEqual(0, _pyhl.get_data_cache_statistics()[0])
+    finally:
+      _pyhl.set_data_cache_limit(0)
+      _pyhl.clear_data_cache()
+
   def testWriteChar(self):
     a=_pyhl.nodelist()
     self.addScalarValueNode(a, _pyhl.ATTRIBUTE_ID, "/charvalue", -1, 123, "char", -1)
@@ -667,6 +710,554 @@ class HlhdfWriteTest(unittest.TestCase):
     self.assertEqual("int", a.fetchNode("/info/xsize").format())
     self.assertEqual("long", a.fetchNode("/info/ysize").format())
 
+  def testFetchScaled(self):
+    a=_pyhl.nodelist()
+    self.addGroupNode(a, "/dataset1")
+    self.addGroupNode(a, "/dataset1/what")
+    self.addScalarValueNode(a, _pyhl.ATTRIBUTE_ID, "/dataset1/what/gain", -1, 0.5, "double", -1)
+    self.addScalarValueNode(a, _pyhl.ATTRIBUTE_ID, "/dataset1/what/offset", -1, -32.0, "double", -1)
+    self.addScalarValueNode(a, _pyhl.ATTRIBUTE_ID, "/dataset1/what/nodata", -1, 255.0, "double", -1)
+    self.addScalarValueNode(a, _pyhl.ATTRIBUTE_ID, "/dataset1/what/undetect", -1, 0.0, "double", -1)
+    self.addGroupNode(a, "/dataset1/data1")
+    self.addGroupNode(a, "/dataset1/data1/what")
+    self.addScalarValueNode(a, _pyhl.ATTRIBUTE_ID, "/dataset1/data1/what/gain", -1, 2.0, "double", -1)
+    data = numpy.array([[0, 1, 2], [100, 254, 255]], numpy.uint8)
+    self.addArrayValueNode(a, _pyhl.DATASET_ID, "/dataset1/data1/data", -1, [2,3], data, "uchar", -1)
+    self.addGroupNode(a, "/dataset1/data2")
+    big = numpy.arange(700*1000, dtype=numpy.uint16).reshape(700, 1000) % 4000
+    b = _pyhl.node(_pyhl.DATASET_ID, "/dataset1/data2/data", _pyhl.compression(_pyhl.COMPRESSION_ZLIB))
+    b.setArrayValue(-1, [700, 1000], big, "ushort", -1)
+    a.addNode(b)
+    a.write(self.TESTFILE)
+
+    a=_pyhl.read_nodelist(self.TESTFILE)
+    result = a.fetchScaled("/dataset1/data1/data")
+    self.assertEqual(numpy.float32, result.dtype)
+    self.assertEqual((2,3), result.shape)
+    self.assertTrue(numpy.isnan(result[0][0]))
+    self.assertTrue(numpy.isnan(result[1][2]))
+    self.assertTrue(numpy.allclose([-30.0, -28.0, 168.0, 476.0], [result[0][1], result[0][2], result[1][0], result[1][1]]))
+
+    result = a.fetchScaled("/dataset1/data1/data", format="double", gain=1.0, offset=0.0, nodatavalue=-1.0, undetectvalue=-2.0)
+    self.assertEqual(numpy.float64, result.dtype)
+    self.assertTrue(numpy.all(numpy.array([[-2.0, 1.0, 2.0], [100.0, 254.0, -1.0]]) == result))
+
+    # Nodata wins when nodata and undetect are equal, both for 8-bit and wider data
+    result = a.fetchScaled("/dataset1/data1/data", format="double", gain=1.0, offset=0.0, nodata=1.0, undetect=1.0, nodatavalue=-1.0, undetectvalue=-2.0)
+    self.assertEqual(-1.0, result[0][1])
+    result = a.fetchScaled("/dataset1/data2/data", format="double", gain=1.0, offset=0.0, nodata=1.0, undetect=1.0, nodatavalue=-1.0, undetectvalue=-2.0)
+    self.assertTrue(numpy.all(result[big == 1] == -1.0))
+    self.assertEqual(0.0, result[0][0])
+
+    # Read in several slabs
+    result = a.fetchScaled("/dataset1/data2/data", nodata=3999.0)
+    expected = numpy.where(big == 3999, numpy.nan, big * 0.5 - 32.0)
+    expected[big == 0] = numpy.nan
+    self.assertEqual((700, 1000), result.shape)
+    self.assertTrue(numpy.allclose(expected, result, equal_nan=True))
+    self.assertEqual(0, a.getMemoryUsage("/dataset1/data2/data")["data"])
+
+    try:
+      a.fetchScaled("/dataset1/data1/data", format="int")
+      self.fail("Expected ValueError")
+    except ValueError:
+      pass
+
+  def testWriteStatisticsAttributes(self):
+    a=_pyhl.nodelist()
+    self.addGroupNode(a, "/dataset1")
+    data = numpy.arange(700*1000, dtype=numpy.uint16).reshape(700, 1000) % 4000
+    b = _pyhl.node(_pyhl.DATASET_ID, "/dataset1/data", _pyhl.compression(_pyhl.COMPRESSION_ZLIB))
+    b.setArrayValue(-1, [700, 1000], data, "ushort", -1)
+    a.addNode(b)
+    a.write(self.TESTFILE)
+
+    # Statistics are computed on each slab while the data is read
+    a=_pyhl.read_nodelist(self.TESTFILE)
+    a.setStatisticsOptions(nbins=4, histmin=0.0, histmax=4000.0, undetect=0.0)
+    stats = a.fetchNode("/dataset1/data").statistics()
+    valid = data[data != 0]
+    self.assertEqual(valid.size, stats["count"])
+    self.assertEqual(data.size - valid.size, stats["undetect_count"])
+    self.assertAlmostEqual(1.0, stats["min"], 4)
+    self.assertAlmostEqual(3999.0, stats["max"], 4)
+    self.assertAlmostEqual(valid.mean(), stats["mean"], 4)
+    self.assertEqual(numpy.histogram(valid, bins=4, range=(0, 4000))[0].tolist(), stats["histogram"])
+
+    a.addStatisticsAttributes()
+    a.update()
+
+    a=_pyhl.read_nodelist(self.TESTFILE)
+    a.selectAllMetadata()
+    a.fetch()
+    self.assertEqual(valid.size, a.getNode("/dataset1/data/stat_count").data())
+    self.assertAlmostEqual(1.0, a.getNode("/dataset1/data/stat_min").data(), 4)
+    self.assertAlmostEqual(3999.0, a.getNode("/dataset1/data/stat_max").data(), 4)
+    self.assertAlmostEqual(valid.mean(), a.getNode("/dataset1/data/stat_mean").data(), 4)
+    self.assertEqual(stats["histogram"], a.getNode("/dataset1/data/stat_histogram").data().tolist())
+
+  def testOperationCounters(self):
+    a=_pyhl.nodelist()
+    self.addGroupNode(a, "/group1")
+    self.addScalarValueNode(a, _pyhl.ATTRIBUTE_ID, "/group1/attr", -1, 10, "int", -1)
+    b = _pyhl.node(_pyhl.DATASET_ID, "/group1/data", _pyhl.compression(_pyhl.COMPRESSION_ZLIB))
+    b.setArrayValue(-1, [100, 100], numpy.zeros((100, 100), numpy.int32), "int", -1)
+    a.addNode(b)
+
+    _pyhl.reset_stats()
+    a.write(self.TESTFILE)
+    stats = _pyhl.get_stats()
+    self.assertEqual(1, stats["files_opened"])
+    self.assertEqual(1, stats["attributes_written"])
+    self.assertEqual(1, stats["datasets_written"])
+    self.assertEqual(100*100*4 + 4, stats["bytes_written"])
+    self.assertTrue(0 < stats["raw_bytes_written"] < stats["bytes_written"])
+    self.assertTrue(stats["write_time"] > 0.0)
+    self.assertEqual(0, stats["datasets_read"])
+
+    _pyhl.reset_stats()
+    a=_pyhl.read_nodelist(self.TESTFILE)
+    a.selectAll()
+    a.fetch()
+    stats = _pyhl.get_stats()
+    self.assertEqual(2, stats["files_opened"])
+    self.assertEqual(1, stats["attributes_read"])
+    self.assertEqual(1, stats["datasets_read"])
+    self.assertEqual(100*100*4 + 4, stats["bytes_read"])
+    self.assertTrue(0 < stats["raw_bytes_read"] < stats["bytes_read"])
+    self.assertTrue(stats["objects_opened"] >= 3)
+    self.assertTrue(stats["allocations"] > 0)
+    self.assertTrue(stats["traverse_time"] > 0.0)
+    self.assertTrue(stats["fetch_time"] > 0.0)
+    self.assertEqual(0, stats["datasets_written"])
+
+  def testChromeTrace(self):
+    a=_pyhl.nodelist()
+    self.addGroupNode(a, "/group1")
+    b = _pyhl.node(_pyhl.DATASET_ID, "/group1/data", _pyhl.compression(_pyhl.COMPRESSION_ZLIB))
+    b.setArrayValue(-1, [100, 100], numpy.zeros((100, 100), numpy.int32), "int", -1)
+    a.addNode(b)
+
+    _pyhl.start_trace(self.TESTFILE2)
+    try:
+      a.write(self.TESTFILE)
+      a=_pyhl.read_nodelist(self.TESTFILE)
+      a.selectAll()
+      a.fetch()
+    finally:
+      _pyhl.stop_trace()
+
+    with open(self.TESTFILE2) as fp:
+      events = json.load(fp)
+    self.assertEqual(len([e for e in events if e["ph"] == "B"]), len([e for e in events if e["ph"] == "E"]))
+    names = [e["name"] for e in events if e["ph"] == "E"]
+    self.assertEqual(["open", "write /group1/data", "open", "traverse .", "open", "fetch /group1", "fetch /group1/data"], names)
+    written = [e for e in events if e["ph"] == "E" and e["name"] == "write /group1/data"][0]["args"]
+    self.assertEqual(100*100*4, written["bytes"])
+    self.assertTrue(0 < written["raw_bytes"] < written["bytes"])
+    self.assertEqual("deflate", written["filters"])
+    self.assertEqual(1, written["status"])
+    fetched = [e for e in events if e["ph"] == "E" and e["name"] == "fetch /group1/data"][0]["args"]
+    self.assertEqual(self.TESTFILE, fetched["file"])
+    self.assertEqual(100*100*4, fetched["bytes"])
+    self.assertEqual("deflate", fetched["filters"])
+
+  def testCopyMarkedNodes(self):
+    data = numpy.arange(200*300, dtype=numpy.int32).reshape(200, 300)
+    a=_pyhl.nodelist()
+    self.addScalarValueNode(a, _pyhl.ATTRIBUTE_ID, "/title", -1, "copied", "string", -1)
+    self.addGroupNode(a, "/group1")
+    self.addGroupNode(a, "/group1/sub")
+    b = _pyhl.node(_pyhl.DATASET_ID, "/group1/sub/compressed", _pyhl.compression(_pyhl.COMPRESSION_ZLIB))
+    b.setArrayValue(-1, [200, 300], data, "int", -1)
+    a.addNode(b)
+    self.addScalarValueNode(a, _pyhl.ATTRIBUTE_ID, "/group1/sub/compressed/gain", -1, 0.5, "double", -1)
+    self.addArrayValueNode(a, _pyhl.DATASET_ID, "/group1/plain", -1, [200, 300], data, "int", -1)
+    self.addReference(a, "/group1/ref", "/group1/plain")
+    self.addGroupNode(a, "/group2")
+    a.write(self.TESTFILE)
+
+    a=_pyhl.read_nodelist(self.TESTFILE)
+    a.selectAll()
+    a.deselectNode("/group1")
+    a.deselectNode("/group1/sub")
+    a.deselectNode("/group2")
+    _pyhl.reset_stats()
+    a.copy(self.TESTFILE2)
+    stats = _pyhl.get_stats()
+    self.assertEqual(2, stats["datasets_written"])
+    self.assertTrue(stats["bytes_read"] < 100)
+    self.assertEqual(stats["raw_bytes_read"], stats["raw_bytes_written"])
+    self.assertTrue(200*300*4 < stats["raw_bytes_written"] < 2*200*300*4)
+
+    b=_pyhl.read_nodelist(self.TESTFILE2)
+    self.assertEqual(["/group1", "/group1/plain", "/group1/ref", "/group1/sub", "/group1/sub/compressed",
+                      "/group1/sub/compressed/gain", "/title"], sorted(b.getNodeNames().keys()))
+    b.selectAll()
+    b.fetch()
+    self.assertEqual("copied", b.getNode("/title").data())
+    self.assertAlmostEqual(0.5, b.getNode("/group1/sub/compressed/gain").data(), 4)
+    self.assertEqual("/group1/plain", b.getNode("/group1/ref").data())
+    self.assertTrue(numpy.all(data == b.getNode("/group1/plain").data()))
+    self.assertTrue(numpy.all(data == b.getNode("/group1/sub/compressed").data()))
+
+  def testIterateChunks(self):
+    data = numpy.arange(1000*600, dtype=numpy.int32).reshape(1000, 600)
+    a=_pyhl.nodelist()
+    self.addArrayValueNode(a, _pyhl.DATASET_ID, "/plain", -1, [1000, 600], data, "int", -1)
+    b = _pyhl.node(_pyhl.DATASET_ID, "/compressed", _pyhl.compression(_pyhl.COMPRESSION_ZLIB))
+    b.setArrayValue(-1, [1000, 600], data, "int", -1)
+    a.addNode(b)
+    a.write(self.TESTFILE)
+
+    a=_pyhl.read_nodelist(self.TESTFILE)
+    for name in ["/plain", "/compressed"]:
+      for readahead in [0, 1]:
+        result = numpy.zeros((1000, 600), numpy.int32)
+        blocks = 0
+        for offset, block in a.iterateChunks(name, readahead):
+          result[offset[0]:offset[0]+block.shape[0], offset[1]:offset[1]+block.shape[1]] = block
+          blocks = blocks + 1
+        self.assertTrue(numpy.all(data == result))
+        # The 2.4 MB chunk is split into blocks of 250 rows
+        self.assertEqual((name == "/plain") and 3 or 4, blocks)
+
+    # Iterating with the file kept open by the nodelist
+    with _pyhl.read_nodelist(self.TESTFILE) as a:
+      _pyhl.reset_stats()
+      blocks = [offset[0] for offset, block in a.iterateChunks("/compressed", 1)]
+      self.assertEqual([0, 250, 500, 750], blocks)
+      self.assertEqual(0, _pyhl.get_stats()["files_opened"])
+
+  def testFetchAsync(self):
+    a=_pyhl.nodelist()
+    for i in range(4):
+      data = numpy.arange(300*200, dtype=numpy.int32).reshape(300, 200) + i
+      self.addArrayValueNode(a, _pyhl.DATASET_ID, "/data%d"%i, -1, [300, 200], data, "int", -1)
+    self.addScalarValueNode(a, _pyhl.ATTRIBUTE_ID, "/attr", -1, 10, "int", -1)
+    a.write(self.TESTFILE)
+
+    a=_pyhl.read_nodelist(self.TESTFILE)
+    a.selectAll()
+    h = a.fetchAsync()
+    h.wait("/data2")
+    self.assertTrue(numpy.all(numpy.arange(300*200, dtype=numpy.int32).reshape(300, 200) + 2 == a.getNode("/data2").data()))
+    h.wait()
+    self.assertEqual((5, 5), h.poll())
+    self.assertEqual(10, a.getNode("/attr").data())
+    for i in range(4):
+      self.assertTrue(numpy.all(numpy.arange(300*200, dtype=numpy.int32).reshape(300, 200) + i == a.getNode("/data%d"%i).data()))
+    try:
+      h.wait("/nonexisting")
+      self.fail("Expected IOError")
+    except IOError:
+      pass
+
+  def testFetchAsync_nodelistWaits(self):
+    a=_pyhl.nodelist()
+    for i in range(4):
+      data = numpy.arange(300*200, dtype=numpy.int32).reshape(300, 200) + i
+      self.addArrayValueNode(a, _pyhl.DATASET_ID, "/data%d"%i, -1, [300, 200], data, "int", -1)
+    a.write(self.TESTFILE)
+
+    a=_pyhl.read_nodelist(self.TESTFILE)
+    a.selectAll()
+    h = a.fetchAsync()
+    # The nodelist methods wait for the fetch instead of racing with it
+    self.assertTrue(numpy.all(numpy.arange(300*200, dtype=numpy.int32).reshape(300, 200) + 3 == a.getNode("/data3").data()))
+    self.assertEqual((4, 4), h.poll())
+    a.selectAll()
+    h2 = a.fetchAsync()
+    self.assertEqual(4*300*200*4, a.getMemoryUsage()["data"])
+    h2.wait()
+    h = None
+    h2 = None
+    self.assertEqual(4, len([k for k in a.getNodeNames().keys() if k.startswith("/data")]))
+
+  def testFetchAsync_memoryBudget(self):
+    a=_pyhl.nodelist()
+    for i in range(4):
+      data = numpy.arange(300*200, dtype=numpy.int32).reshape(300, 200) + i
+      self.addArrayValueNode(a, _pyhl.DATASET_ID, "/data%d"%i, -1, [300, 200], data, "int", -1)
+    a.write(self.TESTFILE)
+
+    # The budget is enforced as each dataset is filled, not only when the fetch is done
+    peak = _varioustests.fetchAsyncPeakMemory(self.TESTFILE, 300*200*4 + 10000)
+    self.assertTrue(peak > 0)
+    self.assertTrue(peak <= 300*200*4 + 10000, "peak was %d"%peak)
+
+  def testWriteAsync(self):
+    data = numpy.arange(400*300, dtype=numpy.int32).reshape(400, 300)
+    a=_pyhl.nodelist()
+    self.addArrayValueNode(a, _pyhl.DATASET_ID, "/data", -1, [400, 300], data, "int", -1)
+    self.addScalarValueNode(a, _pyhl.ATTRIBUTE_ID, "/attr", -1, 10, "int", -1)
+    h = a.writeAsync(self.TESTFILE, 6)
+    self.assertEqual(0, len(a.getNodeNames()))
+    h.wait()
+    self.assertTrue(h.done())
+
+    a=_pyhl.read_nodelist(self.TESTFILE)
+    a.selectAll()
+    a.fetch()
+    self.assertTrue(numpy.all(data == a.getNode("/data").data()))
+    self.assertEqual(10, a.getNode("/attr").data())
+
+  def testWriteAsync_sharedWithCache(self):
+    rinfo_obj =_rave_info_type.object()
+    rinfo_type=_rave_info_type.type()
+    a=_pyhl.nodelist()
+    for i in range(4):
+      rinfo_obj.xsize = 90 + i
+      self.addScalarValueNode(a, _pyhl.ATTRIBUTE_ID, "/attribute%d"%i, rinfo_type.size(), rinfo_obj.tostring(), "compound", rinfo_type.hid())
+      data = numpy.arange(200*100, dtype=numpy.int32).reshape(200, 100) + i
+      self.addArrayValueNode(a, _pyhl.DATASET_ID, "/data%d"%i, -1, [200, 100], data, "int", -1)
+    a.write(self.TESTFILE)
+
+    _pyhl.clear_data_cache()
+    _pyhl.set_data_cache_limit(1024*1024)
+    try:
+      # Both nodelists share data with the cache and compound descriptions with each other
+      a=_pyhl.read_nodelist(self.TESTFILE)
+      a.selectAll()
+      a.fetch()
+      b=_pyhl.read_nodelist(self.TESTFILE)
+      b.selectAll()
+      b.fetch()
+      h = a.writeAsync(self.TESTFILE2, 6)
+      for i in range(10):
+        c=_pyhl.read_nodelist(self.TESTFILE)
+        c.selectAll()
+        c.fetch()
+        c = None
+        _pyhl.clear_data_cache()
+      b = None
+      h.wait()
+    finally:
+      _pyhl.set_data_cache_limit(0)
+      _pyhl.clear_data_cache()
+
+    a=_pyhl.read_nodelist(self.TESTFILE2)
+    a.selectAll()
+    a.fetch()
+    for i in range(4):
+      self.assertEqual(90 + i, a.getNode("/attribute%d"%i).compound_data()['xsize'])
+      self.assertTrue(numpy.all(numpy.arange(200*100, dtype=numpy.int32).reshape(200, 100) + i == a.getNode("/data%d"%i).data()))
+
+  def testOpenSession(self):
+    a=_pyhl.nodelist()
+    for i in range(3):
+      data = numpy.arange(100*50, dtype=numpy.int32).reshape(100, 50) + i
+      self.addArrayValueNode(a, _pyhl.DATASET_ID, "/data%d"%i, -1, [100, 50], data, "int", -1)
+    a.write(self.TESTFILE)
+
+    _pyhl.reset_stats()
+    with _pyhl.read_nodelist(self.TESTFILE) as a:
+      for i in range(3):
+        result = a.fetchNode("/data%d"%i).data()
+        self.assertTrue(numpy.all(numpy.arange(100*50, dtype=numpy.int32).reshape(100, 50) + i == result))
+    # One open when reading the structure and one for the session
+    self.assertEqual(2, _pyhl.get_stats()["files_opened"])
+
+    # Writing closes the session
+    a=_pyhl.read_nodelist(self.TESTFILE)
+    a.open()
+    a.selectAll()
+    a.fetch()
+    a.write(self.TESTFILE2)
+    a.close()
+    a=_pyhl.read_nodelist(self.TESTFILE2)
+    self.assertTrue(numpy.all(numpy.arange(100*50, dtype=numpy.int32).reshape(100, 50) + 2 == a.fetchNode("/data2").data()))
+
+  def testFetchInStorageOrder(self):
+    a=_pyhl.nodelist()
+    for name in ["/z", "/m", "/a"]:
+      self.addArrayValueNode(a, _pyhl.DATASET_ID, name, -1, [100, 100], numpy.zeros((100, 100), numpy.int32), "int", -1)
+    b = _pyhl.node(_pyhl.DATASET_ID, "/c", _pyhl.compression(_pyhl.COMPRESSION_ZLIB))
+    b.setArrayValue(-1, [100, 100], numpy.ones((100, 100), numpy.int32), "int", -1)
+    a.addNode(b)
+    self.addScalarValueNode(a, _pyhl.ATTRIBUTE_ID, "/z/attr", -1, 10, "int", -1)
+    a.write(self.TESTFILE)
+
+    a=_pyhl.read_nodelist(self.TESTFILE)
+    a.selectAll()
+    _pyhl.reset_stats()
+    _pyhl.start_trace(self.TESTFILE2)
+    try:
+      a.fetch()
+    finally:
+      _pyhl.stop_trace()
+    opened = _pyhl.get_stats()["objects_opened"]
+
+    with open(self.TESTFILE2) as fp:
+      events = json.load(fp)
+    names = [e["name"] for e in events if e["ph"] == "E" and e["name"].startswith("fetch")]
+    self.assertEqual(["fetch /z/attr", "fetch /z", "fetch /m", "fetch /a", "fetch /c"], names)
+    self.assertTrue(numpy.all(1 == a.getNode("/c").data()))
+    # The datasets opened for ordering are reused by the fetch, the attribute
+    # and the dataset it belongs to are opened once more
+    self.assertEqual(6, opened)
+
+  def testFetchInStorageOrder_cachedFirst(self):
+    a=_pyhl.nodelist()
+    for name in ["/z", "/m", "/a"]:
+      self.addArrayValueNode(a, _pyhl.DATASET_ID, name, -1, [100, 100], numpy.zeros((100, 100), numpy.int32), "int", -1)
+    a.write(self.TESTFILE)
+
+    _pyhl.clear_data_cache()
+    _pyhl.set_data_cache_limit(1024*1024)
+    try:
+      a=_pyhl.read_nodelist(self.TESTFILE)
+      a.fetchNode("/a")
+      a=_pyhl.read_nodelist(self.TESTFILE)
+      a.selectAll()
+      _pyhl.start_trace(self.TESTFILE2)
+      try:
+        a.fetch()
+      finally:
+        _pyhl.stop_trace()
+      with open(self.TESTFILE2) as fp:
+        events = json.load(fp)
+      names = [e["name"] for e in events if e["ph"] == "E" and e["name"].startswith("fetch")]
+      # /a is served by the cache without being traced, the others are read in storage order
+      self.assertEqual(["fetch /z", "fetch /m"], names)
+      self.assertEqual(1, _pyhl.get_data_cache_statistics()[0])
+    finally:
+      _pyhl.set_data_cache_limit(0)
+      _pyhl.clear_data_cache()
+
+  def testWholeFileReadLimit(self):
+    data = numpy.arange(200*300, dtype=numpy.int32).reshape(200, 300)
+    a=_pyhl.nodelist()
+    self.addArrayValueNode(a, _pyhl.DATASET_ID, "/data", -1, [200, 300], data, "int", -1)
+    self.addScalarValueNode(a, _pyhl.ATTRIBUTE_ID, "/data/attr", -1, 10, "int", -1)
+    a.write(self.TESTFILE)
+    a = None # Release the written nodes so that the file is closed
+    size = os.path.getsize(self.TESTFILE)
+
+    _pyhl.set_whole_file_read_limit(size)
+    try:
+      self.assertEqual(size, _pyhl.get_whole_file_read_limit())
+      _pyhl.reset_stats()
+      a=_pyhl.read_nodelist(self.TESTFILE)
+      a.selectAll()
+      a.fetch()
+      self.assertEqual(1, _pyhl.get_stats()["files_opened"])
+      self.assertTrue(numpy.all(data == a.getNode("/data").data()))
+      self.assertEqual(10, a.getNode("/data/attr").data())
+      self.assertEqual(size, a.getMemoryUsage()["file"])
+
+      # The image is released by close and fetches then read from the file
+      a.close()
+      self.assertEqual(0, a.getMemoryUsage()["file"])
+      _pyhl.reset_stats()
+      self.assertTrue(numpy.all(data == a.fetchNode("/data").data()))
+      self.assertEqual(1, _pyhl.get_stats()["files_opened"])
+
+      # and before any data when the memory budget is exceeded
+      a=_pyhl.read_nodelist(self.TESTFILE)
+      a.setMemoryBudget(200*300*4 + size // 2)
+      a.selectAll()
+      a.fetch()
+      self.assertEqual(0, a.getMemoryUsage()["file"])
+      self.assertEqual(200*300*4, a.getMemoryUsage()["data"])
+
+      _pyhl.set_whole_file_read_limit(size - 1)
+      _pyhl.reset_stats()
+      a=_pyhl.read_nodelist(self.TESTFILE)
+      a.selectAll()
+      a.fetch()
+      self.assertEqual(2, _pyhl.get_stats()["files_opened"])
+    finally:
+      _pyhl.set_whole_file_read_limit(0)
+
+  def testPagedFileSpace(self):
+    data = numpy.arange(200*300, dtype=numpy.int32).reshape(200, 300)
+    fcp = _pyhl.filecreationproperty()
+    self.assertEqual(_pyhl.FSPACE_STRATEGY_DEFAULT, fcp.fs_strategy)
+    fcp.fs_strategy = _pyhl.FSPACE_STRATEGY_PAGE
+    fcp.fs_page_size = 8192
+    fcp.page_buffer_size = 65536
+    a=_pyhl.nodelist()
+    self.addArrayValueNode(a, _pyhl.DATASET_ID, "/data", -1, [200, 300], data, "int", -1)
+    self.addScalarValueNode(a, _pyhl.ATTRIBUTE_ID, "/data/attr", -1, 10, "int", -1)
+    a.write(self.TESTFILE, fcp)
+    a = None
+    self.assertEqual(0, os.path.getsize(self.TESTFILE) % 8192)
+
+    a=_pyhl.nodelist()
+    self.addScalarValueNode(a, _pyhl.ATTRIBUTE_ID, "/attr", -1, 5, "int", -1)
+    a.write(self.TESTFILE2)
+    a = None
+
+    _pyhl.set_page_buffer_size(65536)
+    try:
+      self.assertEqual(65536, _pyhl.get_page_buffer_size())
+      a=_pyhl.read_nodelist(self.TESTFILE)
+      a.selectAll()
+      a.fetch()
+      self.assertTrue(numpy.all(data == a.getNode("/data").data()))
+      self.assertEqual(10, a.getNode("/data/attr").data())
+
+      # Files without paged aggregation are read without the page buffer
+      a=_pyhl.read_nodelist(self.TESTFILE2)
+      a.selectAll()
+      a.fetch()
+      self.assertEqual(5, a.getNode("/attr").data())
+    finally:
+      _pyhl.set_page_buffer_size(0)
+
+  def testMemoryMappedReads(self):
+    data = numpy.arange(200*300, dtype=numpy.int32).reshape(200, 300)
+    fcp = _pyhl.filecreationproperty()
+    fcp.userblock = 1024
+    a=_pyhl.nodelist()
+    self.addArrayValueNode(a, _pyhl.DATASET_ID, "/plain", -1, [200, 300], data, "int", -1)
+    b = _pyhl.node(_pyhl.DATASET_ID, "/compressed", _pyhl.compression(_pyhl.COMPRESSION_ZLIB))
+    b.setArrayValue(-1, [200, 300], data, "int", -1)
+    a.addNode(b)
+    a.write(self.TESTFILE, fcp)
+
+    _pyhl.set_memory_mapped_reads(1)
+    try:
+      _pyhl.reset_stats()
+      a=_pyhl.read_nodelist(self.TESTFILE)
+      a.setStatisticsOptions(nbins=2, histmin=0.0, histmax=60000.0)
+      a.selectAll()
+      a.fetch()
+      self.assertTrue(numpy.all(data == a.getNode("/plain").data()))
+      self.assertTrue(numpy.all(data == a.getNode("/compressed").data()))
+      self.assertEqual(200*300*4, _pyhl.get_stats()["bytes_mapped"])
+      self.assertAlmostEqual(data.mean(), a.getNode("/plain").statistics()["mean"], 4)
+    finally:
+      _pyhl.set_memory_mapped_reads(0)
+
+  def testMemoryMappedReads_notCached(self):
+    data = numpy.arange(200*300, dtype=numpy.int32).reshape(200, 300)
+    a=_pyhl.nodelist()
+    self.addArrayValueNode(a, _pyhl.DATASET_ID, "/plain", -1, [200, 300], data, "int", -1)
+    b = _pyhl.node(_pyhl.DATASET_ID, "/compressed", _pyhl.compression(_pyhl.COMPRESSION_ZLIB))
+    b.setArrayValue(-1, [200, 300], data, "int", -1)
+    a.addNode(b)
+    a.write(self.TESTFILE)
+
+    _pyhl.set_memory_mapped_reads(1)
+    _pyhl.clear_data_cache()
+    _pyhl.set_data_cache_limit(10*1024*1024)
+    try:
+      _pyhl.reset_stats()
+      a=_pyhl.read_nodelist(self.TESTFILE)
+      a.selectAll()
+      a.fetch()
+      self.assertEqual(200*300*4, _pyhl.get_stats()["bytes_mapped"])
+      # Only the compressed dataset is cached, the mapped one stays exclusive to the node
+      self.assertEqual(200*300*4, _pyhl.get_data_cache_usage())
+      self.assertTrue(numpy.all(data == a.getNode("/plain").data()))
+      self.assertTrue(numpy.all(data == a.getNode("/compressed").data()))
+    finally:
+      _pyhl.set_data_cache_limit(0)
+      _pyhl.clear_data_cache()
+      _pyhl.set_memory_mapped_reads(0)
+
   def testWriteOnlyRootGroup(self):
     a=_pyhl.nodelist()
     b=_pyhl.node(_pyhl.GROUP_ID, "/")
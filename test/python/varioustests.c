@@ -68,10 +68,170 @@ static PyObject* _varioustests_translatePyFormatToHlHdf(PyObject* self, PyObject
   return result;
 }
 
+/**
+ * Reads the node from two nodelists while the data cache is enabled and verifies
+ * that the data is shared until one of them is modified, and that a copy of the
+ * node gets its own data.
+ * Returns a tuple (shared, isolated, deepcopy) where each value is 1 if the
+ * expectation holds.
+ */
+static PyObject* _varioustests_copyOnWrite(PyObject* self, PyObject* args)
+{
+  char* filename = NULL;
+  char* nodename = NULL;
+  HL_NodeList *a = NULL, *b = NULL;
+  HL_Node *na = NULL, *nb = NULL, *copy = NULL;
+  unsigned char* data = NULL;
+  unsigned char orig = 0;
+  size_t nbytes = 0;
+  int shared = 0, isolated = 0, deepcopy = 0;
+
+  if (!PyArg_ParseTuple(args, "ss", &filename, &nodename)) {
+    return NULL;
+  }
+  a = HLNodeList_read(filename);
+  b = HLNodeList_read(filename);
+  if (a == NULL || b == NULL ||
+      (na = HLNodeList_fetchNode(a, nodename)) == NULL ||
+      (nb = HLNodeList_fetchNode(b, nodename)) == NULL) {
+    setException(PyExc_IOError, "Could not fetch node");
+    goto done;
+  }
+  nbytes = (size_t)HLNode_getNumberOfPoints(nb) * HLNode_getDataSize(nb);
+  shared = (HLNode_getConstData(na) == HLNode_getConstData(nb));
+
+  orig = HLNode_getConstData(nb)[0];
+  if ((data = HLNode_getData(na)) == NULL) {
+    setException(PyExc_MemoryError, "Could not get data");
+    goto done;
+  }
+  data[0] = (unsigned char)~orig;
+  isolated = (HLNode_getConstData(na) != HLNode_getConstData(nb) &&
+              HLNode_getConstData(nb)[0] == orig);
+
+  if ((copy = HLNode_copy(nb)) == NULL) {
+    setException(PyExc_MemoryError, "Could not copy node");
+    goto done;
+  }
+  deepcopy = (HLNode_getConstData(copy) != HLNode_getConstData(nb) &&
+              memcmp(HLNode_getConstData(copy), HLNode_getConstData(nb), nbytes) == 0);
+
+done:
+  HLNode_free(copy);
+  HLNodeList_free(a);
+  HLNodeList_free(b);
+  if (PyErr_Occurred()) {
+    return NULL;
+  }
+  return Py_BuildValue("(iii)", shared, isolated, deepcopy);
+}
+
+/**
+ * Fetches two nodes with the same compound type and verifies that they share the
+ * description until one of them is modified.
+ * Returns a tuple (shared, isolated) where each value is 1 if the expectation holds.
+ */
+static PyObject* _varioustests_compoundCopyOnWrite(PyObject* self, PyObject* args)
+{
+  char* filename = NULL;
+  char* name1 = NULL;
+  char* name2 = NULL;
+  HL_NodeList* nodelist = NULL;
+  HL_Node *n1 = NULL, *n2 = NULL;
+  HL_CompoundTypeDescription* descr = NULL;
+  int shared = 0, isolated = 0;
+
+  if (!PyArg_ParseTuple(args, "sss", &filename, &name1, &name2)) {
+    return NULL;
+  }
+  if ((nodelist = HLNodeList_read(filename)) == NULL ||
+      (n1 = HLNodeList_fetchNode(nodelist, name1)) == NULL ||
+      (n2 = HLNodeList_fetchNode(nodelist, name2)) == NULL ||
+      HLNode_getConstCompoundDescription(n1) == NULL) {
+    setException(PyExc_IOError, "Could not fetch compound nodes");
+    goto done;
+  }
+  shared = (HLNode_getConstCompoundDescription(n1) == HLNode_getConstCompoundDescription(n2));
+  if ((descr = HLNode_getCompoundDescription(n1)) == NULL) {
+    setException(PyExc_MemoryError, "Could not get compound description");
+    goto done;
+  }
+  strcpy(descr->attrs[0]->attrname, "modified");
+  isolated = (HLNode_getConstCompoundDescription(n1) != HLNode_getConstCompoundDescription(n2) &&
+              strcmp(HLNode_getConstCompoundDescription(n2)->attrs[0]->attrname, "modified") != 0);
+
+done:
+  HLNodeList_free(nodelist);
+  if (PyErr_Occurred()) {
+    return NULL;
+  }
+  return Py_BuildValue("(ii)", shared, isolated);
+}
+
+/**
+ * Records the largest memory usage of the nodelist seen by the fetch callback.
+ */
+typedef struct {
+  HL_NodeList* nodelist; /**< the nodelist being fetched */
+  size_t peak;           /**< the largest total memory usage */
+} FetchPeakMemory;
+
+/**
+ * Fetch callback, runs on the I/O thread.
+ */
+static void _varioustests_recordPeakMemory(HL_Node* node, int status, void* userdata)
+{
+  FetchPeakMemory* peak = (FetchPeakMemory*)userdata;
+  HL_MemoryUsage usage;
+  HLNodeList_getMemoryUsage(peak->nodelist, &usage);
+  if (usage.total > peak->peak) {
+    peak->peak = usage.total;
+  }
+}
+
+/**
+ * Fetches all nodes asynchronously with all datasets evictable and the given memory budget.
+ * Returns the largest total memory usage of the nodelist while the nodes were fetched.
+ */
+static PyObject* _varioustests_fetchAsyncPeakMemory(PyObject* self, PyObject* args)
+{
+  char* filename = NULL;
+  Py_ssize_t budget = 0;
+  FetchPeakMemory peak = {NULL, 0};
+  HL_FetchHandle* handle = NULL;
+  int i = 0, status = 0;
+
+  if (!PyArg_ParseTuple(args, "sn", &filename, &budget)) {
+    return NULL;
+  }
+  if ((peak.nodelist = HLNodeList_read(filename)) == NULL) {
+    setException(PyExc_IOError, "Could not read nodelist");
+    return NULL;
+  }
+  for (i = 0; i < HLNodeList_getNumberOfNodes(peak.nodelist); i++) {
+    HLNode_setEvictable(HLNodeList_getNodeByIndex(peak.nodelist, i), 1);
+  }
+  HLNodeList_setMemoryBudget(peak.nodelist, (size_t)budget);
+  HLNodeList_selectAllNodes(peak.nodelist);
+  if ((handle = HLNodeList_fetchMarkedNodesAsync(peak.nodelist, _varioustests_recordPeakMemory, &peak)) != NULL) {
+    status = HLFetchHandle_wait(handle);
+    HLFetchHandle_free(handle);
+  }
+  HLNodeList_free(peak.nodelist);
+  if (!status) {
+    setException(PyExc_IOError, "Could not fetch nodes");
+    return NULL;
+  }
+  return PyLong_FromSize_t(peak.peak);
+}
+
 static PyMethodDef functions[] = {
   {"sizeoflong", (PyCFunction)_varioustests_sizeoflong, 1},
   {"sizeoflonglong", (PyCFunction)_varioustests_sizeoflonglong, 1},
   {"translatePyFormatToHlhdf", (PyCFunction)_varioustests_translatePyFormatToHlHdf, 1},
+  {"copyOnWrite", (PyCFunction)_varioustests_copyOnWrite, 1},
+  {"compoundCopyOnWrite", (PyCFunction)_varioustests_compoundCopyOnWrite, 1},
+  {"fetchAsyncPeakMemory", (PyCFunction)_varioustests_fetchAsyncPeakMemory, 1},
   {NULL,NULL} /*Sentinel*/
 };
 